@@ -33,6 +33,10 @@
 #define DROPBEAR_MODE_CBC 1
 #define DROPBEAR_MODE_CTR 2
 
+/* direction argument of dropbear_cipher_mode.aead_crypt() */
+#define DROPBEAR_AEAD_ENCRYPT 0
+#define DROPBEAR_AEAD_DECRYPT 1
+
 struct Algo_Type {
 
 	const char *name; /* identifying name */
@@ -72,6 +76,18 @@ struct dropbear_cipher_mode {
 			unsigned long len, void *cipher_state);
 	int (*decrypt)(const unsigned char *ct, unsigned char *pt, 
 			unsigned long len, void *cipher_state);
+	/* AEAD modes only. aead_crypt() en/decrypts a whole packet and
+	 * writes or checks the tag that follows it, aead_getlength() reads
+	 * the packet length from the first block */
+	int (*aead_crypt)(unsigned int seq,
+			const unsigned char *in, unsigned char *out,
+			unsigned long len, unsigned long taglen,
+			void *cipher_state, int direction);
+	int (*aead_getlength)(unsigned int seq,
+			const unsigned char *in, unsigned int *outlen,
+			unsigned long len, void *cipher_state);
+	/* used in place of the negotiated MAC, only hashsize is used */
+	const struct dropbear_hash *aead_mac;
 };
 
 struct dropbear_hash {
@@ -80,6 +96,16 @@ struct dropbear_hash {
 	/* hashsize may be truncated from the size returned by hash_desc,
 	   eg sha1-96 */
 	const unsigned char hashsize;
+	/* encrypt-then-mac: the MAC covers the length and ciphertext, and
+	   the length field isn't encrypted */
+	const unsigned char etm;
+	/* MACs that aren't an HMAC (UMAC) have no hash_desc. mac_start()
+	   keys the state from the MAC key, and mac() computes the MAC of
+	   a packet from its sequence number and contents */
+	int (*mac_start)(const unsigned char *key, unsigned long keylen,
+			unsigned long maclen, void *mac_state);
+	int (*mac)(unsigned int seqno, const unsigned char *in,
+			unsigned long len, unsigned char *out, void *mac_state);
 };
 
 enum dropbear_kex_mode {
@@ -94,6 +120,9 @@ struct dropbear_kex {
 	/* "normal" DH KEX */
 	const unsigned char *dh_p_bytes;
 	const int dh_p_len;
+	/* private exponent bits with DROPBEAR_DH_SHORT_EXPONENT, twice the
+	 * group's security strength (RFC 8270) */
+	const int dh_priv_bits;
 
 	/* elliptic curve DH KEX */
 	const void* dummy;
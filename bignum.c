@@ -75,6 +75,93 @@ void bytes_to_mp(mp_int *mp, const unsigned char* bytes, unsigned int len) {
 	}
 }
 
+/* The temporaries of a key exchange or signature come from a scratch
+ * arena rather than the heap, see libtommath/bn_mp_arena.c. Enough for
+ * an exptmod's window table and the rest, for the largest modulus seen
+ * so far, anything more goes to the heap */
+#define SCRATCH_DIGITS(used) (96 * (2 * (size_t)(used) + 2 * MP_PREC))
+
+static mp_arena scratch;
+static int scratch_active = 0;
+
+/* Start an operation mod mod. Operations don't nest, a second begin
+ * would rewind or free the digits of the one in progress */
+void m_mp_scratch_begin(mp_int *mod) {
+
+	size_t size = SCRATCH_DIGITS(mod->used);
+
+	dropbear_assert(!scratch_active);
+	scratch_active = 1;
+	if (scratch.size < size) {
+		mp_arena_free(&scratch);
+		if (mp_arena_init(&scratch, size) != MP_OKAY) {
+			dropbear_exit("Mem alloc error");
+		}
+	}
+	mp_arena_begin(&scratch);
+}
+
+/* An mp_int set during the operation that is still needed after it */
+void m_mp_scratch_keep(mp_int *mp) {
+
+	if (mp_arena_keep(mp) != MP_OKAY) {
+		dropbear_exit("Mem alloc error");
+	}
+}
+
+/* Finish, everything else used meanwhile must have been cleared */
+void m_mp_scratch_end() {
+	mp_arena_end();
+	scratch_active = 0;
+}
+
+/* The constants for exponentiations mod mod by the fixed size engine of
+ * libtommath/bn_mp_exptmod_fixed.c, or NULL if it doesn't take mod. To
+ * be kept with mod and freed with m_mp_fixed_free() */
+mp_fixed_mont* m_mp_fixed_new(mp_int *mod) {
+#ifdef LTM_EXPTMOD_FIXED
+	mp_fixed_mont *mont = m_malloc(sizeof(*mont));
+
+	if (mp_fixed_mont_setup(mod, mont) == MP_OKAY) {
+		return mont;
+	}
+	m_free(mont);
+#else
+	(void)mod;
+#endif
+	return NULL;
+}
+
+/* The modulus may be a secret prime */
+void m_mp_fixed_free(mp_fixed_mont *mont) {
+#ifdef LTM_EXPTMOD_FIXED
+	if (mont) {
+		m_burn(mont, sizeof(*mont));
+		m_free(mont);
+	}
+#else
+	(void)mont;
+#endif
+}
+
+/* y = b^x mod mod, with the constants from m_mp_fixed_new() when there
+ * are some. A vector kernel set by crypto_init() is quicker still, so
+ * that goes first through mp_exptmod(). Returns MP_OKAY or an mp error */
+int m_mp_exptmod(mp_int *b, mp_int *x, mp_int *mod, mp_fixed_mont *mont,
+		mp_int *y) {
+#ifdef LTM_EXPTMOD_FIXED
+	int res;
+
+	if (mont != NULL && mp_exptmod_accel == NULL
+			&& (res = mp_exptmod_fixed_mont(b, x, mod, mont, y)) != MP_VAL) {
+		return res;
+	}
+#else
+	(void)mont;
+#endif
+	return mp_exptmod(b, x, mod, y);
+}
+
 /* hash the ssh representation of the mp_int mp */
 void hash_process_mp(const struct ltc_hash_descriptor *hash_desc, 
 				hash_state *hs, mp_int *mp) {
@@ -31,6 +31,13 @@ void m_mp_init(mp_int *mp);
 void m_mp_init_multi(mp_int *mp, ...) ATTRIB_SENTINEL;
 void m_mp_alloc_init_multi(mp_int **mp, ...) ATTRIB_SENTINEL;
 void bytes_to_mp(mp_int *mp, const unsigned char* bytes, unsigned int len);
+void m_mp_scratch_begin(mp_int *mod);
+void m_mp_scratch_keep(mp_int *mp);
+void m_mp_scratch_end(void);
+mp_fixed_mont* m_mp_fixed_new(mp_int *mod);
+void m_mp_fixed_free(mp_fixed_mont *mont);
+int m_mp_exptmod(mp_int *b, mp_int *x, mp_int *mod, mp_fixed_mont *mont,
+		mp_int *y);
 void hash_process_mp(const struct ltc_hash_descriptor *hash_desc, 
 				hash_state *hs, mp_int *mp);
 
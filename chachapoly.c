@@ -0,0 +1,138 @@
+#include "includes.h"
+#include "algo.h"
+#include "dbutil.h"
+#include "chachapoly.h"
+
+/* chacha20-poly1305@openssh.com, see PROTOCOL.chacha20poly1305 in OpenSSH.
+ * The 64 byte key is split in two ChaCha20 keys. The second only encrypts
+ * the 4 byte packet length, the first encrypts the rest of the packet from
+ * block counter 1, and its block 0 provides the Poly1305 key. The nonce is
+ * the packet sequence number and the 16 byte tag replaces the MAC. */
+
+#ifdef DROPBEAR_CHACHA20POLY1305
+
+/* there is no libtomcrypt block cipher behind this, gen_new_keys() skips
+ * find_cipher() for a descriptor without a name */
+static const struct ltc_cipher_descriptor dummy = {NULL};
+
+const struct dropbear_cipher dropbear_chachapoly =
+	{&dummy, CHACHA20_KEY_LEN*2, CHACHA20_BLOCKSIZE};
+
+/* the tag replaces the negotiated MAC */
+static const struct dropbear_hash dropbear_chachapoly_mac =
+	{NULL, POLY1305_KEY_LEN, POLY1305_TAG_LEN, 0};
+
+static int dropbear_chachapoly_start(int UNUSED(cipher), const unsigned char* UNUSED(IV),
+			const unsigned char *key, int keylen,
+			int UNUSED(num_rounds), dropbear_chachapoly_state *state) {
+	int err;
+
+	TRACE2(("enter dropbear_chachapoly_start"))
+
+	if (keylen != CHACHA20_KEY_LEN*2) {
+		return CRYPT_ERROR;
+	}
+
+	if ((err = chacha_setup(&state->chacha, key,
+				CHACHA20_KEY_LEN, 20)) != CRYPT_OK) {
+		return err;
+	}
+
+	if ((err = chacha_setup(&state->header, key + CHACHA20_KEY_LEN,
+				CHACHA20_KEY_LEN, 20)) != CRYPT_OK) {
+		return err;
+	}
+
+	TRACE2(("leave dropbear_chachapoly_start"))
+	return CRYPT_OK;
+}
+
+/* in and out may be the same buffer. len is the length of the packet
+ * including the encrypted length field, the tag follows it */
+static int dropbear_chachapoly_crypt(unsigned int seq,
+			const unsigned char *in, unsigned char *out,
+			unsigned long len, unsigned long taglen,
+			dropbear_chachapoly_state *state, int direction) {
+	poly1305_state poly;
+	unsigned char seqbuf[8], key[POLY1305_KEY_LEN], tag[POLY1305_TAG_LEN];
+	unsigned long tagbuflen = POLY1305_TAG_LEN;
+	int err;
+
+	TRACE2(("enter dropbear_chachapoly_crypt"))
+
+	if (len < 4 || taglen != POLY1305_TAG_LEN) {
+		return CRYPT_ERROR;
+	}
+
+	STORE64H((ulong64)seq, seqbuf);
+
+	/* block 0 of the main key stream is the Poly1305 key */
+	if ((err = chacha_ivctr64(&state->chacha, seqbuf, sizeof(seqbuf), 0)) != CRYPT_OK
+		|| (err = chacha_keystream(&state->chacha, key, sizeof(key))) != CRYPT_OK
+		|| (err = poly1305_init(&poly, key, sizeof(key))) != CRYPT_OK) {
+		goto out;
+	}
+
+	/* check the tag over the ciphertext before decrypting anything */
+	if (direction == DROPBEAR_AEAD_DECRYPT) {
+		if ((err = poly1305_process(&poly, in, len)) != CRYPT_OK
+			|| (err = poly1305_done(&poly, tag, &tagbuflen)) != CRYPT_OK) {
+			goto out;
+		}
+		if (constant_time_memcmp(in + len, tag, taglen) != 0) {
+			err = CRYPT_ERROR;
+			goto out;
+		}
+	}
+
+	if ((err = chacha_ivctr64(&state->header, seqbuf, sizeof(seqbuf), 0)) != CRYPT_OK
+		|| (err = chacha_crypt(&state->header, in, 4, out)) != CRYPT_OK
+		|| (err = chacha_ivctr64(&state->chacha, seqbuf, sizeof(seqbuf), 1)) != CRYPT_OK
+		|| (err = chacha_crypt(&state->chacha, in + 4, len - 4, out + 4)) != CRYPT_OK) {
+		goto out;
+	}
+
+	if (direction == DROPBEAR_AEAD_ENCRYPT) {
+		if ((err = poly1305_process(&poly, out, len)) != CRYPT_OK
+			|| (err = poly1305_done(&poly, out + len, &tagbuflen)) != CRYPT_OK) {
+			goto out;
+		}
+	}
+
+out:
+	m_burn(&poly, sizeof(poly));
+	m_burn(key, sizeof(key));
+	m_burn(tag, sizeof(tag));
+	TRACE2(("leave dropbear_chachapoly_crypt"))
+	return err;
+}
+
+/* decrypt only the length field, the packet stays encrypted for
+ * dropbear_chachapoly_crypt() to authenticate */
+static int dropbear_chachapoly_getlength(unsigned int seq,
+			const unsigned char *in, unsigned int *outlen,
+			unsigned long len, dropbear_chachapoly_state *state) {
+	unsigned char seqbuf[8], buf[4];
+	int err;
+
+	if (len < sizeof(buf)) {
+		return CRYPT_ERROR;
+	}
+
+	STORE64H((ulong64)seq, seqbuf);
+
+	if ((err = chacha_ivctr64(&state->header, seqbuf, sizeof(seqbuf), 0)) == CRYPT_OK
+		&& (err = chacha_crypt(&state->header, in, sizeof(buf), buf)) == CRYPT_OK) {
+		LOAD32H(*outlen, buf);
+	}
+
+	m_burn(buf, sizeof(buf));
+	return err;
+}
+
+const struct dropbear_cipher_mode dropbear_mode_chachapoly =
+	{(void*)dropbear_chachapoly_start, NULL, NULL,
+	(void*)dropbear_chachapoly_crypt, (void*)dropbear_chachapoly_getlength,
+	&dropbear_chachapoly_mac};
+
+#endif /* DROPBEAR_CHACHA20POLY1305 */
@@ -0,0 +1,24 @@
+#ifndef DROPBEAR_CHACHAPOLY_H_
+#define DROPBEAR_CHACHAPOLY_H_
+
+#include "includes.h"
+#include "algo.h"
+
+#ifdef DROPBEAR_CHACHA20POLY1305
+
+#define CHACHA20_KEY_LEN 32
+#define CHACHA20_BLOCKSIZE 8
+#define POLY1305_KEY_LEN 32
+#define POLY1305_TAG_LEN 16
+
+typedef struct {
+	chacha_state chacha;	/* payload, keyed with the first 32 bytes */
+	chacha_state header;	/* packet length, keyed with the second 32 bytes */
+} dropbear_chachapoly_state;
+
+extern const struct dropbear_cipher dropbear_chachapoly;
+extern const struct dropbear_cipher_mode dropbear_mode_chachapoly;
+
+#endif /* DROPBEAR_CHACHA20POLY1305 */
+
+#endif /* DROPBEAR_CHACHAPOLY_H_ */
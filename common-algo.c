@@ -28,6 +28,8 @@
 #include "session.h"
 #include "dbutil.h"
 #include "dh_groups.h"
+#include "gcm.h"
+#include "chachapoly.h"
 
 /* This file (algo.c) organises the ciphers which can be used, and is used to
  * decide which ciphers/hashes/compression/signing to use during key exchange*/
@@ -90,24 +92,82 @@ const struct dropbear_cipher_mode dropbear_mode_ctr =
 	{(void*)dropbear_big_endian_ctr_start, (void*)ctr_encrypt, (void*)ctr_decrypt};
 #endif /* DROPBEAR_ENABLE_CTR_MODE */
 
+#ifdef DROPBEAR_UMAC
+/* UMAC derives its subkeys with AES keyed by the MAC key, and takes the
+   sequence number as its nonce */
+static int dropbear_umac_start(const unsigned char *key, unsigned long keylen,
+		unsigned long maclen, umac_state *umac) {
+	return umac_init(umac, find_cipher("aes"), key, keylen, maclen);
+}
+static int dropbear_umac(unsigned int seqno, const unsigned char *in,
+		unsigned long len, unsigned char *out, umac_state *umac) {
+	unsigned char nonce[8];
+	unsigned long outlen = umac->taglen;
+	int err;
+
+	STORE64H((ulong64)seqno, nonce);
+	if ((err = umac_process(umac, in, len)) != CRYPT_OK) {
+		return err;
+	}
+	return umac_done(umac, nonce, sizeof(nonce), out, &outlen);
+}
+#endif /* DROPBEAR_UMAC */
+
 /* Mapping of ssh hashes to libtomcrypt hashes, including keysize etc.
-   {&hash_desc, keysize, hashsize} */
+   {&hash_desc, keysize, hashsize, etm} */
 
 #ifdef DROPBEAR_SHA1_HMAC
 static const struct dropbear_hash dropbear_sha1 = 
-	{&sha1_desc, 20, 20};
+	{&sha1_desc, 20, 20, 0};
 #endif
 #ifdef DROPBEAR_SHA1_96_HMAC
 static const struct dropbear_hash dropbear_sha1_96 = 
-	{&sha1_desc, 20, 12};
+	{&sha1_desc, 20, 12, 0};
+#endif
+#ifdef DROPBEAR_SHA2_256_HMAC
+static const struct dropbear_hash dropbear_sha2_256 = 
+	{&sha256_desc, 32, 32, 0};
 #endif
 #ifdef DROPBEAR_MD5_HMAC
 static const struct dropbear_hash dropbear_md5 = 
-	{&md5_desc, 16, 16};
+	{&md5_desc, 16, 16, 0};
 #endif
 
+#ifdef DROPBEAR_ETM_HMAC
+#ifdef DROPBEAR_SHA1_HMAC
+static const struct dropbear_hash dropbear_sha1_etm = 
+	{&sha1_desc, 20, 20, 1};
+#endif
+#ifdef DROPBEAR_SHA1_96_HMAC
+static const struct dropbear_hash dropbear_sha1_96_etm = 
+	{&sha1_desc, 20, 12, 1};
+#endif
+#ifdef DROPBEAR_SHA2_256_HMAC
+static const struct dropbear_hash dropbear_sha2_256_etm = 
+	{&sha256_desc, 32, 32, 1};
+#endif
+#ifdef DROPBEAR_MD5_HMAC
+static const struct dropbear_hash dropbear_md5_etm = 
+	{&md5_desc, 16, 16, 1};
+#endif
+#endif /* DROPBEAR_ETM_HMAC */
+
+#ifdef DROPBEAR_UMAC
+/* {NULL, keysize, hashsize, etm, mac_start, mac} */
+static const struct dropbear_hash dropbear_umac64 = 
+	{NULL, 16, 8, 0, (void*)dropbear_umac_start, (void*)dropbear_umac};
+static const struct dropbear_hash dropbear_umac128 = 
+	{NULL, 16, 16, 0, (void*)dropbear_umac_start, (void*)dropbear_umac};
+#ifdef DROPBEAR_ETM_HMAC
+static const struct dropbear_hash dropbear_umac64_etm = 
+	{NULL, 16, 8, 1, (void*)dropbear_umac_start, (void*)dropbear_umac};
+static const struct dropbear_hash dropbear_umac128_etm = 
+	{NULL, 16, 16, 1, (void*)dropbear_umac_start, (void*)dropbear_umac};
+#endif
+#endif /* DROPBEAR_UMAC */
+
 const struct dropbear_hash dropbear_nohash =
-	{NULL, 16, 0}; /* used initially */
+	{NULL, 16, 0, 0}; /* used initially */
 	
 
 /* The following map ssh names to internal values.
@@ -115,6 +175,16 @@ const struct dropbear_hash dropbear_nohash =
  * that is also supported by the server will get used. */
 
 algo_type sshciphers[] = {
+#ifdef DROPBEAR_CHACHA20POLY1305
+	{"chacha20-poly1305@openssh.com", 0, &dropbear_chachapoly, 1, &dropbear_mode_chachapoly},
+#endif
+
+#ifdef DROPBEAR_ENABLE_GCM_MODE
+#ifdef DROPBEAR_AES128
+	{"aes128-gcm@openssh.com", 0, &dropbear_aes128, 1, &dropbear_mode_gcm},
+#endif
+#endif /* DROPBEAR_ENABLE_GCM_MODE */
+
 #ifdef DROPBEAR_ENABLE_CTR_MODE
 #ifdef DROPBEAR_AES128
 	{"aes128-ctr", 0, &dropbear_aes128, 1, &dropbear_mode_ctr},
@@ -142,6 +212,31 @@ algo_type sshciphers[] = {
 };
 
 algo_type sshhashes[] = {
+#ifdef DROPBEAR_ETM_HMAC
+#ifdef DROPBEAR_UMAC
+	{"umac-64-etm@openssh.com", 0, &dropbear_umac64_etm, 1, NULL},
+	{"umac-128-etm@openssh.com", 0, &dropbear_umac128_etm, 1, NULL},
+#endif
+#ifdef DROPBEAR_SHA2_256_HMAC
+	{"hmac-sha2-256-etm@openssh.com", 0, &dropbear_sha2_256_etm, 1, NULL},
+#endif
+#ifdef DROPBEAR_SHA1_HMAC
+	{"hmac-sha1-etm@openssh.com", 0, &dropbear_sha1_etm, 1, NULL},
+#endif
+#ifdef DROPBEAR_SHA1_96_HMAC
+	{"hmac-sha1-96-etm@openssh.com", 0, &dropbear_sha1_96_etm, 1, NULL},
+#endif
+#ifdef DROPBEAR_MD5_HMAC
+	{"hmac-md5-etm@openssh.com", 0, (void*)&dropbear_md5_etm, 1, NULL},
+#endif
+#endif /* DROPBEAR_ETM_HMAC */
+#ifdef DROPBEAR_UMAC
+	{"umac-64@openssh.com", 0, &dropbear_umac64, 1, NULL},
+	{"umac-128@openssh.com", 0, &dropbear_umac128, 1, NULL},
+#endif
+#ifdef DROPBEAR_SHA2_256_HMAC
+	{"hmac-sha2-256", 0, &dropbear_sha2_256, 1, NULL},
+#endif
 #ifdef DROPBEAR_SHA1_96_HMAC
 	{"hmac-sha1-96", 0, &dropbear_sha1_96, 1, NULL},
 #endif
@@ -163,6 +258,12 @@ algo_type ssh_nocompress[] = {
 };
 
 algo_type sshhostkey[] = {
+#ifdef DROPBEAR_ED25519
+	{"ssh-ed25519", DROPBEAR_SIGNKEY_ED25519, NULL, 1, NULL},
+#endif
+#ifdef DROPBEAR_ECDSA
+	{"ecdsa-sha2-nistp256", DROPBEAR_SIGNKEY_ECDSA_NISTP256, NULL, 1, NULL},
+#endif
 #ifdef DROPBEAR_RSA
 	{"ssh-rsa", DROPBEAR_SIGNKEY_RSA, NULL, 1, NULL},
 #endif
@@ -173,13 +274,28 @@ algo_type sshhostkey[] = {
 };
 
 #if DROPBEAR_DH_GROUP1
-static const struct dropbear_kex kex_dh_group1 = {DROPBEAR_KEX_NORMAL_DH, dh_p_1, DH_P_1_LEN, NULL, &sha1_desc };
+static const struct dropbear_kex kex_dh_group1 = {DROPBEAR_KEX_NORMAL_DH, dh_p_1, DH_P_1_LEN, 160, NULL, &sha1_desc };
 #endif
 #if DROPBEAR_DH_GROUP14
-static const struct dropbear_kex kex_dh_group14_sha1 = {DROPBEAR_KEX_NORMAL_DH, dh_p_14, DH_P_14_LEN, NULL, &sha1_desc };
+static const struct dropbear_kex kex_dh_group14_sha1 = {DROPBEAR_KEX_NORMAL_DH, dh_p_14, DH_P_14_LEN, 224, NULL, &sha1_desc };
+#endif
+
+#ifdef DROPBEAR_CURVE25519
+static const struct dropbear_kex kex_curve25519 = {DROPBEAR_KEX_CURVE25519, NULL, 0, 0, NULL, &sha256_desc };
+#endif
+
+#ifdef DROPBEAR_ECDH
+static const struct dropbear_kex kex_ecdh_nistp256 = {DROPBEAR_KEX_ECDH, NULL, 0, 0, NULL, &sha256_desc };
 #endif
 
 algo_type sshkex[] = {
+#ifdef DROPBEAR_CURVE25519
+	{"curve25519-sha256", 0, &kex_curve25519, 1, NULL},
+	{"curve25519-sha256@libssh.org", 0, &kex_curve25519, 1, NULL},
+#endif
+#ifdef DROPBEAR_ECDH
+	{"ecdh-sha2-nistp256", 0, &kex_ecdh_nistp256, 1, NULL},
+#endif
 #if DROPBEAR_DH_GROUP14
 	{"diffie-hellman-group14-sha1", 0, &kex_dh_group14_sha1, 1, NULL},
 #endif
@@ -35,7 +35,7 @@
 #include "bignum.h"
 #include "dbrandom.h"
 #include "runopts.h"
-// #include "ecc.h"
+#include "ecc.h"
 #include "crypto_desc.h"
 
 static void kexinitialise(void);
@@ -44,7 +44,9 @@ static void read_kex_algos(void);
 /* helper function for gen_new_keys */
 static void hashkeys(unsigned char *out, unsigned int outlen, 
 		const hash_state * hs, const unsigned char X);
+static void gen_mac_states(struct key_context_directional *keys);
 static void finish_kexhashbuf(void);
+static void *kex_take_param(const struct dropbear_kex *kex);
 
 
 /* Send our list of algorithms we can use */
@@ -241,6 +243,37 @@ static void hashkeys(unsigned char *out, unsigned int outlen,
 	m_burn(&hs2, sizeof(hash_state));
 }
 
+/* Helper function for gen_new_keys, hashes the HMAC key XORed with ipad
+ * and opad into keys->mac_inner and keys->mac_outer. make_mac() starts
+ * from copies of these rather than calling hmac_init() for every packet.
+ * keys->mackey and keys->algo_mac must already be set. */
+static void gen_mac_states(struct key_context_directional *keys) {
+
+	const struct ltc_hash_descriptor *hash_desc = keys->algo_mac->hash_desc;
+	unsigned char pad[MAXBLOCKSIZE];
+	unsigned int i;
+
+	/* all our MAC keys are shorter than the hash block */
+	dropbear_assert(keys->algo_mac->keysize <= hash_desc->blocksize);
+
+	memset(pad, 0x0, hash_desc->blocksize);
+	memcpy(pad, keys->mackey, keys->algo_mac->keysize);
+	for (i = 0; i < hash_desc->blocksize; i++) {
+		pad[i] ^= 0x36;
+	}
+	hash_desc->init(&keys->mac_inner);
+	hash_desc->process(&keys->mac_inner, pad, hash_desc->blocksize);
+
+	/* 0x36 ^ 0x5c flips ipad to opad */
+	for (i = 0; i < hash_desc->blocksize; i++) {
+		pad[i] ^= 0x36 ^ 0x5c;
+	}
+	hash_desc->init(&keys->mac_outer);
+	hash_desc->process(&keys->mac_outer, pad, hash_desc->blocksize);
+
+	m_burn(pad, sizeof(pad));
+}
+
 /* Generate the actual encryption/integrity keys, using the results of the
  * key exchange, as specified in section 7.2 of the transport rfc 4253.
  * This occurs after the DH key-exchange.
@@ -280,15 +313,24 @@ static void gen_new_keys() {
 	mactransletter = 'F';
 	macrecvletter = 'E';
 
+	/* the keys are only MAX_KEY_LEN long, a cipher with a longer key would
+	 * read past them (as 3des-cbc did with a MAX_KEY_LEN of 16) */
+	dropbear_assert(ses.newkeys->recv.algo_crypt->keysize <= MAX_KEY_LEN
+			&& ses.newkeys->trans.algo_crypt->keysize <= MAX_KEY_LEN);
+
 	hashkeys(C2S_IV, sizeof(C2S_IV), &hs, 'A');
 	hashkeys(S2C_IV, sizeof(S2C_IV), &hs, 'B');
 	hashkeys(C2S_key, sizeof(C2S_key), &hs, 'C');
 	hashkeys(S2C_key, sizeof(S2C_key), &hs, 'D');
 
 	if (ses.newkeys->recv.algo_crypt->cipherdesc != NULL) {
-		int recv_cipher = find_cipher(ses.newkeys->recv.algo_crypt->cipherdesc->name);
-		if (recv_cipher < 0)
-			dropbear_exit("Crypto error");
+		int recv_cipher = -1;
+		/* chacha20-poly1305 has a descriptor with no libtomcrypt cipher */
+		if (ses.newkeys->recv.algo_crypt->cipherdesc->name != NULL) {
+			recv_cipher = find_cipher(ses.newkeys->recv.algo_crypt->cipherdesc->name);
+			if (recv_cipher < 0)
+				dropbear_exit("Crypto error");
+		}
 		if (ses.newkeys->recv.crypt_mode->start(recv_cipher, 
 				recv_IV, recv_key, 
 				ses.newkeys->recv.algo_crypt->keysize, 0, 
@@ -298,9 +340,12 @@ static void gen_new_keys() {
 	}
 
 	if (ses.newkeys->trans.algo_crypt->cipherdesc != NULL) {
-		int trans_cipher = find_cipher(ses.newkeys->trans.algo_crypt->cipherdesc->name);
-		if (trans_cipher < 0)
-			dropbear_exit("Crypto error");
+		int trans_cipher = -1;
+		if (ses.newkeys->trans.algo_crypt->cipherdesc->name != NULL) {
+			trans_cipher = find_cipher(ses.newkeys->trans.algo_crypt->cipherdesc->name);
+			if (trans_cipher < 0)
+				dropbear_exit("Crypto error");
+		}
 		if (ses.newkeys->trans.crypt_mode->start(trans_cipher, 
 				trans_IV, trans_key, 
 				ses.newkeys->trans.algo_crypt->keysize, 0, 
@@ -312,13 +357,31 @@ static void gen_new_keys() {
 	if (ses.newkeys->trans.algo_mac->hash_desc != NULL) {
 		hashkeys(ses.newkeys->trans.mackey, 
 				ses.newkeys->trans.algo_mac->keysize, &hs, mactransletter);
-		ses.newkeys->trans.hash_index = find_hash(ses.newkeys->trans.algo_mac->hash_desc->name);
+		gen_mac_states(&ses.newkeys->trans);
+	} else if (ses.newkeys->trans.algo_mac->mac_start != NULL) {
+		hashkeys(ses.newkeys->trans.mackey, 
+				ses.newkeys->trans.algo_mac->keysize, &hs, mactransletter);
+		if (ses.newkeys->trans.algo_mac->mac_start(ses.newkeys->trans.mackey,
+				ses.newkeys->trans.algo_mac->keysize,
+				ses.newkeys->trans.algo_mac->hashsize,
+				&ses.newkeys->trans.mac_state) != CRYPT_OK) {
+			dropbear_exit("Crypto error");
+		}
 	}
 
 	if (ses.newkeys->recv.algo_mac->hash_desc != NULL) {
 		hashkeys(ses.newkeys->recv.mackey, 
 				ses.newkeys->recv.algo_mac->keysize, &hs, macrecvletter);
-		ses.newkeys->recv.hash_index = find_hash(ses.newkeys->recv.algo_mac->hash_desc->name);
+		gen_mac_states(&ses.newkeys->recv);
+	} else if (ses.newkeys->recv.algo_mac->mac_start != NULL) {
+		hashkeys(ses.newkeys->recv.mackey, 
+				ses.newkeys->recv.algo_mac->keysize, &hs, macrecvletter);
+		if (ses.newkeys->recv.algo_mac->mac_start(ses.newkeys->recv.mackey,
+				ses.newkeys->recv.algo_mac->keysize,
+				ses.newkeys->recv.algo_mac->hashsize,
+				&ses.newkeys->recv.mac_state) != CRYPT_OK) {
+			dropbear_exit("Crypto error");
+		}
 	}
 
 	/* Ready to switch over */
@@ -395,51 +458,65 @@ void recv_msg_kexinit() {
 	TRACE(("leave recv_msg_kexinit"))
 }
 
-static void load_dh_p(mp_int * dh_p)
+/* The group for a DH kex, built on first use */
+static struct dh_group *kex_dh_group(const struct dropbear_kex *kex)
 {
-	bytes_to_mp(dh_p, ses.newkeys->algo_kex->dh_p_bytes, 
-		ses.newkeys->algo_kex->dh_p_len);
+#ifdef DROPBEAR_DH_SHORT_EXPONENT
+	/* the upper bound is 2^bits rather than q, which is far larger */
+	int priv_bits = kex->dh_priv_bits;
+#else
+	/* the upper bound is q = (p-1)/2 */
+	int priv_bits = 0;
+#endif
+	return dh_get_group(kex->dh_p_bytes, kex->dh_p_len, priv_bits);
+}
+
+/* Builds the groups of all the DH kex methods we offer. Done once before
+ * forking, rather than by each connection */
+void kexdh_init_groups() {
+	unsigned int i;
+
+	for (i = 0; sshkex[i].name != NULL; i++) {
+		const struct dropbear_kex *kex = sshkex[i].data;
+		if (kex->mode == DROPBEAR_KEX_NORMAL_DH) {
+			kex_dh_group(kex);
+		}
+	}
 }
 
 /* Initialises and generate one side of the diffie-hellman key exchange values.
  * See the transport rfc 4253 section 8 for details */
-/* dh_pub and dh_priv MUST be already initialised */
-struct kex_dh_param *gen_kexdh_param() {
+static struct kex_dh_param *make_kexdh_param(const struct dropbear_kex *kex) {
 	struct kex_dh_param *param = NULL;
-
-	DEF_MP_INT(dh_p);
-	DEF_MP_INT(dh_q);
-	DEF_MP_INT(dh_g);
+	struct dh_group *group = kex_dh_group(kex);
 
 	TRACE(("enter gen_kexdh_vals"))
 
 	param = m_malloc(sizeof(*param));
-	m_mp_init_multi(&param->pub, &param->priv, &dh_g, &dh_p, &dh_q, NULL);
+	m_mp_init_multi(&param->pub, &param->priv, NULL);
+	m_mp_scratch_begin(&group->p);
 
-	/* read the prime and generator*/
-	load_dh_p(&dh_p);
-	
-	if (mp_set_int(&dh_g, DH_G_VAL) != MP_OKAY) {
-		dropbear_exit("Diffie-Hellman error");
-	}
+	/* Generate a private portion 0 < dh_priv < dh_q */
+	gen_random_mpint(&group->q, &param->priv);
 
-	/* calculate q = (p-1)/2 */
-	/* dh_priv is just a temp var here */
-	if (mp_sub_d(&dh_p, 1, &param->priv) != MP_OKAY) { 
-		dropbear_exit("Diffie-Hellman error");
-	}
-	if (mp_div_2(&param->priv, &dh_q) != MP_OKAY) {
+	/* f = g^y mod p, the generator is DH_G_VAL = 2 for all groups */
+	if (dh_exptmod_g2(group, &param->priv, &param->pub) != MP_OKAY) {
 		dropbear_exit("Diffie-Hellman error");
 	}
 
-	/* Generate a private portion 0 < dh_priv < dh_q */
-	gen_random_mpint(&dh_q, &param->priv);
+	m_mp_scratch_keep(&param->pub);
+	m_mp_scratch_keep(&param->priv);
+	m_mp_scratch_end();
+	return param;
+}
 
-	/* f = g^y mod p */
-	if (mp_exptmod(&dh_g, &param->priv, &dh_p, &param->pub) != MP_OKAY) {
-		dropbear_exit("Diffie-Hellman error");
+/* Our half of the exchange, precomputed if kex_precompute() got to it */
+struct kex_dh_param *gen_kexdh_param() {
+	struct kex_dh_param *param = kex_take_param(ses.newkeys->algo_kex);
+
+	if (param == NULL) {
+		param = make_kexdh_param(ses.newkeys->algo_kex);
 	}
-	mp_clear_multi(&dh_g, &dh_p, &dh_q, NULL);
 	return param;
 }
 
@@ -456,31 +533,23 @@ void free_kexdh_param(struct kex_dh_param *param)
 void kexdh_comb_key(struct kex_dh_param *param, mp_int *dh_pub_them,
 		sign_key *hostkey) {
 
-	DEF_MP_INT(dh_p);
-	DEF_MP_INT(dh_p_min1);
+	struct dh_group *group = kex_dh_group(ses.newkeys->algo_kex);
 	mp_int *dh_e = NULL, *dh_f = NULL;
 
-	m_mp_init_multi(&dh_p, &dh_p_min1, NULL);
-	load_dh_p(&dh_p);
-
-	if (mp_sub_d(&dh_p, 1, &dh_p_min1) != MP_OKAY) { 
-		dropbear_exit("Diffie-Hellman error");
-	}
-
 	/* Check that dh_pub_them (dh_e or dh_f) is in the range [2, p-2] */
-	if (mp_cmp(dh_pub_them, &dh_p_min1) != MP_LT 
+	if (mp_cmp(dh_pub_them, &group->p_min1) != MP_LT 
 			|| mp_cmp_d(dh_pub_them, 1) != MP_GT) {
 		dropbear_exit("Diffie-Hellman error");
 	}
 	
 	/* K = e^y mod p = f^x mod p */
 	m_mp_alloc_init_multi(&ses.dh_K, NULL);
-	if (mp_exptmod(dh_pub_them, &param->priv, &dh_p, ses.dh_K) != MP_OKAY) {
+	m_mp_scratch_begin(&group->p);
+	if (dh_exptmod(group, dh_pub_them, &param->priv, ses.dh_K) != MP_OKAY) {
 		dropbear_exit("Diffie-Hellman error");
 	}
-
-	/* clear no longer needed vars */
-	mp_clear_multi(&dh_p, &dh_p_min1, NULL);
+	m_mp_scratch_keep(ses.dh_K);
+	m_mp_scratch_end();
 
 	/* From here on, the code needs to work with the _same_ vars on each side,
 	 * not vice-versaing for client/server */
@@ -501,6 +570,218 @@ void kexdh_comb_key(struct kex_dh_param *param, mp_int *dh_pub_them,
 	finish_kexhashbuf();
 }
 
+#ifdef DROPBEAR_CURVE25519
+/* A random private key and its public value, see RFC 8731 */
+static struct kex_curve25519_param *make_kexcurve25519_param() {
+	struct kex_curve25519_param *param = m_malloc(sizeof(*param));
+
+	/* the clamping is done in curve25519_scalarmult() */
+	genrandom(param->priv, CURVE25519_LEN);
+	curve25519_base(param->pub, param->priv);
+	return param;
+}
+
+struct kex_curve25519_param *gen_kexcurve25519_param() {
+	struct kex_curve25519_param *param = kex_take_param(ses.newkeys->algo_kex);
+
+	if (param == NULL) {
+		param = make_kexcurve25519_param();
+	}
+	return param;
+}
+
+void free_kexcurve25519_param(struct kex_curve25519_param *param)
+{
+	m_burn(param->priv, CURVE25519_LEN);
+	m_free(param);
+}
+
+/* The curve25519 counterpart of kexdh_comb_key(), pub_them being Q_C
+ * for the server */
+void kexcurve25519_comb_key(struct kex_curve25519_param *param,
+		const unsigned char *pub_them, unsigned int pub_them_len,
+		sign_key *hostkey) {
+	static const unsigned char zeroes[CURVE25519_LEN] = {0};
+	unsigned char out[CURVE25519_LEN];
+
+	if (pub_them_len != CURVE25519_LEN) {
+		dropbear_exit("Bad curve25519");
+	}
+
+	curve25519_scalarmult(out, param->priv, pub_them);
+	/* a low order point from the other side gives all zeroes */
+	if (constant_time_memcmp(out, zeroes, CURVE25519_LEN) == 0) {
+		dropbear_exit("Bad curve25519");
+	}
+
+	/* K is the output as a big endian integer (RFC 8731 section 3.1) */
+	m_mp_alloc_init_multi(&ses.dh_K, NULL);
+	bytes_to_mp(ses.dh_K, out, CURVE25519_LEN);
+	m_burn(out, sizeof(out));
+
+	/* Create the remainder of the hash buffer, to generate the exchange hash.
+	 * See RFC5656 section 4 page 7 */
+	/* K_S, the host key */
+	buf_put_pub_key(ses.kexhashbuf, hostkey, ses.newkeys->algo_hostkey);
+	/* Q_C, client's ephemeral public key octet string */
+	buf_putstring(ses.kexhashbuf, (const char*)pub_them, CURVE25519_LEN);
+	/* Q_S, server's ephemeral public key octet string */
+	buf_putstring(ses.kexhashbuf, (const char*)param->pub, CURVE25519_LEN);
+	/* K, the shared secret */
+	buf_putmpint(ses.kexhashbuf, ses.dh_K);
+
+	/* calculate the hash H to sign */
+	finish_kexhashbuf();
+}
+#endif /* DROPBEAR_CURVE25519 */
+
+#ifdef DROPBEAR_ECDH
+/* A random private key and its public point, see RFC 5656 */
+static struct kex_ecdh_param *make_kexecdh_param() {
+	struct kex_ecdh_param *param = m_malloc(sizeof(*param));
+
+	ecc256_gen_priv(param->priv);
+	ecc256_make_key(param->pub, param->priv);
+	return param;
+}
+
+struct kex_ecdh_param *gen_kexecdh_param() {
+	struct kex_ecdh_param *param = kex_take_param(ses.newkeys->algo_kex);
+
+	if (param == NULL) {
+		param = make_kexecdh_param();
+	}
+	return param;
+}
+
+void free_kexecdh_param(struct kex_ecdh_param *param)
+{
+	m_burn(param->priv, ECC256_LEN);
+	m_free(param);
+}
+
+/* The nistp256 counterpart of kexdh_comb_key(), pub_them being Q_C
+ * for the server */
+void kexecdh_comb_key(struct kex_ecdh_param *param,
+		const unsigned char *pub_them, unsigned int pub_them_len,
+		sign_key *hostkey) {
+	unsigned char out[ECC256_LEN];
+
+	/* checks that Q_C is on the curve (RFC 5656 section 4) */
+	if (ecc256_shared(out, param->priv, pub_them, pub_them_len)
+			== DROPBEAR_FAILURE) {
+		dropbear_exit("Bad ecdh");
+	}
+
+	/* K is the x coordinate of the shared point */
+	m_mp_alloc_init_multi(&ses.dh_K, NULL);
+	bytes_to_mp(ses.dh_K, out, ECC256_LEN);
+	m_burn(out, sizeof(out));
+
+	/* Create the remainder of the hash buffer, to generate the exchange hash.
+	 * See RFC5656 section 4 page 7 */
+	/* K_S, the host key */
+	buf_put_pub_key(ses.kexhashbuf, hostkey, ses.newkeys->algo_hostkey);
+	/* Q_C, client's ephemeral public key octet string */
+	buf_putstring(ses.kexhashbuf, (const char*)pub_them, pub_them_len);
+	/* Q_S, server's ephemeral public key octet string */
+	buf_putstring(ses.kexhashbuf, (const char*)param->pub, ECC256_POINT_LEN);
+	/* K, the shared secret */
+	buf_putmpint(ses.kexhashbuf, ses.dh_K);
+
+	/* calculate the hash H to sign */
+	finish_kexhashbuf();
+}
+#endif /* DROPBEAR_ECDH */
+
+/* Whether work for the next key exchange is worth doing ahead of it.
+ * That waits until the session is half way to a rekey of its own, since
+ * most sessions never get there, and three quarters of the way unless the
+ * session is idle */
+int kex_rekey_near(int idle) {
+	unsigned int data, quarters;
+	time_t elapsed;
+
+	if (!ses.kexstate.donefirstkex
+			|| ses.kexstate.sentkexinit || ses.kexstate.recvkexinit) {
+		return 0;
+	}
+
+	quarters = idle ? 2 : 3;
+	elapsed = monotonic_now() - ses.kexstate.lastkextime;
+	data = ses.kexstate.datarecv + ses.kexstate.datatrans;
+	return elapsed >= KEX_REKEY_TIMEOUT / 4 * quarters
+		|| data >= KEX_REKEY_DATA / 4 * quarters;
+}
+
+/* Whether kex_precompute() should make our half of the next key exchange */
+int kex_precompute_wanted(int idle) {
+	return ses.kexstate.next_param == NULL && kex_rekey_near(idle);
+}
+
+/* Make our half of the next key exchange ahead of a rekey, for the method
+ * of the last one. The rekey then only has to combine it with the peer's
+ * half, rather than stalling the session for both */
+void kex_precompute() {
+	const struct dropbear_kex *kex = ses.keys->algo_kex;
+	void *param = NULL;
+
+	TRACE(("enter kex_precompute"))
+	switch (kex->mode) {
+		case DROPBEAR_KEX_NORMAL_DH:
+			param = make_kexdh_param(kex);
+			break;
+		case DROPBEAR_KEX_ECDH:
+#ifdef DROPBEAR_ECDH
+			param = make_kexecdh_param();
+#endif
+			break;
+		case DROPBEAR_KEX_CURVE25519:
+#ifdef DROPBEAR_CURVE25519
+			param = make_kexcurve25519_param();
+#endif
+			break;
+	}
+	ses.kexstate.next_kex = kex;
+	ses.kexstate.next_param = param;
+	TRACE(("leave kex_precompute"))
+}
+
+/* The precomputed half for kex, or NULL if there isn't one. One made for
+ * a different method is freed */
+static void *kex_take_param(const struct dropbear_kex *kex) {
+	const struct dropbear_kex *next_kex = ses.kexstate.next_kex;
+	void *param = ses.kexstate.next_param;
+
+	ses.kexstate.next_kex = NULL;
+	ses.kexstate.next_param = NULL;
+	if (param == NULL || next_kex == kex) {
+		return param;
+	}
+
+	switch (next_kex->mode) {
+		case DROPBEAR_KEX_NORMAL_DH:
+			free_kexdh_param(param);
+			break;
+		case DROPBEAR_KEX_ECDH:
+#ifdef DROPBEAR_ECDH
+			free_kexecdh_param(param);
+#endif
+			break;
+		case DROPBEAR_KEX_CURVE25519:
+#ifdef DROPBEAR_CURVE25519
+			free_kexcurve25519_param(param);
+#endif
+			break;
+	}
+	return NULL;
+}
+
+/* Free a precomputed half at the end of the session */
+void kex_precompute_cleanup() {
+	kex_take_param(NULL);
+}
+
 static void finish_kexhashbuf(void) {
 	hash_state hs;
 	const struct ltc_hash_descriptor *hash_desc = ses.newkeys->algo_kex->hash_desc;
@@ -595,19 +876,34 @@ static void read_kex_algos() {
 
 	/* mac_algorithms_client_to_server */
 	c2s_hash_algo = buf_match_algo(ses.payload, sshhashes, NULL);
-	if (c2s_hash_algo == NULL) {
-		erralgo = "mac c->s";
-		goto error;
+#ifdef DROPBEAR_AEAD_MODE
+	if (((struct dropbear_cipher_mode*)c2s_cipher_algo->mode)->aead_crypt != NULL) {
+		/* the cipher authenticates, the MAC list is ignored */
+		c2s_hash_algo = NULL;
+	} else
+#endif
+	{
+		if (c2s_hash_algo == NULL) {
+			erralgo = "mac c->s";
+			goto error;
+		}
+		TRACE(("hash c2s is  %s", c2s_hash_algo->name))
 	}
-	TRACE(("hash c2s is  %s", c2s_hash_algo->name))
 
 	/* mac_algorithms_server_to_client */
 	s2c_hash_algo = buf_match_algo(ses.payload, sshhashes, NULL);
-	if (s2c_hash_algo == NULL) {
-		erralgo = "mac s->c";
-		goto error;
+#ifdef DROPBEAR_AEAD_MODE
+	if (((struct dropbear_cipher_mode*)s2c_cipher_algo->mode)->aead_crypt != NULL) {
+		s2c_hash_algo = NULL;
+	} else
+#endif
+	{
+		if (s2c_hash_algo == NULL) {
+			erralgo = "mac s->c";
+			goto error;
+		}
+		TRACE(("hash s2c is  %s", s2c_hash_algo->name))
 	}
-	TRACE(("hash s2c is  %s", s2c_hash_algo->name))
 
 	/* compression_algorithms_client_to_server */
 	c2s_comp_algo = buf_match_algo(ses.payload, ses.compress_algos, NULL);
@@ -651,10 +947,12 @@ static void read_kex_algos() {
 		(struct dropbear_cipher_mode*)c2s_cipher_algo->mode;
 	ses.newkeys->trans.crypt_mode =
 		(struct dropbear_cipher_mode*)s2c_cipher_algo->mode;
-	ses.newkeys->recv.algo_mac = 
-		(struct dropbear_hash*)c2s_hash_algo->data;
-	ses.newkeys->trans.algo_mac = 
-		(struct dropbear_hash*)s2c_hash_algo->data;
+	ses.newkeys->recv.algo_mac = c2s_hash_algo != NULL
+		? (struct dropbear_hash*)c2s_hash_algo->data
+		: ses.newkeys->recv.crypt_mode->aead_mac;
+	ses.newkeys->trans.algo_mac = s2c_hash_algo != NULL
+		? (struct dropbear_hash*)s2c_hash_algo->data
+		: ses.newkeys->trans.crypt_mode->aead_mac;
 	ses.newkeys->recv.algo_comp = c2s_comp_algo->val;
 	ses.newkeys->trans.algo_comp = s2c_comp_algo->val;
 
@@ -143,13 +143,17 @@ void session_loop(void(*loophandler)()) {
 	fd_set readfd, writefd;
 	struct timeval timeout;
 	int val;
+	int idle;
 
 	/* main loop, select()s for all sockets in use */
 	for(;;) {
 		const int writequeue_has_space = (ses.writequeue_len <= 2*TRANS_MAX_PAYLOAD_LEN);
 
-		timeout.tv_sec = select_timeout();
-		timeout.tv_usec = 0;
+		/* With idle work pending we wait only briefly, and do one
+		 * piece of it below if nothing is ready */
+		idle = ses.idle_work != NULL && ses.idle_work(0);
+		timeout.tv_sec = idle ? 0 : select_timeout();
+		timeout.tv_usec = idle ? IDLE_WORK_DELAY : 0;
 		FD_ZERO(&writefd);
 		FD_ZERO(&readfd);
 		dropbear_assert(ses.payload == NULL);
@@ -201,6 +205,10 @@ void session_loop(void(*loophandler)()) {
 			FD_ZERO(&writefd);
 			FD_ZERO(&readfd);
 		}
+
+		if (val == 0 && idle) {
+			ses.idle_work(1);
+		}
 		
 		/* We'll just empty out the pipe if required. We don't do
 		any thing with the data, since the pipe's purpose is purely to
@@ -316,6 +324,7 @@ void session_cleanup() {
 		mp_clear(ses.dh_K);
 	}
 	m_free(ses.dh_K);
+	kex_precompute_cleanup();
 
 	m_burn(ses.keys, sizeof(struct key_context));
 	m_free(ses.keys);
@@ -499,6 +508,12 @@ static void checktimeouts() {
 		TRACE(("rekeying after timeout or max data reached"))
 		send_msg_kexinit();
 	}
+
+	/* a busy session might never be idle long enough to make our half of
+	 * the rekey ahead of time, so make it here before the rekey is due */
+	if (kex_precompute_wanted(0)) {
+		kex_precompute();
+	}
 	
 	if (opts.keepalive_secs > 0 && ses.authstate.authdone) {
 		/* Avoid sending keepalives prior to auth - those are
@@ -1,14 +1,69 @@
 #include "includes.h"
 #include "dbutil.h"
 #include "crypto_desc.h"
+#include "runopts.h"
 
-/* Register the compiled in ciphers.
+/* names for DROPBEAR_CPU_DISABLE */
+static const struct {
+	const char *name;
+	unsigned long feature;
+} cpu_features[] = {
+	{"sse2", LTC_CPU_SSE2},
+	{"ssse3", LTC_CPU_SSSE3},
+	{"sse4.1", LTC_CPU_SSE41},
+	{"aes-ni", LTC_CPU_AESNI},
+	{"pclmul", LTC_CPU_PCLMUL},
+	{"avx2", LTC_CPU_AVX2},
+	{"bmi2", LTC_CPU_BMI2},
+	{"sha-ni", LTC_CPU_SHA},
+	{"neon", LTC_CPU_NEON},
+	{"sha1", LTC_CPU_ARMSHA1},
+	{"sha2", LTC_CPU_ARMSHA2},
+	{"avx512ifma", LTC_CPU_AVX512IFMA},
+	{"all", LTC_CPU_ALL},
+	{NULL, 0}
+};
+
+/* Turn off the kernels the -C option or DROPBEAR_CPU_DISABLE environment
+ * variable (a comma separated list of the names above) ask for, so the
+ * portable code can be forced on a box whose SIMD code is suspect */
+static void disable_cpu_features() {
+
+	char *env, *list, *name, *saveptr = NULL;
+	int i;
+
+	if (opts.portable_crypto) {
+		crypt_cpu_disable(LTC_CPU_ALL);
+	}
+
+	env = getenv("DROPBEAR_CPU_DISABLE");
+	if (env == NULL) {
+		return;
+	}
+	list = m_strdup(env);
+	for (name = strtok_r(list, ",", &saveptr); name != NULL;
+			name = strtok_r(NULL, ",", &saveptr)) {
+		for (i = 0; cpu_features[i].name != NULL; i++) {
+			if (strcmp(name, cpu_features[i].name) == 0) {
+				crypt_cpu_disable(cpu_features[i].feature);
+				break;
+			}
+		}
+		if (cpu_features[i].name == NULL) {
+			dropbear_log(LOG_WARNING, "Unknown CPU feature '%s' in DROPBEAR_CPU_DISABLE", name);
+		}
+	}
+	m_free(list);
+}
+
+/* Register the compiled in ciphers, with the fastest kernels this CPU
+ * can run bound in.
  * This should be run before using any of the ciphers/hashes */
 void crypto_init() {
 
 	const struct ltc_cipher_descriptor *regciphers[] = {
 #ifdef DROPBEAR_AES
-		&aes_desc,
+		NULL, /* filled in below */
 #endif
 #ifdef DROPBEAR_BLOWFISH
 		&blowfish_desc,
@@ -22,12 +77,105 @@ void crypto_init() {
 	const struct ltc_hash_descriptor *reghashes[] = {
 		/* we need sha1 for hostkey stuff regardless */
 		&sha1_desc,
+#ifdef DROPBEAR_SHA256
+		&sha256_desc,
+#endif
+#ifdef DROPBEAR_SHA512
+		&sha512_desc,
+#endif
 #ifdef DROPBEAR_MD5_HMAC
 		&md5_desc,
 #endif
 		NULL
 	};	
+	const char *aes = "c", *ghash = "c", *chacha = "c", *umac = "c";
+	const char *sha1, *sha256 = "c", *exptmod = "c";
 	int i;
+
+	disable_cpu_features();
+
+#ifdef DROPBEAR_AES
+	/* registered under the same name, so find_cipher("aes")
+	 * picks up the best version this CPU has: AES-NI, else one
+	 * of the constant time ones rather than the T-tables, whose
+	 * lookups leak key bits through the cache. The tables are
+	 * only left without vector units and DROPBEAR_AES_CT */
+	regciphers[0] = &aes_desc;
+#ifdef LTC_AES_CT
+	regciphers[0] = &aes_ct_desc;
+	aes = "bitsliced";
+#endif
+#ifdef LTC_AES_VPERM
+	if (aes_vperm_is_supported()) {
+		regciphers[0] = &aes_vperm_desc;
+		aes = "vperm";
+	}
+#endif
+#ifdef LTC_AES_NI
+	if (aes_ni_is_supported()) {
+		regciphers[0] = &aes_ni_desc;
+		aes = "aes-ni";
+	}
+#endif
+#endif
+
+	/* the hashes pick their compression kernel before anything is
+	 * hashed, SHA-1 is also used for the random pool */
+	sha1 = sha1_accel_init();
+#ifdef DROPBEAR_SHA256
+	sha256 = sha256_accel_init();
+#endif
+
+	/* GCM, ChaCha and UMAC choose when a key is set up, from the same
+	 * features, these are only for the log */
+#ifdef LTC_GCM_PCLMUL
+	if (gcm_pclmul_is_supported()) {
+		ghash = "pclmul";
+	}
+#endif
+#ifdef LTC_CHACHA_SSE2
+	if (crypt_cpu_features() & LTC_CPU_SSE2) {
+		chacha = "sse2";
+	}
+#elif defined(LTC_CHACHA_NEON)
+	if (crypt_cpu_features() & LTC_CPU_NEON) {
+		chacha = "neon";
+	}
+#endif
+#ifdef LTC_CHACHA_AVX2
+	if (chacha_avx2_is_supported()) {
+		chacha = "avx2";
+	}
+#endif
+#ifdef LTC_UMAC_SSE2
+	if (crypt_cpu_features() & LTC_CPU_SSE2) {
+		umac = "sse2";
+	}
+#elif defined(LTC_UMAC_NEON)
+	if (crypt_cpu_features() & LTC_CPU_NEON) {
+		umac = "neon";
+	}
+#endif
+#ifdef LTC_UMAC_AVX2
+	if (umac_avx2_is_supported()) {
+		umac = "avx2";
+	}
+#endif
+
+	/* for DH, RSA and DSS, through mp_exptmod() and dh_exptmod(). Without
+	 * one the 1024 and 2048-bit moduli go to the constant time fixed size
+	 * code, with constants kept by the DH group or the key */
+#ifdef LTM_EXPTMOD_FIXED
+	exptmod = "fixed";
+#endif
+#ifdef LTM_EXPTMOD_IFMA
+	if (crypt_cpu_features() & LTC_CPU_AVX512IFMA) {
+		mp_exptmod_accel = mp_exptmod_ifma;
+		exptmod = "avx512ifma";
+	}
+#endif
+	dropbear_log(LOG_INFO, "Crypto kernels: aes %s, ghash %s, chacha %s, umac %s, sha1 %s, sha256 %s, exptmod %s",
+			aes, ghash, chacha, umac, sha1, sha256, exptmod);
 	
 	for (i = 0; regciphers[i] != NULL; i++) {
 		if (register_cipher(regciphers[i]) == -1) {
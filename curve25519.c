@@ -0,0 +1,709 @@
+#include "includes.h"
+#include "dbutil.h"
+#include "curve25519.h"
+
+/* X25519 (RFC 7748) for the curve25519-sha256 key exchange, and Ed25519
+ * (RFC 8032) for ssh-ed25519 host keys, over the same field.
+ *
+ * Field elements mod p = 2^255 - 19 are held in five 51-bit limbs, so a
+ * product of two limbs fits an unsigned __int128 with room for the sums,
+ * and the 2^255 = 19 wrap folds the high columns back in with a multiply
+ * by 19. The scalar multiply is the Montgomery ladder on the u coordinate
+ * with a masked conditional swap, the same sequence of field operations
+ * for every scalar, and the field operations have no branches or table
+ * lookups that depend on the values. */
+
+#ifdef DROPBEAR_CURVE25519_FIELD
+
+typedef uint64_t fe[5];
+typedef unsigned __int128 fe_wide;
+
+#define FE_MASK ((((uint64_t)1) << 51) - 1)
+
+/* limbs out of fe_mul(), fe_sqr() and the load are below 2^51 + 2^13.
+ * Sums and differences of a few of those stay below 2^54, which is still
+ * fine for another multiply */
+
+static void fe_0(fe h) {
+	h[0] = h[1] = h[2] = h[3] = h[4] = 0;
+}
+
+static void fe_1(fe h) {
+	fe_0(h);
+	h[0] = 1;
+}
+
+static void fe_copy(fe h, const fe f) {
+	h[0] = f[0]; h[1] = f[1]; h[2] = f[2]; h[3] = f[3]; h[4] = f[4];
+}
+
+static void fe_add(fe h, const fe f, const fe g) {
+	h[0] = f[0] + g[0];
+	h[1] = f[1] + g[1];
+	h[2] = f[2] + g[2];
+	h[3] = f[3] + g[3];
+	h[4] = f[4] + g[4];
+}
+
+/* h = f - g + 2p, g's limbs must be below 2^52 */
+static void fe_sub(fe h, const fe f, const fe g) {
+	h[0] = (f[0] + 0xFFFFFFFFFFFDAULL) - g[0];
+	h[1] = (f[1] + 0xFFFFFFFFFFFFEULL) - g[1];
+	h[2] = (f[2] + 0xFFFFFFFFFFFFEULL) - g[2];
+	h[3] = (f[3] + 0xFFFFFFFFFFFFEULL) - g[3];
+	h[4] = (f[4] + 0xFFFFFFFFFFFFEULL) - g[4];
+}
+
+/* carries the column sums of a product down to 51-bit limbs */
+static inline void fe_carry_wide(fe h, fe_wide r0, fe_wide r1, fe_wide r2,
+		fe_wide r3, fe_wide r4) {
+	uint64_t c;
+
+	r1 += (uint64_t)(r0 >> 51);
+	r2 += (uint64_t)(r1 >> 51);
+	r3 += (uint64_t)(r2 >> 51);
+	r4 += (uint64_t)(r3 >> 51);
+	c = (uint64_t)(r4 >> 51);
+	h[0] = ((uint64_t)r0 & FE_MASK) + c * 19;
+	h[1] = ((uint64_t)r1 & FE_MASK) + (h[0] >> 51);
+	h[0] &= FE_MASK;
+	h[2] = (uint64_t)r2 & FE_MASK;
+	h[3] = (uint64_t)r3 & FE_MASK;
+	h[4] = (uint64_t)r4 & FE_MASK;
+}
+
+static void fe_mul(fe h, const fe f, const fe g) {
+	uint64_t f0 = f[0], f1 = f[1], f2 = f[2], f3 = f[3], f4 = f[4];
+	uint64_t g0 = g[0], g1 = g[1], g2 = g[2], g3 = g[3], g4 = g[4];
+	uint64_t g1_19 = 19 * g1, g2_19 = 19 * g2, g3_19 = 19 * g3,
+		g4_19 = 19 * g4;
+	fe_wide r0, r1, r2, r3, r4;
+
+	r0 = (fe_wide)f0 * g0 + (fe_wide)f1 * g4_19 + (fe_wide)f2 * g3_19
+		+ (fe_wide)f3 * g2_19 + (fe_wide)f4 * g1_19;
+	r1 = (fe_wide)f0 * g1 + (fe_wide)f1 * g0 + (fe_wide)f2 * g4_19
+		+ (fe_wide)f3 * g3_19 + (fe_wide)f4 * g2_19;
+	r2 = (fe_wide)f0 * g2 + (fe_wide)f1 * g1 + (fe_wide)f2 * g0
+		+ (fe_wide)f3 * g4_19 + (fe_wide)f4 * g3_19;
+	r3 = (fe_wide)f0 * g3 + (fe_wide)f1 * g2 + (fe_wide)f2 * g1
+		+ (fe_wide)f3 * g0 + (fe_wide)f4 * g4_19;
+	r4 = (fe_wide)f0 * g4 + (fe_wide)f1 * g3 + (fe_wide)f2 * g2
+		+ (fe_wide)f3 * g1 + (fe_wide)f4 * g0;
+	fe_carry_wide(h, r0, r1, r2, r3, r4);
+}
+
+static void fe_sqr(fe h, const fe f) {
+	uint64_t f0 = f[0], f1 = f[1], f2 = f[2], f3 = f[3], f4 = f[4];
+	uint64_t d0 = 2 * f0, d1 = 2 * f1, d2 = 2 * f2, d3 = 2 * f3;
+	uint64_t f3_19 = 19 * f3, f4_19 = 19 * f4;
+	fe_wide r0, r1, r2, r3, r4;
+
+	r0 = (fe_wide)f0 * f0 + (fe_wide)d1 * f4_19 + (fe_wide)d2 * f3_19;
+	r1 = (fe_wide)d0 * f1 + (fe_wide)d2 * f4_19 + (fe_wide)f3 * f3_19;
+	r2 = (fe_wide)d0 * f2 + (fe_wide)f1 * f1 + (fe_wide)d3 * f4_19;
+	r3 = (fe_wide)d0 * f3 + (fe_wide)d1 * f2 + (fe_wide)f4 * f4_19;
+	r4 = (fe_wide)d0 * f4 + (fe_wide)d1 * f3 + (fe_wide)f2 * f2;
+	fe_carry_wide(h, r0, r1, r2, r3, r4);
+}
+
+/* h = f^(2^n) */
+static void fe_sqr_n(fe h, const fe f, int n) {
+	fe_sqr(h, f);
+	while (--n > 0) {
+		fe_sqr(h, h);
+	}
+}
+
+/* h = f^(p - 2) = 1/f, 254 squarings and 11 multiplies */
+static void fe_invert(fe h, const fe f) {
+	fe z2, z9, z11, z2_5_0, z2_10_0, z2_20_0, z2_50_0, z2_100_0, t;
+
+	fe_sqr(z2, f);
+	fe_sqr_n(t, z2, 2);
+	fe_mul(z9, t, f);
+	fe_mul(z11, z9, z2);
+	fe_sqr(t, z11);
+	fe_mul(z2_5_0, t, z9);
+	fe_sqr_n(t, z2_5_0, 5);
+	fe_mul(z2_10_0, t, z2_5_0);
+	fe_sqr_n(t, z2_10_0, 10);
+	fe_mul(z2_20_0, t, z2_10_0);
+	fe_sqr_n(t, z2_20_0, 20);
+	fe_mul(t, t, z2_20_0);
+	fe_sqr_n(t, t, 10);
+	fe_mul(z2_50_0, t, z2_10_0);
+	fe_sqr_n(t, z2_50_0, 50);
+	fe_mul(z2_100_0, t, z2_50_0);
+	fe_sqr_n(t, z2_100_0, 100);
+	fe_mul(t, t, z2_100_0);
+	fe_sqr_n(t, t, 50);
+	fe_mul(t, t, z2_50_0);
+	fe_sqr_n(t, t, 5);
+	fe_mul(h, t, z11);
+
+	m_burn(z2, sizeof(z2));
+	m_burn(z9, sizeof(z9));
+	m_burn(z11, sizeof(z11));
+	m_burn(z2_5_0, sizeof(z2_5_0));
+	m_burn(z2_10_0, sizeof(z2_10_0));
+	m_burn(z2_20_0, sizeof(z2_20_0));
+	m_burn(z2_50_0, sizeof(z2_50_0));
+	m_burn(z2_100_0, sizeof(z2_100_0));
+	m_burn(t, sizeof(t));
+}
+
+static uint64_t load64_le(const unsigned char *s) {
+	return (uint64_t)s[0] | ((uint64_t)s[1] << 8)
+		| ((uint64_t)s[2] << 16) | ((uint64_t)s[3] << 24)
+		| ((uint64_t)s[4] << 32) | ((uint64_t)s[5] << 40)
+		| ((uint64_t)s[6] << 48) | ((uint64_t)s[7] << 56);
+}
+
+static void store64_le(unsigned char *s, uint64_t w) {
+	int i;
+
+	for (i = 0; i < 8; i++) {
+		s[i] = (unsigned char)(w >> (8 * i));
+	}
+}
+
+/* the top bit is dropped, as RFC 7748 asks for u coordinates */
+static void fe_frombytes(fe h, const unsigned char *s) {
+	uint64_t w0 = load64_le(s), w1 = load64_le(s + 8),
+		w2 = load64_le(s + 16), w3 = load64_le(s + 24);
+
+	h[0] = w0 & FE_MASK;
+	h[1] = ((w0 >> 51) | (w1 << 13)) & FE_MASK;
+	h[2] = ((w1 >> 38) | (w2 << 26)) & FE_MASK;
+	h[3] = ((w2 >> 25) | (w3 << 39)) & FE_MASK;
+	h[4] = (w3 >> 12) & FE_MASK;
+}
+
+/* writes the unique representative below p */
+static void fe_tobytes(unsigned char *s, const fe f) {
+	uint64_t t0 = f[0], t1 = f[1], t2 = f[2], t3 = f[3], t4 = f[4], q;
+	int i;
+
+	/* twice round leaves every limb below 2^51, bar 19 more in t0 */
+	for (i = 0; i < 2; i++) {
+		t1 += t0 >> 51; t0 &= FE_MASK;
+		t2 += t1 >> 51; t1 &= FE_MASK;
+		t3 += t2 >> 51; t2 &= FE_MASK;
+		t4 += t3 >> 51; t3 &= FE_MASK;
+		t0 += 19 * (t4 >> 51); t4 &= FE_MASK;
+	}
+
+	/* q is 1 when t >= p, the carry out of t + 19 */
+	q = (t0 + 19) >> 51;
+	q = (t1 + q) >> 51;
+	q = (t2 + q) >> 51;
+	q = (t3 + q) >> 51;
+	q = (t4 + q) >> 51;
+
+	/* t - q*p, the 2^255 going with the top carry */
+	t0 += 19 * q;
+	t1 += t0 >> 51; t0 &= FE_MASK;
+	t2 += t1 >> 51; t1 &= FE_MASK;
+	t3 += t2 >> 51; t2 &= FE_MASK;
+	t4 += t3 >> 51; t3 &= FE_MASK;
+	t4 &= FE_MASK;
+
+	store64_le(s, t0 | (t1 << 51));
+	store64_le(s + 8, (t1 >> 13) | (t2 << 38));
+	store64_le(s + 16, (t2 >> 26) | (t3 << 25));
+	store64_le(s + 24, (t3 >> 39) | (t4 << 12));
+}
+
+#ifdef DROPBEAR_CURVE25519
+/* h = 121665 * f, (A - 2) / 4 for the ladder */
+static void fe_mul_a24(fe h, const fe f) {
+	fe_carry_wide(h, (fe_wide)f[0] * 121665, (fe_wide)f[1] * 121665,
+		(fe_wide)f[2] * 121665, (fe_wide)f[3] * 121665,
+		(fe_wide)f[4] * 121665);
+}
+
+/* swaps f and g when swap is 1, leaves them when it is 0 */
+static void fe_cswap(fe f, fe g, uint64_t swap) {
+	uint64_t mask = 0 - swap, x;
+	int i;
+
+	for (i = 0; i < 5; i++) {
+		x = mask & (f[i] ^ g[i]);
+		f[i] ^= x;
+		g[i] ^= x;
+	}
+}
+
+void curve25519_scalarmult(unsigned char *out, const unsigned char *scalar,
+		const unsigned char *point) {
+	unsigned char e[CURVE25519_LEN];
+	fe x1, x2, z2, x3, z3, a, aa, b, bb, c, d, da, cb, ee;
+	uint64_t swap = 0, bit;
+	int pos;
+
+	memcpy(e, scalar, CURVE25519_LEN);
+	e[0] &= 248;
+	e[31] &= 127;
+	e[31] |= 64;
+
+	fe_frombytes(x1, point);
+	fe_1(x2);
+	fe_0(z2);
+	fe_copy(x3, x1);
+	fe_1(z3);
+
+	for (pos = 254; pos >= 0; pos--) {
+		bit = (e[pos >> 3] >> (pos & 7)) & 1;
+		swap ^= bit;
+		fe_cswap(x2, x3, swap);
+		fe_cswap(z2, z3, swap);
+		swap = bit;
+
+		fe_add(a, x2, z2);
+		fe_sqr(aa, a);
+		fe_sub(b, x2, z2);
+		fe_sqr(bb, b);
+		fe_sub(ee, aa, bb);
+		fe_add(c, x3, z3);
+		fe_sub(d, x3, z3);
+		fe_mul(da, d, a);
+		fe_mul(cb, c, b);
+
+		fe_add(x3, da, cb);
+		fe_sqr(x3, x3);
+		fe_sub(z3, da, cb);
+		fe_sqr(z3, z3);
+		fe_mul(z3, z3, x1);
+
+		fe_mul(x2, aa, bb);
+		fe_mul_a24(z2, ee);
+		fe_add(z2, z2, aa);
+		fe_mul(z2, z2, ee);
+	}
+	fe_cswap(x2, x3, swap);
+	fe_cswap(z2, z3, swap);
+
+	fe_invert(z2, z2);
+	fe_mul(x2, x2, z2);
+	fe_tobytes(out, x2);
+
+	m_burn(e, sizeof(e));
+	m_burn(x2, sizeof(x2));
+	m_burn(z2, sizeof(z2));
+	m_burn(x3, sizeof(x3));
+	m_burn(z3, sizeof(z3));
+	m_burn(a, sizeof(a));
+	m_burn(aa, sizeof(aa));
+	m_burn(b, sizeof(b));
+	m_burn(bb, sizeof(bb));
+	m_burn(c, sizeof(c));
+	m_burn(d, sizeof(d));
+	m_burn(da, sizeof(da));
+	m_burn(cb, sizeof(cb));
+	m_burn(ee, sizeof(ee));
+}
+
+void curve25519_base(unsigned char *out, const unsigned char *scalar) {
+	static const unsigned char basepoint[CURVE25519_LEN] = {9};
+
+	curve25519_scalarmult(out, scalar, basepoint);
+}
+#endif /* DROPBEAR_CURVE25519 */
+
+#ifdef DROPBEAR_ED25519
+/* Ed25519 points are on the twisted Edwards curve -x^2 + y^2 = 1 + d x^2 y^2,
+ * in extended coordinates x = X/Z, y = Y/Z, x*y = T/Z. The addition is
+ * complete, so the identity and doublings need no special cases.
+ *
+ * Signing only ever multiplies the base point B, so that goes through a
+ * table of i * 256^k * B for i = 1..8 and k = 0..31, built once. The
+ * scalar is recoded in 64 signed digits from -8 to 8, each table lookup
+ * reads all eight entries of the row and keeps one by mask, and then the
+ * sign is applied by mask as well, leaving 64 additions and 4 doublings
+ * with no branches or addresses that depend on the scalar. */
+
+typedef struct {
+	fe X, Y, Z, T;
+} ge_p3;
+
+/* an affine point as y + x, y - x and 2*d*x*y, for ge_madd() */
+typedef struct {
+	fe yplusx, yminusx, xy2d;
+} ge_precomp;
+
+static const unsigned char ed25519_d[32] = {
+	0xa3, 0x78, 0x59, 0x13, 0xca, 0x4d, 0xeb, 0x75, 0xab, 0xd8, 0x41, 0x41,
+	0x4d, 0x0a, 0x70, 0x00, 0x98, 0xe8, 0x79, 0x77, 0x79, 0x40, 0xc7, 0x8c,
+	0x73, 0xfe, 0x6f, 0x2b, 0xee, 0x6c, 0x03, 0x52
+};
+
+static const unsigned char ed25519_bx[32] = {
+	0x1a, 0xd5, 0x25, 0x8f, 0x60, 0x2d, 0x56, 0xc9, 0xb2, 0xa7, 0x25, 0x95,
+	0x60, 0xc7, 0x2c, 0x69, 0x5c, 0xdc, 0xd6, 0xfd, 0x31, 0xe2, 0xa4, 0xc0,
+	0xfe, 0x53, 0x6e, 0xcd, 0xd3, 0x36, 0x69, 0x21
+};
+
+static const unsigned char ed25519_by[32] = {
+	0x58, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66,
+	0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66,
+	0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66
+};
+
+/* the group order, 2^252 + 27742317777372353535851937790883648493 */
+static const int64_t ed25519_l[32] = {
+	0xed, 0xd3, 0xf5, 0x5c, 0x1a, 0x63, 0x12, 0x58, 0xd6, 0x9c, 0xf7, 0xa2,
+	0xde, 0xf9, 0xde, 0x14, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0x10
+};
+
+static ge_precomp ed25519_base[32][8];
+static int ed25519_base_done;
+
+/* f = g when b is 1, unchanged when it is 0 */
+static void fe_cmov(fe f, const fe g, uint64_t b) {
+	uint64_t mask = 0 - b;
+	int i;
+
+	for (i = 0; i < 5; i++) {
+		f[i] ^= mask & (f[i] ^ g[i]);
+	}
+}
+
+static void ge_p3_0(ge_p3 *h) {
+	fe_0(h->X);
+	fe_1(h->Y);
+	fe_1(h->Z);
+	fe_0(h->T);
+}
+
+/* r = 2p, dbl-2008-hwcd with a = -1 and the signs of E, F, G and H
+ * flipped, which leaves the products alone */
+static void ge_dbl(ge_p3 *r, const ge_p3 *p) {
+	fe a, b, c, e, f, g, h;
+
+	fe_sqr(a, p->X);
+	fe_sqr(b, p->Y);
+	fe_sqr(c, p->Z);
+	fe_add(c, c, c);
+	fe_add(h, a, b);
+	fe_add(e, p->X, p->Y);
+	fe_sqr(e, e);
+	fe_sub(e, h, e);
+	fe_sub(g, a, b);
+	fe_add(f, c, g);
+
+	fe_mul(r->X, e, f);
+	fe_mul(r->Y, g, h);
+	fe_mul(r->T, e, h);
+	fe_mul(r->Z, f, g);
+}
+
+/* r = p + q, q affine */
+static void ge_madd(ge_p3 *r, const ge_p3 *p, const ge_precomp *q) {
+	fe a, b, c, d, e, f, g, h;
+
+	fe_sub(a, p->Y, p->X);
+	fe_mul(a, a, q->yminusx);
+	fe_add(b, p->Y, p->X);
+	fe_mul(b, b, q->yplusx);
+	fe_mul(c, p->T, q->xy2d);
+	fe_add(d, p->Z, p->Z);
+	fe_sub(e, b, a);
+	fe_sub(f, d, c);
+	fe_add(g, d, c);
+	fe_add(h, b, a);
+
+	fe_mul(r->X, e, f);
+	fe_mul(r->Y, g, h);
+	fe_mul(r->T, e, h);
+	fe_mul(r->Z, f, g);
+}
+
+/* r = p + q, only for building the table */
+static void ge_add(ge_p3 *r, const ge_p3 *p, const ge_p3 *q, const fe d2) {
+	fe a, b, c, d, e, f, g, h;
+
+	fe_sub(a, p->Y, p->X);
+	fe_sub(b, q->Y, q->X);
+	fe_mul(a, a, b);
+	fe_add(b, p->Y, p->X);
+	fe_add(c, q->Y, q->X);
+	fe_mul(b, b, c);
+	fe_mul(c, p->T, q->T);
+	fe_mul(c, c, d2);
+	fe_mul(d, p->Z, q->Z);
+	fe_add(d, d, d);
+	fe_sub(e, b, a);
+	fe_sub(f, d, c);
+	fe_add(g, d, c);
+	fe_add(h, b, a);
+
+	fe_mul(r->X, e, f);
+	fe_mul(r->Y, g, h);
+	fe_mul(r->T, e, h);
+	fe_mul(r->Z, f, g);
+}
+
+/* y with the low bit of x in the top bit */
+static void ge_tobytes(unsigned char *s, const ge_p3 *h) {
+	fe recip, x, y;
+	unsigned char xs[32];
+
+	fe_invert(recip, h->Z);
+	fe_mul(x, h->X, recip);
+	fe_mul(y, h->Y, recip);
+	fe_tobytes(xs, x);
+	fe_tobytes(s, y);
+	s[31] ^= (xs[0] & 1) << 7;
+}
+
+void ed25519_init_base() {
+	ge_p3 *pts = NULL, row;
+	fe *acc = NULL, d2, inv, zinv, x, y;
+	int i, j;
+
+	if (ed25519_base_done) {
+		return;
+	}
+
+	pts = m_malloc(256 * sizeof(ge_p3));
+	acc = m_malloc(256 * sizeof(fe));
+
+	fe_frombytes(d2, ed25519_d);
+	fe_add(d2, d2, d2);
+	fe_frombytes(row.X, ed25519_bx);
+	fe_frombytes(row.Y, ed25519_by);
+	fe_1(row.Z);
+	fe_mul(row.T, row.X, row.Y);
+
+	/* pts[8k + i - 1] = i * 256^k * B */
+	for (i = 0; i < 32; i++) {
+		pts[8 * i] = row;
+		for (j = 1; j < 8; j++) {
+			ge_add(&pts[8 * i + j], &pts[8 * i + j - 1], &row, d2);
+		}
+		for (j = 0; j < 8; j++) {
+			ge_dbl(&row, &row);
+		}
+	}
+
+	/* one inversion for all the Z, from the running products */
+	fe_copy(acc[0], pts[0].Z);
+	for (i = 1; i < 256; i++) {
+		fe_mul(acc[i], acc[i - 1], pts[i].Z);
+	}
+	fe_invert(inv, acc[255]);
+	for (i = 255; i >= 0; i--) {
+		if (i > 0) {
+			fe_mul(zinv, inv, acc[i - 1]);
+			fe_mul(inv, inv, pts[i].Z);
+		} else {
+			fe_copy(zinv, inv);
+		}
+		fe_mul(x, pts[i].X, zinv);
+		fe_mul(y, pts[i].Y, zinv);
+		fe_add(ed25519_base[i / 8][i % 8].yplusx, y, x);
+		fe_sub(ed25519_base[i / 8][i % 8].yminusx, y, x);
+		fe_mul(x, x, y);
+		fe_mul(ed25519_base[i / 8][i % 8].xy2d, x, d2);
+	}
+
+	m_free(pts);
+	m_free(acc);
+	ed25519_base_done = 1;
+}
+
+/* 1 when b == c, else 0 */
+static uint64_t ct_equal(unsigned char b, unsigned char c) {
+	uint64_t x = b ^ c;
+
+	return (x - 1) >> 63;
+}
+
+/* t = b * 256^pos * B, for -8 <= b <= 8 */
+static void ge_select(ge_precomp *t, int pos, signed char b) {
+	ge_precomp minust;
+	uint64_t bnegative = ((unsigned char)b) >> 7;
+	unsigned char babs = b - (((-bnegative) & b) << 1);
+	int i;
+
+	fe_1(t->yplusx);
+	fe_1(t->yminusx);
+	fe_0(t->xy2d);
+	for (i = 0; i < 8; i++) {
+		uint64_t eq = ct_equal(babs, i + 1);
+		fe_cmov(t->yplusx, ed25519_base[pos][i].yplusx, eq);
+		fe_cmov(t->yminusx, ed25519_base[pos][i].yminusx, eq);
+		fe_cmov(t->xy2d, ed25519_base[pos][i].xy2d, eq);
+	}
+	/* -(x, y) = (-x, y) swaps y + x with y - x */
+	fe_copy(minust.yplusx, t->yminusx);
+	fe_copy(minust.yminusx, t->yplusx);
+	fe_0(minust.xy2d);
+	fe_sub(minust.xy2d, minust.xy2d, t->xy2d);
+	fe_cmov(t->yplusx, minust.yplusx, bnegative);
+	fe_cmov(t->yminusx, minust.yminusx, bnegative);
+	fe_cmov(t->xy2d, minust.xy2d, bnegative);
+}
+
+/* h = a * B, a little endian and below 2^255 */
+static void ge_scalarmult_base(ge_p3 *h, const unsigned char *a) {
+	signed char e[64];
+	signed char carry;
+	ge_precomp t;
+	int i;
+
+	/* 64 digits of 4 bits, then moved to -8..7 (the last to -8..8) */
+	for (i = 0; i < 32; i++) {
+		e[2 * i] = a[i] & 15;
+		e[2 * i + 1] = (a[i] >> 4) & 15;
+	}
+	carry = 0;
+	for (i = 0; i < 63; i++) {
+		e[i] += carry;
+		carry = (e[i] + 8) >> 4;
+		e[i] -= carry << 4;
+	}
+	e[63] += carry;
+
+	/* the odd digits, times 16, then the even ones */
+	ge_p3_0(h);
+	for (i = 1; i < 64; i += 2) {
+		ge_select(&t, i / 2, e[i]);
+		ge_madd(h, h, &t);
+	}
+	for (i = 0; i < 4; i++) {
+		ge_dbl(h, h);
+	}
+	for (i = 0; i < 64; i += 2) {
+		ge_select(&t, i / 2, e[i]);
+		ge_madd(h, h, &t);
+	}
+
+	m_burn(e, sizeof(e));
+	m_burn(&t, sizeof(t));
+}
+
+/* r = x mod l, x being 64 limbs of about 8 bits which are used up */
+static void sc_modl(unsigned char *r, int64_t *x) {
+	int64_t carry;
+	int i, j;
+
+	/* takes 16 * x[i] * l off from 2^(8*i), the top limbs of l being 0 */
+	for (i = 63; i >= 32; i--) {
+		carry = 0;
+		for (j = i - 32; j < i - 12; j++) {
+			x[j] += carry - 16 * x[i] * ed25519_l[j - (i - 32)];
+			carry = (x[j] + 128) >> 8;
+			x[j] -= carry * 256;
+		}
+		x[j] += carry;
+		x[i] = 0;
+	}
+	carry = 0;
+	for (j = 0; j < 32; j++) {
+		x[j] += carry - (x[31] >> 4) * ed25519_l[j];
+		carry = x[j] >> 8;
+		x[j] &= 255;
+	}
+	for (j = 0; j < 32; j++) {
+		x[j] -= carry * ed25519_l[j];
+	}
+	for (i = 0; i < 32; i++) {
+		x[i + 1] += x[i] >> 8;
+		r[i] = x[i] & 255;
+	}
+}
+
+/* s = s mod l, for a 64 byte s, leaving 32 bytes */
+static void sc_reduce(unsigned char *s) {
+	int64_t x[64];
+	int i;
+
+	for (i = 0; i < 64; i++) {
+		x[i] = s[i];
+	}
+	sc_modl(s, x);
+	m_burn(x, sizeof(x));
+}
+
+/* s = (a * b + c) mod l */
+static void sc_muladd(unsigned char *s, const unsigned char *a,
+		const unsigned char *b, const unsigned char *c) {
+	int64_t x[64];
+	int i, j;
+
+	for (i = 0; i < 64; i++) {
+		x[i] = i < 32 ? c[i] : 0;
+	}
+	for (i = 0; i < 32; i++) {
+		for (j = 0; j < 32; j++) {
+			x[i + j] += (int64_t)a[i] * b[j];
+		}
+	}
+	sc_modl(s, x);
+	m_burn(x, sizeof(x));
+}
+
+/* the secret scalar in az[0..31] and the nonce prefix in az[32..63] */
+static void ed25519_expand(unsigned char *az, const unsigned char *seed) {
+	hash_state hs;
+
+	sha512_init(&hs);
+	sha512_process(&hs, seed, ED25519_SEED_LEN);
+	sha512_done(&hs, az);
+	az[0] &= 248;
+	az[31] &= 127;
+	az[31] |= 64;
+	m_burn(&hs, sizeof(hs));
+}
+
+void ed25519_make_key(unsigned char *pub, const unsigned char *seed) {
+	unsigned char az[64];
+	ge_p3 a;
+
+	ed25519_init_base();
+	ed25519_expand(az, seed);
+	ge_scalarmult_base(&a, az);
+	ge_tobytes(pub, &a);
+	m_burn(az, sizeof(az));
+	m_burn(&a, sizeof(a));
+}
+
+void ed25519_sign(unsigned char *sig, const unsigned char *msg,
+		unsigned int msglen, const unsigned char *seed,
+		const unsigned char *pub) {
+	unsigned char az[64], nonce[64], hram[64];
+	hash_state hs;
+	ge_p3 r;
+
+	ed25519_init_base();
+	ed25519_expand(az, seed);
+
+	/* r = H(prefix || M) */
+	sha512_init(&hs);
+	sha512_process(&hs, az + 32, 32);
+	sha512_process(&hs, msg, msglen);
+	sha512_done(&hs, nonce);
+	sc_reduce(nonce);
+
+	/* R = r * B */
+	ge_scalarmult_base(&r, nonce);
+	ge_tobytes(sig, &r);
+
+	/* S = (H(R || A || M) * a + r) mod l */
+	sha512_init(&hs);
+	sha512_process(&hs, sig, 32);
+	sha512_process(&hs, pub, ED25519_PUB_LEN);
+	sha512_process(&hs, msg, msglen);
+	sha512_done(&hs, hram);
+	sc_reduce(hram);
+	sc_muladd(sig + 32, hram, az, nonce);
+
+	m_burn(az, sizeof(az));
+	m_burn(nonce, sizeof(nonce));
+	m_burn(&hs, sizeof(hs));
+	m_burn(&r, sizeof(r));
+}
+#endif /* DROPBEAR_ED25519 */
+#endif /* DROPBEAR_CURVE25519_FIELD */
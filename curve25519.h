@@ -0,0 +1,38 @@
+#ifndef DROPBEAR_CURVE25519_H_
+#define DROPBEAR_CURVE25519_H_
+
+#include "includes.h"
+
+#ifdef DROPBEAR_CURVE25519_FIELD
+
+#define CURVE25519_LEN 32
+
+#ifdef DROPBEAR_CURVE25519
+
+/* out = scalar * point, all little endian as in RFC 7748. The scalar is
+ * clamped here, and the top bit of the point ignored */
+void curve25519_scalarmult(unsigned char *out, const unsigned char *scalar,
+		const unsigned char *point);
+/* out = scalar * 9, the public key for the private key scalar */
+void curve25519_base(unsigned char *out, const unsigned char *scalar);
+#endif
+
+#ifdef DROPBEAR_ED25519
+#define ED25519_SEED_LEN 32
+#define ED25519_PUB_LEN 32
+#define ED25519_SIG_LEN 64
+
+/* builds the table of multiples of the base point used for signing,
+ * done on first use otherwise */
+void ed25519_init_base(void);
+/* pub is the public key for the private key seed */
+void ed25519_make_key(unsigned char *pub, const unsigned char *seed);
+/* sig is the signature of msg by the key seed, whose public key is pub */
+void ed25519_sign(unsigned char *sig, const unsigned char *msg,
+		unsigned int msglen, const unsigned char *seed,
+		const unsigned char *pub);
+#endif
+
+#endif /* DROPBEAR_CURVE25519_FIELD */
+
+#endif /* DROPBEAR_CURVE25519_H_ */
@@ -1,5 +1,7 @@
-#include "options.h"
+#include "includes.h"
 #include "dh_groups.h"
+#include "dbutil.h"
+#include "bignum.h"
 
 #if DROPBEAR_DH_GROUP1
 /* diffie-hellman-group1-sha1 value for p */
@@ -47,3 +49,330 @@ const unsigned char dh_p_14[DH_P_14_LEN] = {
 /* Same for all groups */
 const int DH_G_VAL = 2;
 
+
+/* Window width for dh_exptmod_g2(), 2^width - 1 bit shifts must fit a
+ * digit multiplier */
+#if DIGIT_BIT >= 32
+#define G2_WINDOW 5
+#else
+#define G2_WINDOW 4
+#endif
+
+/* Groups built so far, kept for the life of the process */
+static struct dh_group *dh_group_list = NULL;
+
+/* Returns the context for the prime in p_bytes, building it the first
+ * time it is asked for. priv_bits sets the private exponent bound q,
+ * 2^priv_bits or (p-1)/2 if priv_bits is 0. Exits on failure. */
+struct dh_group *dh_get_group(const unsigned char *p_bytes, int p_len,
+		int priv_bits) {
+
+	struct dh_group *g;
+
+	for (g = dh_group_list; g != NULL; g = g->next) {
+		if (g->p_bytes == p_bytes && g->p_len == p_len
+				&& g->priv_bits == priv_bits) {
+			return g;
+		}
+	}
+
+	TRACE(("dh_get_group: building %d byte group", p_len))
+
+	g = m_malloc(sizeof(*g));
+	g->p_bytes = p_bytes;
+	g->p_len = p_len;
+	g->priv_bits = priv_bits;
+	m_mp_init_multi(&g->p, &g->p_min1, &g->q, &g->delta, &g->r, &g->rr, NULL);
+
+	bytes_to_mp(&g->p, p_bytes, p_len);
+	g->n = mp_count_bits(&g->p);
+	if (mp_iseven(&g->p) || g->n < 2 * DIGIT_BIT) {
+		dropbear_exit("Diffie-Hellman error");
+	}
+
+	if (mp_sub_d(&g->p, 1, &g->p_min1) != MP_OKAY) {
+		dropbear_exit("Diffie-Hellman error");
+	}
+	if (priv_bits > 0) {
+		if (mp_2expt(&g->q, priv_bits) != MP_OKAY) {
+			dropbear_exit("Diffie-Hellman error");
+		}
+	} else {
+		if (mp_div_2(&g->p_min1, &g->q) != MP_OKAY) {
+			dropbear_exit("Diffie-Hellman error");
+		}
+	}
+
+	/* Montgomery constants, R = 2^(DIGIT_BIT * p.used) */
+	if (mp_montgomery_setup(&g->p, &g->rho) != MP_OKAY
+			|| mp_montgomery_calc_normalization(&g->r, &g->p) != MP_OKAY
+			|| mp_sqrmod(&g->r, &g->p, &g->rr) != MP_OKAY) {
+		dropbear_exit("Diffie-Hellman error");
+	}
+	g->fixed = m_mp_fixed_new(&g->p);
+
+	/* delta = 2^n - p, for dh_exptmod_g2(). Left as zero unless it is
+	 * small enough for the shortcut there */
+	if (mp_2expt(&g->delta, g->n) != MP_OKAY
+			|| mp_sub(&g->delta, &g->p, &g->delta) != MP_OKAY) {
+		dropbear_exit("Diffie-Hellman error");
+	}
+	if (mp_count_bits(&g->delta) + (1 << G2_WINDOW) >= g->n) {
+		mp_zero(&g->delta);
+	}
+
+	g->next = dh_group_list;
+	dh_group_list = g;
+	return g;
+}
+
+/* a = a * b / R mod g->p, a and b below p */
+static int mont_mul(struct dh_group *g, mp_int *a, mp_int *b) {
+	int res;
+
+	if (a == b) {
+		res = mp_sqr(a, a);
+	} else {
+		res = mp_mul(a, b, a);
+	}
+	if (res == MP_OKAY) {
+		res = mp_montgomery_reduce(a, &g->p, g->rho);
+	}
+	return res;
+}
+
+/* bits [pos, pos+len) of a, len up to the digit size */
+static mp_digit get_bits(mp_int *a, int pos, int len) {
+	mp_digit w = 0;
+	int i;
+
+	for (i = len - 1; i >= 0; i--) {
+		int b = pos + i, d = b / DIGIT_BIT;
+		w <<= 1;
+		if (d < a->used) {
+			w |= (a->dp[d] >> (b % DIGIT_BIT)) & 1;
+		}
+	}
+	return w;
+}
+
+/* Sliding window width for dh_exptmod(), as mp_exptmod() picks it */
+#define EXP_WINDOW(bits) ((bits) <= 36 ? 3 : (bits) <= 140 ? 4 : \
+		(bits) <= 450 ? 5 : 6)
+#define EXP_WINDOW_MAX 6
+
+/* y = b^x mod g->p, for 0 <= b < p. The same sliding window method as
+ * mp_exptmod(), but with the Montgomery constants from the group rather
+ * than set up afresh, and b entering Montgomery form by a multiplication
+ * with R^2 instead of a division. Returns MP_OKAY or an mp error. */
+int dh_exptmod(struct dh_group *g, mp_int *b, mp_int *x, mp_int *y) {
+
+	/* odd powers, M[i] = b^(2i+1) * R mod p */
+	mp_int M[1 << (EXP_WINDOW_MAX - 1)], a;
+	int bits, win, pos, low, i, tab = 0, first = 1;
+	int res;
+
+	if (mp_cmp(b, &g->p) != MP_LT || b->sign == MP_NEG
+			|| x->sign == MP_NEG) {
+		return MP_VAL;
+	}
+
+	/* a vector unit kernel, if crypto_init() found one, is quicker */
+	if (mp_exptmod_accel != NULL
+			&& (res = mp_exptmod_accel(b, x, &g->p, y)) != MP_VAL) {
+		return res;
+	}
+#ifdef LTM_EXPTMOD_FIXED
+	/* then the constant time one, for the groups it takes */
+	if (g->fixed != NULL) {
+		return mp_exptmod_fixed_mont(b, x, &g->p, g->fixed, y);
+	}
+#endif
+
+	bits = mp_count_bits(x);
+	win = EXP_WINDOW(bits);
+
+	if ((res = mp_init_copy(&a, &g->r)) != MP_OKAY) {
+		return res;
+	}
+	for (tab = 0; tab < (1 << (win - 1)); tab++) {
+		if ((res = mp_init_size(&M[tab], g->p.used * 2 + 1)) != MP_OKAY) {
+			goto out;
+		}
+	}
+
+	/* M[0] = b * R, a = b^2 * R temporarily */
+	if ((res = mp_copy(b, &M[0])) != MP_OKAY
+			|| (res = mont_mul(g, &M[0], &g->rr)) != MP_OKAY
+			|| (res = mp_copy(&M[0], &a)) != MP_OKAY
+			|| (res = mont_mul(g, &a, &a)) != MP_OKAY) {
+		goto out;
+	}
+	for (i = 1; i < tab; i++) {
+		if ((res = mp_copy(&M[i - 1], &M[i])) != MP_OKAY
+				|| (res = mont_mul(g, &M[i], &a)) != MP_OKAY) {
+			goto out;
+		}
+	}
+	if ((res = mp_copy(&g->r, &a)) != MP_OKAY) {
+		goto out;
+	}
+
+	pos = bits - 1;
+	while (pos >= 0) {
+		if (get_bits(x, pos, 1) == 0) {
+			if (!first && (res = mont_mul(g, &a, &a)) != MP_OKAY) {
+				goto out;
+			}
+			pos--;
+			continue;
+		}
+
+		/* the longest window [low, pos] that ends in a set bit */
+		low = pos - win + 1 < 0 ? 0 : pos - win + 1;
+		while (get_bits(x, low, 1) == 0) {
+			low++;
+		}
+
+		if (first) {
+			/* a is one, take the power straight from the table */
+			res = mp_copy(&M[get_bits(x, low, pos - low + 1) >> 1], &a);
+			first = 0;
+		} else {
+			for (i = low; i <= pos; i++) {
+				if ((res = mont_mul(g, &a, &a)) != MP_OKAY) {
+					goto out;
+				}
+			}
+			res = mont_mul(g, &a, &M[get_bits(x, low, pos - low + 1) >> 1]);
+		}
+		if (res != MP_OKAY) {
+			goto out;
+		}
+		pos = low - 1;
+	}
+
+	/* out of Montgomery form */
+	if ((res = mp_montgomery_reduce(&a, &g->p, g->rho)) != MP_OKAY) {
+		goto out;
+	}
+	mp_exch(&a, y);
+
+out:
+	for (i = 0; i < tab; i++) {
+		mp_clear(&M[i]);
+	}
+	mp_clear(&a);
+	return res;
+}
+
+/* y = 2^x mod g->p, for the MODP groups of RFC 2409 and RFC 3526.
+ *
+ * Those primes have their top 64 bits set, p = 2^n - delta with delta
+ * below 2^(n-64). In a windowed exponentiation the multiplication by
+ * the generator 2^w is then a shift and, as a*2^w = hi*2^n + lo is
+ * lo + hi*delta mod p, one single digit multiplication of delta and a
+ * subtraction or two. That leaves only the Montgomery squarings, with
+ * no table of powers to precompute or to index by the exponent.
+ *
+ * The shift and the reduction after it depend on the exponent bits, so
+ * this is variable time. A vector kernel or the fixed size code is used
+ * instead when either takes the group, and groups with a large delta go
+ * to dh_exptmod(). Returns MP_OKAY or an mp error. */
+int dh_exptmod_g2(struct dh_group *g, mp_int *x, mp_int *y) {
+
+	mp_int a, t;
+	mp_digit hi;
+	int bits, pos, len, d, s, i, first = 1;
+	int res;
+
+#ifdef LTM_EXPTMOD_FIXED
+	/* the exponent is our private key, keep it to constant time */
+	if (g->fixed != NULL && mp_exptmod_accel == NULL) {
+		if ((res = mp_init(&t)) != MP_OKAY) {
+			return res;
+		}
+		if ((res = mp_set_int(&t, 2)) == MP_OKAY) {
+			res = mp_exptmod_fixed_mont(&t, x, &g->p, g->fixed, y);
+		}
+		mp_clear(&t);
+		return res;
+	}
+#endif
+
+	if (mp_iszero(&g->delta) || mp_exptmod_accel != NULL) {
+		if ((res = mp_init(&t)) != MP_OKAY) {
+			return res;
+		}
+		if ((res = mp_set_int(&t, 2)) == MP_OKAY) {
+			res = dh_exptmod(g, &t, x, y);
+		}
+		mp_clear(&t);
+		return res;
+	}
+
+	/* a = R mod p, which is 1 in Montgomery form */
+	if ((res = mp_init_copy(&a, &g->r)) != MP_OKAY) {
+		return res;
+	}
+	if ((res = mp_init(&t)) != MP_OKAY) {
+		mp_clear(&a);
+		return res;
+	}
+
+	d = g->n / DIGIT_BIT;
+	s = g->n % DIGIT_BIT;
+	bits = mp_count_bits(x);
+	len = bits % G2_WINDOW ? bits % G2_WINDOW : G2_WINDOW;
+	for (pos = bits - len; pos >= 0; pos -= G2_WINDOW, len = G2_WINDOW) {
+		/* a is 1 for the first window, no need to square */
+		if (!first) {
+			for (i = 0; i < G2_WINDOW; i++) {
+				if ((res = mont_mul(g, &a, &a)) != MP_OKAY) {
+					goto out;
+				}
+			}
+		}
+
+		first = 0;
+
+		/* a = a * 2^w, below 2^(n+w) */
+		if ((res = mp_mul_d(&a, (mp_digit)1 << get_bits(x, pos, len), &a))
+				!= MP_OKAY
+				|| (res = mp_grow(&a, d + 2)) != MP_OKAY) {
+			goto out;
+		}
+
+		/* split off hi = a >> n, leaving lo in a */
+		hi = a.dp[d] >> s;
+		if (s != 0) {
+			hi |= (a.dp[d + 1] << (DIGIT_BIT - s)) & MP_MASK;
+		}
+		a.dp[d] &= ((mp_digit)1 << s) - 1;
+		for (i = d + 1; i < a.used; i++) {
+			a.dp[i] = 0;
+		}
+		mp_clamp(&a);
+
+		/* lo + hi*delta < 2^n + 2^(n-1), less than 2p */
+		if ((res = mp_mul_d(&g->delta, hi, &t)) != MP_OKAY
+				|| (res = mp_add(&a, &t, &a)) != MP_OKAY) {
+			goto out;
+		}
+		while (mp_cmp_mag(&a, &g->p) != MP_LT) {
+			if ((res = s_mp_sub(&a, &g->p, &a)) != MP_OKAY) {
+				goto out;
+			}
+		}
+	}
+
+	/* out of Montgomery form */
+	if ((res = mp_montgomery_reduce(&a, &g->p, g->rho)) != MP_OKAY) {
+		goto out;
+	}
+	mp_exch(&a, y);
+
+out:
+	mp_clear_multi(&a, &t, NULL);
+	return res;
+}
@@ -1,6 +1,6 @@
 #ifndef DROPBEAR_DH_GROUPS_H
 #define DROPBEAR_DH_GROUPS_H
-#include "options.h"
+#include "includes.h"
 
 #if DROPBEAR_DH_GROUP1
 #define DH_P_1_LEN 128
@@ -14,4 +14,37 @@ extern const unsigned char dh_p_14[DH_P_14_LEN];
 
 extern const int DH_G_VAL;
 
+/* A group's modulus and the constants derived from it, built once by
+ * dh_get_group() and kept for the life of the process */
+struct dh_group {
+	const unsigned char *p_bytes;
+	int p_len;
+	int priv_bits;
+
+	mp_int p;
+	mp_int p_min1; /* p - 1, the bound for the other side's public value */
+	mp_int q; /* the private exponent bound */
+	int n; /* bits in p */
+
+	/* Montgomery reduction, R being 2^(DIGIT_BIT * p.used) */
+	mp_digit rho;
+	mp_int r; /* R mod p */
+	mp_int rr; /* R^2 mod p */
+	/* the same for the fixed size code, NULL if it doesn't take p */
+	mp_fixed_mont *fixed;
+
+	mp_int delta; /* 2^n - p, or zero if too large for dh_exptmod_g2() */
+
+	struct dh_group *next;
+};
+
+struct dh_group *dh_get_group(const unsigned char *p_bytes, int p_len,
+		int priv_bits);
+/* y = b^x mod p */
+int dh_exptmod(struct dh_group *g, mp_int *b, mp_int *x, mp_int *y);
+/* y = 2^x mod p, DH_G_VAL being 2. Constant time for the groups the
+ * fixed size code takes, otherwise a variable time shortcut, see
+ * dh_groups.c */
+int dh_exptmod_g2(struct dh_group *g, mp_int *x, mp_int *y);
+
 #endif
@@ -39,6 +39,8 @@
 
 #ifdef DROPBEAR_DSS 
 
+static void dss_nonce_clear(dropbear_dss_key *key);
+
 /* Load a dss key from a buffer, initialising the values.
  * The key will have the same format as buf_put_dss_key.
  * These should be freed with dss_key_free.
@@ -49,6 +51,7 @@ int buf_get_dss_pub_key(buffer* buf, dropbear_dss_key *key) {
 	dropbear_assert(key != NULL);
 	m_mp_alloc_init_multi(&key->p, &key->q, &key->g, &key->y, NULL);
 	key->x = NULL;
+	key->p_mont = NULL;
 
 	buf_incrpos(buf, 4+SSH_SIGNKEY_DSS_LEN); /* int + "ssh-dss" */
 	if (buf_getmpint(buf, key->p) == DROPBEAR_FAILURE
@@ -87,6 +90,8 @@ int buf_get_dss_priv_key(buffer* buf, dropbear_dss_key *key) {
 	ret = buf_getmpint(buf, key->x);
 	if (ret == DROPBEAR_FAILURE) {
 		m_free(key->x);
+	} else {
+		key->p_mont = m_mp_fixed_new(key->p);
 	}
 
 	return ret;
@@ -121,6 +126,8 @@ void dss_key_free(dropbear_dss_key *key) {
 		mp_clear(key->x);
 		m_free(key->x);
 	}
+	m_mp_fixed_free(key->p_mont);
+	dss_nonce_clear(key);
 	m_free(key);
 	TRACE2(("leave dsa_key_free"))
 }
@@ -153,13 +160,97 @@ void buf_put_dss_priv_key(buffer* buf, dropbear_dss_key *key) {
 
 }
 
+/* Free the precomputed nonces */
+static void dss_nonce_clear(dropbear_dss_key *key) {
+
+	while (key->nonce_count > 0) {
+		key->nonce_count--;
+		mp_clear(key->nonce_r[key->nonce_count]);
+		mp_clear(key->nonce_kinv[key->nonce_count]);
+		m_free(key->nonce_r[key->nonce_count]);
+		m_free(key->nonce_kinv[key->nonce_count]);
+	}
+}
+
+/* Drop precomputed nonces left by a parent process. Parent and child
+ * would otherwise both sign with them, and two signatures with one k give
+ * away the private key */
+static void dss_nonce_check(dropbear_dss_key *key) {
+
+	if (key->nonce_pid != getpid()) {
+		dss_nonce_clear(key);
+		key->nonce_pid = getpid();
+	}
+}
+
+/* A new random nonce k, giving r = (g^k mod p) mod q and kinv = k^-1 mod q.
+ * The random number generator's input has included the private key which
+ * avoids DSS's problem of private key exposure due to low entropy */
+static void dss_gen_nonce(dropbear_dss_key *key, mp_int *r, mp_int *kinv) {
+
+	DEF_MP_INT(dss_k);
+	DEF_MP_INT(dss_temp);
+
+	m_mp_init_multi(&dss_k, &dss_temp, NULL);
+	gen_random_mpint(key->q, &dss_k);
+
+	/* g^k mod p */
+	if (m_mp_exptmod(key->g, &dss_k, key->p, key->p_mont, &dss_temp)
+			!= MP_OKAY) {
+		dropbear_exit("DSS error");
+	}
+	/* r = (g^k mod p) mod q */
+	if (mp_mod(&dss_temp, key->q, r) != MP_OKAY) {
+		dropbear_exit("DSS error");
+	}
+	/* (k^-1) mod q */
+	if (mp_invmod(&dss_k, key->q, kinv) != MP_OKAY) {
+		dropbear_exit("DSS error");
+	}
+
+	mp_clear_multi(&dss_k, &dss_temp, NULL);
+}
+
+/* Whether a private key's nonce pool has room for dss_nonce_refill() */
+int dss_nonce_wanted(dropbear_dss_key *key) {
+
+	dss_nonce_check(key);
+	return key->x != NULL && key->nonce_count < DSS_NONCE_POOL;
+}
+
+/* Make one signing nonce ahead of time for buf_put_dss_sign(), for the
+ * session to call while it has nothing else to do. It costs the exptmod
+ * and invmod that would otherwise be done during the key exchange */
+void dss_nonce_refill(dropbear_dss_key *key) {
+
+	mp_int *r, *kinv;
+
+	TRACE(("enter dss_nonce_refill"))
+	if (!dss_nonce_wanted(key)) {
+		TRACE(("leave dss_nonce_refill: full"))
+		return;
+	}
+
+	m_mp_alloc_init_multi(&r, &kinv, NULL);
+	m_mp_scratch_begin(key->p);
+	dss_gen_nonce(key, r, kinv);
+	m_mp_scratch_keep(r);
+	m_mp_scratch_keep(kinv);
+	m_mp_scratch_end();
+
+	key->nonce_r[key->nonce_count] = r;
+	key->nonce_kinv[key->nonce_count] = kinv;
+	key->nonce_count++;
+	TRACE(("leave dss_nonce_refill: %d nonces", key->nonce_count))
+}
+
 /* Sign the data presented with key, writing the signature contents
  * to the buffer */
 void buf_put_dss_sign(buffer* buf, dropbear_dss_key *key, buffer *data_buf) {
 	unsigned char msghash[SHA1_HASH_SIZE];
 	unsigned int writelen;
 	unsigned int i;
-	DEF_MP_INT(dss_k);
+	DEF_MP_INT(dss_kinv);
 	DEF_MP_INT(dss_m);
 	DEF_MP_INT(dss_temp1);
 	DEF_MP_INT(dss_temp2);
@@ -175,24 +266,28 @@ void buf_put_dss_sign(buffer* buf, dropbear_dss_key *key, buffer *data_buf) {
 	sha1_process(&hs, data_buf->data, data_buf->len);
 	sha1_done(&hs, msghash);
 
-	m_mp_init_multi(&dss_k, &dss_temp1, &dss_temp2, &dss_r, &dss_s,
+	m_mp_init_multi(&dss_kinv, &dss_temp1, &dss_temp2, &dss_r, &dss_s,
 			&dss_m, NULL);
-	/* the random number generator's input has included the private key which
-	 * avoids DSS's problem of private key exposure due to low entropy */
-	gen_random_mpint(key->q, &dss_k);
+	m_mp_scratch_begin(key->p);
+
+	/* take a precomputed nonce if the session made one, otherwise
+	 * (k^-1, r) is made now */
+	dss_nonce_check(key);
+	if (key->nonce_count > 0) {
+		mp_exch(key->nonce_r[key->nonce_count-1], &dss_r);
+		mp_exch(key->nonce_kinv[key->nonce_count-1], &dss_kinv);
+		key->nonce_count--;
+		mp_clear(key->nonce_r[key->nonce_count]);
+		mp_clear(key->nonce_kinv[key->nonce_count]);
+		m_free(key->nonce_r[key->nonce_count]);
+		m_free(key->nonce_kinv[key->nonce_count]);
+	} else {
+		dss_gen_nonce(key, &dss_r, &dss_kinv);
+	}
 
 	/* now generate the actual signature */
 	bytes_to_mp(&dss_m, msghash, SHA1_HASH_SIZE);
 
-	/* g^k mod p */
-	if (mp_exptmod(key->g, &dss_k, key->p, &dss_temp1) !=  MP_OKAY) {
-		dropbear_exit("DSS error");
-	}
-	/* r = (g^k mod p) mod q */
-	if (mp_mod(&dss_temp1, key->q, &dss_r) != MP_OKAY) {
-		dropbear_exit("DSS error");
-	}
-
 	/* x*r mod q */
 	if (mp_mulmod(&dss_r, key->x, key->q, &dss_temp1) != MP_OKAY) {
 		dropbear_exit("DSS error");
@@ -201,14 +296,9 @@ void buf_put_dss_sign(buffer* buf, dropbear_dss_key *key, buffer *data_buf) {
 	if (mp_addmod(&dss_m, &dss_temp1, key->q, &dss_temp2) != MP_OKAY) {
 		dropbear_exit("DSS error");
 	}
-	
-	/* (k^-1) mod q */
-	if (mp_invmod(&dss_k, key->q, &dss_temp1) != MP_OKAY) {
-		dropbear_exit("DSS error");
-	}
 
 	/* s = (k^-1(SHA1(M) + xr)) mod q */
-	if (mp_mulmod(&dss_temp1, &dss_temp2, key->q, &dss_s) != MP_OKAY) {
+	if (mp_mulmod(&dss_kinv, &dss_temp2, key->q, &dss_s) != MP_OKAY) {
 		dropbear_exit("DSS error");
 	}
 
@@ -241,8 +331,9 @@ void buf_put_dss_sign(buffer* buf, dropbear_dss_key *key, buffer *data_buf) {
 	mp_clear(&dss_s);
 	buf_incrwritepos(buf, writelen);
 
-	mp_clear_multi(&dss_k, &dss_temp1, &dss_temp2, &dss_r, &dss_s,
+	mp_clear_multi(&dss_kinv, &dss_temp1, &dss_temp2, &dss_r, &dss_s,
 			&dss_m, NULL);
+	m_mp_scratch_end();
 	
 	/* create the signature to return */
 
@@ -38,6 +38,16 @@ typedef struct {
 	mp_int* y;
 	/* x is the private part */
 	mp_int* x;
+	/* constants for exponentiations mod p, see m_mp_fixed_new() */
+	mp_fixed_mont* p_mont;
+
+	/* signing nonces made ahead of time by dss_nonce_refill(), as
+	 * r = (g^k mod p) mod q and k^-1 mod q. They belong to the process
+	 * nonce_pid, a nonce shared across a fork would give away x */
+	mp_int* nonce_r[DSS_NONCE_POOL];
+	mp_int* nonce_kinv[DSS_NONCE_POOL];
+	unsigned int nonce_count;
+	pid_t nonce_pid;
 
 } dropbear_dss_key;
 
@@ -47,6 +57,8 @@ int buf_get_dss_priv_key(buffer* buf, dropbear_dss_key *key);
 void buf_put_dss_pub_key(buffer* buf, dropbear_dss_key *key);
 void buf_put_dss_priv_key(buffer* buf, dropbear_dss_key *key);
 void dss_key_free(dropbear_dss_key *key);
+int dss_nonce_wanted(dropbear_dss_key *key);
+void dss_nonce_refill(dropbear_dss_key *key);
 
 #endif /* DROPBEAR_DSS */
 
@@ -0,0 +1,923 @@
+#include "includes.h"
+#include "dbutil.h"
+#include "dbrandom.h"
+#include "ecc.h"
+
+/* NIST P-256 (secp256r1) for the ecdh-sha2-nistp256 key exchange and
+ * ecdsa-sha2-nistp256 host keys, RFC 5656.
+ *
+ * Field elements are four 64-bit limbs in the Montgomery domain, a * 2^256
+ * mod p, always fully reduced. The same Montgomery multiply works mod the
+ * group order n for the ECDSA scalar arithmetic. Points are homogeneous
+ * projective and use the complete addition formulas of Renes, Costello and
+ * Batina (eprint 2015/1060) for a = -3, so the identity and doublings need
+ * no special cases. Table lookups scan every entry with masks, and nothing
+ * branches on secret values. */
+
+#ifdef DROPBEAR_ECC
+
+typedef uint64_t fe[4];
+typedef unsigned __int128 fe_wide;
+
+struct mont_modulus {
+	fe m;
+	/* -m^-1 mod 2^64 */
+	uint64_t m0inv;
+	/* 2^512 mod m, to move into the Montgomery domain */
+	fe rr;
+};
+
+static const struct mont_modulus p256_p = {
+	{0xffffffffffffffffULL, 0x00000000ffffffffULL,
+	 0x0000000000000000ULL, 0xffffffff00000001ULL},
+	1,
+	{0x0000000000000003ULL, 0xfffffffbffffffffULL,
+	 0xfffffffffffffffeULL, 0x00000004fffffffdULL}
+};
+
+static const struct mont_modulus p256_n = {
+	{0xf3b9cac2fc632551ULL, 0xbce6faada7179e84ULL,
+	 0xffffffffffffffffULL, 0xffffffff00000000ULL},
+	0xccd1c8aaee00bc4fULL,
+	{0x83244c95be79eea2ULL, 0x4699799c49bd6fa6ULL,
+	 0x2845b2392b6bec59ULL, 0x66e12d94f3d95620ULL}
+};
+
+/* the exponent for inversion mod n */
+static const fe p256_n_minus_2 = {
+	0xf3b9cac2fc63254fULL, 0xbce6faada7179e84ULL,
+	0xffffffffffffffffULL, 0xffffffff00000000ULL
+};
+
+static const fe fe_one = {1, 0, 0, 0};
+
+/* 1 and the curve's b in the Montgomery domain of p */
+static const fe p256_one = {
+	0x0000000000000001ULL, 0xffffffff00000000ULL,
+	0xffffffffffffffffULL, 0x00000000fffffffeULL
+};
+static const fe p256_b = {
+	0xd89cdf6229c4bddfULL, 0xacf005cd78843090ULL,
+	0xe5a220abf7212ed6ULL, 0xdc30061d04874834ULL
+};
+
+/* the base point, big endian */
+static const unsigned char p256_gx[32] = {
+	0x6b, 0x17, 0xd1, 0xf2, 0xe1, 0x2c, 0x42, 0x47, 0xf8, 0xbc, 0xe6, 0xe5,
+	0x63, 0xa4, 0x40, 0xf2, 0x77, 0x03, 0x7d, 0x81, 0x2d, 0xeb, 0x33, 0xa0,
+	0xf4, 0xa1, 0x39, 0x45, 0xd8, 0x98, 0xc2, 0x96
+};
+static const unsigned char p256_gy[32] = {
+	0x4f, 0xe3, 0x42, 0xe2, 0xfe, 0x1a, 0x7f, 0x9b, 0x8e, 0xe7, 0xeb, 0x4a,
+	0x7c, 0x0f, 0x9e, 0x16, 0x2b, 0xce, 0x33, 0x57, 0x6b, 0x31, 0x5e, 0xce,
+	0xcb, 0xb6, 0x40, 0x68, 0x37, 0xbf, 0x51, 0xf5
+};
+
+static void fe_copy(fe h, const fe f) {
+	h[0] = f[0]; h[1] = f[1]; h[2] = f[2]; h[3] = f[3];
+}
+
+/* f = g when b is 1, unchanged when it is 0 */
+static void fe_cmov(fe f, const fe g, uint64_t b) {
+	uint64_t mask = 0 - b;
+	int i;
+
+	for (i = 0; i < 4; i++) {
+		f[i] ^= mask & (f[i] ^ g[i]);
+	}
+}
+
+/* 1 when f is zero, else 0 */
+static uint64_t fe_iszero(const fe f) {
+	uint64_t x = f[0] | f[1] | f[2] | f[3];
+
+	return ((x | (0 - x)) >> 63) ^ 1;
+}
+
+/* the carry chains, written out since the build doesn't unroll loops */
+#define ADDC(h, f, g, c) do { \
+		fe_wide w_ = (fe_wide)(f) + (g) + (c); \
+		(h) = (uint64_t)w_; (c) = (uint64_t)(w_ >> 64); \
+	} while (0)
+#define SUBB(h, f, g, b) do { \
+		fe_wide w_ = (fe_wide)(f) - (g) - (b); \
+		(h) = (uint64_t)w_; (b) = (uint64_t)(w_ >> 64) & 1; \
+	} while (0)
+/* (c, h) = f * g + h + c */
+#define MULADDC(h, f, g, c) do { \
+		fe_wide w_ = (fe_wide)(f) * (g) + (h) + (c); \
+		(h) = (uint64_t)w_; (c) = (uint64_t)(w_ >> 64); \
+	} while (0)
+
+/* h = f - m, returning the borrow out of the top limb */
+static inline uint64_t fe_sub_raw(fe h, const fe f, const fe m) {
+	uint64_t borrow = 0;
+
+	SUBB(h[0], f[0], m[0], borrow);
+	SUBB(h[1], f[1], m[1], borrow);
+	SUBB(h[2], f[2], m[2], borrow);
+	SUBB(h[3], f[3], m[3], borrow);
+	return borrow;
+}
+
+/* 1 when f < m, else 0 */
+static uint64_t fe_lt(const fe f, const fe m) {
+	fe t;
+
+	return fe_sub_raw(t, f, m);
+}
+
+/* h = r when b is 1, t when it is 0 */
+static inline void fe_select(fe h, const fe t, const fe r, uint64_t b) {
+	uint64_t mask = 0 - b;
+
+	h[0] = t[0] ^ (mask & (t[0] ^ r[0]));
+	h[1] = t[1] ^ (mask & (t[1] ^ r[1]));
+	h[2] = t[2] ^ (mask & (t[2] ^ r[2]));
+	h[3] = t[3] ^ (mask & (t[3] ^ r[3]));
+}
+
+/* t[0..4] += f * g, t[5] taking the carry */
+static inline void mont_mul_row(uint64_t *t, const fe f, uint64_t g) {
+	uint64_t c = 0;
+
+	MULADDC(t[0], f[0], g, c);
+	MULADDC(t[1], f[1], g, c);
+	MULADDC(t[2], f[2], g, c);
+	MULADDC(t[3], f[3], g, c);
+	t[5] = 0;
+	ADDC(t[4], t[4], 0, c);
+	t[5] = c;
+}
+
+/* t = (t + u * m) / 2^64 with u chosen so the low limb is zero */
+static inline void mont_reduce_row(uint64_t *t,
+		const struct mont_modulus *mod) {
+	uint64_t u = t[0] * mod->m0inv, c = 0, lo = t[0];
+
+	MULADDC(lo, u, mod->m[0], c);
+	t[0] = t[1];
+	MULADDC(t[0], u, mod->m[1], c);
+	t[1] = t[2];
+	MULADDC(t[1], u, mod->m[2], c);
+	t[2] = t[3];
+	MULADDC(t[2], u, mod->m[3], c);
+	t[3] = t[4];
+	ADDC(t[3], t[3], 0, c);
+	t[4] = t[5] + c;
+}
+
+/* mont_reduce_row() for p. -p^-1 mod 2^64 is 1, so u is the low limb,
+ * and u * p = u * 2^256 - u * 2^224 + u * 2^192 + u * 2^96 - u. The -u
+ * cancels the low limb, u * 2^96 is a shift and the top three terms are
+ * u * p[3] * 2^192, one multiply instead of four */
+static inline void fe_reduce_row(uint64_t *t) {
+	uint64_t u = t[0], c = 0, hi;
+	fe_wide w;
+
+	ADDC(t[0], t[1], u << 32, c);
+	ADDC(t[1], t[2], u >> 32, c);
+	w = (fe_wide)u * p256_p.m[3] + t[3] + c;
+	t[2] = (uint64_t)w;
+	hi = (uint64_t)(w >> 64);
+	c = 0;
+	ADDC(t[3], t[4], hi, c);
+	t[4] = t[5] + c;
+}
+
+/* h = f * g / 2^256 mod m, for f and g below m. Operand scanning with
+ * a reduction step after each word of g, the result below 2m until the
+ * final masked subtraction */
+static inline void mont_mul(fe h, const fe f, const fe g,
+		const struct mont_modulus *mod) {
+	uint64_t t[6], r[4], c;
+
+	t[0] = t[1] = t[2] = t[3] = t[4] = 0;
+	mont_mul_row(t, f, g[0]);
+	mont_reduce_row(t, mod);
+	mont_mul_row(t, f, g[1]);
+	mont_reduce_row(t, mod);
+	mont_mul_row(t, f, g[2]);
+	mont_reduce_row(t, mod);
+	mont_mul_row(t, f, g[3]);
+	mont_reduce_row(t, mod);
+
+	/* t - m unless that borrows and t has no fifth limb */
+	c = fe_sub_raw(r, t, mod->m);
+	fe_select(h, t, r, (c ^ 1) | t[4]);
+}
+
+/* h = f + g mod m */
+static inline void mod_add(fe h, const fe f, const fe g, const fe m) {
+	fe t, r;
+	uint64_t c = 0, b;
+
+	ADDC(t[0], f[0], g[0], c);
+	ADDC(t[1], f[1], g[1], c);
+	ADDC(t[2], f[2], g[2], c);
+	ADDC(t[3], f[3], g[3], c);
+	b = fe_sub_raw(r, t, m);
+	/* t >= m unless the subtraction borrowed without a carry in */
+	fe_select(h, t, r, (b & (c ^ 1)) ^ 1);
+}
+
+/* h = h mod m for h below 2m */
+static void mod_reduce_once(fe h, const fe m) {
+	fe r;
+	uint64_t b;
+
+	b = fe_sub_raw(r, h, m);
+	fe_select(h, h, r, b ^ 1);
+}
+
+/* h = f - g mod m */
+static inline void mod_sub(fe h, const fe f, const fe g, const fe m) {
+	uint64_t b, mask, c = 0;
+
+	b = fe_sub_raw(h, f, g);
+	mask = 0 - b;
+	ADDC(h[0], h[0], m[0] & mask, c);
+	ADDC(h[1], h[1], m[1] & mask, c);
+	ADDC(h[2], h[2], m[2] & mask, c);
+	ADDC(h[3], h[3], m[3] & mask, c);
+}
+
+/* h = f^e, everything in the Montgomery domain of mod. e is public, so
+ * branching on its bits is fine */
+static void mont_pow(fe h, const fe f, const fe e, const fe one,
+		const struct mont_modulus *mod) {
+	fe r;
+	int i;
+
+	fe_copy(r, one);
+	for (i = 255; i >= 0; i--) {
+		mont_mul(r, r, r, mod);
+		if ((e[i / 64] >> (i % 64)) & 1) {
+			mont_mul(r, r, f, mod);
+		}
+	}
+	fe_copy(h, r);
+}
+
+/* mont_mul() mod p with fe_reduce_row() */
+static void fe_mul(fe h, const fe f, const fe g) {
+	uint64_t t[6], r[4], c;
+
+	t[0] = t[1] = t[2] = t[3] = t[4] = 0;
+	mont_mul_row(t, f, g[0]);
+	fe_reduce_row(t);
+	mont_mul_row(t, f, g[1]);
+	fe_reduce_row(t);
+	mont_mul_row(t, f, g[2]);
+	fe_reduce_row(t);
+	mont_mul_row(t, f, g[3]);
+	fe_reduce_row(t);
+
+	c = fe_sub_raw(r, t, p256_p.m);
+	fe_select(h, t, r, (c ^ 1) | t[4]);
+}
+
+/* The full 512-bit square with each cross product done once, then the
+ * low half reduced by four fe_reduce_row() steps and the high half added */
+static void fe_sqr(fe h, const fe f) {
+	uint64_t t[8], acc[6], r[4], c, b;
+	fe_wide w;
+
+	t[1] = t[2] = t[3] = 0;
+	c = 0;
+	MULADDC(t[1], f[0], f[1], c);
+	MULADDC(t[2], f[0], f[2], c);
+	MULADDC(t[3], f[0], f[3], c);
+	t[4] = c;
+	c = 0;
+	MULADDC(t[3], f[1], f[2], c);
+	MULADDC(t[4], f[1], f[3], c);
+	t[5] = c;
+	c = 0;
+	t[6] = 0;
+	MULADDC(t[5], f[2], f[3], c);
+	t[6] = c;
+
+	t[7] = t[6] >> 63;
+	t[6] = (t[6] << 1) | (t[5] >> 63);
+	t[5] = (t[5] << 1) | (t[4] >> 63);
+	t[4] = (t[4] << 1) | (t[3] >> 63);
+	t[3] = (t[3] << 1) | (t[2] >> 63);
+	t[2] = (t[2] << 1) | (t[1] >> 63);
+	t[1] = t[1] << 1;
+
+	c = 0;
+	w = (fe_wide)f[0] * f[0];
+	t[0] = (uint64_t)w;
+	ADDC(t[1], t[1], (uint64_t)(w >> 64), c);
+	w = (fe_wide)f[1] * f[1];
+	ADDC(t[2], t[2], (uint64_t)w, c);
+	ADDC(t[3], t[3], (uint64_t)(w >> 64), c);
+	w = (fe_wide)f[2] * f[2];
+	ADDC(t[4], t[4], (uint64_t)w, c);
+	ADDC(t[5], t[5], (uint64_t)(w >> 64), c);
+	w = (fe_wide)f[3] * f[3];
+	ADDC(t[6], t[6], (uint64_t)w, c);
+	ADDC(t[7], t[7], (uint64_t)(w >> 64), c);
+
+	/* the reduced low half is at most p, the high half below p */
+	acc[0] = t[0]; acc[1] = t[1]; acc[2] = t[2]; acc[3] = t[3];
+	acc[4] = acc[5] = 0;
+	fe_reduce_row(acc);
+	acc[5] = 0;
+	fe_reduce_row(acc);
+	acc[5] = 0;
+	fe_reduce_row(acc);
+	acc[5] = 0;
+	fe_reduce_row(acc);
+
+	c = 0;
+	ADDC(acc[0], acc[0], t[4], c);
+	ADDC(acc[1], acc[1], t[5], c);
+	ADDC(acc[2], acc[2], t[6], c);
+	ADDC(acc[3], acc[3], t[7], c);
+	b = fe_sub_raw(r, acc, p256_p.m);
+	fe_select(h, acc, r, (b & (c ^ 1)) ^ 1);
+}
+
+static void fe_sqr_n(fe h, const fe f, int n) {
+	int i;
+
+	fe_sqr(h, f);
+	for (i = 1; i < n; i++) {
+		fe_sqr(h, h);
+	}
+}
+
+static void fe_add(fe h, const fe f, const fe g) {
+	mod_add(h, f, g, p256_p.m);
+}
+
+static void fe_sub(fe h, const fe f, const fe g) {
+	mod_sub(h, f, g, p256_p.m);
+}
+
+/* h = f^(p - 2), p - 2 being ffffffff 00000001 00000000 00000000
+ * 00000000 ffffffff ffffffff fffffffd. xN = f^(2^N - 1), a run of N ones */
+static void fe_invert(fe h, const fe f) {
+	fe x2, x3, x6, x12, x15, x30, x32, t;
+
+	fe_sqr(t, f);
+	fe_mul(x2, t, f);
+	fe_sqr(t, x2);
+	fe_mul(x3, t, f);
+	fe_sqr_n(t, x3, 3);
+	fe_mul(x6, t, x3);
+	fe_sqr_n(t, x6, 6);
+	fe_mul(x12, t, x6);
+	fe_sqr_n(t, x12, 3);
+	fe_mul(x15, t, x3);
+	fe_sqr_n(t, x15, 15);
+	fe_mul(x30, t, x15);
+	fe_sqr_n(t, x30, 2);
+	fe_mul(x32, t, x2);
+
+	fe_sqr_n(t, x32, 32);
+	fe_mul(t, t, f);
+	fe_sqr_n(t, t, 128);
+	fe_mul(t, t, x32);
+	fe_sqr_n(t, t, 32);
+	fe_mul(t, t, x32);
+	fe_sqr_n(t, t, 30);
+	fe_mul(t, t, x30);
+	fe_sqr_n(t, t, 2);
+	fe_mul(h, t, f);
+}
+
+/* big endian bytes to limbs, no reduction */
+static void fe_frombytes(fe h, const unsigned char *s) {
+	int i, j;
+
+	for (i = 0; i < 4; i++) {
+		h[i] = 0;
+		for (j = 0; j < 8; j++) {
+			h[i] = (h[i] << 8) | s[(3 - i) * 8 + j];
+		}
+	}
+}
+
+static void fe_tobytes(unsigned char *s, const fe f) {
+	int i, j;
+
+	for (i = 0; i < 4; i++) {
+		for (j = 0; j < 8; j++) {
+			s[(3 - i) * 8 + j] = (unsigned char)(f[i] >> (56 - 8 * j));
+		}
+	}
+}
+
+static void fe_to_mont(fe h, const fe f, const struct mont_modulus *mod) {
+	mont_mul(h, f, mod->rr, mod);
+}
+
+static void fe_from_mont(fe h, const fe f, const struct mont_modulus *mod) {
+	mont_mul(h, f, fe_one, mod);
+}
+
+typedef struct {
+	fe X, Y, Z;
+} ecp;
+
+typedef struct {
+	fe x, y;
+} ecp_affine;
+
+static void ecp_0(ecp *h) {
+	memset(h->X, 0, sizeof(fe));
+	fe_copy(h->Y, p256_one);
+	memset(h->Z, 0, sizeof(fe));
+}
+
+/* r = p + q, algorithm 4 of Renes, Costello and Batina */
+static void ecp_add(ecp *r, const ecp *p, const ecp *q) {
+	fe t0, t1, t2, t3, t4, x3, y3, z3;
+
+	fe_mul(t0, p->X, q->X);
+	fe_mul(t1, p->Y, q->Y);
+	fe_mul(t2, p->Z, q->Z);
+	fe_add(t3, p->X, p->Y);
+	fe_add(t4, q->X, q->Y);
+	fe_mul(t3, t3, t4);
+	fe_add(t4, t0, t1);
+	fe_sub(t3, t3, t4);
+	fe_add(t4, p->Y, p->Z);
+	fe_add(x3, q->Y, q->Z);
+	fe_mul(t4, t4, x3);
+	fe_add(x3, t1, t2);
+	fe_sub(t4, t4, x3);
+	fe_add(x3, p->X, p->Z);
+	fe_add(y3, q->X, q->Z);
+	fe_mul(x3, x3, y3);
+	fe_add(y3, t0, t2);
+	fe_sub(y3, x3, y3);
+	fe_mul(z3, p256_b, t2);
+	fe_sub(x3, y3, z3);
+	fe_add(z3, x3, x3);
+	fe_add(x3, x3, z3);
+	fe_sub(z3, t1, x3);
+	fe_add(x3, t1, x3);
+	fe_mul(y3, p256_b, y3);
+	fe_add(t1, t2, t2);
+	fe_add(t2, t1, t2);
+	fe_sub(y3, y3, t2);
+	fe_sub(y3, y3, t0);
+	fe_add(t1, y3, y3);
+	fe_add(y3, t1, y3);
+	fe_add(t1, t0, t0);
+	fe_add(t0, t1, t0);
+	fe_sub(t0, t0, t2);
+	fe_mul(t1, t4, y3);
+	fe_mul(t2, t0, y3);
+	fe_mul(y3, x3, z3);
+	fe_add(r->Y, y3, t2);
+	fe_mul(x3, t3, x3);
+	fe_sub(r->X, x3, t1);
+	fe_mul(z3, t4, z3);
+	fe_mul(t1, t3, t0);
+	fe_add(r->Z, z3, t1);
+}
+
+/* r = p + q, q affine and not the identity, algorithm 5 */
+static void ecp_madd(ecp *r, const ecp *p, const ecp_affine *q) {
+	fe t0, t1, t2, t3, t4, x3, y3, z3;
+
+	fe_mul(t0, p->X, q->x);
+	fe_mul(t1, p->Y, q->y);
+	fe_add(t3, q->x, q->y);
+	fe_add(t4, p->X, p->Y);
+	fe_mul(t3, t3, t4);
+	fe_add(t4, t0, t1);
+	fe_sub(t3, t3, t4);
+	fe_mul(t4, q->y, p->Z);
+	fe_add(t4, t4, p->Y);
+	fe_mul(y3, q->x, p->Z);
+	fe_add(y3, y3, p->X);
+	fe_mul(z3, p256_b, p->Z);
+	fe_sub(x3, y3, z3);
+	fe_add(z3, x3, x3);
+	fe_add(x3, x3, z3);
+	fe_sub(z3, t1, x3);
+	fe_add(x3, t1, x3);
+	fe_mul(y3, p256_b, y3);
+	fe_add(t1, p->Z, p->Z);
+	fe_add(t2, t1, p->Z);
+	fe_sub(y3, y3, t2);
+	fe_sub(y3, y3, t0);
+	fe_add(t1, y3, y3);
+	fe_add(y3, t1, y3);
+	fe_add(t1, t0, t0);
+	fe_add(t0, t1, t0);
+	fe_sub(t0, t0, t2);
+	fe_mul(t1, t4, y3);
+	fe_mul(t2, t0, y3);
+	fe_mul(y3, x3, z3);
+	fe_add(r->Y, y3, t2);
+	fe_mul(x3, t3, x3);
+	fe_sub(r->X, x3, t1);
+	fe_mul(z3, t4, z3);
+	fe_mul(t1, t3, t0);
+	fe_add(r->Z, z3, t1);
+}
+
+/* r = 2p, algorithm 6 */
+static void ecp_dbl(ecp *r, const ecp *p) {
+	fe t0, t1, t2, t3, x3, y3, z3;
+
+	fe_sqr(t0, p->X);
+	fe_sqr(t1, p->Y);
+	fe_sqr(t2, p->Z);
+	fe_mul(t3, p->X, p->Y);
+	fe_add(t3, t3, t3);
+	fe_mul(z3, p->X, p->Z);
+	fe_add(z3, z3, z3);
+	fe_mul(y3, p256_b, t2);
+	fe_sub(y3, y3, z3);
+	fe_add(x3, y3, y3);
+	fe_add(y3, x3, y3);
+	fe_sub(x3, t1, y3);
+	fe_add(y3, t1, y3);
+	fe_mul(y3, x3, y3);
+	fe_mul(x3, x3, t3);
+	fe_add(t3, t2, t2);
+	fe_add(t2, t2, t3);
+	fe_mul(z3, p256_b, z3);
+	fe_sub(z3, z3, t2);
+	fe_sub(z3, z3, t0);
+	fe_add(t3, z3, z3);
+	fe_add(z3, z3, t3);
+	fe_add(t3, t0, t0);
+	fe_add(t0, t3, t0);
+	fe_sub(t0, t0, t2);
+	fe_mul(t0, t0, z3);
+	fe_add(y3, y3, t0);
+	fe_mul(t0, p->Y, p->Z);
+	fe_add(t0, t0, t0);
+	fe_mul(z3, t0, z3);
+	fe_sub(r->X, x3, z3);
+	fe_copy(r->Y, y3);
+	fe_mul(z3, t0, t1);
+	fe_add(z3, z3, z3);
+	fe_add(r->Z, z3, z3);
+}
+
+/* the affine x and y as big endian bytes, failing for the identity */
+static int ecp_tobytes(unsigned char *x, unsigned char *y, const ecp *p) {
+	fe zinv, t;
+
+	if (fe_iszero(p->Z)) {
+		return DROPBEAR_FAILURE;
+	}
+	fe_invert(zinv, p->Z);
+	fe_mul(t, p->X, zinv);
+	fe_from_mont(t, t, &p256_p);
+	fe_tobytes(x, t);
+	if (y) {
+		fe_mul(t, p->Y, zinv);
+		fe_from_mont(t, t, &p256_p);
+		fe_tobytes(y, t);
+	}
+	return DROPBEAR_SUCCESS;
+}
+
+/* 1 when b == c, else 0 */
+static uint64_t ct_equal(unsigned char b, unsigned char c) {
+	uint64_t x = b ^ c;
+
+	return (x - 1) >> 63;
+}
+
+/* y = -y when neg is 1 */
+static void fe_cneg(fe y, uint64_t neg) {
+	static const fe zero = {0, 0, 0, 0};
+	fe t;
+
+	fe_sub(t, zero, y);
+	fe_cmov(y, t, neg);
+}
+
+/* Fixed-base table, the comb for the base point. p256_base[k][i - 1] is
+ * i * 16^(2k) * G for 1 <= i <= 8, affine. 16kB, built once */
+static ecp_affine p256_base[32][8];
+static int p256_base_done;
+
+void ecc256_init_base() {
+	ecp *pts = NULL, row;
+	fe *acc = NULL, inv, zinv;
+	int i, j;
+
+	if (p256_base_done) {
+		return;
+	}
+
+	pts = m_malloc(256 * sizeof(ecp));
+	acc = m_malloc(256 * sizeof(fe));
+
+	fe_frombytes(row.X, p256_gx);
+	fe_to_mont(row.X, row.X, &p256_p);
+	fe_frombytes(row.Y, p256_gy);
+	fe_to_mont(row.Y, row.Y, &p256_p);
+	fe_copy(row.Z, p256_one);
+
+	/* pts[8k + i - 1] = i * 256^k * G */
+	for (i = 0; i < 32; i++) {
+		pts[8 * i] = row;
+		for (j = 1; j < 8; j++) {
+			ecp_add(&pts[8 * i + j], &pts[8 * i + j - 1], &row);
+		}
+		for (j = 0; j < 8; j++) {
+			ecp_dbl(&row, &row);
+		}
+	}
+
+	/* one inversion for all the Z, from the running products */
+	fe_copy(acc[0], pts[0].Z);
+	for (i = 1; i < 256; i++) {
+		fe_mul(acc[i], acc[i - 1], pts[i].Z);
+	}
+	fe_invert(inv, acc[255]);
+	for (i = 255; i >= 0; i--) {
+		if (i > 0) {
+			fe_mul(zinv, inv, acc[i - 1]);
+			fe_mul(inv, inv, pts[i].Z);
+		} else {
+			fe_copy(zinv, inv);
+		}
+		fe_mul(p256_base[i / 8][i % 8].x, pts[i].X, zinv);
+		fe_mul(p256_base[i / 8][i % 8].y, pts[i].Y, zinv);
+	}
+
+	m_free(pts);
+	m_free(acc);
+	p256_base_done = 1;
+}
+
+/* t = |b| * 256^pos * G negated for b < 0, -8 <= b <= 8. Returns 1 when
+ * b is 0 and t is left as a dummy point */
+static uint64_t ecp_select_base(ecp_affine *t, int pos, signed char b) {
+	uint64_t bnegative = ((unsigned char)b) >> 7;
+	unsigned char babs = b - (((-bnegative) & b) << 1);
+	int i;
+
+	*t = p256_base[pos][0];
+	for (i = 1; i < 8; i++) {
+		uint64_t eq = ct_equal(babs, i + 1);
+		fe_cmov(t->x, p256_base[pos][i].x, eq);
+		fe_cmov(t->y, p256_base[pos][i].y, eq);
+	}
+	fe_cneg(t->y, bnegative);
+	return ct_equal(babs, 0);
+}
+
+/* h = a * G, a big endian and below n */
+static void ecp_scalarmult_base(ecp *h, const unsigned char *a) {
+	signed char e[64];
+	signed char carry;
+	ecp_affine t;
+	ecp sum;
+	fe k, kneg;
+	uint64_t skip, neg;
+	int i;
+
+	/* the top digit must stay within -8..8, so a scalar of 2^255 or more
+	 * is replaced by n - a, below 2^255, and the result negated */
+	fe_frombytes(k, a);
+	fe_sub_raw(kneg, p256_n.m, k);
+	neg = k[3] >> 63;
+	fe_cmov(k, kneg, neg);
+
+	/* 64 digits of 4 bits, then moved to -8..7 (the last to -8..8) */
+	for (i = 0; i < 64; i++) {
+		e[i] = (k[i / 16] >> (4 * (i % 16))) & 15;
+	}
+	carry = 0;
+	for (i = 0; i < 63; i++) {
+		e[i] += carry;
+		carry = (e[i] + 8) >> 4;
+		e[i] -= carry << 4;
+	}
+	e[63] += carry;
+
+	/* the odd digits, times 16, then the even ones. A zero digit still
+	 * does the addition and throws it away */
+	ecp_0(h);
+	for (i = 1; i < 64; i += 2) {
+		skip = ecp_select_base(&t, i / 2, e[i]);
+		ecp_madd(&sum, h, &t);
+		fe_cmov(h->X, sum.X, skip ^ 1);
+		fe_cmov(h->Y, sum.Y, skip ^ 1);
+		fe_cmov(h->Z, sum.Z, skip ^ 1);
+	}
+	for (i = 0; i < 4; i++) {
+		ecp_dbl(h, h);
+	}
+	for (i = 0; i < 64; i += 2) {
+		skip = ecp_select_base(&t, i / 2, e[i]);
+		ecp_madd(&sum, h, &t);
+		fe_cmov(h->X, sum.X, skip ^ 1);
+		fe_cmov(h->Y, sum.Y, skip ^ 1);
+		fe_cmov(h->Z, sum.Z, skip ^ 1);
+	}
+	fe_cneg(h->Y, neg);
+
+	m_burn(e, sizeof(e));
+	m_burn(k, sizeof(k));
+	m_burn(kneg, sizeof(kneg));
+	m_burn(&t, sizeof(t));
+}
+
+/* t = b * table entry, -16 <= b <= 16 with table[i - 1] = i * P. Zero
+ * gives the identity */
+static void ecp_select(ecp *t, const ecp *table, signed char b) {
+	uint64_t bnegative = ((unsigned char)b) >> 7;
+	unsigned char babs = b - (((-bnegative) & b) << 1);
+	int i;
+
+	ecp_0(t);
+	for (i = 0; i < 16; i++) {
+		uint64_t eq = ct_equal(babs, i + 1);
+		fe_cmov(t->X, table[i].X, eq);
+		fe_cmov(t->Y, table[i].Y, eq);
+		fe_cmov(t->Z, table[i].Z, eq);
+	}
+	fe_cneg(t->Y, bnegative);
+}
+
+/* h = a * p, a big endian. Fixed windows of 5 bits as signed digits, so
+ * a table of 16 multiples */
+static void ecp_scalarmult(ecp *h, const ecp *p, const unsigned char *a) {
+	ecp table[16], t;
+	signed char e[52];
+	signed char carry;
+	fe k;
+	int i, bit;
+
+	table[0] = *p;
+	ecp_dbl(&table[1], p);
+	for (i = 2; i < 16; i++) {
+		ecp_add(&table[i], &table[i - 1], p);
+	}
+
+	fe_frombytes(k, a);
+	carry = 0;
+	for (i = 0; i < 52; i++) {
+		bit = 5 * i;
+		e[i] = (k[bit / 64] >> (bit % 64)) & 31;
+		if (bit % 64 > 59 && bit / 64 < 3) {
+			e[i] |= (k[bit / 64 + 1] << (64 - bit % 64)) & 31;
+		}
+		e[i] += carry;
+		carry = (e[i] + 15) >> 5;
+		e[i] -= carry << 5;
+	}
+
+	ecp_select(h, table, e[51]);
+	for (i = 50; i >= 0; i--) {
+		ecp_dbl(h, h);
+		ecp_dbl(h, h);
+		ecp_dbl(h, h);
+		ecp_dbl(h, h);
+		ecp_dbl(h, h);
+		ecp_select(&t, table, e[i]);
+		ecp_add(h, h, &t);
+	}
+
+	m_burn(e, sizeof(e));
+	m_burn(k, sizeof(k));
+	m_burn(table, sizeof(table));
+	m_burn(&t, sizeof(t));
+}
+
+/* 1 when 0 < s < n, s big endian */
+static uint64_t sc_valid(const unsigned char *s) {
+	fe k;
+	uint64_t ret;
+
+	fe_frombytes(k, s);
+	ret = fe_lt(k, p256_n.m) & (fe_iszero(k) ^ 1);
+	m_burn(k, sizeof(k));
+	return ret;
+}
+
+/* A random private scalar, 0 < priv < n. Rejecting the few out of range
+ * keeps the distribution uniform */
+void ecc256_gen_priv(unsigned char *priv) {
+	do {
+		genrandom(priv, ECC256_LEN);
+	} while (!sc_valid(priv));
+}
+
+void ecc256_make_key(unsigned char *pub, const unsigned char *priv) {
+	ecp h;
+
+	ecc256_init_base();
+	ecp_scalarmult_base(&h, priv);
+	pub[0] = 0x04;
+	ecp_tobytes(&pub[1], &pub[1 + ECC256_LEN], &h);
+}
+
+/* Loads an uncompressed point, checking that it is on the curve */
+static int ecp_frombytes(ecp *p, const unsigned char *s, unsigned int len) {
+	fe lhs, rhs, t;
+
+	if (len != ECC256_POINT_LEN || s[0] != 0x04) {
+		return DROPBEAR_FAILURE;
+	}
+	fe_frombytes(p->X, &s[1]);
+	fe_frombytes(p->Y, &s[1 + ECC256_LEN]);
+	if (!fe_lt(p->X, p256_p.m) || !fe_lt(p->Y, p256_p.m)) {
+		return DROPBEAR_FAILURE;
+	}
+	fe_to_mont(p->X, p->X, &p256_p);
+	fe_to_mont(p->Y, p->Y, &p256_p);
+	fe_copy(p->Z, p256_one);
+
+	/* y^2 = x^3 - 3x + b */
+	fe_sqr(lhs, p->Y);
+	fe_sqr(rhs, p->X);
+	fe_mul(rhs, rhs, p->X);
+	fe_add(t, p->X, p->X);
+	fe_add(t, t, p->X);
+	fe_sub(rhs, rhs, t);
+	fe_add(rhs, rhs, p256_b);
+	fe_sub(t, lhs, rhs);
+	if (!fe_iszero(t)) {
+		return DROPBEAR_FAILURE;
+	}
+	return DROPBEAR_SUCCESS;
+}
+
+/* out is the x coordinate of priv * pub, the ECDH shared secret. The
+ * curve has a prime order, so a point that is on it can't land in a small
+ * subgroup */
+int ecc256_shared(unsigned char *out, const unsigned char *priv,
+		const unsigned char *pub, unsigned int publen) {
+	ecp p, h;
+	int ret;
+
+	if (ecp_frombytes(&p, pub, publen) == DROPBEAR_FAILURE) {
+		return DROPBEAR_FAILURE;
+	}
+	ecp_scalarmult(&h, &p, priv);
+	ret = ecp_tobytes(out, NULL, &h);
+	m_burn(&h, sizeof(h));
+	return ret;
+}
+
+/* The ECDSA signature (r, s) of the SHA-256 hash by priv, with the nonce
+ * k from ecc256_gen_priv(). Fails in the unlikely case of r or s being
+ * zero, the caller then tries again with another k */
+int ecc256_sign(unsigned char *r, unsigned char *s, const unsigned char *hash,
+		const unsigned char *priv, const unsigned char *k) {
+	ecp h;
+	fe x, e, d, kinv, t;
+	int ret = DROPBEAR_FAILURE;
+
+	ecc256_init_base();
+	ecp_scalarmult_base(&h, k);
+	if (ecp_tobytes(r, NULL, &h) == DROPBEAR_FAILURE) {
+		goto out;
+	}
+
+	/* x and the hash are below 2^256 < 2n, so one subtraction reduces */
+	fe_frombytes(x, r);
+	mod_reduce_once(x, p256_n.m);
+	if (fe_iszero(x)) {
+		goto out;
+	}
+	fe_tobytes(r, x);
+	fe_frombytes(e, hash);
+	mod_reduce_once(e, p256_n.m);
+
+	/* s = k^-1 (e + r d) mod n */
+	fe_frombytes(t, k);
+	fe_to_mont(t, t, &p256_n);
+	fe_to_mont(kinv, fe_one, &p256_n);
+	mont_pow(kinv, t, p256_n_minus_2, kinv, &p256_n);
+	fe_frombytes(d, priv);
+	fe_to_mont(d, d, &p256_n);
+	fe_to_mont(x, x, &p256_n);
+	mont_mul(t, x, d, &p256_n);
+	fe_to_mont(e, e, &p256_n);
+	mod_add(t, t, e, p256_n.m);
+	mont_mul(t, t, kinv, &p256_n);
+	fe_from_mont(t, t, &p256_n);
+	if (fe_iszero(t)) {
+		goto out;
+	}
+	fe_tobytes(s, t);
+	ret = DROPBEAR_SUCCESS;
+
+out:
+	m_burn(&h, sizeof(h));
+	m_burn(d, sizeof(d));
+	m_burn(kinv, sizeof(kinv));
+	m_burn(t, sizeof(t));
+	return ret;
+}
+
+#endif /* DROPBEAR_ECC */
@@ -0,0 +1,31 @@
+#ifndef DROPBEAR_ECC_H_
+#define DROPBEAR_ECC_H_
+
+#include "includes.h"
+
+#ifdef DROPBEAR_ECC
+
+/* scalars and coordinates, big endian */
+#define ECC256_LEN 32
+/* an uncompressed point, 0x04 || x || y */
+#define ECC256_POINT_LEN (1 + 2 * ECC256_LEN)
+
+/* builds the table of multiples of the base point used for key generation
+ * and signing, done on first use otherwise */
+void ecc256_init_base(void);
+/* a random scalar 0 < priv < n, for a private key or an ECDSA nonce */
+void ecc256_gen_priv(unsigned char *priv);
+/* pub is the uncompressed public point for the private scalar priv */
+void ecc256_make_key(unsigned char *pub, const unsigned char *priv);
+/* out is the x coordinate of priv * pub. Fails when pub isn't a point on
+ * the curve */
+int ecc256_shared(unsigned char *out, const unsigned char *priv,
+		const unsigned char *pub, unsigned int publen);
+/* (r, s) is the ECDSA signature of the SHA-256 hash by priv with nonce k.
+ * Fails for the rare k that gives r or s of zero */
+int ecc256_sign(unsigned char *r, unsigned char *s, const unsigned char *hash,
+		const unsigned char *priv, const unsigned char *k);
+
+#endif /* DROPBEAR_ECC */
+
+#endif /* DROPBEAR_ECC_H_ */
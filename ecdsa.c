@@ -0,0 +1,191 @@
+#include "includes.h"
+#include "dbutil.h"
+#include "ecdsa.h"
+#include "buffer.h"
+#include "bignum.h"
+#include "ssh.h"
+
+/* ecdsa-sha2-nistp256 keys and signatures, RFC 5656. The curve arithmetic
+ * is in ecc.c, key generation in genecdsa.c */
+
+#ifdef DROPBEAR_ECDSA
+
+/* Load an ecdsa public key from a buffer:
+ *
+ * string	"ecdsa-sha2-nistp256"
+ * string	"nistp256"
+ * string	Q, the uncompressed point
+ *
+ * Returns DROPBEAR_SUCCESS or DROPBEAR_FAILURE */
+int buf_get_ecdsa_pub_key(buffer* buf, dropbear_ecdsa_key *key) {
+
+	unsigned int len;
+
+	TRACE(("enter buf_get_ecdsa_pub_key"))
+	dropbear_assert(key != NULL);
+
+	/* int + "ecdsa-sha2-nistp256" */
+	buf_incrpos(buf, 4+SSH_SIGNKEY_ECDSA_NISTP256_LEN);
+
+	len = buf_getint(buf);
+	if (len != SSH_ECC_NISTP256_LEN
+			|| memcmp(buf_getptr(buf, len), SSH_ECC_NISTP256, len) != 0) {
+		TRACE(("leave buf_get_ecdsa_pub_key: bad curve"))
+		return DROPBEAR_FAILURE;
+	}
+	buf_incrpos(buf, len);
+
+	len = buf_getint(buf);
+	if (len != ECC256_POINT_LEN) {
+		TRACE(("leave buf_get_ecdsa_pub_key: bad length"))
+		return DROPBEAR_FAILURE;
+	}
+	memcpy(key->pub, buf_getptr(buf, len), len);
+	buf_incrpos(buf, len);
+	if (key->pub[0] != 0x04) {
+		TRACE(("leave buf_get_ecdsa_pub_key: compressed point"))
+		return DROPBEAR_FAILURE;
+	}
+
+	TRACE(("leave buf_get_ecdsa_pub_key: success"))
+	return DROPBEAR_SUCCESS;
+}
+
+/* Same as buf_get_ecdsa_pub_key, but reads the private scalar at the end:
+ *
+ * mpint	d
+ *
+ * The public point is checked against it.
+ * Returns DROPBEAR_SUCCESS or DROPBEAR_FAILURE */
+int buf_get_ecdsa_priv_key(buffer* buf, dropbear_ecdsa_key *key) {
+
+	unsigned char check[ECC256_POINT_LEN];
+	unsigned int len;
+	int ret = DROPBEAR_FAILURE;
+	DEF_MP_INT(d);
+
+	TRACE(("enter buf_get_ecdsa_priv_key"))
+	dropbear_assert(key != NULL);
+
+	if (buf_get_ecdsa_pub_key(buf, key) == DROPBEAR_FAILURE) {
+		TRACE(("leave buf_get_ecdsa_priv_key: pub: ret == DROPBEAR_FAILURE"))
+		return DROPBEAR_FAILURE;
+	}
+
+	m_mp_init(&d);
+	if (buf_getmpint(buf, &d) == DROPBEAR_FAILURE) {
+		goto out;
+	}
+	len = mp_unsigned_bin_size(&d);
+	if (len > ECC256_LEN) {
+		goto out;
+	}
+	memset(key->priv, 0x0, ECC256_LEN);
+	if (mp_to_unsigned_bin(&d, &key->priv[ECC256_LEN - len]) != MP_OKAY) {
+		goto out;
+	}
+
+	ecc256_make_key(check, key->priv);
+	if (memcmp(check, key->pub, ECC256_POINT_LEN) != 0) {
+		TRACE(("buf_get_ecdsa_priv_key: d doesn't match Q"))
+		goto out;
+	}
+	ret = DROPBEAR_SUCCESS;
+
+out:
+	mp_clear(&d);
+	if (ret == DROPBEAR_FAILURE) {
+		m_burn(key->priv, ECC256_LEN);
+	}
+	TRACE(("leave buf_get_ecdsa_priv_key"))
+	return ret;
+}
+
+/* Clear and free the memory used by a public or private key */
+void ecdsa_key_free(dropbear_ecdsa_key *key) {
+
+	TRACE2(("enter ecdsa_key_free"))
+	if (key == NULL) {
+		TRACE2(("leave ecdsa_key_free: key == NULL"))
+		return;
+	}
+	m_burn(key->priv, ECC256_LEN);
+	m_free(key);
+	TRACE2(("leave ecdsa_key_free"))
+}
+
+/* put the ecdsa public key into the buffer in the required format */
+void buf_put_ecdsa_pub_key(buffer* buf, dropbear_ecdsa_key *key) {
+
+	dropbear_assert(key != NULL);
+	buf_putstring(buf, SSH_SIGNKEY_ECDSA_NISTP256,
+			SSH_SIGNKEY_ECDSA_NISTP256_LEN);
+	buf_putstring(buf, SSH_ECC_NISTP256, SSH_ECC_NISTP256_LEN);
+	buf_putstring(buf, (const char*)key->pub, ECC256_POINT_LEN);
+
+}
+
+/* the private key format, see buf_get_ecdsa_priv_key() */
+void buf_put_ecdsa_priv_key(buffer* buf, dropbear_ecdsa_key *key) {
+
+	DEF_MP_INT(d);
+
+	dropbear_assert(key != NULL);
+	buf_put_ecdsa_pub_key(buf, key);
+	m_mp_init(&d);
+	bytes_to_mp(&d, key->priv, ECC256_LEN);
+	buf_putmpint(buf, &d);
+	mp_clear(&d);
+
+}
+
+/* Sign the data presented with key, writing the signature contents
+ * to the buffer:
+ *
+ * string	"ecdsa-sha2-nistp256"
+ * string	signature blob, containing
+ *	mpint	r
+ *	mpint	s */
+void buf_put_ecdsa_sign(buffer* buf, dropbear_ecdsa_key *key, buffer *data_buf) {
+
+	unsigned char msghash[SHA256_HASH_SIZE];
+	unsigned char k[ECC256_LEN], r[ECC256_LEN], s[ECC256_LEN];
+	hash_state hs;
+	buffer *sigblob = NULL;
+	DEF_MP_INT(ecdsa_r);
+	DEF_MP_INT(ecdsa_s);
+
+	TRACE(("enter buf_put_ecdsa_sign"))
+	dropbear_assert(key != NULL);
+
+	/* hash the data */
+	sha256_init(&hs);
+	sha256_process(&hs, data_buf->data, data_buf->len);
+	sha256_done(&hs, msghash);
+
+	/* as with DSS, the random number generator's input includes the
+	 * private key, so a weak source doesn't give away k */
+	do {
+		ecc256_gen_priv(k);
+	} while (ecc256_sign(r, s, msghash, key->priv, k) == DROPBEAR_FAILURE);
+	m_burn(k, sizeof(k));
+
+	m_mp_init_multi(&ecdsa_r, &ecdsa_s, NULL);
+	bytes_to_mp(&ecdsa_r, r, ECC256_LEN);
+	bytes_to_mp(&ecdsa_s, s, ECC256_LEN);
+
+	sigblob = buf_new(2 * (4 + ECC256_LEN + 1));
+	buf_putmpint(sigblob, &ecdsa_r);
+	buf_putmpint(sigblob, &ecdsa_s);
+
+	buf_putstring(buf, SSH_SIGNKEY_ECDSA_NISTP256,
+			SSH_SIGNKEY_ECDSA_NISTP256_LEN);
+	buf_putbufstring(buf, sigblob);
+
+	buf_free(sigblob);
+	mp_clear_multi(&ecdsa_r, &ecdsa_s, NULL);
+
+	TRACE(("leave buf_put_ecdsa_sign"))
+}
+
+#endif /* DROPBEAR_ECDSA */
@@ -0,0 +1,28 @@
+#ifndef DROPBEAR_ECDSA_H_
+#define DROPBEAR_ECDSA_H_
+
+#include "includes.h"
+#include "buffer.h"
+#include "ecc.h"
+
+#ifdef DROPBEAR_ECDSA
+
+typedef struct {
+
+	/* the uncompressed point */
+	unsigned char pub[ECC256_POINT_LEN];
+	/* the private scalar, big endian, zero for a public key */
+	unsigned char priv[ECC256_LEN];
+
+} dropbear_ecdsa_key;
+
+void buf_put_ecdsa_sign(buffer* buf, dropbear_ecdsa_key *key, buffer *data_buf);
+int buf_get_ecdsa_pub_key(buffer* buf, dropbear_ecdsa_key *key);
+int buf_get_ecdsa_priv_key(buffer* buf, dropbear_ecdsa_key *key);
+void buf_put_ecdsa_pub_key(buffer* buf, dropbear_ecdsa_key *key);
+void buf_put_ecdsa_priv_key(buffer* buf, dropbear_ecdsa_key *key);
+void ecdsa_key_free(dropbear_ecdsa_key *key);
+
+#endif /* DROPBEAR_ECDSA */
+
+#endif /* DROPBEAR_ECDSA_H_ */
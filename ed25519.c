@@ -0,0 +1,134 @@
+#include "includes.h"
+#include "dbutil.h"
+#include "ed25519.h"
+#include "buffer.h"
+#include "ssh.h"
+
+/* ssh-ed25519 keys and signatures, RFC 8709. The curve arithmetic is in
+ * curve25519.c, key generation in gened25519.c */
+
+#ifdef DROPBEAR_ED25519
+
+/* Load an ed25519 public key from a buffer:
+ *
+ * string	"ssh-ed25519"
+ * string	public key, 32 bytes
+ *
+ * Returns DROPBEAR_SUCCESS or DROPBEAR_FAILURE */
+int buf_get_ed25519_pub_key(buffer* buf, dropbear_ed25519_key *key) {
+
+	unsigned int len;
+
+	TRACE(("enter buf_get_ed25519_pub_key"))
+	dropbear_assert(key != NULL);
+
+	buf_incrpos(buf, 4+SSH_SIGNKEY_ED25519_LEN); /* int + "ssh-ed25519" */
+
+	len = buf_getint(buf);
+	if (len != ED25519_PUB_LEN) {
+		TRACE(("leave buf_get_ed25519_pub_key: bad length"))
+		return DROPBEAR_FAILURE;
+	}
+	memcpy(key->pub, buf_getptr(buf, len), len);
+	buf_incrpos(buf, len);
+
+	TRACE(("leave buf_get_ed25519_pub_key: success"))
+	return DROPBEAR_SUCCESS;
+}
+
+/* The private key is stored as OpenSSH does, the seed followed by the
+ * public key in one string:
+ *
+ * string	"ssh-ed25519"
+ * string	seed and public key, 64 bytes
+ *
+ * The public key is checked against the seed, signing hashes it in.
+ * Returns DROPBEAR_SUCCESS or DROPBEAR_FAILURE */
+int buf_get_ed25519_priv_key(buffer* buf, dropbear_ed25519_key *key) {
+
+	unsigned char check[ED25519_PUB_LEN];
+	unsigned int len;
+	int ret = DROPBEAR_FAILURE;
+
+	TRACE(("enter buf_get_ed25519_priv_key"))
+	dropbear_assert(key != NULL);
+
+	buf_incrpos(buf, 4+SSH_SIGNKEY_ED25519_LEN); /* int + "ssh-ed25519" */
+
+	len = buf_getint(buf);
+	if (len != ED25519_SEED_LEN + ED25519_PUB_LEN) {
+		TRACE(("leave buf_get_ed25519_priv_key: bad length"))
+		return DROPBEAR_FAILURE;
+	}
+	memcpy(key->priv, buf_getptr(buf, ED25519_SEED_LEN), ED25519_SEED_LEN);
+	buf_incrpos(buf, ED25519_SEED_LEN);
+	memcpy(key->pub, buf_getptr(buf, ED25519_PUB_LEN), ED25519_PUB_LEN);
+	buf_incrpos(buf, ED25519_PUB_LEN);
+
+	ed25519_make_key(check, key->priv);
+	if (memcmp(check, key->pub, ED25519_PUB_LEN) != 0) {
+		TRACE(("buf_get_ed25519_priv_key: seed doesn't match public key"))
+		m_burn(key->priv, ED25519_SEED_LEN);
+	} else {
+		ret = DROPBEAR_SUCCESS;
+	}
+	m_burn(check, sizeof(check));
+
+	TRACE(("leave buf_get_ed25519_priv_key"))
+	return ret;
+}
+
+/* Clear and free the memory used by a public or private key */
+void ed25519_key_free(dropbear_ed25519_key *key) {
+
+	TRACE2(("enter ed25519_key_free"))
+	if (key == NULL) {
+		TRACE2(("leave ed25519_key_free: key == NULL"))
+		return;
+	}
+	m_burn(key->priv, ED25519_SEED_LEN);
+	m_free(key);
+	TRACE2(("leave ed25519_key_free"))
+}
+
+/* put the ed25519 public key into the buffer in the required format */
+void buf_put_ed25519_pub_key(buffer* buf, dropbear_ed25519_key *key) {
+
+	dropbear_assert(key != NULL);
+	buf_putstring(buf, SSH_SIGNKEY_ED25519, SSH_SIGNKEY_ED25519_LEN);
+	buf_putstring(buf, (const char*)key->pub, ED25519_PUB_LEN);
+
+}
+
+/* the private key format, see buf_get_ed25519_priv_key() */
+void buf_put_ed25519_priv_key(buffer* buf, dropbear_ed25519_key *key) {
+
+	dropbear_assert(key != NULL);
+	buf_putstring(buf, SSH_SIGNKEY_ED25519, SSH_SIGNKEY_ED25519_LEN);
+	buf_putint(buf, ED25519_SEED_LEN + ED25519_PUB_LEN);
+	buf_putbytes(buf, key->priv, ED25519_SEED_LEN);
+	buf_putbytes(buf, key->pub, ED25519_PUB_LEN);
+
+}
+
+/* Sign the data presented with key, writing the signature contents
+ * to the buffer:
+ *
+ * string	"ssh-ed25519"
+ * string	signature, 64 bytes */
+void buf_put_ed25519_sign(buffer* buf, dropbear_ed25519_key *key, buffer *data_buf) {
+
+	unsigned char sig[ED25519_SIG_LEN];
+
+	TRACE(("enter buf_put_ed25519_sign"))
+	dropbear_assert(key != NULL);
+
+	ed25519_sign(sig, data_buf->data, data_buf->len, key->priv, key->pub);
+
+	buf_putstring(buf, SSH_SIGNKEY_ED25519, SSH_SIGNKEY_ED25519_LEN);
+	buf_putstring(buf, (const char*)sig, ED25519_SIG_LEN);
+
+	TRACE(("leave buf_put_ed25519_sign"))
+}
+
+#endif /* DROPBEAR_ED25519 */
@@ -0,0 +1,27 @@
+#ifndef DROPBEAR_ED25519_H_
+#define DROPBEAR_ED25519_H_
+
+#include "includes.h"
+#include "buffer.h"
+#include "curve25519.h"
+
+#ifdef DROPBEAR_ED25519
+
+typedef struct {
+
+	unsigned char pub[ED25519_PUB_LEN];
+	/* the private seed, zero for a public key */
+	unsigned char priv[ED25519_SEED_LEN];
+
+} dropbear_ed25519_key;
+
+void buf_put_ed25519_sign(buffer* buf, dropbear_ed25519_key *key, buffer *data_buf);
+int buf_get_ed25519_pub_key(buffer* buf, dropbear_ed25519_key *key);
+int buf_get_ed25519_priv_key(buffer* buf, dropbear_ed25519_key *key);
+void buf_put_ed25519_pub_key(buffer* buf, dropbear_ed25519_key *key);
+void buf_put_ed25519_priv_key(buffer* buf, dropbear_ed25519_key *key);
+void ed25519_key_free(dropbear_ed25519_key *key);
+
+#endif /* DROPBEAR_ED25519 */
+
+#endif /* DROPBEAR_ED25519_H_ */
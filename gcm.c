@@ -0,0 +1,102 @@
+#include "includes.h"
+#include "algo.h"
+#include "dbutil.h"
+#include "gcm.h"
+
+/* AES-GCM for SSH, as aes128-gcm@openssh.com (RFC 5647 with the OpenSSH
+ * negotiation). The packet length is sent in the clear as additional
+ * authenticated data, and the 16 byte tag takes the place of the MAC. */
+
+#ifdef DROPBEAR_ENABLE_GCM_MODE
+
+/* the tag replaces the negotiated MAC */
+static const struct dropbear_hash dropbear_ghash =
+	{NULL, 0, GCM_TAG_LEN, 0};
+
+static int dropbear_gcm_start(int cipher, const unsigned char *IV,
+			const unsigned char *key, int keylen,
+			int UNUSED(num_rounds), dropbear_gcm_state *state) {
+	int err;
+
+	TRACE2(("enter dropbear_gcm_start"))
+
+	if ((err = gcm_init(&state->gcm, cipher, key, keylen)) != CRYPT_OK) {
+		return err;
+	}
+	memcpy(state->iv, IV, GCM_NONCE_LEN);
+
+	TRACE2(("leave dropbear_gcm_start"))
+	return CRYPT_OK;
+}
+
+/* in and out may be the same buffer. len is the length of the packet
+ * including the cleartext length field, the tag follows it */
+static int dropbear_gcm_crypt(unsigned int UNUSED(seq),
+			const unsigned char *in, unsigned char *out,
+			unsigned long len, unsigned long taglen,
+			dropbear_gcm_state *state, int direction) {
+	unsigned char tag[GCM_TAG_LEN];
+	unsigned long tagbuflen = GCM_TAG_LEN;
+	int i, err;
+
+	TRACE2(("enter dropbear_gcm_crypt"))
+
+	if (len < 4 || taglen != GCM_TAG_LEN) {
+		return CRYPT_ERROR;
+	}
+
+	if ((err = gcm_reset(&state->gcm)) != CRYPT_OK
+		|| (err = gcm_add_iv(&state->gcm, state->iv, GCM_NONCE_LEN)) != CRYPT_OK
+		|| (err = gcm_add_aad(&state->gcm, in, 4)) != CRYPT_OK) {
+		return err;
+	}
+	if (in != out) {
+		memcpy(out, in, 4);
+	}
+
+	if (direction == DROPBEAR_AEAD_ENCRYPT) {
+		err = gcm_process(&state->gcm, (unsigned char*)in + 4, len - 4,
+				out + 4, GCM_ENCRYPT);
+	} else {
+		err = gcm_process(&state->gcm, out + 4, len - 4,
+				(unsigned char*)in + 4, GCM_DECRYPT);
+	}
+	if (err != CRYPT_OK
+		|| (err = gcm_done(&state->gcm, tag, &tagbuflen)) != CRYPT_OK) {
+		return err;
+	}
+
+	if (direction == DROPBEAR_AEAD_ENCRYPT) {
+		memcpy(out + len, tag, taglen);
+	} else if (constant_time_memcmp(in + len, tag, taglen) != 0) {
+		err = CRYPT_ERROR;
+	}
+
+	/* increment the invocation counter */
+	for (i = GCM_NONCE_LEN - 1; i >= GCM_IVFIX_LEN; i--) {
+		if (++state->iv[i]) {
+			break;
+		}
+	}
+
+	m_burn(tag, sizeof(tag));
+	TRACE2(("leave dropbear_gcm_crypt"))
+	return err;
+}
+
+/* the length field isn't encrypted */
+static int dropbear_gcm_getlength(unsigned int UNUSED(seq),
+			const unsigned char *in, unsigned int *outlen,
+			unsigned long len, dropbear_gcm_state* UNUSED(state)) {
+	if (len < 4) {
+		return CRYPT_ERROR;
+	}
+	LOAD32H(*outlen, in);
+	return CRYPT_OK;
+}
+
+const struct dropbear_cipher_mode dropbear_mode_gcm =
+	{(void*)dropbear_gcm_start, NULL, NULL,
+	(void*)dropbear_gcm_crypt, (void*)dropbear_gcm_getlength, &dropbear_ghash};
+
+#endif /* DROPBEAR_ENABLE_GCM_MODE */
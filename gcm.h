@@ -0,0 +1,22 @@
+#ifndef DROPBEAR_GCM_H_
+#define DROPBEAR_GCM_H_
+
+#include "includes.h"
+#include "algo.h"
+
+#ifdef DROPBEAR_ENABLE_GCM_MODE
+
+#define GCM_TAG_LEN 16
+#define GCM_NONCE_LEN 12 /* 4 byte fixed field, 8 byte invocation counter */
+#define GCM_IVFIX_LEN 4
+
+typedef struct {
+	gcm_state gcm;
+	unsigned char iv[GCM_NONCE_LEN];
+} dropbear_gcm_state;
+
+extern const struct dropbear_cipher_mode dropbear_mode_gcm;
+
+#endif /* DROPBEAR_ENABLE_GCM_MODE */
+
+#endif /* DROPBEAR_GCM_H_ */
@@ -0,0 +1,20 @@
+#include "includes.h"
+#include "dbutil.h"
+#include "dbrandom.h"
+#include "genecdsa.h"
+
+#ifdef DROPBEAR_ECDSA
+
+/* A nistp256 private key is a random scalar 0 < d < n, the public key
+ * is Q = d * G */
+dropbear_ecdsa_key * gen_ecdsa_priv_key() {
+
+	dropbear_ecdsa_key *key = m_malloc(sizeof(*key));
+
+	ecc256_gen_priv(key->priv);
+	ecc256_make_key(key->pub, key->priv);
+
+	return key;
+}
+
+#endif /* DROPBEAR_ECDSA */
@@ -0,0 +1,12 @@
+#ifndef DROPBEAR_GENECDSA_H_
+#define DROPBEAR_GENECDSA_H_
+
+#include "ecdsa.h"
+
+#ifdef DROPBEAR_ECDSA
+
+dropbear_ecdsa_key * gen_ecdsa_priv_key(void);
+
+#endif /* DROPBEAR_ECDSA */
+
+#endif /* DROPBEAR_GENECDSA_H_ */
@@ -0,0 +1,20 @@
+#include "includes.h"
+#include "dbutil.h"
+#include "dbrandom.h"
+#include "gened25519.h"
+
+#ifdef DROPBEAR_ED25519
+
+/* An ed25519 private key is just 32 random bytes, the public key follows
+ * from them (RFC 8032 section 5.1.5) */
+dropbear_ed25519_key * gen_ed25519_priv_key() {
+
+	dropbear_ed25519_key *key = m_malloc(sizeof(*key));
+
+	genrandom(key->priv, ED25519_SEED_LEN);
+	ed25519_make_key(key->pub, key->priv);
+
+	return key;
+}
+
+#endif /* DROPBEAR_ED25519 */
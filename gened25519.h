@@ -0,0 +1,12 @@
+#ifndef DROPBEAR_GENED25519_H_
+#define DROPBEAR_GENED25519_H_
+
+#include "ed25519.h"
+
+#ifdef DROPBEAR_ED25519
+
+dropbear_ed25519_key * gen_ed25519_priv_key(void);
+
+#endif /* DROPBEAR_ED25519 */
+
+#endif /* DROPBEAR_GENED25519_H_ */
@@ -3,11 +3,15 @@
 #include "buffer.h"
 #include "genrsa.h"
 #include "gendss.h"
+#include "gened25519.h"
+#include "genecdsa.h"
 #include "signkey.h"
 #include "dbrandom.h"
 
 #define RSA_DEFAULT_SIZE 2048
 #define DSS_DEFAULT_SIZE 1024
+#define ED25519_DEFAULT_SIZE 256
+#define ECDSA_DEFAULT_SIZE 256
 
 /* Returns DROPBEAR_SUCCESS or DROPBEAR_FAILURE */
 static int buf_writefile(buffer * buf, const char * filename) {
@@ -59,6 +63,14 @@ static int get_default_bits(enum signkey_type keytype)
 #ifdef DROPBEAR_DSS
 		case DROPBEAR_SIGNKEY_DSS:
 			return DSS_DEFAULT_SIZE;
+#endif
+#ifdef DROPBEAR_ED25519
+		case DROPBEAR_SIGNKEY_ED25519:
+			return ED25519_DEFAULT_SIZE;
+#endif
+#ifdef DROPBEAR_ECDSA
+		case DROPBEAR_SIGNKEY_ECDSA_NISTP256:
+			return ECDSA_DEFAULT_SIZE;
 #endif
 		default:
 			return 0;
@@ -92,6 +104,18 @@ int signkey_generate(enum signkey_type keytype, int bits, const char* filename,
 		case DROPBEAR_SIGNKEY_DSS:
 			key->dsskey = gen_dss_priv_key(bits);
 			break;
+#endif
+#ifdef DROPBEAR_ED25519
+		case DROPBEAR_SIGNKEY_ED25519:
+			/* the size is fixed, bits is ignored */
+			key->ed25519key = gen_ed25519_priv_key();
+			break;
+#endif
+#ifdef DROPBEAR_ECDSA
+		case DROPBEAR_SIGNKEY_ECDSA_NISTP256:
+			/* only nistp256, bits is ignored */
+			key->ecdsakey = gen_ecdsa_priv_key();
+			break;
 #endif
 		default:
 			dropbear_exit("Internal error");
@@ -28,6 +28,8 @@
 #include "includes.h"
 #include "algo.h"
 #include "signkey.h"
+#include "curve25519.h"
+#include "ecc.h"
 
 void send_msg_kexinit(void);
 void recv_msg_kexinit(void);
@@ -35,11 +37,33 @@ void send_msg_newkeys(void);
 void recv_msg_newkeys(void);
 void kexfirstinitialise(void);
 
+void kexdh_init_groups(void);
 struct kex_dh_param *gen_kexdh_param(void);
 void free_kexdh_param(struct kex_dh_param *param);
 void kexdh_comb_key(struct kex_dh_param *param, mp_int *dh_pub_them,
 		sign_key *hostkey);
 
+#ifdef DROPBEAR_CURVE25519
+struct kex_curve25519_param *gen_kexcurve25519_param(void);
+void free_kexcurve25519_param(struct kex_curve25519_param *param);
+void kexcurve25519_comb_key(struct kex_curve25519_param *param,
+		const unsigned char *pub_them, unsigned int pub_them_len,
+		sign_key *hostkey);
+#endif
+
+#ifdef DROPBEAR_ECDH
+struct kex_ecdh_param *gen_kexecdh_param(void);
+void free_kexecdh_param(struct kex_ecdh_param *param);
+void kexecdh_comb_key(struct kex_ecdh_param *param,
+		const unsigned char *pub_them, unsigned int pub_them_len,
+		sign_key *hostkey);
+#endif
+
+int kex_rekey_near(int idle);
+int kex_precompute_wanted(int idle);
+void kex_precompute(void);
+void kex_precompute_cleanup(void);
+
 void recv_msg_kexdh_init(void); /* server */
 
 void send_msg_kexdh_init(void); /* client */
@@ -62,6 +86,11 @@ struct KEXState {
 	unsigned int datatrans; /* data transmitted since last kex */
 	unsigned int datarecv; /* data received since last kex */
 
+	/* our half of the next kex, made ahead of a rekey by kex_precompute().
+	 * next_param is a kex_*_param for next_kex's mode */
+	const struct dropbear_kex *next_kex;
+	void *next_param;
+
 };
 
 struct kex_dh_param {
@@ -69,6 +98,20 @@ struct kex_dh_param {
 	mp_int priv; /* x */
 };
 
+#ifdef DROPBEAR_CURVE25519
+struct kex_curve25519_param {
+	unsigned char priv[CURVE25519_LEN];
+	unsigned char pub[CURVE25519_LEN];
+};
+#endif
+
+#ifdef DROPBEAR_ECDH
+struct kex_ecdh_param {
+	unsigned char priv[ECC256_LEN];
+	unsigned char pub[ECC256_POINT_LEN];
+};
+#endif
+
 
 #define MAX_KEXHASHBUF 2000
 
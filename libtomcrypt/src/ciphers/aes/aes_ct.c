@@ -0,0 +1,780 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis
+ *
+ * LibTomCrypt is a library that provides various cryptographic
+ * algorithms in a highly modular and flexible manner.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtomcrypt.com
+ */
+
+/**
+  @file aes_ct.c
+  Bitsliced AES in 64 bit words, for CPUs with neither AES instructions
+  nor byte shuffles.  After Thomas Pornin's "ct64" code in BearSSL: four
+  blocks are spread over eight words, one per bit of each byte, so the
+  S-box is the Boyar-Peralta circuit of 113 and/xor/not operations on
+  all 64 bytes at once and nothing indexes memory by key or data.
+
+  A single block costs as much as four, so the modes that can (ECB, CBC
+  decryption and CTR, which GCM uses) run four blocks per pass through
+  the accel_ hooks.  The round keys are stored compressed, two words a
+  round in the eK array of struct rijndael_key, and expanded when used.
+*/
+
+#include "tomcrypt.h"
+
+#ifdef LTC_AES_CT
+
+const struct ltc_cipher_descriptor aes_ct_desc =
+{
+    "aes",
+    6,
+    16, 32, 16, 10,
+    aes_ct_setup, aes_ct_ecb_encrypt, aes_ct_ecb_decrypt, rijndael_test, rijndael_done, rijndael_keysize,
+    aes_ct_accel_ecb_encrypt, NULL, NULL, aes_ct_cbc_decrypt, aes_ct_ctr_encrypt,
+    NULL, NULL, NULL, NULL, NULL, NULL, NULL
+};
+
+#define CT64(x) CONST64(x)
+
+/* S-box on the eight bit planes, q[0] holding the least significant bits */
+static void ct_sbox(ulong64 *q)
+{
+   ulong64 x0, x1, x2, x3, x4, x5, x6, x7;
+   ulong64 y1, y2, y3, y4, y5, y6, y7, y8, y9;
+   ulong64 y10, y11, y12, y13, y14, y15, y16, y17, y18, y19;
+   ulong64 y20, y21;
+   ulong64 z0, z1, z2, z3, z4, z5, z6, z7, z8, z9;
+   ulong64 z10, z11, z12, z13, z14, z15, z16, z17;
+   ulong64 t0, t1, t2, t3, t4, t5, t6, t7, t8, t9;
+   ulong64 t10, t11, t12, t13, t14, t15, t16, t17, t18, t19;
+   ulong64 t20, t21, t22, t23, t24, t25, t26, t27, t28, t29;
+   ulong64 t30, t31, t32, t33, t34, t35, t36, t37, t38, t39;
+   ulong64 t40, t41, t42, t43, t44, t45, t46, t47, t48, t49;
+   ulong64 t50, t51, t52, t53, t54, t55, t56, t57, t58, t59;
+   ulong64 t60, t61, t62, t63, t64, t65, t66, t67;
+   ulong64 s0, s1, s2, s3, s4, s5, s6, s7;
+
+   x0 = q[7];
+   x1 = q[6];
+   x2 = q[5];
+   x3 = q[4];
+   x4 = q[3];
+   x5 = q[2];
+   x6 = q[1];
+   x7 = q[0];
+
+   /* top linear transformation */
+   y14 = x3 ^ x5;
+   y13 = x0 ^ x6;
+   y9 = x0 ^ x3;
+   y8 = x0 ^ x5;
+   t0 = x1 ^ x2;
+   y1 = t0 ^ x7;
+   y4 = y1 ^ x3;
+   y12 = y13 ^ y14;
+   y2 = y1 ^ x0;
+   y5 = y1 ^ x6;
+   y3 = y5 ^ y8;
+   t1 = x4 ^ y12;
+   y15 = t1 ^ x5;
+   y20 = t1 ^ x1;
+   y6 = y15 ^ x7;
+   y10 = y15 ^ t0;
+   y11 = y20 ^ y9;
+   y7 = x7 ^ y11;
+   y17 = y10 ^ y11;
+   y19 = y10 ^ y8;
+   y16 = t0 ^ y11;
+   y21 = y13 ^ y16;
+   y18 = x0 ^ y16;
+
+   /* non-linear section, the inversion in GF(16^2) */
+   t2 = y12 & y15;
+   t3 = y3 & y6;
+   t4 = t3 ^ t2;
+   t5 = y4 & x7;
+   t6 = t5 ^ t2;
+   t7 = y13 & y16;
+   t8 = y5 & y1;
+   t9 = t8 ^ t7;
+   t10 = y2 & y7;
+   t11 = t10 ^ t7;
+   t12 = y9 & y11;
+   t13 = y14 & y17;
+   t14 = t13 ^ t12;
+   t15 = y8 & y10;
+   t16 = t15 ^ t12;
+   t17 = t4 ^ t14;
+   t18 = t6 ^ t16;
+   t19 = t9 ^ t14;
+   t20 = t11 ^ t16;
+   t21 = t17 ^ y20;
+   t22 = t18 ^ y19;
+   t23 = t19 ^ y21;
+   t24 = t20 ^ y18;
+
+   t25 = t21 ^ t22;
+   t26 = t21 & t23;
+   t27 = t24 ^ t26;
+   t28 = t25 & t27;
+   t29 = t28 ^ t22;
+   t30 = t23 ^ t24;
+   t31 = t22 ^ t26;
+   t32 = t31 & t30;
+   t33 = t32 ^ t24;
+   t34 = t23 ^ t33;
+   t35 = t27 ^ t33;
+   t36 = t24 & t35;
+   t37 = t36 ^ t34;
+   t38 = t27 ^ t36;
+   t39 = t29 & t38;
+   t40 = t25 ^ t39;
+
+   t41 = t40 ^ t37;
+   t42 = t29 ^ t33;
+   t43 = t29 ^ t40;
+   t44 = t33 ^ t37;
+   t45 = t42 ^ t41;
+   z0 = t44 & y15;
+   z1 = t37 & y6;
+   z2 = t33 & x7;
+   z3 = t43 & y16;
+   z4 = t40 & y1;
+   z5 = t29 & y7;
+   z6 = t42 & y11;
+   z7 = t45 & y17;
+   z8 = t41 & y10;
+   z9 = t44 & y12;
+   z10 = t37 & y3;
+   z11 = t33 & y4;
+   z12 = t43 & y13;
+   z13 = t40 & y5;
+   z14 = t29 & y2;
+   z15 = t42 & y9;
+   z16 = t45 & y14;
+   z17 = t41 & y8;
+
+   /* bottom linear transformation, with the affine constant */
+   t46 = z15 ^ z16;
+   t47 = z10 ^ z11;
+   t48 = z5 ^ z13;
+   t49 = z9 ^ z10;
+   t50 = z2 ^ z12;
+   t51 = z2 ^ z5;
+   t52 = z7 ^ z8;
+   t53 = z0 ^ z3;
+   t54 = z6 ^ z7;
+   t55 = z16 ^ z17;
+   t56 = z12 ^ t48;
+   t57 = t50 ^ t53;
+   t58 = z4 ^ t46;
+   t59 = z3 ^ t54;
+   t60 = t46 ^ t57;
+   t61 = z14 ^ t57;
+   t62 = t52 ^ t58;
+   t63 = t49 ^ t58;
+   t64 = z4 ^ t59;
+   t65 = t61 ^ t62;
+   t66 = z1 ^ t63;
+   s0 = t59 ^ t63;
+   s6 = t56 ^ ~t62;
+   s7 = t48 ^ ~t60;
+   t67 = t64 ^ t65;
+   s3 = t53 ^ t66;
+   s4 = t51 ^ t66;
+   s5 = t47 ^ t65;
+   s1 = t64 ^ ~s3;
+   s2 = t55 ^ ~t67;
+
+   q[7] = s0;
+   q[6] = s1;
+   q[5] = s2;
+   q[4] = s3;
+   q[3] = s4;
+   q[2] = s5;
+   q[1] = s6;
+   q[0] = s7;
+}
+
+/* the inverse of the affine map of the S-box, less its constant 0x63 */
+static void ct_inv_affine(ulong64 *q)
+{
+   ulong64 q0 = ~q[0], q1 = ~q[1], q2 = q[2], q3 = q[3];
+   ulong64 q4 = q[4], q5 = ~q[5], q6 = ~q[6], q7 = q[7];
+
+   q[7] = q1 ^ q4 ^ q6;
+   q[6] = q0 ^ q3 ^ q5;
+   q[5] = q7 ^ q2 ^ q4;
+   q[4] = q6 ^ q1 ^ q3;
+   q[3] = q5 ^ q0 ^ q2;
+   q[2] = q4 ^ q7 ^ q1;
+   q[1] = q3 ^ q6 ^ q0;
+   q[0] = q2 ^ q5 ^ q7;
+}
+
+/* S^-1 = A^-1 o S o A^-1, as S = A o (1/x) */
+static void ct_inv_sbox(ulong64 *q)
+{
+   ct_inv_affine(q);
+   ct_sbox(q);
+   ct_inv_affine(q);
+}
+
+/* transpose the 8x8 bit blocks of the eight words, a byte of input
+   becomes one bit in each word */
+static void ct_ortho(ulong64 *q)
+{
+#define SWAPN(cl, ch, s, x, y) do { \
+      ulong64 a = (x), b = (y); \
+      (x) = (a & CT64(cl)) | ((b & CT64(cl)) << (s)); \
+      (y) = ((a & CT64(ch)) >> (s)) | (b & CT64(ch)); \
+   } while (0)
+#define SWAP2(x, y) SWAPN(0x5555555555555555, 0xAAAAAAAAAAAAAAAA, 1, x, y)
+#define SWAP4(x, y) SWAPN(0x3333333333333333, 0xCCCCCCCCCCCCCCCC, 2, x, y)
+#define SWAP8(x, y) SWAPN(0x0F0F0F0F0F0F0F0F, 0xF0F0F0F0F0F0F0F0, 4, x, y)
+
+   SWAP2(q[0], q[1]);
+   SWAP2(q[2], q[3]);
+   SWAP2(q[4], q[5]);
+   SWAP2(q[6], q[7]);
+
+   SWAP4(q[0], q[2]);
+   SWAP4(q[1], q[3]);
+   SWAP4(q[4], q[6]);
+   SWAP4(q[5], q[7]);
+
+   SWAP8(q[0], q[4]);
+   SWAP8(q[1], q[5]);
+   SWAP8(q[2], q[6]);
+   SWAP8(q[3], q[7]);
+
+#undef SWAP2
+#undef SWAP4
+#undef SWAP8
+#undef SWAPN
+}
+
+/* spread the four little endian words of a block over two words, a
+   byte from each column in every 16 bits */
+static void ct_interleave_in(ulong64 *q0, ulong64 *q1, const ulong32 *w)
+{
+   ulong64 x0 = w[0], x1 = w[1], x2 = w[2], x3 = w[3];
+
+   x0 |= (x0 << 16);
+   x1 |= (x1 << 16);
+   x2 |= (x2 << 16);
+   x3 |= (x3 << 16);
+   x0 &= CT64(0x0000FFFF0000FFFF);
+   x1 &= CT64(0x0000FFFF0000FFFF);
+   x2 &= CT64(0x0000FFFF0000FFFF);
+   x3 &= CT64(0x0000FFFF0000FFFF);
+   x0 |= (x0 << 8);
+   x1 |= (x1 << 8);
+   x2 |= (x2 << 8);
+   x3 |= (x3 << 8);
+   x0 &= CT64(0x00FF00FF00FF00FF);
+   x1 &= CT64(0x00FF00FF00FF00FF);
+   x2 &= CT64(0x00FF00FF00FF00FF);
+   x3 &= CT64(0x00FF00FF00FF00FF);
+   *q0 = x0 | (x2 << 8);
+   *q1 = x1 | (x3 << 8);
+}
+
+static void ct_interleave_out(ulong32 *w, ulong64 q0, ulong64 q1)
+{
+   ulong64 x0, x1, x2, x3;
+
+   x0 = q0 & CT64(0x00FF00FF00FF00FF);
+   x1 = q1 & CT64(0x00FF00FF00FF00FF);
+   x2 = (q0 >> 8) & CT64(0x00FF00FF00FF00FF);
+   x3 = (q1 >> 8) & CT64(0x00FF00FF00FF00FF);
+   x0 |= (x0 >> 8);
+   x1 |= (x1 >> 8);
+   x2 |= (x2 >> 8);
+   x3 |= (x3 >> 8);
+   x0 &= CT64(0x0000FFFF0000FFFF);
+   x1 &= CT64(0x0000FFFF0000FFFF);
+   x2 &= CT64(0x0000FFFF0000FFFF);
+   x3 &= CT64(0x0000FFFF0000FFFF);
+   w[0] = (ulong32)((x0 | (x0 >> 16)) & 0xFFFFFFFFUL);
+   w[1] = (ulong32)((x1 | (x1 >> 16)) & 0xFFFFFFFFUL);
+   w[2] = (ulong32)((x2 | (x2 >> 16)) & 0xFFFFFFFFUL);
+   w[3] = (ulong32)((x3 | (x3 >> 16)) & 0xFFFFFFFFUL);
+}
+
+/* load up to four blocks into the bit planes, missing ones as zero */
+static void ct_load(ulong64 *q, const unsigned char *in, int n)
+{
+   ulong32 w[16];
+   int i;
+
+   for (i = 0; i < 16; i++) {
+      if (i < 4 * n) {
+         LOAD32L(w[i], in + 4 * i);
+      } else {
+         w[i] = 0;
+      }
+   }
+   for (i = 0; i < 4; i++) {
+      ct_interleave_in(&q[i], &q[i + 4], w + 4 * i);
+   }
+   ct_ortho(q);
+}
+
+static void ct_store(unsigned char *out, ulong64 *q, int n)
+{
+   ulong32 w[16];
+   int i;
+
+   ct_ortho(q);
+   for (i = 0; i < 4; i++) {
+      ct_interleave_out(w + 4 * i, q[i], q[i + 4]);
+   }
+   for (i = 0; i < 4 * n; i++) {
+      STORE32L(w[i], out + 4 * i);
+   }
+}
+
+static ulong32 ct_sub_word(ulong32 x)
+{
+   ulong64 q[8];
+
+   zeromem(q, sizeof(q));
+   q[0] = x;
+   ct_ortho(q);
+   ct_sbox(q);
+   ct_ortho(q);
+   return (ulong32)(q[0] & 0xFFFFFFFFUL);
+}
+
+static void ct_add_round_key(ulong64 *q, const ulong64 *sk)
+{
+   q[0] ^= sk[0];
+   q[1] ^= sk[1];
+   q[2] ^= sk[2];
+   q[3] ^= sk[3];
+   q[4] ^= sk[4];
+   q[5] ^= sk[5];
+   q[6] ^= sk[6];
+   q[7] ^= sk[7];
+}
+
+static void ct_shift_rows(ulong64 *q)
+{
+   int i;
+
+   for (i = 0; i < 8; i++) {
+      ulong64 x = q[i];
+      q[i] = (x & CT64(0x000000000000FFFF))
+         | ((x & CT64(0x00000000FFF00000)) >> 4)
+         | ((x & CT64(0x00000000000F0000)) << 12)
+         | ((x & CT64(0x0000FF0000000000)) >> 8)
+         | ((x & CT64(0x000000FF00000000)) << 8)
+         | ((x & CT64(0xF000000000000000)) >> 12)
+         | ((x & CT64(0x0FFF000000000000)) << 4);
+   }
+}
+
+static void ct_inv_shift_rows(ulong64 *q)
+{
+   int i;
+
+   for (i = 0; i < 8; i++) {
+      ulong64 x = q[i];
+      q[i] = (x & CT64(0x000000000000FFFF))
+         | ((x & CT64(0x000000000FFF0000)) << 4)
+         | ((x & CT64(0x00000000F0000000)) >> 12)
+         | ((x & CT64(0x000000FF00000000)) << 8)
+         | ((x & CT64(0x0000FF0000000000)) >> 8)
+         | ((x & CT64(0x000F000000000000)) << 12)
+         | ((x & CT64(0xFFF0000000000000)) >> 4);
+   }
+}
+
+/* rotating a word by 16 bits moves each byte up a row of its column,
+   by 32 bits two rows */
+#define ROTR16(x) (((x) >> 16) | ((x) << 48))
+#define ROTR32(x) (((x) >> 32) | ((x) << 32))
+
+static void ct_mix_columns(ulong64 *q)
+{
+   ulong64 q0, q1, q2, q3, q4, q5, q6, q7;
+   ulong64 r0, r1, r2, r3, r4, r5, r6, r7;
+
+   q0 = q[0]; q1 = q[1]; q2 = q[2]; q3 = q[3];
+   q4 = q[4]; q5 = q[5]; q6 = q[6]; q7 = q[7];
+   r0 = ROTR16(q0); r1 = ROTR16(q1); r2 = ROTR16(q2); r3 = ROTR16(q3);
+   r4 = ROTR16(q4); r5 = ROTR16(q5); r6 = ROTR16(q6); r7 = ROTR16(q7);
+
+   q[0] = q7 ^ r7 ^ r0 ^ ROTR32(q0 ^ r0);
+   q[1] = q0 ^ r0 ^ q7 ^ r7 ^ r1 ^ ROTR32(q1 ^ r1);
+   q[2] = q1 ^ r1 ^ r2 ^ ROTR32(q2 ^ r2);
+   q[3] = q2 ^ r2 ^ q7 ^ r7 ^ r3 ^ ROTR32(q3 ^ r3);
+   q[4] = q3 ^ r3 ^ q7 ^ r7 ^ r4 ^ ROTR32(q4 ^ r4);
+   q[5] = q4 ^ r4 ^ r5 ^ ROTR32(q5 ^ r5);
+   q[6] = q5 ^ r5 ^ r6 ^ ROTR32(q6 ^ r6);
+   q[7] = q6 ^ r6 ^ r7 ^ ROTR32(q7 ^ r7);
+}
+
+/* InvMixColumns is MixColumns after the circulant (05 00 04 00), that
+   is a ^= 4(a ^ c) in each column */
+static void ct_inv_mix_columns(ulong64 *q)
+{
+   ulong64 u[8], t;
+   int i;
+
+   for (i = 0; i < 8; i++) {
+      u[i] = q[i] ^ ROTR32(q[i]);
+   }
+   /* times x, twice */
+   for (i = 0; i < 2; i++) {
+      t = u[7];
+      u[7] = u[6];
+      u[6] = u[5];
+      u[5] = u[4];
+      u[4] = u[3] ^ t;
+      u[3] = u[2] ^ t;
+      u[2] = u[1];
+      u[1] = u[0] ^ t;
+      u[0] = t;
+   }
+   for (i = 0; i < 8; i++) {
+      q[i] ^= u[i];
+   }
+   ct_mix_columns(q);
+}
+
+/* the round keys, each as eight words for the bit planes */
+static void ct_expand_key(ulong64 *sk, const symmetric_key *skey)
+{
+   ulong64 comp[30], x0, x1, x2, x3;
+   int u, j, Nr = skey->rijndael.Nr;
+
+   XMEMCPY(comp, skey->rijndael.eK, (Nr + 1) * 2 * sizeof(ulong64));
+   for (u = 0; u <= Nr; u++) {
+      for (j = 0; j < 2; j++) {
+         x0 = comp[2 * u + j];
+         x1 = x0 & CT64(0x2222222222222222);
+         x2 = x0 & CT64(0x4444444444444444);
+         x3 = x0 & CT64(0x8888888888888888);
+         x0 &= CT64(0x1111111111111111);
+         x1 >>= 1;
+         x2 >>= 2;
+         x3 >>= 3;
+         /* one bit spread to its four block lanes */
+         sk[8 * u + 4 * j + 0] = (x0 << 4) - x0;
+         sk[8 * u + 4 * j + 1] = (x1 << 4) - x1;
+         sk[8 * u + 4 * j + 2] = (x2 << 4) - x2;
+         sk[8 * u + 4 * j + 3] = (x3 << 4) - x3;
+      }
+   }
+#ifdef LTC_CLEAN_STACK
+   zeromem(comp, sizeof(comp));
+#endif
+}
+
+static void ct_encrypt(ulong64 *q, const ulong64 *sk, int Nr)
+{
+   int r;
+
+   ct_add_round_key(q, sk);
+   for (r = 1; r < Nr; r++) {
+      ct_sbox(q);
+      ct_shift_rows(q);
+      ct_mix_columns(q);
+      ct_add_round_key(q, sk + 8 * r);
+   }
+   ct_sbox(q);
+   ct_shift_rows(q);
+   ct_add_round_key(q, sk + 8 * Nr);
+}
+
+static void ct_decrypt(ulong64 *q, const ulong64 *sk, int Nr)
+{
+   int r;
+
+   ct_add_round_key(q, sk + 8 * Nr);
+   for (r = Nr - 1; r > 0; r--) {
+      ct_inv_shift_rows(q);
+      ct_inv_sbox(q);
+      ct_add_round_key(q, sk + 8 * r);
+      ct_inv_mix_columns(q);
+   }
+   ct_inv_shift_rows(q);
+   ct_inv_sbox(q);
+   ct_add_round_key(q, sk);
+}
+
+/**
+    Initialize the AES (Rijndael) block cipher
+    @param key The symmetric key you wish to pass
+    @param keylen The key length in bytes
+    @param num_rounds The number of rounds desired (0 for default)
+    @param skey The key in as scheduled by this function.
+    @return CRYPT_OK if successful
+ */
+int aes_ct_setup(const unsigned char *key, int keylen, int num_rounds, symmetric_key *skey)
+{
+   static const unsigned char rcon[10] = { 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1B, 0x36 };
+   ulong32 w[60], tmp;
+   ulong64 q[8], comp[30];
+   int i, j, k, Nk, Nr;
+
+   LTC_ARGCHK(key  != NULL);
+   LTC_ARGCHK(skey != NULL);
+
+   if (keylen != 16 && keylen != 24 && keylen != 32) {
+      return CRYPT_INVALID_KEYSIZE;
+   }
+
+   Nr = 10 + ((keylen/8)-2)*2;
+   if (num_rounds != 0 && num_rounds != Nr) {
+      return CRYPT_INVALID_ROUNDS;
+   }
+   skey->rijndael.Nr = Nr;
+
+   /* the FIPS-197 key expansion on little endian words */
+   Nk = keylen / 4;
+   for (i = 0; i < Nk; i++) {
+      LOAD32L(w[i], key + 4 * i);
+   }
+   tmp = w[Nk - 1];
+   for (i = Nk, j = 0, k = 0; i < 4 * (Nr + 1); i++) {
+      if (j == 0) {
+         tmp = ((tmp << 24) | (tmp >> 8)) & 0xFFFFFFFFUL;
+         tmp = ct_sub_word(tmp) ^ rcon[k];
+      } else if (Nk > 6 && j == 4) {
+         tmp = ct_sub_word(tmp);
+      }
+      tmp ^= w[i - Nk];
+      w[i] = tmp;
+      if (++j == Nk) {
+         j = 0;
+         k++;
+      }
+   }
+
+   /* bitslice each round key for one block, and keep one bit in four
+      of each plane, see ct_expand_key() */
+   for (i = 0; i <= Nr; i++) {
+      ct_interleave_in(&q[0], &q[4], w + 4 * i);
+      q[1] = q[2] = q[3] = q[0];
+      q[5] = q[6] = q[7] = q[4];
+      ct_ortho(q);
+      comp[2 * i] = (q[0] & CT64(0x1111111111111111))
+                  | (q[1] & CT64(0x2222222222222222))
+                  | (q[2] & CT64(0x4444444444444444))
+                  | (q[3] & CT64(0x8888888888888888));
+      comp[2 * i + 1] = (q[4] & CT64(0x1111111111111111))
+                      | (q[5] & CT64(0x2222222222222222))
+                      | (q[6] & CT64(0x4444444444444444))
+                      | (q[7] & CT64(0x8888888888888888));
+   }
+   XMEMCPY(skey->rijndael.eK, comp, (Nr + 1) * 2 * sizeof(ulong64));
+
+   zeromem(w, sizeof(w));
+   zeromem(q, sizeof(q));
+   zeromem(comp, sizeof(comp));
+   return CRYPT_OK;
+}
+
+/* up to four blocks from in to out */
+static void ct_ecb(const unsigned char *in, unsigned char *out, int n, const ulong64 *sk, int Nr, int dec)
+{
+   ulong64 q[8];
+
+   ct_load(q, in, n);
+   if (dec) {
+      ct_decrypt(q, sk, Nr);
+   } else {
+      ct_encrypt(q, sk, Nr);
+   }
+   ct_store(out, q, n);
+}
+
+/**
+  Encrypts a block of text with the bitsliced code
+  @param pt The input plaintext (16 bytes)
+  @param ct The output ciphertext (16 bytes)
+  @param skey The key as scheduled by aes_ct_setup()
+  @return CRYPT_OK if successful
+*/
+int aes_ct_ecb_encrypt(const unsigned char *pt, unsigned char *ct, symmetric_key *skey)
+{
+   ulong64 sk[120];
+
+   LTC_ARGCHK(pt != NULL);
+   LTC_ARGCHK(ct != NULL);
+   LTC_ARGCHK(skey != NULL);
+
+   ct_expand_key(sk, skey);
+   ct_ecb(pt, ct, 1, sk, skey->rijndael.Nr, 0);
+#ifdef LTC_CLEAN_STACK
+   zeromem(sk, sizeof(sk));
+#endif
+   return CRYPT_OK;
+}
+
+/**
+  Decrypts a block of text with the bitsliced code
+  @param ct The input ciphertext (16 bytes)
+  @param pt The output plaintext (16 bytes)
+  @param skey The key as scheduled by aes_ct_setup()
+  @return CRYPT_OK if successful
+*/
+int aes_ct_ecb_decrypt(const unsigned char *ct, unsigned char *pt, symmetric_key *skey)
+{
+   ulong64 sk[120];
+
+   LTC_ARGCHK(pt != NULL);
+   LTC_ARGCHK(ct != NULL);
+   LTC_ARGCHK(skey != NULL);
+
+   ct_expand_key(sk, skey);
+   ct_ecb(ct, pt, 1, sk, skey->rijndael.Nr, 1);
+#ifdef LTC_CLEAN_STACK
+   zeromem(sk, sizeof(sk));
+#endif
+   return CRYPT_OK;
+}
+
+/**
+  Encrypt several blocks in ECB mode, four at a time
+  @param pt      Plaintext
+  @param ct      [out] Ciphertext
+  @param blocks  The number of complete blocks to process
+  @param skey    The scheduled key context
+  @return CRYPT_OK if successful
+*/
+int aes_ct_accel_ecb_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, symmetric_key *skey)
+{
+   ulong64 sk[120];
+   int n;
+
+   ct_expand_key(sk, skey);
+   while (blocks > 0) {
+      n = blocks < 4 ? (int)blocks : 4;
+      ct_ecb(pt, ct, n, sk, skey->rijndael.Nr, 0);
+      pt += 16 * n;
+      ct += 16 * n;
+      blocks -= n;
+   }
+#ifdef LTC_CLEAN_STACK
+   zeromem(sk, sizeof(sk));
+#endif
+   return CRYPT_OK;
+}
+
+/**
+  CBC decryption, see cbc_decrypt().  Four blocks are decrypted at a
+  time; encryption is serial and left to cbc_encrypt().
+  @param ct      Ciphertext
+  @param pt      [out] Plaintext
+  @param blocks  The number of complete blocks to process
+  @param IV      The initial value (input/output)
+  @param skey    The scheduled key context
+  @return CRYPT_OK if successful
+*/
+int aes_ct_cbc_decrypt(const unsigned char *ct, unsigned char *pt, unsigned long blocks, unsigned char *IV, symmetric_key *skey)
+{
+   ulong64 sk[120];
+   unsigned char buf[64], prev[64 + 16];
+   int i, n;
+
+   ct_expand_key(sk, skey);
+   XMEMCPY(prev, IV, 16);
+   while (blocks > 0) {
+      n = blocks < 4 ? (int)blocks : 4;
+      /* keep the ciphertext, pt may be ct */
+      XMEMCPY(prev + 16, ct, 16 * n);
+      ct_ecb(ct, buf, n, sk, skey->rijndael.Nr, 1);
+      for (i = 0; i < 16 * n; i++) {
+         pt[i] = buf[i] ^ prev[i];
+      }
+      XMEMCPY(prev, prev + 16 * n, 16);
+      pt += 16 * n;
+      ct += 16 * n;
+      blocks -= n;
+   }
+   XMEMCPY(IV, prev, 16);
+#ifdef LTC_CLEAN_STACK
+   zeromem(sk, sizeof(sk));
+   zeromem(buf, sizeof(buf));
+#endif
+   return CRYPT_OK;
+}
+
+/* the next counter block, as ctr_encrypt() increments it */
+static void ct_next_counter(unsigned char *out, ulong64 *hi, ulong64 *lo, int mode)
+{
+   if (++*lo == 0) {
+      ++*hi;
+   }
+   if (mode == CTR_COUNTER_BIG_ENDIAN) {
+      STORE64H(*hi, out);
+      STORE64H(*lo, out + 8);
+   } else {
+      STORE64L(*lo, out);
+      STORE64L(*hi, out + 8);
+   }
+}
+
+/**
+  CTR encryption, see ctr_encrypt().  As in ctr_encrypt() the counter is
+  incremented before each block is encrypted, and is left holding the
+  last counter value used.
+  @param pt      Plaintext
+  @param ct      [out] Ciphertext
+  @param blocks  The number of complete blocks to process
+  @param IV      The counter (input/output)
+  @param mode    CTR_COUNTER_LITTLE_ENDIAN or CTR_COUNTER_BIG_ENDIAN
+  @param skey    The scheduled key context
+  @return CRYPT_OK if successful
+*/
+int aes_ct_ctr_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, unsigned char *IV, int mode, symmetric_key *skey)
+{
+   ulong64 sk[120], hi, lo;
+   unsigned char buf[64];
+   int i, n;
+
+   ct_expand_key(sk, skey);
+   if (mode == CTR_COUNTER_BIG_ENDIAN) {
+      LOAD64H(hi, IV);
+      LOAD64H(lo, IV + 8);
+   } else {
+      LOAD64L(lo, IV);
+      LOAD64L(hi, IV + 8);
+   }
+
+   while (blocks > 0) {
+      n = blocks < 4 ? (int)blocks : 4;
+      for (i = 0; i < n; i++) {
+         ct_next_counter(buf + 16 * i, &hi, &lo, mode);
+      }
+      ct_ecb(buf, buf, n, sk, skey->rijndael.Nr, 0);
+      for (i = 0; i < 16 * n; i++) {
+         ct[i] = pt[i] ^ buf[i];
+      }
+      pt += 16 * n;
+      ct += 16 * n;
+      blocks -= n;
+   }
+
+   if (mode == CTR_COUNTER_BIG_ENDIAN) {
+      STORE64H(hi, IV);
+      STORE64H(lo, IV + 8);
+   } else {
+      STORE64L(lo, IV);
+      STORE64L(hi, IV + 8);
+   }
+#ifdef LTC_CLEAN_STACK
+   zeromem(sk, sizeof(sk));
+   zeromem(buf, sizeof(buf));
+#endif
+   return CRYPT_OK;
+}
+
+#endif /* LTC_AES_CT */
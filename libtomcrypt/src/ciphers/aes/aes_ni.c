@@ -0,0 +1,447 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis
+ *
+ * LibTomCrypt is a library that provides various cryptographic
+ * algorithms in a highly modular and flexible manner.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtomcrypt.com
+ */
+
+/**
+  @file aes_ni.c
+  AES using the x86 AES-NI instructions.
+
+  The round keys are kept in the eK/dK arrays of struct rijndael_key as
+  raw 16 byte blocks, not as the big-endian words used by aes.c, so a key
+  scheduled by aes_ni_setup() must only be used through aes_ni_desc.
+  Only call these once aes_ni_is_supported() has returned non-zero.
+*/
+
+#include "tomcrypt.h"
+
+#ifdef LTC_AES_NI
+
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#include <wmmintrin.h>
+
+/* Only the functions below use AES/SSSE3 instructions, the rest of the
+ * build doesn't need -maes */
+#define AESNI_TARGET __attribute__((target("sse2,ssse3,aes")))
+
+const struct ltc_cipher_descriptor aes_ni_desc =
+{
+    "aes",
+    6,
+    16, 32, 16, 10,
+    aes_ni_setup, aes_ni_ecb_encrypt, aes_ni_ecb_decrypt, rijndael_test, rijndael_done, rijndael_keysize,
+    NULL, NULL, aes_ni_cbc_encrypt, aes_ni_cbc_decrypt, aes_ni_ctr_encrypt,
+    NULL, NULL, NULL, NULL, NULL, NULL, NULL
+};
+
+/**
+  Check whether this CPU can run the AES-NI code
+  @return non-zero if aes_ni_desc may be used
+*/
+int aes_ni_is_supported(void)
+{
+   const unsigned long need = LTC_CPU_AESNI | LTC_CPU_SSSE3;
+
+   return (crypt_cpu_features() & need) == need;
+}
+
+#define RK(skey, i) (((__m128i *)(skey)->rijndael.eK) + (i))
+#define DK(skey, i) (((__m128i *)(skey)->rijndael.dK) + (i))
+
+AESNI_TARGET
+static __m128i expand_step(__m128i key, __m128i assist)
+{
+   key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+   key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+   key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+   return _mm_xor_si128(key, assist);
+}
+
+#define EXPAND128(k, rcon) \
+   expand_step((k), _mm_shuffle_epi32(_mm_aeskeygenassist_si128((k), (rcon)), 0xff))
+
+AESNI_TARGET
+static void setup128(const unsigned char *key, symmetric_key *skey)
+{
+   __m128i k = _mm_loadu_si128((const __m128i *)key);
+
+   _mm_storeu_si128(RK(skey, 0), k);
+   k = EXPAND128(k, 0x01); _mm_storeu_si128(RK(skey, 1), k);
+   k = EXPAND128(k, 0x02); _mm_storeu_si128(RK(skey, 2), k);
+   k = EXPAND128(k, 0x04); _mm_storeu_si128(RK(skey, 3), k);
+   k = EXPAND128(k, 0x08); _mm_storeu_si128(RK(skey, 4), k);
+   k = EXPAND128(k, 0x10); _mm_storeu_si128(RK(skey, 5), k);
+   k = EXPAND128(k, 0x20); _mm_storeu_si128(RK(skey, 6), k);
+   k = EXPAND128(k, 0x40); _mm_storeu_si128(RK(skey, 7), k);
+   k = EXPAND128(k, 0x80); _mm_storeu_si128(RK(skey, 8), k);
+   k = EXPAND128(k, 0x1b); _mm_storeu_si128(RK(skey, 9), k);
+   k = EXPAND128(k, 0x36); _mm_storeu_si128(RK(skey, 10), k);
+}
+
+/* one 192 bit step, t1 holds words 0-3 and the low half of t3 words 4-5 */
+AESNI_TARGET
+static void expand192(__m128i *t1, __m128i *t3, __m128i assist)
+{
+   __m128i t;
+
+   *t1 = expand_step(*t1, _mm_shuffle_epi32(assist, 0x55));
+   t   = _mm_shuffle_epi32(*t1, 0xff);
+   *t3 = _mm_xor_si128(*t3, _mm_slli_si128(*t3, 4));
+   *t3 = _mm_xor_si128(*t3, t);
+}
+
+#define LO_HI(a, b) _mm_castpd_si128(_mm_shuffle_pd(_mm_castsi128_pd(a), _mm_castsi128_pd(b), 0))
+#define HI_LO(a, b) _mm_castpd_si128(_mm_shuffle_pd(_mm_castsi128_pd(a), _mm_castsi128_pd(b), 1))
+
+AESNI_TARGET
+static void setup192(const unsigned char *key, symmetric_key *skey)
+{
+   __m128i t1, t3, prev;
+
+   t1 = _mm_loadu_si128((const __m128i *)key);
+   t3 = _mm_loadl_epi64((const __m128i *)(key + 16));
+
+   _mm_storeu_si128(RK(skey, 0), t1);
+   prev = t3;
+   expand192(&t1, &t3, _mm_aeskeygenassist_si128(t3, 0x01));
+   _mm_storeu_si128(RK(skey, 1), LO_HI(prev, t1));
+   _mm_storeu_si128(RK(skey, 2), HI_LO(t1, t3));
+   expand192(&t1, &t3, _mm_aeskeygenassist_si128(t3, 0x02));
+   _mm_storeu_si128(RK(skey, 3), t1);
+   prev = t3;
+   expand192(&t1, &t3, _mm_aeskeygenassist_si128(t3, 0x04));
+   _mm_storeu_si128(RK(skey, 4), LO_HI(prev, t1));
+   _mm_storeu_si128(RK(skey, 5), HI_LO(t1, t3));
+   expand192(&t1, &t3, _mm_aeskeygenassist_si128(t3, 0x08));
+   _mm_storeu_si128(RK(skey, 6), t1);
+   prev = t3;
+   expand192(&t1, &t3, _mm_aeskeygenassist_si128(t3, 0x10));
+   _mm_storeu_si128(RK(skey, 7), LO_HI(prev, t1));
+   _mm_storeu_si128(RK(skey, 8), HI_LO(t1, t3));
+   expand192(&t1, &t3, _mm_aeskeygenassist_si128(t3, 0x20));
+   _mm_storeu_si128(RK(skey, 9), t1);
+   prev = t3;
+   expand192(&t1, &t3, _mm_aeskeygenassist_si128(t3, 0x40));
+   _mm_storeu_si128(RK(skey, 10), LO_HI(prev, t1));
+   _mm_storeu_si128(RK(skey, 11), HI_LO(t1, t3));
+   expand192(&t1, &t3, _mm_aeskeygenassist_si128(t3, 0x80));
+   _mm_storeu_si128(RK(skey, 12), t1);
+}
+
+#define EXPAND256A(k1, k3, rcon) \
+   expand_step((k1), _mm_shuffle_epi32(_mm_aeskeygenassist_si128((k3), (rcon)), 0xff))
+#define EXPAND256B(k1, k3) \
+   expand_step((k3), _mm_shuffle_epi32(_mm_aeskeygenassist_si128((k1), 0x00), 0xaa))
+
+AESNI_TARGET
+static void setup256(const unsigned char *key, symmetric_key *skey)
+{
+   __m128i k1, k3;
+
+   k1 = _mm_loadu_si128((const __m128i *)key);
+   k3 = _mm_loadu_si128((const __m128i *)(key + 16));
+   _mm_storeu_si128(RK(skey, 0), k1);
+   _mm_storeu_si128(RK(skey, 1), k3);
+
+   k1 = EXPAND256A(k1, k3, 0x01); _mm_storeu_si128(RK(skey, 2), k1);
+   k3 = EXPAND256B(k1, k3);       _mm_storeu_si128(RK(skey, 3), k3);
+   k1 = EXPAND256A(k1, k3, 0x02); _mm_storeu_si128(RK(skey, 4), k1);
+   k3 = EXPAND256B(k1, k3);       _mm_storeu_si128(RK(skey, 5), k3);
+   k1 = EXPAND256A(k1, k3, 0x04); _mm_storeu_si128(RK(skey, 6), k1);
+   k3 = EXPAND256B(k1, k3);       _mm_storeu_si128(RK(skey, 7), k3);
+   k1 = EXPAND256A(k1, k3, 0x08); _mm_storeu_si128(RK(skey, 8), k1);
+   k3 = EXPAND256B(k1, k3);       _mm_storeu_si128(RK(skey, 9), k3);
+   k1 = EXPAND256A(k1, k3, 0x10); _mm_storeu_si128(RK(skey, 10), k1);
+   k3 = EXPAND256B(k1, k3);       _mm_storeu_si128(RK(skey, 11), k3);
+   k1 = EXPAND256A(k1, k3, 0x20); _mm_storeu_si128(RK(skey, 12), k1);
+   k3 = EXPAND256B(k1, k3);       _mm_storeu_si128(RK(skey, 13), k3);
+   k1 = EXPAND256A(k1, k3, 0x40); _mm_storeu_si128(RK(skey, 14), k1);
+}
+
+ /**
+    Initialize the AES (Rijndael) block cipher for AES-NI
+    @param key The symmetric key you wish to pass
+    @param keylen The key length in bytes
+    @param num_rounds The number of rounds desired (0 for default)
+    @param skey The key in as scheduled by this function.
+    @return CRYPT_OK if successful
+ */
+AESNI_TARGET
+int aes_ni_setup(const unsigned char *key, int keylen, int num_rounds, symmetric_key *skey)
+{
+   int i, Nr;
+
+   LTC_ARGCHK(key  != NULL);
+   LTC_ARGCHK(skey != NULL);
+
+   if (keylen != 16 && keylen != 24 && keylen != 32) {
+      return CRYPT_INVALID_KEYSIZE;
+   }
+
+   Nr = 10 + ((keylen/8)-2)*2;
+   if (num_rounds != 0 && num_rounds != Nr) {
+      return CRYPT_INVALID_ROUNDS;
+   }
+   skey->rijndael.Nr = Nr;
+
+   if (keylen == 16) {
+      setup128(key, skey);
+   } else if (keylen == 24) {
+      setup192(key, skey);
+   } else {
+      setup256(key, skey);
+   }
+
+   /* the equivalent inverse cipher wants the round keys in reverse
+    * order, with InvMixColumns applied to all but the first and last */
+   _mm_storeu_si128(DK(skey, 0), _mm_loadu_si128(RK(skey, Nr)));
+   for (i = 1; i < Nr; i++) {
+      _mm_storeu_si128(DK(skey, i), _mm_aesimc_si128(_mm_loadu_si128(RK(skey, Nr - i))));
+   }
+   _mm_storeu_si128(DK(skey, Nr), _mm_loadu_si128(RK(skey, 0)));
+
+   return CRYPT_OK;
+}
+
+AESNI_TARGET
+static __m128i encrypt_block(__m128i b, const symmetric_key *skey)
+{
+   int r, Nr = skey->rijndael.Nr;
+
+   b = _mm_xor_si128(b, _mm_loadu_si128(RK(skey, 0)));
+   for (r = 1; r < Nr; r++) {
+      b = _mm_aesenc_si128(b, _mm_loadu_si128(RK(skey, r)));
+   }
+   return _mm_aesenclast_si128(b, _mm_loadu_si128(RK(skey, Nr)));
+}
+
+AESNI_TARGET
+static __m128i decrypt_block(__m128i b, const symmetric_key *skey)
+{
+   int r, Nr = skey->rijndael.Nr;
+
+   b = _mm_xor_si128(b, _mm_loadu_si128(DK(skey, 0)));
+   for (r = 1; r < Nr; r++) {
+      b = _mm_aesdec_si128(b, _mm_loadu_si128(DK(skey, r)));
+   }
+   return _mm_aesdeclast_si128(b, _mm_loadu_si128(DK(skey, Nr)));
+}
+
+/**
+  Encrypts a block of text with AES-NI
+  @param pt The input plaintext (16 bytes)
+  @param ct The output ciphertext (16 bytes)
+  @param skey The key as scheduled by aes_ni_setup()
+  @return CRYPT_OK if successful
+*/
+AESNI_TARGET
+int aes_ni_ecb_encrypt(const unsigned char *pt, unsigned char *ct, symmetric_key *skey)
+{
+   LTC_ARGCHK(pt != NULL);
+   LTC_ARGCHK(ct != NULL);
+   LTC_ARGCHK(skey != NULL);
+
+   _mm_storeu_si128((__m128i *)ct, encrypt_block(_mm_loadu_si128((const __m128i *)pt), skey));
+   return CRYPT_OK;
+}
+
+/**
+  Decrypts a block of text with AES-NI
+  @param ct The input ciphertext (16 bytes)
+  @param pt The output plaintext (16 bytes)
+  @param skey The key as scheduled by aes_ni_setup()
+  @return CRYPT_OK if successful
+*/
+AESNI_TARGET
+int aes_ni_ecb_decrypt(const unsigned char *ct, unsigned char *pt, symmetric_key *skey)
+{
+   LTC_ARGCHK(pt != NULL);
+   LTC_ARGCHK(ct != NULL);
+   LTC_ARGCHK(skey != NULL);
+
+   _mm_storeu_si128((__m128i *)pt, decrypt_block(_mm_loadu_si128((const __m128i *)ct), skey));
+   return CRYPT_OK;
+}
+
+/**
+  Accelerated CBC encryption, see cbc_encrypt()
+  @param pt      Plaintext
+  @param ct      [out] Ciphertext
+  @param blocks  The number of complete blocks to process
+  @param IV      The initial value (input/output)
+  @param skey    The scheduled key context
+  @return CRYPT_OK if successful
+*/
+AESNI_TARGET
+int aes_ni_cbc_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, unsigned char *IV, symmetric_key *skey)
+{
+   __m128i iv = _mm_loadu_si128((const __m128i *)IV);
+
+   while (blocks--) {
+      iv = encrypt_block(_mm_xor_si128(iv, _mm_loadu_si128((const __m128i *)pt)), skey);
+      _mm_storeu_si128((__m128i *)ct, iv);
+      pt += 16;
+      ct += 16;
+   }
+   _mm_storeu_si128((__m128i *)IV, iv);
+   return CRYPT_OK;
+}
+
+/* Apply one round to all eight blocks of a stripe */
+#define ROUND8(op, k) do { \
+   __m128i rk_ = (k); \
+   b0 = op(b0, rk_); b1 = op(b1, rk_); b2 = op(b2, rk_); b3 = op(b3, rk_); \
+   b4 = op(b4, rk_); b5 = op(b5, rk_); b6 = op(b6, rk_); b7 = op(b7, rk_); \
+} while (0)
+
+/* XOR a decrypted block with the ciphertext block before it */
+#define CBC_XOR_STORE(i, b) \
+   _mm_storeu_si128((__m128i *)pt + (i), _mm_xor_si128((b), _mm_loadu_si128((const __m128i *)ct + (i) - 1)))
+
+/**
+  Accelerated CBC decryption, see cbc_decrypt().  Unlike encryption the
+  block cipher calls are independent, so eight blocks are decrypted at a
+  time to overlap the AESDEC latencies.  Results are stored last block
+  first so that ct and pt may be the same buffer.
+  @param ct      Ciphertext
+  @param pt      [out] Plaintext
+  @param blocks  The number of complete blocks to process
+  @param IV      The initial value (input/output)
+  @param skey    The scheduled key context
+  @return CRYPT_OK if successful
+*/
+AESNI_TARGET
+int aes_ni_cbc_decrypt(const unsigned char *ct, unsigned char *pt, unsigned long blocks, unsigned char *IV, symmetric_key *skey)
+{
+   int r, Nr = skey->rijndael.Nr;
+   __m128i iv = _mm_loadu_si128((const __m128i *)IV), c;
+   __m128i b0, b1, b2, b3, b4, b5, b6, b7;
+
+   for (; blocks >= 8; blocks -= 8) {
+      b0 = _mm_loadu_si128((const __m128i *)ct + 0);
+      b1 = _mm_loadu_si128((const __m128i *)ct + 1);
+      b2 = _mm_loadu_si128((const __m128i *)ct + 2);
+      b3 = _mm_loadu_si128((const __m128i *)ct + 3);
+      b4 = _mm_loadu_si128((const __m128i *)ct + 4);
+      b5 = _mm_loadu_si128((const __m128i *)ct + 5);
+      b6 = _mm_loadu_si128((const __m128i *)ct + 6);
+      b7 = _mm_loadu_si128((const __m128i *)ct + 7);
+
+      ROUND8(_mm_xor_si128, _mm_loadu_si128(DK(skey, 0)));
+      for (r = 1; r < Nr; r++) {
+         ROUND8(_mm_aesdec_si128, _mm_loadu_si128(DK(skey, r)));
+      }
+      ROUND8(_mm_aesdeclast_si128, _mm_loadu_si128(DK(skey, Nr)));
+
+      c = _mm_loadu_si128((const __m128i *)ct + 7);
+      CBC_XOR_STORE(7, b7); CBC_XOR_STORE(6, b6); CBC_XOR_STORE(5, b5); CBC_XOR_STORE(4, b4);
+      CBC_XOR_STORE(3, b3); CBC_XOR_STORE(2, b2); CBC_XOR_STORE(1, b1);
+      _mm_storeu_si128((__m128i *)pt, _mm_xor_si128(b0, iv));
+      iv = c;
+      pt += 128;
+      ct += 128;
+   }
+
+   while (blocks--) {
+      /* ct and pt may be the same buffer */
+      c = _mm_loadu_si128((const __m128i *)ct);
+      _mm_storeu_si128((__m128i *)pt, _mm_xor_si128(decrypt_block(c, skey), iv));
+      iv = c;
+      pt += 16;
+      ct += 16;
+   }
+   _mm_storeu_si128((__m128i *)IV, iv);
+   return CRYPT_OK;
+}
+
+#define XOR8_STORE(i, b) \
+   _mm_storeu_si128((__m128i *)ct + (i), _mm_xor_si128((b), _mm_loadu_si128((const __m128i *)pt + (i))))
+
+/* return the next counter block, the counter is held as two native halves */
+AESNI_TARGET
+static __m128i next_counter(ulong64 *hi, ulong64 *lo, int mode)
+{
+   if (++*lo == 0) {
+      ++*hi;
+   }
+   if (mode == CTR_COUNTER_BIG_ENDIAN) {
+      return _mm_set_epi64x((long long)__builtin_bswap64(*lo), (long long)__builtin_bswap64(*hi));
+   }
+   return _mm_set_epi64x((long long)*hi, (long long)*lo);
+}
+
+/**
+  Accelerated CTR encryption, see ctr_encrypt().  As in ctr_encrypt() the
+  counter is incremented before each block is encrypted, and is left
+  holding the last counter value used.  Eight blocks are encrypted at a
+  time so the AESENC latencies of independent blocks overlap.
+  @param pt      Plaintext
+  @param ct      [out] Ciphertext
+  @param blocks  The number of complete blocks to process
+  @param IV      The counter (input/output)
+  @param mode    CTR_COUNTER_LITTLE_ENDIAN or CTR_COUNTER_BIG_ENDIAN
+  @param skey    The scheduled key context
+  @return CRYPT_OK if successful
+*/
+AESNI_TARGET
+int aes_ni_ctr_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, unsigned char *IV, int mode, symmetric_key *skey)
+{
+   int r, Nr = skey->rijndael.Nr;
+   ulong64 hi, lo;
+   __m128i b0, b1, b2, b3, b4, b5, b6, b7;
+
+   if (mode == CTR_COUNTER_BIG_ENDIAN) {
+      LOAD64H(hi, IV);
+      LOAD64H(lo, IV + 8);
+   } else {
+      LOAD64L(lo, IV);
+      LOAD64L(hi, IV + 8);
+   }
+
+   for (; blocks >= 8; blocks -= 8) {
+      b0 = next_counter(&hi, &lo, mode);
+      b1 = next_counter(&hi, &lo, mode);
+      b2 = next_counter(&hi, &lo, mode);
+      b3 = next_counter(&hi, &lo, mode);
+      b4 = next_counter(&hi, &lo, mode);
+      b5 = next_counter(&hi, &lo, mode);
+      b6 = next_counter(&hi, &lo, mode);
+      b7 = next_counter(&hi, &lo, mode);
+
+      ROUND8(_mm_xor_si128, _mm_loadu_si128(RK(skey, 0)));
+      for (r = 1; r < Nr; r++) {
+         ROUND8(_mm_aesenc_si128, _mm_loadu_si128(RK(skey, r)));
+      }
+      ROUND8(_mm_aesenclast_si128, _mm_loadu_si128(RK(skey, Nr)));
+
+      XOR8_STORE(0, b0); XOR8_STORE(1, b1); XOR8_STORE(2, b2); XOR8_STORE(3, b3);
+      XOR8_STORE(4, b4); XOR8_STORE(5, b5); XOR8_STORE(6, b6); XOR8_STORE(7, b7);
+      pt += 128;
+      ct += 128;
+   }
+
+   while (blocks--) {
+      b0 = encrypt_block(next_counter(&hi, &lo, mode), skey);
+      _mm_storeu_si128((__m128i *)ct, _mm_xor_si128(b0, _mm_loadu_si128((const __m128i *)pt)));
+      pt += 16;
+      ct += 16;
+   }
+
+   if (mode == CTR_COUNTER_BIG_ENDIAN) {
+      STORE64H(hi, IV);
+      STORE64H(lo, IV + 8);
+   } else {
+      STORE64L(lo, IV);
+      STORE64L(hi, IV + 8);
+   }
+   return CRYPT_OK;
+}
+
+#endif /* LTC_AES_NI */
@@ -0,0 +1,631 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis
+ *
+ * LibTomCrypt is a library that provides various cryptographic
+ * algorithms in a highly modular and flexible manner.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtomcrypt.com
+ */
+
+/**
+  @file aes_vperm.c
+  AES with byte shuffles (SSSE3 pshufb or NEON tbl) in place of tables
+  in memory, after Hamburg's "Accelerating AES with vector permute
+  instructions".  No memory access depends on key or data, so unlike
+  aes.c it doesn't leak through the cache.
+
+  The state is kept in a tower field representation, GF(2^8) as
+  GF(16)[t]/(t^2 + t + z^3) over GF(16) = GF(2)[z]/(z^4 + z + 1), where
+  a byte is k*t + i with k the high nibble.  Each lane of the 16 byte
+  state is inverted with five 16 entry lookups:
+
+     j = i ^ k, iak = 1/i ^ a/k, jak = 1/j ^ a/k   (a = z^3+z^2+z+1)
+     io = 1/iak ^ j, jo = 1/jak ^ i
+
+  where 1/0 is looked up as 0x80, which the next shuffle turns into 0
+  (pshufb for the top bit, tbl for an index past the table).  The inverse
+  is then F(io) ^ G(jo) for a pair of nibble tables, and any linear map
+  of it is another pair, so one lookup pair gives the S-box output already
+  multiplied by a MixColumns coefficient and moved back into the tower
+  basis for the next round.  The affine constants are folded into the
+  round keys.  ShiftRows and the column rotations of (Inv)MixColumns are
+  byte permutations, merged into four shuffles per round.
+
+  The tables were generated from the field definitions above and the
+  cipher checked against FIPS-197, the S-box for every input.
+  The round keys are kept transformed in the eK/dK arrays of struct
+  rijndael_key, so a key scheduled by aes_vperm_setup() must only be
+  used through aes_vperm_desc.
+*/
+
+#include "tomcrypt.h"
+
+#ifdef LTC_AES_VPERM
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <emmintrin.h>
+#include <tmmintrin.h>
+
+#define VP_TARGET __attribute__((target("sse2,ssse3")))
+
+typedef __m128i vec;
+#define VLOAD(p)       _mm_loadu_si128((const __m128i *)(p))
+#define VSTORE(p, x)   _mm_storeu_si128((__m128i *)(p), x)
+#define VSPLAT(c)      _mm_set1_epi8((char)(c))
+#define VXOR(a, b)     _mm_xor_si128(a, b)
+#define VLO(x)         _mm_and_si128(x, VSPLAT(0x0F))
+#define VHI(x)         _mm_and_si128(_mm_srli_epi16(x, 4), VSPLAT(0x0F))
+/* look each lane of x up in a 16 byte table */
+#define VTBL(t, x)     _mm_shuffle_epi8(_mm_load_si128((const __m128i *)(t)), x)
+/* rearrange the bytes of x */
+#define VPERM(x, p)    _mm_shuffle_epi8(x, _mm_load_si128((const __m128i *)(p)))
+
+#else
+
+#include <arm_neon.h>
+
+#define VP_TARGET
+
+typedef uint8x16_t vec;
+#define VLOAD(p)       vld1q_u8(p)
+#define VSTORE(p, x)   vst1q_u8(p, x)
+#define VSPLAT(c)      vdupq_n_u8(c)
+#define VXOR(a, b)     veorq_u8(a, b)
+#define VLO(x)         vandq_u8(x, VSPLAT(0x0F))
+#define VHI(x)         vshrq_n_u8(x, 4)
+#ifdef __aarch64__
+#define VTBL(t, x)     vqtbl1q_u8(vld1q_u8(t), x)
+#define VPERM(x, p)    vqtbl1q_u8(x, vld1q_u8(p))
+#else
+static inline uint8x16_t vtbl16(uint8x16_t t, uint8x16_t x)
+{
+   uint8x8x2_t tt = { { vget_low_u8(t), vget_high_u8(t) } };
+   return vcombine_u8(vtbl2_u8(tt, vget_low_u8(x)), vtbl2_u8(tt, vget_high_u8(x)));
+}
+#define VTBL(t, x)     vtbl16(vld1q_u8(t), x)
+#define VPERM(x, p)    vtbl16(x, vld1q_u8(p))
+#endif
+
+#endif
+
+const struct ltc_cipher_descriptor aes_vperm_desc =
+{
+    "aes",
+    6,
+    16, 32, 16, 10,
+    aes_vperm_setup, aes_vperm_ecb_encrypt, aes_vperm_ecb_decrypt, rijndael_test, rijndael_done, rijndael_keysize,
+    aes_vperm_accel_ecb_encrypt, NULL, aes_vperm_cbc_encrypt, aes_vperm_cbc_decrypt, aes_vperm_ctr_encrypt,
+    NULL, NULL, NULL, NULL, NULL, NULL, NULL
+};
+
+/* Tables for the pairs of lookups are [F, G], see above.  ipt/dipt take
+   a block (less the affine constant of InvSubBytes for dipt) into the
+   tower basis from its low and high nibbles; sb1/sb2 give S(x) and 2S(x)
+   in the tower basis, sbo S(x) in the AES basis, d14..d9 the InvSubBytes
+   output times the InvMixColumns coefficient in the basis dipt gives and
+   dbo the InvSubBytes output in the AES basis.  perm[n]/iperm[n] take
+   (Inv)ShiftRows and then the rows n down in each column. */
+static const struct {
+   unsigned char inv[16], inva[16],
+                 ipt[2][16], dipt[2][16],
+                 sb1[2][16], sb2[2][16], sbo[2][16],
+                 d14[2][16], d11[2][16], d13[2][16], d9[2][16], dbo[2][16],
+                 perm[4][16], iperm[4][16];
+   unsigned char t05, t63;     /* 0x05 and 0x63 in the tower basis */
+} vp __attribute__((aligned(16))) = {
+   /* inv */
+   { 0x80, 0x01, 0x09, 0x0E, 0x0D, 0x0B, 0x07, 0x06, 0x0F, 0x02, 0x0C, 0x05, 0x0A, 0x04, 0x03, 0x08 },
+   /* inva */
+   { 0x80, 0x0F, 0x0E, 0x05, 0x07, 0x03, 0x0B, 0x04, 0x0A, 0x0D, 0x08, 0x06, 0x0C, 0x09, 0x02, 0x01 },
+   /* ipt */
+   { { 0x00, 0x01, 0x20, 0x21, 0x46, 0x47, 0x66, 0x67, 0x4C, 0x4D, 0x6C, 0x6D, 0x0A, 0x0B, 0x2A, 0x2B },
+     { 0x00, 0x3C, 0xD5, 0xE9, 0x34, 0x08, 0xE1, 0xDD, 0xE5, 0xD9, 0x30, 0x0C, 0xD1, 0xED, 0x04, 0x38 } },
+   /* dipt */
+   { { 0x00, 0x58, 0x9F, 0xC7, 0x98, 0xC0, 0x07, 0x5F, 0x28, 0x70, 0xB7, 0xEF, 0xB0, 0xE8, 0x2F, 0x77 },
+     { 0x00, 0x76, 0x79, 0x0F, 0xF9, 0x8F, 0x80, 0xF6, 0x92, 0xE4, 0xEB, 0x9D, 0x6B, 0x1D, 0x12, 0x64 } },
+   /* sb1 */
+   { { 0x00, 0xA7, 0x94, 0x1C, 0x43, 0x6C, 0x88, 0x2F, 0xBB, 0xF8, 0xE4, 0x70, 0xCB, 0xD7, 0x5F, 0x33 },
+     { 0x00, 0xB0, 0x0C, 0xE2, 0x86, 0xD8, 0xEE, 0x5E, 0x52, 0xD4, 0x36, 0x3A, 0x68, 0x8A, 0x64, 0xBC } },
+   /* sb2 */
+   { { 0x00, 0x9D, 0x98, 0x93, 0xEC, 0x7A, 0x0B, 0x96, 0x0E, 0xE2, 0x71, 0xE9, 0xE7, 0x74, 0x7F, 0x05 },
+     { 0x00, 0x5E, 0xB0, 0xB1, 0xFB, 0xA4, 0x01, 0x5F, 0xEF, 0x14, 0xA5, 0x15, 0xFA, 0x4B, 0x4A, 0xEE } },
+   /* sbo */
+   { { 0x00, 0x64, 0x99, 0x12, 0xE5, 0x0A, 0x8B, 0xEF, 0x76, 0x93, 0x81, 0x18, 0x6E, 0x7C, 0xF7, 0xFD },
+     { 0x00, 0x7B, 0xB0, 0x3D, 0x67, 0x91, 0x8D, 0xF6, 0x46, 0x21, 0x1C, 0xAC, 0xEA, 0xD7, 0x5A, 0xCB } },
+   /* d14 */
+   { { 0x00, 0x84, 0x6A, 0xE0, 0x4D, 0x43, 0x8A, 0x0E, 0x64, 0x29, 0xC9, 0xA3, 0xC7, 0x27, 0xAD, 0xEE },
+     { 0x00, 0xAB, 0x54, 0x61, 0x23, 0xBD, 0x35, 0x9E, 0xCA, 0xE9, 0x88, 0xDC, 0x16, 0x77, 0x42, 0xFF } },
+   /* d11 */
+   { { 0x00, 0xAD, 0xEE, 0x84, 0x27, 0xE0, 0x6A, 0xC7, 0x29, 0x0E, 0x8A, 0x64, 0x4D, 0xC9, 0xA3, 0x43 },
+     { 0x00, 0x42, 0xFF, 0xAB, 0x77, 0x61, 0x54, 0x16, 0xE9, 0x9E, 0x35, 0xCA, 0x23, 0x88, 0xDC, 0xBD } },
+   /* d13 */
+   { { 0x00, 0x6C, 0xF7, 0x6F, 0x60, 0x94, 0x98, 0xF4, 0x03, 0x63, 0x0C, 0xFB, 0xF8, 0x97, 0x0F, 0x9B },
+     { 0x00, 0x84, 0x6A, 0xE0, 0x4D, 0x43, 0x8A, 0x0E, 0x64, 0x29, 0xC9, 0xA3, 0xC7, 0x27, 0xAD, 0xEE } },
+   /* d9 */
+   { { 0x00, 0xBE, 0xE7, 0x04, 0x06, 0x5B, 0xE3, 0x5D, 0xBA, 0xBC, 0xB8, 0x5F, 0xE5, 0xE1, 0x02, 0x59 },
+     { 0x00, 0xCE, 0x82, 0x87, 0xD0, 0x1B, 0x05, 0xCB, 0x49, 0x99, 0x1E, 0x9C, 0xD5, 0x52, 0x57, 0x4C } },
+   /* dbo */
+   { { 0x00, 0xF2, 0x99, 0x30, 0x9D, 0xC6, 0xA9, 0x5B, 0xC2, 0x5F, 0x6F, 0xF6, 0x34, 0x04, 0xAD, 0x6B },
+     { 0x00, 0xF3, 0xC8, 0xDC, 0x2C, 0xCB, 0x14, 0xE7, 0x2F, 0x03, 0xDF, 0x17, 0x38, 0xE4, 0xF0, 0x3B } },
+   /* perm */
+   { { 0x00, 0x05, 0x0A, 0x0F, 0x04, 0x09, 0x0E, 0x03, 0x08, 0x0D, 0x02, 0x07, 0x0C, 0x01, 0x06, 0x0B },
+     { 0x05, 0x0A, 0x0F, 0x00, 0x09, 0x0E, 0x03, 0x04, 0x0D, 0x02, 0x07, 0x08, 0x01, 0x06, 0x0B, 0x0C },
+     { 0x0A, 0x0F, 0x00, 0x05, 0x0E, 0x03, 0x04, 0x09, 0x02, 0x07, 0x08, 0x0D, 0x06, 0x0B, 0x0C, 0x01 },
+     { 0x0F, 0x00, 0x05, 0x0A, 0x03, 0x04, 0x09, 0x0E, 0x07, 0x08, 0x0D, 0x02, 0x0B, 0x0C, 0x01, 0x06 } },
+   /* iperm */
+   { { 0x00, 0x0D, 0x0A, 0x07, 0x04, 0x01, 0x0E, 0x0B, 0x08, 0x05, 0x02, 0x0F, 0x0C, 0x09, 0x06, 0x03 },
+     { 0x0D, 0x0A, 0x07, 0x00, 0x01, 0x0E, 0x0B, 0x04, 0x05, 0x02, 0x0F, 0x08, 0x09, 0x06, 0x03, 0x0C },
+     { 0x0A, 0x07, 0x00, 0x0D, 0x0E, 0x0B, 0x04, 0x01, 0x02, 0x0F, 0x08, 0x05, 0x06, 0x03, 0x0C, 0x09 },
+     { 0x07, 0x00, 0x0D, 0x0A, 0x0B, 0x04, 0x01, 0x0E, 0x0F, 0x08, 0x05, 0x02, 0x03, 0x0C, 0x09, 0x06 } },
+   /* t05, t63 */
+   0x47, 0xC0
+};
+
+/**
+  Check whether this CPU can run the vector permute code
+  @return non-zero if aes_vperm_desc may be used
+*/
+int aes_vperm_is_supported(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+   return (crypt_cpu_features() & LTC_CPU_SSSE3) != 0;
+#else
+   return (crypt_cpu_features() & LTC_CPU_NEON) != 0;
+#endif
+}
+
+#define EK(skey, r) ((unsigned char *)(skey)->rijndael.eK + 16 * (r))
+#define DK(skey, r) ((unsigned char *)(skey)->rijndael.dK + 16 * (r))
+
+/* a linear map of each byte, from lookups of its two nibbles */
+VP_TARGET
+static inline vec vp_xform(vec x, const unsigned char (*t)[16])
+{
+   return VXOR(VTBL(t[0], VLO(x)), VTBL(t[1], VHI(x)));
+}
+
+/* the two nibble sets the inverse of each lane of W is found from */
+VP_TARGET
+static inline void vp_invert(vec W, vec *io, vec *jo)
+{
+   vec i = VLO(W), k = VHI(W), j = VXOR(i, k), ak = VTBL(vp.inva, k);
+
+   *io = VXOR(VTBL(vp.inv, VXOR(VTBL(vp.inv, i), ak)), j);
+   *jo = VXOR(VTBL(vp.inv, VXOR(VTBL(vp.inv, j), ak)), i);
+}
+
+#define VP_OUT(t, io, jo) VXOR(VTBL((t)[0], io), VTBL((t)[1], jo))
+
+/* SubBytes, ShiftRows, MixColumns (2a + 3b + c + d) and AddRoundKey */
+VP_TARGET
+static inline vec vp_enc_round(vec W, const unsigned char *rk)
+{
+   vec io, jo, a1, a2;
+
+   vp_invert(W, &io, &jo);
+   a1 = VP_OUT(vp.sb1, io, jo);
+   a2 = VP_OUT(vp.sb2, io, jo);
+   return VXOR(VXOR(VPERM(a2, vp.perm[0]), VPERM(VXOR(a1, a2), vp.perm[1])),
+               VXOR(VXOR(VPERM(a1, vp.perm[2]), VPERM(a1, vp.perm[3])), VLOAD(rk)));
+}
+
+VP_TARGET
+static inline vec vp_enc_last(vec W, const unsigned char *rk)
+{
+   vec io, jo;
+
+   vp_invert(W, &io, &jo);
+   return VXOR(VPERM(VP_OUT(vp.sbo, io, jo), vp.perm[0]), VLOAD(rk));
+}
+
+/* InvSubBytes, InvShiftRows, InvMixColumns (14a + 11b + 13c + 9d) and
+   AddRoundKey, the equivalent inverse cipher */
+VP_TARGET
+static inline vec vp_dec_round(vec W, const unsigned char *rk)
+{
+   vec io, jo;
+
+   vp_invert(W, &io, &jo);
+   return VXOR(VXOR(VPERM(VP_OUT(vp.d14, io, jo), vp.iperm[0]), VPERM(VP_OUT(vp.d11, io, jo), vp.iperm[1])),
+               VXOR(VXOR(VPERM(VP_OUT(vp.d13, io, jo), vp.iperm[2]), VPERM(VP_OUT(vp.d9, io, jo), vp.iperm[3])), VLOAD(rk)));
+}
+
+VP_TARGET
+static inline vec vp_dec_last(vec W, const unsigned char *rk)
+{
+   vec io, jo;
+
+   vp_invert(W, &io, &jo);
+   return VXOR(VPERM(VP_OUT(vp.dbo, io, jo), vp.iperm[0]), VLOAD(rk));
+}
+
+VP_TARGET
+static vec vp_encrypt(vec b, const symmetric_key *skey)
+{
+   int r, Nr = skey->rijndael.Nr;
+
+   b = VXOR(vp_xform(b, vp.ipt), VLOAD(EK(skey, 0)));
+   for (r = 1; r < Nr; r++) {
+      b = vp_enc_round(b, EK(skey, r));
+   }
+   return vp_enc_last(b, EK(skey, Nr));
+}
+
+VP_TARGET
+static vec vp_decrypt(vec b, const symmetric_key *skey)
+{
+   int r, Nr = skey->rijndael.Nr;
+
+   b = VXOR(vp_xform(b, vp.dipt), VLOAD(DK(skey, 0)));
+   for (r = 1; r < Nr; r++) {
+      b = vp_dec_round(b, DK(skey, r));
+   }
+   return vp_dec_last(b, DK(skey, Nr));
+}
+
+/* Four blocks at a time, the shuffles of one block have long latencies
+   to hide.  The loads and stores are left to the callers. */
+VP_TARGET
+static void vp_encrypt4(vec *b, const symmetric_key *skey)
+{
+   int r, Nr = skey->rijndael.Nr;
+   vec k = VLOAD(EK(skey, 0));
+   vec b0 = VXOR(vp_xform(b[0], vp.ipt), k), b1 = VXOR(vp_xform(b[1], vp.ipt), k);
+   vec b2 = VXOR(vp_xform(b[2], vp.ipt), k), b3 = VXOR(vp_xform(b[3], vp.ipt), k);
+
+   for (r = 1; r < Nr; r++) {
+      b0 = vp_enc_round(b0, EK(skey, r));
+      b1 = vp_enc_round(b1, EK(skey, r));
+      b2 = vp_enc_round(b2, EK(skey, r));
+      b3 = vp_enc_round(b3, EK(skey, r));
+   }
+   b[0] = vp_enc_last(b0, EK(skey, Nr));
+   b[1] = vp_enc_last(b1, EK(skey, Nr));
+   b[2] = vp_enc_last(b2, EK(skey, Nr));
+   b[3] = vp_enc_last(b3, EK(skey, Nr));
+}
+
+VP_TARGET
+static void vp_decrypt4(vec *b, const symmetric_key *skey)
+{
+   int r, Nr = skey->rijndael.Nr;
+   vec k = VLOAD(DK(skey, 0));
+   vec b0 = VXOR(vp_xform(b[0], vp.dipt), k), b1 = VXOR(vp_xform(b[1], vp.dipt), k);
+   vec b2 = VXOR(vp_xform(b[2], vp.dipt), k), b3 = VXOR(vp_xform(b[3], vp.dipt), k);
+
+   for (r = 1; r < Nr; r++) {
+      b0 = vp_dec_round(b0, DK(skey, r));
+      b1 = vp_dec_round(b1, DK(skey, r));
+      b2 = vp_dec_round(b2, DK(skey, r));
+      b3 = vp_dec_round(b3, DK(skey, r));
+   }
+   b[0] = vp_dec_last(b0, DK(skey, Nr));
+   b[1] = vp_dec_last(b1, DK(skey, Nr));
+   b[2] = vp_dec_last(b2, DK(skey, Nr));
+   b[3] = vp_dec_last(b3, DK(skey, Nr));
+}
+
+/* SubWord for the key schedule, through the same lookups */
+VP_TARGET
+static void vp_subword(unsigned char *w)
+{
+   unsigned char buf[16];
+   vec io, jo;
+
+   zeromem(buf, sizeof(buf));
+   XMEMCPY(buf, w, 4);
+   vp_invert(vp_xform(VLOAD(buf), vp.ipt), &io, &jo);
+   VSTORE(buf, VXOR(VP_OUT(vp.sbo, io, jo), VSPLAT(0x63)));
+   XMEMCPY(w, buf, 4);
+}
+
+static unsigned char vp_xtime(unsigned char x)
+{
+   return (unsigned char)((x << 1) ^ (0x1B & -(x >> 7)));
+}
+
+/* InvMixColumns of a round key, for the equivalent inverse cipher */
+static void vp_invmixcolumns(unsigned char *rk)
+{
+   unsigned char a[4], x2, x4, x8;
+   int c, r;
+
+   for (c = 0; c < 16; c += 4) {
+      XMEMCPY(a, rk + c, 4);
+      for (r = 0; r < 4; r++) {
+         rk[c + r] = 0;
+      }
+      for (r = 0; r < 4; r++) {
+         x2 = vp_xtime(a[r]);
+         x4 = vp_xtime(x2);
+         x8 = vp_xtime(x4);
+         /* a[r] contributes 14, 9, 13 and 11 times to rows r, r+1, r+2, r+3 */
+         rk[c + r]           ^= x8 ^ x4 ^ x2;
+         rk[c + ((r + 1) & 3)] ^= x8 ^ a[r];
+         rk[c + ((r + 2) & 3)] ^= x8 ^ x4 ^ a[r];
+         rk[c + ((r + 3) & 3)] ^= x8 ^ x2 ^ a[r];
+      }
+   }
+}
+
+/**
+    Initialize the AES (Rijndael) block cipher
+    @param key The symmetric key you wish to pass
+    @param keylen The key length in bytes
+    @param num_rounds The number of rounds desired (0 for default)
+    @param skey The key in as scheduled by this function.
+    @return CRYPT_OK if successful
+ */
+VP_TARGET
+int aes_vperm_setup(const unsigned char *key, int keylen, int num_rounds, symmetric_key *skey)
+{
+   static const unsigned char rcon[10] = { 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1B, 0x36 };
+   unsigned char rk[15 * 16], t[4];
+   int i, Nk, Nr;
+
+   LTC_ARGCHK(key  != NULL);
+   LTC_ARGCHK(skey != NULL);
+
+   if (keylen != 16 && keylen != 24 && keylen != 32) {
+      return CRYPT_INVALID_KEYSIZE;
+   }
+
+   Nr = 10 + ((keylen/8)-2)*2;
+   if (num_rounds != 0 && num_rounds != Nr) {
+      return CRYPT_INVALID_ROUNDS;
+   }
+   skey->rijndael.Nr = Nr;
+
+   /* the FIPS-197 key expansion, a word at a time */
+   Nk = keylen / 4;
+   XMEMCPY(rk, key, keylen);
+   for (i = Nk; i < 4 * (Nr + 1); i++) {
+      XMEMCPY(t, rk + 4 * (i - 1), 4);
+      if (i % Nk == 0) {
+         unsigned char b = t[0];
+         t[0] = t[1]; t[1] = t[2]; t[2] = t[3]; t[3] = b;
+         vp_subword(t);
+         t[0] ^= rcon[i / Nk - 1];
+      } else if (Nk > 6 && i % Nk == 4) {
+         vp_subword(t);
+      }
+      rk[4 * i + 0] = rk[4 * (i - Nk) + 0] ^ t[0];
+      rk[4 * i + 1] = rk[4 * (i - Nk) + 1] ^ t[1];
+      rk[4 * i + 2] = rk[4 * (i - Nk) + 2] ^ t[2];
+      rk[4 * i + 3] = rk[4 * (i - Nk) + 3] ^ t[3];
+   }
+
+   /* encryption keys in the tower basis, with the 0x63 of SubBytes
+      (which MixColumns leaves as 0x63) folded in */
+   VSTORE(EK(skey, 0), vp_xform(VLOAD(rk), vp.ipt));
+   for (i = 1; i < Nr; i++) {
+      VSTORE(EK(skey, i), VXOR(vp_xform(VLOAD(rk + 16 * i), vp.ipt), VSPLAT(vp.t63)));
+   }
+   VSTORE(EK(skey, Nr), VXOR(VLOAD(rk + 16 * Nr), VSPLAT(0x63)));
+
+   /* decryption keys in reverse order with InvMixColumns applied, in
+      the basis dipt gives, with the 0x05 from inverting the affine map */
+   VSTORE(DK(skey, 0), VXOR(vp_xform(VLOAD(rk + 16 * Nr), vp.dipt), VSPLAT(vp.t05)));
+   for (i = 1; i < Nr; i++) {
+      vp_invmixcolumns(rk + 16 * (Nr - i));
+      VSTORE(DK(skey, i), VXOR(vp_xform(VLOAD(rk + 16 * (Nr - i)), vp.dipt), VSPLAT(vp.t05)));
+   }
+   VSTORE(DK(skey, Nr), VLOAD(rk));
+
+   zeromem(rk, sizeof(rk));
+   zeromem(t, sizeof(t));
+   return CRYPT_OK;
+}
+
+/**
+  Encrypts a block of text with the vector permute code
+  @param pt The input plaintext (16 bytes)
+  @param ct The output ciphertext (16 bytes)
+  @param skey The key as scheduled by aes_vperm_setup()
+  @return CRYPT_OK if successful
+*/
+VP_TARGET
+int aes_vperm_ecb_encrypt(const unsigned char *pt, unsigned char *ct, symmetric_key *skey)
+{
+   LTC_ARGCHK(pt != NULL);
+   LTC_ARGCHK(ct != NULL);
+   LTC_ARGCHK(skey != NULL);
+
+   VSTORE(ct, vp_encrypt(VLOAD(pt), skey));
+   return CRYPT_OK;
+}
+
+/**
+  Decrypts a block of text with the vector permute code
+  @param ct The input ciphertext (16 bytes)
+  @param pt The output plaintext (16 bytes)
+  @param skey The key as scheduled by aes_vperm_setup()
+  @return CRYPT_OK if successful
+*/
+VP_TARGET
+int aes_vperm_ecb_decrypt(const unsigned char *ct, unsigned char *pt, symmetric_key *skey)
+{
+   LTC_ARGCHK(pt != NULL);
+   LTC_ARGCHK(ct != NULL);
+   LTC_ARGCHK(skey != NULL);
+
+   VSTORE(pt, vp_decrypt(VLOAD(ct), skey));
+   return CRYPT_OK;
+}
+
+/**
+  Encrypt several blocks in ECB mode, four at a time
+  @param pt      Plaintext
+  @param ct      [out] Ciphertext
+  @param blocks  The number of complete blocks to process
+  @param skey    The scheduled key context
+  @return CRYPT_OK if successful
+*/
+VP_TARGET
+int aes_vperm_accel_ecb_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, symmetric_key *skey)
+{
+   vec b[4];
+
+   for (; blocks >= 4; blocks -= 4) {
+      b[0] = VLOAD(pt);
+      b[1] = VLOAD(pt + 16);
+      b[2] = VLOAD(pt + 32);
+      b[3] = VLOAD(pt + 48);
+      vp_encrypt4(b, skey);
+      VSTORE(ct, b[0]);
+      VSTORE(ct + 16, b[1]);
+      VSTORE(ct + 32, b[2]);
+      VSTORE(ct + 48, b[3]);
+      pt += 64;
+      ct += 64;
+   }
+   while (blocks--) {
+      VSTORE(ct, vp_encrypt(VLOAD(pt), skey));
+      pt += 16;
+      ct += 16;
+   }
+   return CRYPT_OK;
+}
+
+/**
+  CBC encryption, see cbc_encrypt()
+  @param pt      Plaintext
+  @param ct      [out] Ciphertext
+  @param blocks  The number of complete blocks to process
+  @param IV      The initial value (input/output)
+  @param skey    The scheduled key context
+  @return CRYPT_OK if successful
+*/
+VP_TARGET
+int aes_vperm_cbc_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, unsigned char *IV, symmetric_key *skey)
+{
+   vec iv = VLOAD(IV);
+
+   while (blocks--) {
+      iv = vp_encrypt(VXOR(iv, VLOAD(pt)), skey);
+      VSTORE(ct, iv);
+      pt += 16;
+      ct += 16;
+   }
+   VSTORE(IV, iv);
+   return CRYPT_OK;
+}
+
+/**
+  CBC decryption, see cbc_decrypt().  Four blocks are decrypted at a
+  time, and the ciphertext is loaded before any of them is stored so that
+  ct and pt may be the same buffer.
+  @param ct      Ciphertext
+  @param pt      [out] Plaintext
+  @param blocks  The number of complete blocks to process
+  @param IV      The initial value (input/output)
+  @param skey    The scheduled key context
+  @return CRYPT_OK if successful
+*/
+VP_TARGET
+int aes_vperm_cbc_decrypt(const unsigned char *ct, unsigned char *pt, unsigned long blocks, unsigned char *IV, symmetric_key *skey)
+{
+   vec iv = VLOAD(IV), c[4], b[4];
+
+   for (; blocks >= 4; blocks -= 4) {
+      b[0] = c[0] = VLOAD(ct);
+      b[1] = c[1] = VLOAD(ct + 16);
+      b[2] = c[2] = VLOAD(ct + 32);
+      b[3] = c[3] = VLOAD(ct + 48);
+      vp_decrypt4(b, skey);
+      VSTORE(pt, VXOR(b[0], iv));
+      VSTORE(pt + 16, VXOR(b[1], c[0]));
+      VSTORE(pt + 32, VXOR(b[2], c[1]));
+      VSTORE(pt + 48, VXOR(b[3], c[2]));
+      iv = c[3];
+      pt += 64;
+      ct += 64;
+   }
+   while (blocks--) {
+      c[0] = VLOAD(ct);
+      VSTORE(pt, VXOR(vp_decrypt(c[0], skey), iv));
+      iv = c[0];
+      pt += 16;
+      ct += 16;
+   }
+   VSTORE(IV, iv);
+   return CRYPT_OK;
+}
+
+/* write the next counter block, the counter is held as two native halves */
+static void vp_next_counter(unsigned char *out, ulong64 *hi, ulong64 *lo, int mode)
+{
+   if (++*lo == 0) {
+      ++*hi;
+   }
+   if (mode == CTR_COUNTER_BIG_ENDIAN) {
+      STORE64H(*hi, out);
+      STORE64H(*lo, out + 8);
+   } else {
+      STORE64L(*lo, out);
+      STORE64L(*hi, out + 8);
+   }
+}
+
+/**
+  CTR encryption, see ctr_encrypt().  As in ctr_encrypt() the counter is
+  incremented before each block is encrypted, and is left holding the
+  last counter value used.
+  @param pt      Plaintext
+  @param ct      [out] Ciphertext
+  @param blocks  The number of complete blocks to process
+  @param IV      The counter (input/output)
+  @param mode    CTR_COUNTER_LITTLE_ENDIAN or CTR_COUNTER_BIG_ENDIAN
+  @param skey    The scheduled key context
+  @return CRYPT_OK if successful
+*/
+VP_TARGET
+int aes_vperm_ctr_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, unsigned char *IV, int mode, symmetric_key *skey)
+{
+   unsigned char ctr[4 * 16];
+   ulong64 hi, lo;
+   vec b[4];
+   int i;
+
+   if (mode == CTR_COUNTER_BIG_ENDIAN) {
+      LOAD64H(hi, IV);
+      LOAD64H(lo, IV + 8);
+   } else {
+      LOAD64L(lo, IV);
+      LOAD64L(hi, IV + 8);
+   }
+
+   for (; blocks >= 4; blocks -= 4) {
+      for (i = 0; i < 4; i++) {
+         vp_next_counter(ctr + 16 * i, &hi, &lo, mode);
+         b[i] = VLOAD(ctr + 16 * i);
+      }
+      vp_encrypt4(b, skey);
+      VSTORE(ct, VXOR(b[0], VLOAD(pt)));
+      VSTORE(ct + 16, VXOR(b[1], VLOAD(pt + 16)));
+      VSTORE(ct + 32, VXOR(b[2], VLOAD(pt + 32)));
+      VSTORE(ct + 48, VXOR(b[3], VLOAD(pt + 48)));
+      pt += 64;
+      ct += 64;
+   }
+   while (blocks--) {
+      vp_next_counter(ctr, &hi, &lo, mode);
+      VSTORE(ct, VXOR(vp_encrypt(VLOAD(ctr), skey), VLOAD(pt)));
+      pt += 16;
+      ct += 16;
+   }
+
+   if (mode == CTR_COUNTER_BIG_ENDIAN) {
+      STORE64H(hi, IV);
+      STORE64H(lo, IV + 8);
+   } else {
+      STORE64L(lo, IV);
+      STORE64L(hi, IV + 8);
+   }
+   return CRYPT_OK;
+}
+
+#endif /* LTC_AES_VPERM */
@@ -0,0 +1,145 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis
+ *
+ * LibTomCrypt is a library that provides various cryptographic
+ * algorithms in a highly modular and flexible manner.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtomcrypt.com
+ */
+
+/**
+   @file gcm_mult_h.c
+   GCM implementation, do the GF mult, by Tom St Denis
+
+   Portable multiplication by H using Shoup's 4-bit tables: 16 multiples
+   of H built once per key in gcm_init_table(), and a 16 entry table for
+   the reduction of the bits shifted out.
+*/
+#include "tomcrypt.h"
+
+#ifdef GCM_MODE
+
+/* reduction of the low nibble shifted out of the product */
+static const ulong64 gcm_last4[16] = {
+   CONST64(0x0000), CONST64(0x1c20), CONST64(0x3840), CONST64(0x2460),
+   CONST64(0x7080), CONST64(0x6ca0), CONST64(0x48c0), CONST64(0x54e0),
+   CONST64(0xe100), CONST64(0xfd20), CONST64(0xd940), CONST64(0xc560),
+   CONST64(0x9180), CONST64(0x8da0), CONST64(0xa9c0), CONST64(0xb5e0)
+};
+
+/**
+  Build the 4-bit multiplication table for H, called by gcm_init()
+  @param gcm   The GCM state which holds the H value
+*/
+void gcm_init_table(gcm_state *gcm)
+{
+   ulong64 vh, vl, T;
+   int     i, j;
+
+   LOAD64H(vh, gcm->H);
+   LOAD64H(vl, gcm->H + 8);
+
+   /* index 8 (1000b) is 1 in the bit reflected field */
+   gcm->HH[0] = 0;
+   gcm->HL[0] = 0;
+   gcm->HH[8] = vh;
+   gcm->HL[8] = vl;
+
+   /* 4, 2, 1 are H times successive powers of x */
+   for (i = 4; i > 0; i >>= 1) {
+      T  = (CONST64(0) - (vl & 1)) & CONST64(0xe100000000000000);
+      vl = (vh << 63) | (vl >> 1);
+      vh = (vh >> 1) ^ T;
+      gcm->HH[i] = vh;
+      gcm->HL[i] = vl;
+   }
+
+   /* the rest are sums of those */
+   for (i = 2; i <= 8; i *= 2) {
+      for (j = 1; j < i; j++) {
+         gcm->HH[i + j] = gcm->HH[i] ^ gcm->HH[j];
+         gcm->HL[i + j] = gcm->HL[i] ^ gcm->HL[j];
+      }
+   }
+}
+
+/**
+  GCM multiply by H
+  @param gcm   The GCM state which holds the H value
+  @param I     The value to multiply H by
+ */
+void gcm_mult_h(gcm_state *gcm, unsigned char *I)
+{
+   ulong64 zh, zl;
+   int     i, rem;
+   unsigned char lo, hi;
+
+#ifdef LTC_GCM_PCLMUL
+   if (gcm->pclmul) {
+      gcm_pclmul_mult_h(gcm, I);
+      return;
+   }
+#endif
+
+   lo = I[15] & 0xf;
+   zh = gcm->HH[lo];
+   zl = gcm->HL[lo];
+
+   for (i = 15; i >= 0; i--) {
+      lo = I[i] & 0xf;
+      hi = (I[i] >> 4) & 0xf;
+
+      if (i != 15) {
+         rem = (int)(zl & 0xf);
+         zl  = (zh << 60) | (zl >> 4);
+         zh  = (zh >> 4) ^ (gcm_last4[rem] << 48);
+         zh ^= gcm->HH[lo];
+         zl ^= gcm->HL[lo];
+      }
+
+      rem = (int)(zl & 0xf);
+      zl  = (zh << 60) | (zl >> 4);
+      zh  = (zh >> 4) ^ (gcm_last4[rem] << 48);
+      zh ^= gcm->HH[hi];
+      zl ^= gcm->HL[hi];
+   }
+
+   STORE64H(zh, I);
+   STORE64H(zl, I + 8);
+}
+
+/**
+  GHASH whole blocks into the accumulator, X = (X ^ block) * H for each
+  @param gcm     The GCM state
+  @param in      The data to hash
+  @param blocks  The number of 16 byte blocks
+*/
+void gcm_ghash(gcm_state *gcm, const unsigned char *in, unsigned long blocks)
+{
+   int x;
+
+#ifdef LTC_GCM_PCLMUL
+   if (gcm->pclmul) {
+      gcm_pclmul_ghash(gcm, in, blocks);
+      return;
+   }
+#endif
+
+   while (blocks--) {
+#ifdef LTC_FAST
+      for (x = 0; x < 16; x += sizeof(LTC_FAST_TYPE)) {
+         *((LTC_FAST_TYPE*)(&gcm->X[x])) ^= *((LTC_FAST_TYPE*)(in + x));
+      }
+#else
+      for (x = 0; x < 16; x++) {
+         gcm->X[x] ^= in[x];
+      }
+#endif
+      gcm_mult_h(gcm, gcm->X);
+      in += 16;
+   }
+}
+
+#endif
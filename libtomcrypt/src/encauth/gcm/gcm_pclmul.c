@@ -0,0 +1,178 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis
+ *
+ * LibTomCrypt is a library that provides various cryptographic
+ * algorithms in a highly modular and flexible manner.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtomcrypt.com
+ */
+
+/**
+   @file gcm_pclmul.c
+   GHASH using the x86 PCLMULQDQ carry-less multiply.
+
+   Blocks are byte reflected into the order the instruction expects, and
+   GCM_PCLMUL_BLOCKS blocks are multiplied by H^n..H^1 and summed before
+   a single reduction.  Only call these once gcm_pclmul_is_supported()
+   has returned non-zero.
+*/
+#include "tomcrypt.h"
+
+#ifdef LTC_GCM_PCLMUL
+
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#include <wmmintrin.h>
+
+#define PCLMUL_TARGET __attribute__((target("sse2,ssse3,pclmul")))
+
+/**
+  Check whether this CPU can run the PCLMULQDQ code
+  @return non-zero if the kernel may be used
+*/
+int gcm_pclmul_is_supported(void)
+{
+   const unsigned long need = LTC_CPU_PCLMUL | LTC_CPU_SSSE3;
+
+   return (crypt_cpu_features() & need) == need;
+}
+
+PCLMUL_TARGET
+static __m128i bswap128(__m128i x)
+{
+   return _mm_shuffle_epi8(x, _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+}
+
+/* 256-bit carry-less product a*b, added into lo:hi */
+PCLMUL_TARGET
+static void clmul_acc(__m128i a, __m128i b, __m128i *lo, __m128i *hi)
+{
+   __m128i t0, t1, t2, t3;
+
+   t0 = _mm_clmulepi64_si128(a, b, 0x00);
+   t1 = _mm_clmulepi64_si128(a, b, 0x10);
+   t2 = _mm_clmulepi64_si128(a, b, 0x01);
+   t3 = _mm_clmulepi64_si128(a, b, 0x11);
+   t1 = _mm_xor_si128(t1, t2);
+   *lo = _mm_xor_si128(*lo, _mm_xor_si128(t0, _mm_slli_si128(t1, 8)));
+   *hi = _mm_xor_si128(*hi, _mm_xor_si128(t3, _mm_srli_si128(t1, 8)));
+}
+
+/* shift the bit reflected product lo:hi left by one and reduce it
+ * modulo x^128 + x^7 + x^2 + x + 1 */
+PCLMUL_TARGET
+static __m128i reduce(__m128i lo, __m128i hi)
+{
+   __m128i t2, t4, t5, t7, t8, t9;
+
+   t7 = _mm_srli_epi32(lo, 31);
+   t8 = _mm_srli_epi32(hi, 31);
+   lo = _mm_slli_epi32(lo, 1);
+   hi = _mm_slli_epi32(hi, 1);
+   t9 = _mm_srli_si128(t7, 12);
+   t8 = _mm_slli_si128(t8, 4);
+   t7 = _mm_slli_si128(t7, 4);
+   lo = _mm_or_si128(lo, t7);
+   hi = _mm_or_si128(hi, t8);
+   hi = _mm_or_si128(hi, t9);
+
+   t7 = _mm_slli_epi32(lo, 31);
+   t8 = _mm_slli_epi32(lo, 30);
+   t9 = _mm_slli_epi32(lo, 25);
+   t7 = _mm_xor_si128(t7, t8);
+   t7 = _mm_xor_si128(t7, t9);
+   t8 = _mm_srli_si128(t7, 4);
+   t7 = _mm_slli_si128(t7, 12);
+   lo = _mm_xor_si128(lo, t7);
+
+   t2 = _mm_srli_epi32(lo, 1);
+   t4 = _mm_srli_epi32(lo, 2);
+   t5 = _mm_srli_epi32(lo, 7);
+   t2 = _mm_xor_si128(t2, t4);
+   t2 = _mm_xor_si128(t2, t5);
+   t2 = _mm_xor_si128(t2, t8);
+   lo = _mm_xor_si128(lo, t2);
+   return _mm_xor_si128(hi, lo);
+}
+
+PCLMUL_TARGET
+static __m128i gfmul(__m128i a, __m128i b)
+{
+   __m128i lo = _mm_setzero_si128(), hi = _mm_setzero_si128();
+
+   clmul_acc(a, b, &lo, &hi);
+   return reduce(lo, hi);
+}
+
+#define HPOW(gcm, n) _mm_loadu_si128((const __m128i *)(gcm)->HP[(n) - 1])
+
+/**
+  Compute the powers of H used by the aggregated kernel, called by gcm_init()
+  @param gcm   The GCM state which holds the H value
+*/
+PCLMUL_TARGET
+void gcm_pclmul_init(gcm_state *gcm)
+{
+   __m128i h, p;
+   int     i;
+
+   h = bswap128(_mm_loadu_si128((const __m128i *)gcm->H));
+   p = h;
+   _mm_storeu_si128((__m128i *)gcm->HP[0], p);
+   for (i = 1; i < GCM_PCLMUL_BLOCKS; i++) {
+      p = gfmul(p, h);
+      _mm_storeu_si128((__m128i *)gcm->HP[i], p);
+   }
+}
+
+/**
+  GCM multiply by H, see gcm_mult_h()
+  @param gcm   The GCM state which holds the H value
+  @param I     The value to multiply H by
+*/
+PCLMUL_TARGET
+void gcm_pclmul_mult_h(gcm_state *gcm, unsigned char *I)
+{
+   __m128i x = bswap128(_mm_loadu_si128((const __m128i *)I));
+
+   _mm_storeu_si128((__m128i *)I, bswap128(gfmul(x, HPOW(gcm, 1))));
+}
+
+/**
+  GHASH whole blocks into the accumulator, see gcm_ghash()
+  @param gcm     The GCM state
+  @param in      The data to hash
+  @param blocks  The number of 16 byte blocks
+*/
+PCLMUL_TARGET
+void gcm_pclmul_ghash(gcm_state *gcm, const unsigned char *in, unsigned long blocks)
+{
+   __m128i x, lo, hi;
+
+   x = bswap128(_mm_loadu_si128((const __m128i *)gcm->X));
+
+   /* (X ^ B1)*H^4 ^ B2*H^3 ^ B3*H^2 ^ B4*H, reduced once */
+   for (; blocks >= GCM_PCLMUL_BLOCKS; blocks -= GCM_PCLMUL_BLOCKS) {
+      lo = _mm_setzero_si128();
+      hi = _mm_setzero_si128();
+      x = _mm_xor_si128(x, bswap128(_mm_loadu_si128((const __m128i *)in)));
+      clmul_acc(x, HPOW(gcm, 4), &lo, &hi);
+      clmul_acc(bswap128(_mm_loadu_si128((const __m128i *)in + 1)), HPOW(gcm, 3), &lo, &hi);
+      clmul_acc(bswap128(_mm_loadu_si128((const __m128i *)in + 2)), HPOW(gcm, 2), &lo, &hi);
+      clmul_acc(bswap128(_mm_loadu_si128((const __m128i *)in + 3)), HPOW(gcm, 1), &lo, &hi);
+      x = reduce(lo, hi);
+      in += 16 * GCM_PCLMUL_BLOCKS;
+   }
+
+   while (blocks--) {
+      x = _mm_xor_si128(x, bswap128(_mm_loadu_si128((const __m128i *)in)));
+      x = gfmul(x, HPOW(gcm, 1));
+      in += 16;
+   }
+
+   _mm_storeu_si128((__m128i *)gcm->X, bswap128(x));
+}
+
+#endif
@@ -0,0 +1,173 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis
+ *
+ * LibTomCrypt is a library that provides various cryptographic
+ * algorithms in a highly modular and flexible manner.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtomcrypt.com
+ */
+
+/**
+   @file gcm_process.c
+   GCM implementation, process message data, by Tom St Denis
+*/
+#include "tomcrypt.h"
+
+#ifdef GCM_MODE
+
+/* Whole blocks are encrypted and hashed this many at a time, so the
+ * ciphertext is still in L1 cache when GHASH reads it */
+#define GCM_CHUNK_BLOCKS 16
+
+/* increment the 32-bit counter at the end of Y */
+static void gcm_inc32(unsigned char *Y)
+{
+   int y;
+
+   for (y = 15; y >= 12; y--) {
+      if (++Y[y] & 255) {
+         break;
+      }
+   }
+}
+
+/* CTR encrypt whole blocks from the current counter, leaving gcm->Y
+ * holding the last counter used */
+static int gcm_ctr_blocks(gcm_state *gcm, const unsigned char *in, unsigned char *out, unsigned long blocks)
+{
+   ulong32 ctr;
+   int     x, err;
+
+   /* the accelerator increments the full 128-bit counter, which is the
+    * same as inc32 as long as the low word doesn't wrap */
+   LOAD32H(ctr, gcm->Y + 12);
+   if (cipher_descriptor[gcm->cipher].accel_ctr_encrypt != NULL &&
+       blocks <= (unsigned long)(0xFFFFFFFFUL - ctr)) {
+      return cipher_descriptor[gcm->cipher].accel_ctr_encrypt(in, out, blocks, gcm->Y, CTR_COUNTER_BIG_ENDIAN, &gcm->K);
+   }
+
+   while (blocks--) {
+      gcm_inc32(gcm->Y);
+      if ((err = cipher_descriptor[gcm->cipher].ecb_encrypt(gcm->Y, gcm->buf, &gcm->K)) != CRYPT_OK) {
+         return err;
+      }
+#ifdef LTC_FAST
+      for (x = 0; x < 16; x += sizeof(LTC_FAST_TYPE)) {
+         *((LTC_FAST_TYPE*)(out + x)) = *((LTC_FAST_TYPE*)(in + x)) ^ *((LTC_FAST_TYPE*)(&gcm->buf[x]));
+      }
+#else
+      for (x = 0; x < 16; x++) {
+         out[x] = in[x] ^ gcm->buf[x];
+      }
+#endif
+      in  += 16;
+      out += 16;
+   }
+   return CRYPT_OK;
+}
+
+/** 
+  Process plaintext/ciphertext through GCM
+  Whole blocks take a one-pass path that encrypts a chunk and hashes the
+  ciphertext while it is still in cache; pt and ct may be the same buffer.
+  @param gcm       The GCM state 
+  @param pt        The plaintext
+  @param ptlen     The plaintext length (ciphertext length is the same)
+  @param ct        The ciphertext
+  @param direction Encrypt or Decrypt mode (GCM_ENCRYPT or GCM_DECRYPT)
+  @return CRYPT_OK on success
+ */
+int gcm_process(gcm_state *gcm,
+                     unsigned char *pt,     unsigned long ptlen,
+                     unsigned char *ct,
+                     int direction)
+{
+   unsigned long x, n;
+   unsigned char b;
+   int           err;
+
+   LTC_ARGCHK(gcm != NULL);
+   if (ptlen > 0) {
+      LTC_ARGCHK(pt  != NULL);
+      LTC_ARGCHK(ct  != NULL);
+   }
+
+   if (gcm->buflen > 16 || gcm->buflen < 0) {
+      return CRYPT_INVALID_ARG;
+   }
+ 
+   if ((err = cipher_is_valid(gcm->cipher)) != CRYPT_OK) {
+      return err;
+   }
+
+   /* in IV mode? */
+   if (gcm->mode == GCM_MODE_IV) {
+      if ((err = gcm_add_aad(gcm, NULL, 0)) != CRYPT_OK) {
+         return err;
+      }
+   }
+
+   /* in AAD mode? */
+   if (gcm->mode == GCM_MODE_AAD) {
+      /* let's process the AAD */
+      if (gcm->buflen) {
+         gcm->totlen += gcm->buflen * CONST64(8);
+         gcm_mult_h(gcm, gcm->X);
+      }
+      gcm->buflen = 0;
+      gcm->mode   = GCM_MODE_TEXT;
+   }
+
+   if (gcm->mode != GCM_MODE_TEXT) {
+      return CRYPT_INVALID_ARG;
+   }
+
+   x = 0;
+   while (x < ptlen) {
+      if (gcm->buflen == 0 && ptlen - x >= 16) {
+         n = MIN((ptlen - x) / 16, GCM_CHUNK_BLOCKS);
+         if (direction == GCM_ENCRYPT) {
+            if ((err = gcm_ctr_blocks(gcm, pt + x, ct + x, n)) != CRYPT_OK) {
+               return err;
+            }
+            gcm_ghash(gcm, ct + x, n);
+         } else {
+            /* hash before decrypting, ct may be overwritten */
+            gcm_ghash(gcm, ct + x, n);
+            if ((err = gcm_ctr_blocks(gcm, ct + x, pt + x, n)) != CRYPT_OK) {
+               return err;
+            }
+         }
+         gcm->pttotlen += n * CONST64(128);
+         x += n * 16;
+         continue;
+      }
+
+      /* partial block, one byte at a time */
+      if (gcm->buflen == 0) {
+         gcm_inc32(gcm->Y);
+         if ((err = cipher_descriptor[gcm->cipher].ecb_encrypt(gcm->Y, gcm->buf, &gcm->K)) != CRYPT_OK) {
+            return err;
+         }
+      }
+      if (direction == GCM_ENCRYPT) {
+         b = ct[x] = pt[x] ^ gcm->buf[gcm->buflen];
+      } else {
+         b     = ct[x];
+         pt[x] = ct[x] ^ gcm->buf[gcm->buflen];
+      }
+      gcm->X[gcm->buflen++] ^= b;
+      if (gcm->buflen == 16) {
+         gcm->pttotlen += 128;
+         gcm_mult_h(gcm, gcm->X);
+         gcm->buflen = 0;
+      }
+      x++;
+   }
+
+   return CRYPT_OK;
+}
+
+#endif
@@ -13,6 +13,11 @@
 /**
   @file sha1.c
   SHA1 code by Tom St Denis 
+
+  Runs of whole blocks are compressed together by a kernel chosen once
+  with sha1_accel_init(): the SHA-NI or ARMv8 instructions, or scalar
+  rounds fed by an SSSE3 or AVX2 message schedule.  Until then, or on
+  other CPUs, the portable code below is used.
 */
 
 
@@ -42,9 +47,9 @@ const struct ltc_hash_descriptor sha1_desc =
 #define F3(x,y,z)  (x ^ y ^ z)
 
 #ifdef LTC_CLEAN_STACK
-static int _sha1_compress(hash_state *md, unsigned char *buf)
+static void _sha1_compress(ulong32 *state, const unsigned char *buf)
 #else
-static int  sha1_compress(hash_state *md, unsigned char *buf)
+static void  sha1_compress(ulong32 *state, const unsigned char *buf)
 #endif
 {
     ulong32 a,b,c,d,e,W[80],i;
@@ -58,11 +63,11 @@ static int  sha1_compress(hash_state *md, unsigned char *buf)
     }
 
     /* copy state */
-    a = md->sha1.state[0];
-    b = md->sha1.state[1];
-    c = md->sha1.state[2];
-    d = md->sha1.state[3];
-    e = md->sha1.state[4];
+    a = state[0];
+    b = state[1];
+    c = state[2];
+    d = state[3];
+    e = state[4];
 
     /* expand it */
     for (i = 16; i < 80; i++) {
@@ -138,25 +143,65 @@ static int  sha1_compress(hash_state *md, unsigned char *buf)
     #undef FF3
 
     /* store */
-    md->sha1.state[0] = md->sha1.state[0] + a;
-    md->sha1.state[1] = md->sha1.state[1] + b;
-    md->sha1.state[2] = md->sha1.state[2] + c;
-    md->sha1.state[3] = md->sha1.state[3] + d;
-    md->sha1.state[4] = md->sha1.state[4] + e;
-
-    return CRYPT_OK;
+    state[0] = state[0] + a;
+    state[1] = state[1] + b;
+    state[2] = state[2] + c;
+    state[3] = state[3] + d;
+    state[4] = state[4] + e;
 }
 
 #ifdef LTC_CLEAN_STACK
-static int sha1_compress(hash_state *md, unsigned char *buf)
+static void sha1_compress(ulong32 *state, const unsigned char *buf)
 {
-   int err;
-   err = _sha1_compress(md, buf);
+   _sha1_compress(state, buf);
    burn_stack(sizeof(ulong32) * 87);
-   return err;
 }
 #endif
 
+static void sha1_portable_compress(ulong32 *state, const unsigned char *in, unsigned long blocks)
+{
+    while (blocks-- > 0) {
+        sha1_compress(state, in);
+        in += 64;
+    }
+}
+
+/* compresses runs of whole blocks, see sha1_accel_init() */
+static void (*sha1_blocks)(ulong32 *state, const unsigned char *in, unsigned long blocks) = sha1_portable_compress;
+
+/**
+   Choose the fastest SHA-1 compression this CPU has, for all hashing
+   that follows.  Call it once at startup, before hashing anything.
+   @return The name of the kernel chosen
+*/
+const char *sha1_accel_init(void)
+{
+#ifdef LTC_SHA1_SHANI
+    if (sha1_shani_is_supported()) {
+        sha1_blocks = sha1_shani_compress;
+        return "sha-ni";
+    }
+#endif
+#ifdef LTC_SHA1_ARMV8
+    if (sha1_armv8_is_supported()) {
+        sha1_blocks = sha1_armv8_compress;
+        return "armv8";
+    }
+#endif
+#ifdef LTC_SHA1_SIMD
+    if (sha1_avx2_is_supported()) {
+        sha1_blocks = sha1_avx2_compress;
+        return "avx2";
+    }
+    if (sha1_ssse3_is_supported()) {
+        sha1_blocks = sha1_ssse3_compress;
+        return "ssse3";
+    }
+#endif
+    sha1_blocks = sha1_portable_compress;
+    return "c";
+}
+
 /**
    Initialize the hash state
    @param md   The hash state you wish to initialize
@@ -182,7 +227,39 @@ int sha1_init(hash_state * md)
    @param inlen  The length of the data (octets)
    @return CRYPT_OK if successful
 */
-HASH_PROCESS(sha1_process, sha1_compress, sha1, 64)
+int sha1_process(hash_state * md, const unsigned char *in, unsigned long inlen)
+{
+    unsigned long n;
+
+    LTC_ARGCHK(md != NULL);
+    LTC_ARGCHK(in != NULL);
+
+    if (md->sha1.curlen > sizeof(md->sha1.buf)) {
+       return CRYPT_INVALID_ARG;
+    }
+    while (inlen > 0) {
+        if (md->sha1.curlen == 0 && inlen >= 64) {
+           /* all the whole blocks at once, straight from the input */
+           n = inlen / 64;
+           sha1_blocks(md->sha1.state, in, n);
+           md->sha1.length += (ulong64)n * 512;
+           in    += n * 64;
+           inlen -= n * 64;
+        } else {
+           n = MIN(inlen, (64 - md->sha1.curlen));
+           XMEMCPY(md->sha1.buf + md->sha1.curlen, in, (size_t)n);
+           md->sha1.curlen += n;
+           in    += n;
+           inlen -= n;
+           if (md->sha1.curlen == 64) {
+              sha1_blocks(md->sha1.state, md->sha1.buf, 1);
+              md->sha1.length += 512;
+              md->sha1.curlen = 0;
+           }
+        }
+    }
+    return CRYPT_OK;
+}
 
 /**
    Terminate the hash to get the digest
@@ -215,7 +292,7 @@ int sha1_done(hash_state * md, unsigned char *out)
         while (md->sha1.curlen < 64) {
             md->sha1.buf[md->sha1.curlen++] = (unsigned char)0;
         }
-        sha1_compress(md, md->sha1.buf);
+        sha1_blocks(md->sha1.state, md->sha1.buf, 1);
         md->sha1.curlen = 0;
     }
 
@@ -226,7 +303,7 @@ int sha1_done(hash_state * md, unsigned char *out)
 
     /* store length */
     STORE64H(md->sha1.length, md->sha1.buf+56);
-    sha1_compress(md, md->sha1.buf);
+    sha1_blocks(md->sha1.state, md->sha1.buf, 1);
 
     /* copy output */
     for (i = 0; i < 5; i++) {
@@ -0,0 +1,117 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis
+ *
+ * LibTomCrypt is a library that provides various cryptographic
+ * algorithms in a highly modular and flexible manner.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtomcrypt.com
+ */
+
+/**
+   @file sha1_armv8.c
+   SHA-1 compression with the ARMv8 cryptography extensions.
+
+   sha1c/sha1p/sha1m run four rounds on ABCD with E passed separately,
+   sha1h gives the E for the four rounds after from the old A, and
+   sha1su0/sha1su1 extend the message schedule four words at a time.
+   Only call sha1_armv8_compress() once sha1_armv8_is_supported() has
+   returned non-zero.
+*/
+#include "tomcrypt.h"
+
+#ifdef LTC_SHA1_ARMV8
+
+#include <arm_neon.h>
+
+#define ARMV8_TARGET __attribute__((target("+crypto")))
+
+static const uint32_t K[4] = { 0x5a827999UL, 0x6ed9eba1UL, 0x8f1bbcdcUL, 0xca62c1d6UL };
+
+/**
+  Check whether this CPU has the SHA-1 instructions
+  @return non-zero if the kernel may be used
+*/
+int sha1_armv8_is_supported(void)
+{
+   return (crypt_cpu_features() & LTC_CPU_ARMSHA1) != 0;
+}
+
+/* rounds 4i..4i+3 using message words mi, extending the schedule in mi
+   for the rounds 16 further on */
+#define ROUNDS4(i, op, mi, m1, m2, m3) do { \
+   wk = vaddq_u32(mi, vdupq_n_u32(K[(i) / 5])); \
+   enext = vsha1h_u32(vgetq_lane_u32(abcd, 0)); \
+   abcd = op(abcd, e, wk); \
+   e = enext; \
+   if ((i) < 16) { \
+      mi = vsha1su1q_u32(vsha1su0q_u32(mi, m1, m2), m3); \
+   } \
+} while (0)
+
+#define LOAD_BE(p) vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(p)))
+
+/**
+  Compress whole blocks into a SHA-1 state
+  @param state   The five state words
+  @param in      The blocks
+  @param blocks  The number of 64 byte blocks
+*/
+ARMV8_TARGET
+void sha1_armv8_compress(ulong32 *state, const unsigned char *in, unsigned long blocks)
+{
+   uint32x4_t abcd, wk, m0, m1, m2, m3, save_abcd;
+   uint32_t st[4], e, enext, save_e;
+   int i;
+
+   /* ulong32 may be wider than 32 bits here */
+   for (i = 0; i < 4; i++) {
+      st[i] = (uint32_t)state[i];
+   }
+   abcd = vld1q_u32(st);
+   e    = (uint32_t)state[4];
+
+   while (blocks-- > 0) {
+      save_abcd = abcd;
+      save_e    = e;
+
+      m0 = LOAD_BE(in +  0);
+      m1 = LOAD_BE(in + 16);
+      m2 = LOAD_BE(in + 32);
+      m3 = LOAD_BE(in + 48);
+
+      ROUNDS4( 0, vsha1cq_u32, m0, m1, m2, m3);
+      ROUNDS4( 1, vsha1cq_u32, m1, m2, m3, m0);
+      ROUNDS4( 2, vsha1cq_u32, m2, m3, m0, m1);
+      ROUNDS4( 3, vsha1cq_u32, m3, m0, m1, m2);
+      ROUNDS4( 4, vsha1cq_u32, m0, m1, m2, m3);
+      ROUNDS4( 5, vsha1pq_u32, m1, m2, m3, m0);
+      ROUNDS4( 6, vsha1pq_u32, m2, m3, m0, m1);
+      ROUNDS4( 7, vsha1pq_u32, m3, m0, m1, m2);
+      ROUNDS4( 8, vsha1pq_u32, m0, m1, m2, m3);
+      ROUNDS4( 9, vsha1pq_u32, m1, m2, m3, m0);
+      ROUNDS4(10, vsha1mq_u32, m2, m3, m0, m1);
+      ROUNDS4(11, vsha1mq_u32, m3, m0, m1, m2);
+      ROUNDS4(12, vsha1mq_u32, m0, m1, m2, m3);
+      ROUNDS4(13, vsha1mq_u32, m1, m2, m3, m0);
+      ROUNDS4(14, vsha1mq_u32, m2, m3, m0, m1);
+      ROUNDS4(15, vsha1pq_u32, m3, m0, m1, m2);
+      ROUNDS4(16, vsha1pq_u32, m0, m1, m2, m3);
+      ROUNDS4(17, vsha1pq_u32, m1, m2, m3, m0);
+      ROUNDS4(18, vsha1pq_u32, m2, m3, m0, m1);
+      ROUNDS4(19, vsha1pq_u32, m3, m0, m1, m2);
+
+      abcd = vaddq_u32(abcd, save_abcd);
+      e += save_e;
+      in += 64;
+   }
+
+   vst1q_u32(st, abcd);
+   for (i = 0; i < 4; i++) {
+      state[i] = st[i];
+   }
+   state[4] = e;
+}
+
+#endif
@@ -0,0 +1,120 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis
+ *
+ * LibTomCrypt is a library that provides various cryptographic
+ * algorithms in a highly modular and flexible manner.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtomcrypt.com
+ */
+
+/**
+   @file sha1_shani.c
+   SHA-1 compression with the x86 SHA extensions (SHA-NI).
+
+   sha1rnds4 runs four rounds on ABCD, taking E plus the message words in
+   a second register; sha1nexte works out that E from the old A.
+   sha1msg1, an XOR and sha1msg2 extend the message schedule four words
+   at a time.  Only call sha1_shani_compress() once
+   sha1_shani_is_supported() has returned non-zero.
+*/
+#include "tomcrypt.h"
+
+#ifdef LTC_SHA1_SHANI
+
+#include <immintrin.h>
+
+#define SHANI_TARGET __attribute__((target("sse2,ssse3,sse4.1,sha")))
+
+#ifndef bit_SHA
+#define bit_SHA (1 << 29)
+#endif
+
+/**
+  Check whether this CPU can run the SHA-NI code
+  @return non-zero if the kernel may be used
+*/
+int sha1_shani_is_supported(void)
+{
+   const unsigned long need = LTC_CPU_SHA | LTC_CPU_SSSE3 | LTC_CPU_SSE41;
+
+   return (crypt_cpu_features() & need) == need;
+}
+
+/* rounds 4i..4i+3 with e and the message words mi, while the schedule
+   for the next three groups is advanced in m1, m2 and m3 */
+#define ROUNDS4(i, e, enext, mi, m1, m2, m3) do { \
+   if ((i) == 0) { \
+      e = _mm_add_epi32(e, mi); \
+   } else { \
+      e = _mm_sha1nexte_epu32(e, mi); \
+   } \
+   enext = abcd; \
+   if ((i) >= 3 && (i) <= 18) { \
+      m1 = _mm_sha1msg2_epu32(m1, mi); \
+   } \
+   abcd = _mm_sha1rnds4_epu32(abcd, e, (i) / 5); \
+   if ((i) >= 1 && (i) <= 16) { \
+      m3 = _mm_sha1msg1_epu32(m3, mi); \
+   } \
+   if ((i) >= 2 && (i) <= 17) { \
+      m2 = _mm_xor_si128(m2, mi); \
+   } \
+} while (0)
+
+/**
+  Compress whole blocks into a SHA-1 state
+  @param state   The five state words
+  @param in      The blocks
+  @param blocks  The number of 64 byte blocks
+*/
+SHANI_TARGET
+void sha1_shani_compress(ulong32 *state, const unsigned char *in, unsigned long blocks)
+{
+   const __m128i bswap = _mm_set_epi64x(CONST64(0x0001020304050607), CONST64(0x08090a0b0c0d0e0f));
+   __m128i abcd, e0, e1, m0, m1, m2, m3, save_abcd, save_e;
+
+   abcd = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)state), 0x1B);
+   e0   = _mm_set_epi32((int)state[4], 0, 0, 0);
+
+   while (blocks-- > 0) {
+      save_abcd = abcd;
+      save_e    = e0;
+
+      m0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(in +  0)), bswap);
+      m1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(in + 16)), bswap);
+      m2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(in + 32)), bswap);
+      m3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(in + 48)), bswap);
+
+      ROUNDS4( 0, e0, e1, m0, m1, m2, m3);
+      ROUNDS4( 1, e1, e0, m1, m2, m3, m0);
+      ROUNDS4( 2, e0, e1, m2, m3, m0, m1);
+      ROUNDS4( 3, e1, e0, m3, m0, m1, m2);
+      ROUNDS4( 4, e0, e1, m0, m1, m2, m3);
+      ROUNDS4( 5, e1, e0, m1, m2, m3, m0);
+      ROUNDS4( 6, e0, e1, m2, m3, m0, m1);
+      ROUNDS4( 7, e1, e0, m3, m0, m1, m2);
+      ROUNDS4( 8, e0, e1, m0, m1, m2, m3);
+      ROUNDS4( 9, e1, e0, m1, m2, m3, m0);
+      ROUNDS4(10, e0, e1, m2, m3, m0, m1);
+      ROUNDS4(11, e1, e0, m3, m0, m1, m2);
+      ROUNDS4(12, e0, e1, m0, m1, m2, m3);
+      ROUNDS4(13, e1, e0, m1, m2, m3, m0);
+      ROUNDS4(14, e0, e1, m2, m3, m0, m1);
+      ROUNDS4(15, e1, e0, m3, m0, m1, m2);
+      ROUNDS4(16, e0, e1, m0, m1, m2, m3);
+      ROUNDS4(17, e1, e0, m1, m2, m3, m0);
+      ROUNDS4(18, e0, e1, m2, m3, m0, m1);
+      ROUNDS4(19, e1, e0, m3, m0, m1, m2);
+
+      e0   = _mm_sha1nexte_epu32(e0, save_e);
+      abcd = _mm_add_epi32(abcd, save_abcd);
+      in += 64;
+   }
+
+   _mm_storeu_si128((__m128i *)state, _mm_shuffle_epi32(abcd, 0x1B));
+   state[4] = (ulong32)_mm_extract_epi32(e0, 3);
+}
+
+#endif
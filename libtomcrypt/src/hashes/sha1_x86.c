@@ -0,0 +1,205 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis
+ *
+ * LibTomCrypt is a library that provides various cryptographic
+ * algorithms in a highly modular and flexible manner.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtomcrypt.com
+ */
+
+/**
+   @file sha1_x86.c
+   SHA-1 compression for x86 without the SHA extensions: the message
+   schedule, with the round constants added, is computed four words at a
+   time in SSSE3 registers, or for two blocks at once with AVX2, and the
+   scalar rounds only have to add one word from it.  The schedule runs
+   eight groups of four words ahead of the rounds and is interleaved with
+   them, so the vector and scalar units work in parallel.
+
+   Words 16..31 follow the definition, with the fourth word of each group
+   fixed up for its dependence on the first.  From word 32 on, the
+   equivalent W[t] = (W[t-6] ^ W[t-16] ^ W[t-28] ^ W[t-32]) <<< 2 has no
+   dependence within a group.  The kernels must only be called once the
+   matching sha1_*_is_supported() has returned non-zero.
+*/
+#include "tomcrypt.h"
+
+#ifdef LTC_SHA1_SIMD
+
+#include <immintrin.h>
+
+#define SSSE3_TARGET __attribute__((target("ssse3")))
+#define AVX2_TARGET  __attribute__((target("avx2,bmi,bmi2")))
+
+static const ulong32 K[4] = { 0x5a827999UL, 0x6ed9eba1UL, 0x8f1bbcdcUL, 0xca62c1d6UL };
+
+#define F0(x,y,z)  (z ^ (x & (y ^ z)))
+#define F1(x,y,z)  (x ^ y ^ z)
+#define F2(x,y,z)  ((x & y) | (z & (x | y)))
+#define F3(x,y,z)  (x ^ y ^ z)
+
+/* a plain rotate rather than ROLc, whose inline asm the compiler can't
+   schedule or turn into rorx */
+#define ROT(x,n) (((x) << (n)) | ((x) >> (32 - (n))))
+
+#define FF(f,a,b,c,d,e,i) e += ROT(a, 5) + f(b,c,d) + wk[i]; b = ROT(b, 30);
+
+/* rounds 4g..4g+19, running SCHED for the groups eight further on */
+#define ROUNDS20(f, g, SCHED) \
+   SCHED((g) +  8) FF(f,a,b,c,d,e,4*(g)+ 0) FF(f,e,a,b,c,d,4*(g)+ 1) FF(f,d,e,a,b,c,4*(g)+ 2) FF(f,c,d,e,a,b,4*(g)+ 3) \
+   SCHED((g) +  9) FF(f,b,c,d,e,a,4*(g)+ 4) FF(f,a,b,c,d,e,4*(g)+ 5) FF(f,e,a,b,c,d,4*(g)+ 6) FF(f,d,e,a,b,c,4*(g)+ 7) \
+   SCHED((g) + 10) FF(f,c,d,e,a,b,4*(g)+ 8) FF(f,b,c,d,e,a,4*(g)+ 9) FF(f,a,b,c,d,e,4*(g)+10) FF(f,e,a,b,c,d,4*(g)+11) \
+   SCHED((g) + 11) FF(f,d,e,a,b,c,4*(g)+12) FF(f,c,d,e,a,b,4*(g)+13) FF(f,b,c,d,e,a,4*(g)+14) FF(f,a,b,c,d,e,4*(g)+15) \
+   SCHED((g) + 12) FF(f,e,a,b,c,d,4*(g)+16) FF(f,d,e,a,b,c,4*(g)+17) FF(f,c,d,e,a,b,4*(g)+18) FF(f,b,c,d,e,a,4*(g)+19)
+
+#define ROUNDS80(SCHED) \
+   a = state[0]; b = state[1]; c = state[2]; d = state[3]; e = state[4]; \
+   ROUNDS20(F0,  0, SCHED) \
+   ROUNDS20(F1,  5, SCHED) \
+   ROUNDS20(F2, 10, SCHED) \
+   ROUNDS20(F3, 15, SCHED) \
+   state[0] = (state[0] + a) & 0xFFFFFFFFUL; \
+   state[1] = (state[1] + b) & 0xFFFFFFFFUL; \
+   state[2] = (state[2] + c) & 0xFFFFFFFFUL; \
+   state[3] = (state[3] + d) & 0xFFFFFFFFUL; \
+   state[4] = (state[4] + e) & 0xFFFFFFFFUL;
+
+#define NOSCHED(j)
+
+/* group j of the schedule, in the ring w[] of the last eight groups,
+   and its words plus the round constant; from j = 8 on */
+#define SCHED32(j) \
+   if ((j) < 20) { \
+      t = VXOR(VXOR(VALIGNR(w[((j)-1)&7], w[((j)-2)&7]), w[((j)-4)&7]), VXOR(w[((j)-7)&7], w[(j)&7])); \
+      w[(j)&7] = VROL(t, 2); \
+      STOREWK(j, VADD(w[(j)&7], VSET1(K[(j)/5]))); \
+   }
+
+/* groups 0..7, with the first four loaded from in */
+#define SCHED_START \
+   for (j = 0; j < 4; j++) { \
+      w[j] = VLOAD(j); \
+      STOREWK(j, VADD(w[j], VSET1(K[0]))); \
+   } \
+   for (; j < 8; j++) { \
+      t = VXOR(VXOR(w[j-4], VALIGNR(w[j-3], w[j-4])), VXOR(w[j-2], VSRLI4(w[j-1]))); \
+      w[j] = VXOR(VROL(t, 1), VROL(VSLLI12(t), 2)); \
+      STOREWK(j, VADD(w[j], VSET1(K[j/5]))); \
+   }
+
+#define VXOR(a,b)    _mm_xor_si128(a, b)
+#define VADD(a,b)    _mm_add_epi32(a, b)
+#define VROL(a,n)    _mm_or_si128(_mm_slli_epi32(a, n), _mm_srli_epi32(a, 32 - (n)))
+#define VALIGNR(a,b) _mm_alignr_epi8(a, b, 8)
+#define VSRLI4(a)    _mm_srli_si128(a, 4)
+#define VSLLI12(a)   _mm_slli_si128(a, 12)
+#define VSET1(k)     _mm_set1_epi32((int)(k))
+#define VLOAD(j)     _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(in + 16 * (j))), bswap)
+#define STOREWK(j, v) _mm_storeu_si128((__m128i *)&wk[4 * (j)], v);
+
+/**
+  Check whether this CPU can run the SSSE3 code
+  @return non-zero if the kernel may be used
+*/
+int sha1_ssse3_is_supported(void)
+{
+   return (crypt_cpu_features() & LTC_CPU_SSSE3) != 0;
+}
+
+/**
+  Compress whole blocks into a SHA-1 state, with the SSSE3 schedule
+  @param state   The five state words
+  @param in      The blocks
+  @param blocks  The number of 64 byte blocks
+*/
+SSSE3_TARGET
+void sha1_ssse3_compress(ulong32 *state, const unsigned char *in, unsigned long blocks)
+{
+   const __m128i bswap = _mm_set_epi64x(CONST64(0x0c0d0e0f08090a0b), CONST64(0x0405060700010203));
+   __m128i w[8], t;
+   ulong32 a, b, c, d, e, wk[80];
+   int j;
+
+   while (blocks-- > 0) {
+      SCHED_START
+      ROUNDS80(SCHED32)
+      in += 64;
+   }
+   zeromem(wk, sizeof(wk));
+}
+
+#undef VXOR
+#undef VADD
+#undef VROL
+#undef VALIGNR
+#undef VSRLI4
+#undef VSLLI12
+#undef VSET1
+#undef VLOAD
+#undef STOREWK
+
+/* the first block in the low lanes, the second in the high */
+#define VXOR(a,b)    _mm256_xor_si256(a, b)
+#define VADD(a,b)    _mm256_add_epi32(a, b)
+#define VROL(a,n)    _mm256_or_si256(_mm256_slli_epi32(a, n), _mm256_srli_epi32(a, 32 - (n)))
+#define VALIGNR(a,b) _mm256_alignr_epi8(a, b, 8)
+#define VSRLI4(a)    _mm256_srli_si256(a, 4)
+#define VSLLI12(a)   _mm256_slli_si256(a, 12)
+#define VSET1(k)     _mm256_set1_epi32((int)(k))
+#define VLOAD(j)     _mm256_shuffle_epi8(_mm256_inserti128_si256( \
+                       _mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)(in + 16 * (j)))), \
+                       _mm_loadu_si128((const __m128i *)(in + 64 + 16 * (j))), 1), bswap)
+#define STOREWK(j, v) \
+   _mm_storeu_si128((__m128i *)&wk1[4 * (j)], _mm256_castsi256_si128(v)); \
+   _mm_storeu_si128((__m128i *)&wk2[4 * (j)], _mm256_extracti128_si256(v, 1));
+
+/**
+  Check whether this CPU can run the AVX2 code, which also uses BMI1/2
+  for the scalar rounds
+  @return non-zero if the kernel may be used
+*/
+int sha1_avx2_is_supported(void)
+{
+   const unsigned long need = LTC_CPU_AVX2 | LTC_CPU_BMI2;
+
+   return (crypt_cpu_features() & need) == need;
+}
+
+/**
+  Compress whole blocks into a SHA-1 state, with the schedule for two
+  blocks at a time in AVX2 registers
+  @param state   The five state words
+  @param in      The blocks
+  @param blocks  The number of 64 byte blocks
+*/
+AVX2_TARGET
+void sha1_avx2_compress(ulong32 *state, const unsigned char *in, unsigned long blocks)
+{
+   const __m256i bswap = _mm256_set_epi64x(CONST64(0x0c0d0e0f08090a0b), CONST64(0x0405060700010203),
+                                           CONST64(0x0c0d0e0f08090a0b), CONST64(0x0405060700010203));
+   __m256i w[8], t;
+   ulong32 a, b, c, d, e, wk1[80], wk2[80];
+   const ulong32 *wk;
+   int j;
+
+   /* the second block's rounds run on the schedule made alongside the
+      first's */
+   while (blocks >= 2) {
+      SCHED_START
+      wk = wk1;
+      ROUNDS80(SCHED32)
+      wk = wk2;
+      ROUNDS80(NOSCHED)
+      in += 128;
+      blocks -= 2;
+   }
+   zeromem(wk1, sizeof(wk1));
+   zeromem(wk2, sizeof(wk2));
+   if (blocks > 0) {
+      sha1_ssse3_compress(state, in, blocks);
+   }
+}
+
+#endif
@@ -0,0 +1,124 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis
+ *
+ * LibTomCrypt is a library that provides various cryptographic
+ * algorithms in a highly modular and flexible manner.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtomcrypt.com
+ */
+
+/**
+   @file sha256_armv8.c
+   SHA-256 compression with the ARMv8 cryptography extensions.
+
+   sha256h/sha256h2 run four rounds on the ABCD/EFGH halves of the
+   state, and sha256su0/sha256su1 extend the message schedule four words
+   at a time.  Only call sha256_armv8_compress() once
+   sha256_armv8_is_supported() has returned non-zero.
+*/
+#include "tomcrypt.h"
+
+#ifdef LTC_SHA256_ARMV8
+
+#include <arm_neon.h>
+
+#define ARMV8_TARGET __attribute__((target("+crypto")))
+
+static const uint32_t K[64] = {
+    0x428a2f98UL, 0x71374491UL, 0xb5c0fbcfUL, 0xe9b5dba5UL, 0x3956c25bUL, 0x59f111f1UL, 0x923f82a4UL, 0xab1c5ed5UL,
+    0xd807aa98UL, 0x12835b01UL, 0x243185beUL, 0x550c7dc3UL, 0x72be5d74UL, 0x80deb1feUL, 0x9bdc06a7UL, 0xc19bf174UL,
+    0xe49b69c1UL, 0xefbe4786UL, 0x0fc19dc6UL, 0x240ca1ccUL, 0x2de92c6fUL, 0x4a7484aaUL, 0x5cb0a9dcUL, 0x76f988daUL,
+    0x983e5152UL, 0xa831c66dUL, 0xb00327c8UL, 0xbf597fc7UL, 0xc6e00bf3UL, 0xd5a79147UL, 0x06ca6351UL, 0x14292967UL,
+    0x27b70a85UL, 0x2e1b2138UL, 0x4d2c6dfcUL, 0x53380d13UL, 0x650a7354UL, 0x766a0abbUL, 0x81c2c92eUL, 0x92722c85UL,
+    0xa2bfe8a1UL, 0xa81a664bUL, 0xc24b8b70UL, 0xc76c51a3UL, 0xd192e819UL, 0xd6990624UL, 0xf40e3585UL, 0x106aa070UL,
+    0x19a4c116UL, 0x1e376c08UL, 0x2748774cUL, 0x34b0bcb5UL, 0x391c0cb3UL, 0x4ed8aa4aUL, 0x5b9cca4fUL, 0x682e6ff3UL,
+    0x748f82eeUL, 0x78a5636fUL, 0x84c87814UL, 0x8cc70208UL, 0x90befffaUL, 0xa4506cebUL, 0xbef9a3f7UL, 0xc67178f2UL
+};
+
+/**
+  Check whether this CPU has the SHA-256 instructions
+  @return non-zero if the kernel may be used
+*/
+int sha256_armv8_is_supported(void)
+{
+   return (crypt_cpu_features() & LTC_CPU_ARMSHA2) != 0;
+}
+
+/* rounds 4i..4i+3 using message words mi, extending the schedule in mi
+   for the rounds 16 further on */
+#define ROUNDS4(i, mi, m1, m2, m3) do { \
+   wk = vaddq_u32(mi, vld1q_u32(&K[4*(i)])); \
+   if ((i) < 12) { \
+      mi = vsha256su0q_u32(mi, m1); \
+   } \
+   t  = s0; \
+   s0 = vsha256hq_u32(s0, s1, wk); \
+   s1 = vsha256h2q_u32(s1, t, wk); \
+   if ((i) < 12) { \
+      mi = vsha256su1q_u32(mi, m2, m3); \
+   } \
+} while (0)
+
+#define LOAD_BE(p) vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(p)))
+
+/**
+  Compress whole blocks into a SHA-256 state
+  @param state   The eight state words
+  @param in      The blocks
+  @param blocks  The number of 64 byte blocks
+*/
+ARMV8_TARGET
+void sha256_armv8_compress(ulong32 *state, const unsigned char *in, unsigned long blocks)
+{
+   uint32x4_t s0, s1, t, wk, m0, m1, m2, m3, save0, save1;
+   uint32_t st[8];
+   int i;
+
+   /* ulong32 may be wider than 32 bits here */
+   for (i = 0; i < 8; i++) {
+      st[i] = (uint32_t)state[i];
+   }
+   s0 = vld1q_u32(&st[0]);
+   s1 = vld1q_u32(&st[4]);
+
+   while (blocks-- > 0) {
+      save0 = s0;
+      save1 = s1;
+
+      m0 = LOAD_BE(in +  0);
+      m1 = LOAD_BE(in + 16);
+      m2 = LOAD_BE(in + 32);
+      m3 = LOAD_BE(in + 48);
+
+      ROUNDS4( 0, m0, m1, m2, m3);
+      ROUNDS4( 1, m1, m2, m3, m0);
+      ROUNDS4( 2, m2, m3, m0, m1);
+      ROUNDS4( 3, m3, m0, m1, m2);
+      ROUNDS4( 4, m0, m1, m2, m3);
+      ROUNDS4( 5, m1, m2, m3, m0);
+      ROUNDS4( 6, m2, m3, m0, m1);
+      ROUNDS4( 7, m3, m0, m1, m2);
+      ROUNDS4( 8, m0, m1, m2, m3);
+      ROUNDS4( 9, m1, m2, m3, m0);
+      ROUNDS4(10, m2, m3, m0, m1);
+      ROUNDS4(11, m3, m0, m1, m2);
+      ROUNDS4(12, m0, m1, m2, m3);
+      ROUNDS4(13, m1, m2, m3, m0);
+      ROUNDS4(14, m2, m3, m0, m1);
+      ROUNDS4(15, m3, m0, m1, m2);
+
+      s0 = vaddq_u32(s0, save0);
+      s1 = vaddq_u32(s1, save1);
+      in += 64;
+   }
+
+   vst1q_u32(&st[0], s0);
+   vst1q_u32(&st[4], s1);
+   for (i = 0; i < 8; i++) {
+      state[i] = st[i];
+   }
+}
+
+#endif
@@ -0,0 +1,124 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis
+ *
+ * LibTomCrypt is a library that provides various cryptographic
+ * algorithms in a highly modular and flexible manner.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtomcrypt.com
+ */
+
+/**
+   @file sha256_shani.c
+   SHA-256 compression with the x86 SHA extensions (SHA-NI).
+
+   The state is held as ABEF/CDGH, the order sha256rnds2 works on, and
+   each group of four rounds also advances the message schedule with
+   sha256msg1/sha256msg2.  Only call sha256_shani_compress() once
+   sha256_shani_is_supported() has returned non-zero.
+*/
+#include "tomcrypt.h"
+
+#ifdef LTC_SHA256_SHANI
+
+#include <immintrin.h>
+
+#define SHANI_TARGET __attribute__((target("sse2,ssse3,sse4.1,sha")))
+
+#ifndef bit_SHA
+#define bit_SHA (1 << 29)
+#endif
+
+static const ulong32 K[64] = {
+    0x428a2f98UL, 0x71374491UL, 0xb5c0fbcfUL, 0xe9b5dba5UL, 0x3956c25bUL, 0x59f111f1UL, 0x923f82a4UL, 0xab1c5ed5UL,
+    0xd807aa98UL, 0x12835b01UL, 0x243185beUL, 0x550c7dc3UL, 0x72be5d74UL, 0x80deb1feUL, 0x9bdc06a7UL, 0xc19bf174UL,
+    0xe49b69c1UL, 0xefbe4786UL, 0x0fc19dc6UL, 0x240ca1ccUL, 0x2de92c6fUL, 0x4a7484aaUL, 0x5cb0a9dcUL, 0x76f988daUL,
+    0x983e5152UL, 0xa831c66dUL, 0xb00327c8UL, 0xbf597fc7UL, 0xc6e00bf3UL, 0xd5a79147UL, 0x06ca6351UL, 0x14292967UL,
+    0x27b70a85UL, 0x2e1b2138UL, 0x4d2c6dfcUL, 0x53380d13UL, 0x650a7354UL, 0x766a0abbUL, 0x81c2c92eUL, 0x92722c85UL,
+    0xa2bfe8a1UL, 0xa81a664bUL, 0xc24b8b70UL, 0xc76c51a3UL, 0xd192e819UL, 0xd6990624UL, 0xf40e3585UL, 0x106aa070UL,
+    0x19a4c116UL, 0x1e376c08UL, 0x2748774cUL, 0x34b0bcb5UL, 0x391c0cb3UL, 0x4ed8aa4aUL, 0x5b9cca4fUL, 0x682e6ff3UL,
+    0x748f82eeUL, 0x78a5636fUL, 0x84c87814UL, 0x8cc70208UL, 0x90befffaUL, 0xa4506cebUL, 0xbef9a3f7UL, 0xc67178f2UL
+};
+
+/**
+  Check whether this CPU can run the SHA-NI code
+  @return non-zero if the kernel may be used
+*/
+int sha256_shani_is_supported(void)
+{
+   const unsigned long need = LTC_CPU_SHA | LTC_CPU_SSSE3 | LTC_CPU_SSE41;
+
+   return (crypt_cpu_features() & need) == need;
+}
+
+/* rounds 4i..4i+3 using message words mi, then finish the schedule for
+   mnext and start it for mprev while the rounds are in flight */
+#define ROUNDS4(i, mi, mnext, mprev) do { \
+   msg = _mm_add_epi32(mi, _mm_loadu_si128((const __m128i *)&K[4*(i)])); \
+   s1  = _mm_sha256rnds2_epu32(s1, s0, msg); \
+   if ((i) >= 3 && (i) <= 14) { \
+      mnext = _mm_add_epi32(mnext, _mm_alignr_epi8(mi, mprev, 4)); \
+      mnext = _mm_sha256msg2_epu32(mnext, mi); \
+   } \
+   s0  = _mm_sha256rnds2_epu32(s0, s1, _mm_shuffle_epi32(msg, 0x0E)); \
+   if ((i) >= 1 && (i) <= 12) { \
+      mprev = _mm_sha256msg1_epu32(mprev, mi); \
+   } \
+} while (0)
+
+/**
+  Compress whole blocks into a SHA-256 state
+  @param state   The eight state words
+  @param in      The blocks
+  @param blocks  The number of 64 byte blocks
+*/
+SHANI_TARGET
+void sha256_shani_compress(ulong32 *state, const unsigned char *in, unsigned long blocks)
+{
+   const __m128i bswap = _mm_set_epi64x(CONST64(0x0c0d0e0f08090a0b), CONST64(0x0405060700010203));
+   __m128i s0, s1, t, msg, m0, m1, m2, m3, save0, save1;
+
+   t  = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)&state[0]), 0xB1); /* CDAB */
+   s1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)&state[4]), 0x1B); /* EFGH */
+   s0 = _mm_alignr_epi8(t, s1, 8);                                           /* ABEF */
+   s1 = _mm_blend_epi16(s1, t, 0xF0);                                        /* CDGH */
+
+   while (blocks-- > 0) {
+      save0 = s0;
+      save1 = s1;
+
+      m0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(in +  0)), bswap);
+      m1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(in + 16)), bswap);
+      m2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(in + 32)), bswap);
+      m3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(in + 48)), bswap);
+
+      ROUNDS4( 0, m0, m1, m3);
+      ROUNDS4( 1, m1, m2, m0);
+      ROUNDS4( 2, m2, m3, m1);
+      ROUNDS4( 3, m3, m0, m2);
+      ROUNDS4( 4, m0, m1, m3);
+      ROUNDS4( 5, m1, m2, m0);
+      ROUNDS4( 6, m2, m3, m1);
+      ROUNDS4( 7, m3, m0, m2);
+      ROUNDS4( 8, m0, m1, m3);
+      ROUNDS4( 9, m1, m2, m0);
+      ROUNDS4(10, m2, m3, m1);
+      ROUNDS4(11, m3, m0, m2);
+      ROUNDS4(12, m0, m1, m3);
+      ROUNDS4(13, m1, m2, m0);
+      ROUNDS4(14, m2, m3, m1);
+      ROUNDS4(15, m3, m0, m2);
+
+      s0 = _mm_add_epi32(s0, save0);
+      s1 = _mm_add_epi32(s1, save1);
+      in += 64;
+   }
+
+   t  = _mm_shuffle_epi32(s0, 0x1B);                                         /* FEBA */
+   s1 = _mm_shuffle_epi32(s1, 0xB1);                                         /* DCHG */
+   _mm_storeu_si128((__m128i *)&state[0], _mm_blend_epi16(t, s1, 0xF0));     /* DCBA */
+   _mm_storeu_si128((__m128i *)&state[4], _mm_alignr_epi8(s1, t, 8));       /* HGFE */
+}
+
+#endif
@@ -61,7 +61,9 @@ enum {
    CRYPT_PK_INVALID_SIZE,  /* Invalid size input for PK parameters */
 
    CRYPT_INVALID_PRIME_SIZE,/* Invalid size of prime requested */
-   CRYPT_PK_INVALID_PADDING /* Invalid padding on input */
+   CRYPT_PK_INVALID_PADDING,/* Invalid padding on input */
+
+   CRYPT_OVERFLOW          /* An overflow of a value was detected/prevented */
 };
 
 #include <tomcrypt_cfg.h>
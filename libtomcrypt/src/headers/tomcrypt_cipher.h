@@ -624,6 +624,39 @@ void rijndael_enc_done(symmetric_key *skey);
 int rijndael_enc_keysize(int *keysize);
 extern const struct ltc_cipher_descriptor rijndael_desc, aes_desc;
 extern const struct ltc_cipher_descriptor rijndael_enc_desc, aes_enc_desc;
+
+#ifdef LTC_AES_NI
+int aes_ni_is_supported(void);
+int aes_ni_setup(const unsigned char *key, int keylen, int num_rounds, symmetric_key *skey);
+int aes_ni_ecb_encrypt(const unsigned char *pt, unsigned char *ct, symmetric_key *skey);
+int aes_ni_ecb_decrypt(const unsigned char *ct, unsigned char *pt, symmetric_key *skey);
+int aes_ni_cbc_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, unsigned char *IV, symmetric_key *skey);
+int aes_ni_cbc_decrypt(const unsigned char *ct, unsigned char *pt, unsigned long blocks, unsigned char *IV, symmetric_key *skey);
+int aes_ni_ctr_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, unsigned char *IV, int mode, symmetric_key *skey);
+extern const struct ltc_cipher_descriptor aes_ni_desc;
+#endif
+
+#ifdef LTC_AES_VPERM
+int aes_vperm_is_supported(void);
+int aes_vperm_setup(const unsigned char *key, int keylen, int num_rounds, symmetric_key *skey);
+int aes_vperm_ecb_encrypt(const unsigned char *pt, unsigned char *ct, symmetric_key *skey);
+int aes_vperm_ecb_decrypt(const unsigned char *ct, unsigned char *pt, symmetric_key *skey);
+int aes_vperm_accel_ecb_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, symmetric_key *skey);
+int aes_vperm_cbc_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, unsigned char *IV, symmetric_key *skey);
+int aes_vperm_cbc_decrypt(const unsigned char *ct, unsigned char *pt, unsigned long blocks, unsigned char *IV, symmetric_key *skey);
+int aes_vperm_ctr_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, unsigned char *IV, int mode, symmetric_key *skey);
+extern const struct ltc_cipher_descriptor aes_vperm_desc;
+#endif
+
+#ifdef LTC_AES_CT
+int aes_ct_setup(const unsigned char *key, int keylen, int num_rounds, symmetric_key *skey);
+int aes_ct_ecb_encrypt(const unsigned char *pt, unsigned char *ct, symmetric_key *skey);
+int aes_ct_ecb_decrypt(const unsigned char *ct, unsigned char *pt, symmetric_key *skey);
+int aes_ct_accel_ecb_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, symmetric_key *skey);
+int aes_ct_cbc_decrypt(const unsigned char *ct, unsigned char *pt, unsigned long blocks, unsigned char *IV, symmetric_key *skey);
+int aes_ct_ctr_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long blocks, unsigned char *IV, int mode, symmetric_key *skey);
+extern const struct ltc_cipher_descriptor aes_ct_desc;
+#endif
 #endif
 
 #ifdef XTEA
@@ -824,6 +857,45 @@ int f8_done(symmetric_F8 *f8);
 int f8_test_mode(void);
 #endif
 
+#ifdef LTC_CHACHA
+
+typedef struct {
+   ulong32 input[16];
+   unsigned char kstream[64];
+   unsigned long ksleft;
+   unsigned long ivlen;
+   int rounds;
+#if defined(LTC_CHACHA_SSE2) || defined(LTC_CHACHA_NEON)
+   int simd;             /* use the 4-way SSE2/NEON kernel? */
+#endif
+#ifdef LTC_CHACHA_AVX2
+   int avx2;             /* use the 8-way AVX2 kernel? */
+#endif
+} chacha_state;
+
+int chacha_setup(chacha_state *st, const unsigned char *key, unsigned long keylen, int rounds);
+int chacha_ivctr32(chacha_state *st, const unsigned char *iv, unsigned long ivlen, ulong32 counter);
+int chacha_ivctr64(chacha_state *st, const unsigned char *iv, unsigned long ivlen, ulong64 counter);
+int chacha_crypt(chacha_state *st, const unsigned char *in, unsigned long inlen, unsigned char *out);
+int chacha_keystream(chacha_state *st, unsigned char *out, unsigned long outlen);
+int chacha_done(chacha_state *st);
+int chacha_test(void);
+
+/* multi-block kernels, each XORs as many whole groups of its width as
+   fit in blocks and returns the number of blocks done */
+#ifdef LTC_CHACHA_SSE2
+unsigned long chacha_sse2_blocks(ulong32 *input, const unsigned char *in, unsigned char *out, unsigned long blocks, int rounds);
+#endif
+#ifdef LTC_CHACHA_AVX2
+int chacha_avx2_is_supported(void);
+unsigned long chacha_avx2_blocks(ulong32 *input, const unsigned char *in, unsigned char *out, unsigned long blocks, int rounds);
+#endif
+#ifdef LTC_CHACHA_NEON
+unsigned long chacha_neon_blocks(ulong32 *input, const unsigned char *in, unsigned char *out, unsigned long blocks, int rounds);
+#endif
+
+#endif /* LTC_CHACHA */
+
 
 int find_cipher(const char *name);
 int find_cipher_any(const char *name, int blocklen, int keylen);
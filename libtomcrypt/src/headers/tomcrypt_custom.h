@@ -96,6 +96,21 @@
 
 #ifdef DROPBEAR_AES
 #define RIJNDAEL
+/* AES-NI version of aes_desc, chosen at runtime in crypto_init() */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && !defined(LTC_NO_ASM)
+#define LTC_AES_NI
+#endif
+/* constant time versions for CPUs without it, vector permutes with
+   SSSE3 or NEON, else bitsliced in 64 bit words unless DROPBEAR_AES_CT
+   is turned off */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && !defined(LTC_NO_ASM)
+#define LTC_AES_VPERM
+#elif defined(__GNUC__) && (defined(__ARM_NEON) || defined(__ARM_NEON__)) && !defined(LTC_NO_ASM)
+#define LTC_AES_VPERM
+#endif
+#ifdef DROPBEAR_AES_CT
+#define LTC_AES_CT
+#endif
 #endif
 
 #ifdef DROPBEAR_3DES
@@ -108,7 +123,67 @@
 #define LTC_CTR_MODE
 #endif
 
+#ifdef DROPBEAR_CHACHA20POLY1305
+#define LTC_CHACHA
+#define LTC_POLY1305
+#if defined(__GNUC__) && !defined(LTC_NO_ASM)
+#if defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__))
+#define LTC_CHACHA_SSE2
+/* chosen at runtime in chacha_setup() */
+#define LTC_CHACHA_AVX2
+#elif (defined(__ARM_NEON) || defined(__ARM_NEON__)) && !defined(__ARM_BIG_ENDIAN)
+#define LTC_CHACHA_NEON
+#endif
+#endif
+#endif
+
+#ifdef DROPBEAR_UMAC
+#define LTC_UMAC
+#if defined(__GNUC__) && !defined(LTC_NO_ASM)
+#if defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__))
+#define LTC_UMAC_SSE2
+/* chosen at runtime in umac_init() */
+#define LTC_UMAC_AVX2
+#elif (defined(__ARM_NEON) || defined(__ARM_NEON__)) && !defined(__ARM_BIG_ENDIAN)
+#define LTC_UMAC_NEON
+#endif
+#endif
+#endif
+
+#ifdef DROPBEAR_ENABLE_GCM_MODE
+#define GCM_MODE
+/* PCLMULQDQ GHASH, chosen at runtime in gcm_init() */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && !defined(LTC_NO_ASM)
+#define LTC_GCM_PCLMUL
+#endif
+#endif
+
 #define SHA1
+/* SHA-1 compression kernels, chosen by sha1_accel_init() */
+#if defined(__GNUC__) && !defined(LTC_NO_ASM)
+#if defined(__x86_64__) || defined(__i386__)
+#define LTC_SHA1_SHANI
+#define LTC_SHA1_SIMD
+#elif defined(__aarch64__) && defined(__linux__)
+#define LTC_SHA1_ARMV8
+#endif
+#endif
+
+#ifdef DROPBEAR_SHA256
+#define SHA256
+/* hardware SHA-256 compression, chosen by sha256_accel_init() */
+#if defined(__GNUC__) && !defined(LTC_NO_ASM)
+#if defined(__x86_64__) || defined(__i386__)
+#define LTC_SHA256_SHANI
+#elif defined(__aarch64__) && defined(__linux__)
+#define LTC_SHA256_ARMV8
+#endif
+#endif
+#endif
+
+#ifdef DROPBEAR_SHA512
+#define SHA512
+#endif
 
 #ifdef DROPBEAR_MD5
 #define MD5
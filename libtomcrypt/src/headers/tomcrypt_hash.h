@@ -232,8 +232,19 @@ int sha256_init(hash_state * md);
 int sha256_process(hash_state * md, const unsigned char *in, unsigned long inlen);
 int sha256_done(hash_state * md, unsigned char *hash);
 int sha256_test(void);
+const char *sha256_accel_init(void);
 extern const struct ltc_hash_descriptor sha256_desc;
 
+/* whole-block compression kernels, see sha256_accel_init() */
+#ifdef LTC_SHA256_SHANI
+int sha256_shani_is_supported(void);
+void sha256_shani_compress(ulong32 *state, const unsigned char *in, unsigned long blocks);
+#endif
+#ifdef LTC_SHA256_ARMV8
+int sha256_armv8_is_supported(void);
+void sha256_armv8_compress(ulong32 *state, const unsigned char *in, unsigned long blocks);
+#endif
+
 #ifdef SHA224
 #ifndef SHA256
    #error SHA256 is required for SHA224
@@ -251,7 +262,24 @@ int sha1_init(hash_state * md);
 int sha1_process(hash_state * md, const unsigned char *in, unsigned long inlen);
 int sha1_done(hash_state * md, unsigned char *hash);
 int sha1_test(void);
+const char *sha1_accel_init(void);
 extern const struct ltc_hash_descriptor sha1_desc;
+
+/* whole-block compression kernels, see sha1_accel_init() */
+#ifdef LTC_SHA1_SHANI
+int sha1_shani_is_supported(void);
+void sha1_shani_compress(ulong32 *state, const unsigned char *in, unsigned long blocks);
+#endif
+#ifdef LTC_SHA1_SIMD
+int sha1_ssse3_is_supported(void);
+void sha1_ssse3_compress(ulong32 *state, const unsigned char *in, unsigned long blocks);
+int sha1_avx2_is_supported(void);
+void sha1_avx2_compress(ulong32 *state, const unsigned char *in, unsigned long blocks);
+#endif
+#ifdef LTC_SHA1_ARMV8
+int sha1_armv8_is_supported(void);
+void sha1_armv8_compress(ulong32 *state, const unsigned char *in, unsigned long blocks);
+#endif
 #endif
 
 #ifdef MD5
@@ -23,6 +23,89 @@ int hmac_file(int hash, const char *fname, const unsigned char *key,
               unsigned char *dst, unsigned long *dstlen);
 #endif
 
+#ifdef LTC_POLY1305
+
+/* h and r are held in 44/44/42 bit limbs where a 64x64->128 bit
+   multiply is available, otherwise in five 26 bit limbs */
+#if defined(__SIZEOF_INT128__) && !defined(LTC_NO_INT128)
+#define LTC_POLY1305_64
+#endif
+
+typedef struct {
+#ifdef LTC_POLY1305_64
+   ulong64 r[3];
+   ulong64 h[3];
+   ulong64 pad[2];
+#else
+   ulong32 r[5];
+   ulong32 h[5];
+   ulong32 pad[4];
+#endif
+   unsigned long leftover;
+   unsigned char buffer[16];
+   int final;
+} poly1305_state;
+
+int poly1305_init(poly1305_state *st, const unsigned char *key, unsigned long keylen);
+int poly1305_process(poly1305_state *st, const unsigned char *in, unsigned long inlen);
+int poly1305_done(poly1305_state *st, unsigned char *mac, unsigned long *maclen);
+int poly1305_test(void);
+#endif /* LTC_POLY1305 */
+
+#ifdef LTC_UMAC
+
+#define UMAC_KEY_LEN        16
+#define UMAC_L1_KEY_LEN     1024   /* message bytes per NH block */
+#define UMAC_L1_KEY_SHIFT   16     /* NH key offset between streams */
+#define UMAC_MAX_STREAMS    4      /* one per 32 bits of tag */
+
+typedef struct {
+   symmetric_key prf;              /* key for the pad, from the kdf */
+   unsigned char nhkey[UMAC_L1_KEY_LEN + UMAC_L1_KEY_SHIFT * (UMAC_MAX_STREAMS - 1)];
+   ulong64       polykey[UMAC_MAX_STREAMS],
+                 ipkey[4 * UMAC_MAX_STREAMS];
+   ulong32       iptrans[UMAC_MAX_STREAMS];
+
+   ulong64       nh[UMAC_MAX_STREAMS],      /* NH sums of the current block */
+                 poly[UMAC_MAX_STREAMS];    /* L2 polynomial hashes */
+   ulong64       msglen;
+   unsigned long l1off;                     /* bytes NH hashed in this block */
+   unsigned char buf[32];                   /* a partial NH word group */
+   unsigned long buflen;
+
+   unsigned char nonce[16], pad[16];        /* the last pad, and its nonce */
+   int           padvalid;
+
+   int           cipher, streams;
+   unsigned long taglen;
+#if defined(LTC_UMAC_SSE2) || defined(LTC_UMAC_NEON)
+   int           simd;                      /* use the SSE2/NEON NH kernel? */
+#endif
+#ifdef LTC_UMAC_AVX2
+   int           avx2;
+#endif
+} umac_state;
+
+int umac_init(umac_state *st, int cipher, const unsigned char *key, unsigned long keylen, unsigned long taglen);
+int umac_process(umac_state *st, const unsigned char *in, unsigned long inlen);
+int umac_done(umac_state *st, const unsigned char *nonce, unsigned long noncelen, unsigned char *out, unsigned long *outlen);
+int umac_test(void);
+
+/* NH kernels, each adds the NH sums over len bytes (a multiple of 32)
+   for 2 or 4 streams to nh */
+#ifdef LTC_UMAC_SSE2
+void umac_nh_sse2(const unsigned char *key, const unsigned char *in, unsigned long len, int streams, ulong64 *nh);
+#endif
+#ifdef LTC_UMAC_AVX2
+int umac_avx2_is_supported(void);
+void umac_nh_avx2(const unsigned char *key, const unsigned char *in, unsigned long len, int streams, ulong64 *nh);
+#endif
+#ifdef LTC_UMAC_NEON
+void umac_nh_neon(const unsigned char *key, const unsigned char *in, unsigned long len, int streams, ulong64 *nh);
+#endif
+
+#endif /* LTC_UMAC */
+
 #ifdef LTC_OMAC
 
 typedef struct {
@@ -231,6 +314,9 @@ extern const unsigned char gcm_shift_table[];
 #define GCM_MODE_AAD   1
 #define GCM_MODE_TEXT  2
 
+/* blocks hashed per reduction by the PCLMULQDQ kernel */
+#define GCM_PCLMUL_BLOCKS 4
+
 typedef struct { 
    symmetric_key       K;
    unsigned char       H[16],        /* multiplier */
@@ -254,9 +340,26 @@ __attribute__ ((aligned (16)))
 #endif
 ;
 #endif  
+
+   ulong64             HL[16],       /* 4-bit table of multiples of H, */
+                       HH[16];       /* low and high halves */
+
+#ifdef LTC_GCM_PCLMUL
+   unsigned char       HP[GCM_PCLMUL_BLOCKS][16]; /* H^1..H^n, byte reflected */
+   int                 pclmul;       /* use the PCLMULQDQ kernel? */
+#endif
 } gcm_state;
 
 void gcm_mult_h(gcm_state *gcm, unsigned char *I);
+void gcm_init_table(gcm_state *gcm);
+void gcm_ghash(gcm_state *gcm, const unsigned char *in, unsigned long blocks);
+
+#ifdef LTC_GCM_PCLMUL
+int gcm_pclmul_is_supported(void);
+void gcm_pclmul_init(gcm_state *gcm);
+void gcm_pclmul_mult_h(gcm_state *gcm, unsigned char *I);
+void gcm_pclmul_ghash(gcm_state *gcm, const unsigned char *in, unsigned long blocks);
+#endif
 
 int gcm_init(gcm_state *gcm, int cipher,
              const unsigned char *key, int keylen);
@@ -1,3 +1,21 @@
 
 /* ---- MEM routines ---- */
 void zeromem(void *dst, size_t len);
+
+/* ---- CPU features, see crypt_cpu.c ---- */
+#define LTC_CPU_SSE2     0x0001UL
+#define LTC_CPU_SSSE3    0x0002UL
+#define LTC_CPU_SSE41    0x0004UL
+#define LTC_CPU_AESNI    0x0008UL
+#define LTC_CPU_PCLMUL   0x0010UL
+#define LTC_CPU_AVX2     0x0020UL
+#define LTC_CPU_BMI2     0x0040UL   /* BMI1 and BMI2 */
+#define LTC_CPU_SHA      0x0080UL   /* x86 SHA extensions */
+#define LTC_CPU_NEON     0x0100UL
+#define LTC_CPU_ARMSHA1  0x0200UL
+#define LTC_CPU_ARMSHA2  0x0400UL
+#define LTC_CPU_AVX512IFMA 0x0800UL /* and AVX-512F */
+#define LTC_CPU_ALL      0xFFFFUL
+
+unsigned long crypt_cpu_features(void);
+void crypt_cpu_disable(unsigned long features);
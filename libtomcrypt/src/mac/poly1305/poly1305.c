@@ -0,0 +1,339 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis
+ *
+ * LibTomCrypt is a library that provides various cryptographic
+ * algorithms in a highly modular and flexible manner.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtomcrypt.com
+ */
+#include "tomcrypt.h"
+
+/**
+   @file poly1305.c
+   Poly1305 one-time authenticator (D. J. Bernstein), after A. Moon's
+   poly1305-donna.  h and r are kept in three 44/44/42 bit limbs when
+   the compiler has a 64x64->128 bit multiply and in five 26 bit limbs
+   otherwise; either way the accumulator is only partially reduced
+   between blocks.
+*/
+
+#ifdef LTC_POLY1305
+
+#ifdef LTC_POLY1305_64
+
+typedef unsigned __int128 poly1305_u128;
+
+#define MASK44 CONST64(0xfffffffffff)
+#define MASK42 CONST64(0x3ffffffffff)
+
+static void poly1305_blocks(poly1305_state *st, const unsigned char *m, unsigned long bytes)
+{
+   const ulong64 hibit = st->final ? 0 : ((ulong64)1 << 40); /* 1 << 128 */
+   ulong64 r0, r1, r2, s1, s2, h0, h1, h2, c, t0, t1;
+   poly1305_u128 d0, d1, d2;
+
+   r0 = st->r[0];
+   r1 = st->r[1];
+   r2 = st->r[2];
+   h0 = st->h[0];
+   h1 = st->h[1];
+   h2 = st->h[2];
+   s1 = r1 * (5 << 2);
+   s2 = r2 * (5 << 2);
+
+   while (bytes >= 16) {
+      LOAD64L(t0, m + 0);
+      LOAD64L(t1, m + 8);
+      h0 += t0 & MASK44;
+      h1 += ((t0 >> 44) | (t1 << 20)) & MASK44;
+      h2 += ((t1 >> 24) & MASK42) | hibit;
+
+      /* h *= r, using 2^130 = 5 mod p */
+      d0 = (poly1305_u128)h0 * r0 + (poly1305_u128)h1 * s2 + (poly1305_u128)h2 * s1;
+      d1 = (poly1305_u128)h0 * r1 + (poly1305_u128)h1 * r0 + (poly1305_u128)h2 * s2;
+      d2 = (poly1305_u128)h0 * r2 + (poly1305_u128)h1 * r1 + (poly1305_u128)h2 * r0;
+
+      c  = (ulong64)(d0 >> 44); h0 = (ulong64)d0 & MASK44;
+      d1 += c;
+      c  = (ulong64)(d1 >> 44); h1 = (ulong64)d1 & MASK44;
+      d2 += c;
+      c  = (ulong64)(d2 >> 42); h2 = (ulong64)d2 & MASK42;
+      h0 += c * 5;
+      c  = h0 >> 44; h0 &= MASK44;
+      h1 += c;
+
+      m     += 16;
+      bytes -= 16;
+   }
+
+   st->h[0] = h0;
+   st->h[1] = h1;
+   st->h[2] = h2;
+}
+
+static void poly1305_setkey(poly1305_state *st, const unsigned char *key)
+{
+   ulong64 t0, t1;
+
+   /* r &= 0xffffffc0ffffffc0ffffffc0fffffff */
+   LOAD64L(t0, key + 0);
+   LOAD64L(t1, key + 8);
+   st->r[0] = t0 & CONST64(0xffc0fffffff);
+   st->r[1] = ((t0 >> 44) | (t1 << 20)) & CONST64(0xfffffc0ffff);
+   st->r[2] = (t1 >> 24) & CONST64(0x00ffffffc0f);
+   st->h[0] = st->h[1] = st->h[2] = 0;
+   LOAD64L(st->pad[0], key + 16);
+   LOAD64L(st->pad[1], key + 24);
+}
+
+static void poly1305_finish(poly1305_state *st, unsigned char *mac)
+{
+   ulong64 h0, h1, h2, g0, g1, g2, c, t0, t1;
+
+   h0 = st->h[0];
+   h1 = st->h[1];
+   h2 = st->h[2];
+
+   /* fully carry h */
+   c = h1 >> 44; h1 &= MASK44;
+   h2 += c;     c = h2 >> 42; h2 &= MASK42;
+   h0 += c * 5; c = h0 >> 44; h0 &= MASK44;
+   h1 += c;     c = h1 >> 44; h1 &= MASK44;
+   h2 += c;     c = h2 >> 42; h2 &= MASK42;
+   h0 += c * 5; c = h0 >> 44; h0 &= MASK44;
+   h1 += c;
+
+   /* g = h - p, and pick h or g without branching */
+   g0 = h0 + 5; c = g0 >> 44; g0 &= MASK44;
+   g1 = h1 + c; c = g1 >> 44; g1 &= MASK44;
+   g2 = h2 + c - ((ulong64)1 << 42);
+
+   c = (g2 >> 63) - 1;
+   g0 &= c;
+   g1 &= c;
+   g2 &= c;
+   c = ~c;
+   h0 = (h0 & c) | g0;
+   h1 = (h1 & c) | g1;
+   h2 = (h2 & c) | g2;
+
+   /* h = (h + pad) mod 2^128 */
+   t0 = st->pad[0];
+   t1 = st->pad[1];
+   h0 += t0 & MASK44;                                   c = h0 >> 44; h0 &= MASK44;
+   h1 += (((t0 >> 44) | (t1 << 20)) & MASK44) + c;      c = h1 >> 44; h1 &= MASK44;
+   h2 += ((t1 >> 24) & MASK42) + c;                     h2 &= MASK42;
+
+   h0 = h0 | (h1 << 44);
+   h1 = (h1 >> 20) | (h2 << 24);
+   STORE64L(h0, mac + 0);
+   STORE64L(h1, mac + 8);
+}
+
+#else /* 26 bit limbs */
+
+#define MASK26 0x3ffffffUL
+
+static void poly1305_blocks(poly1305_state *st, const unsigned char *m, unsigned long bytes)
+{
+   const ulong32 hibit = st->final ? 0 : (1UL << 24); /* 1 << 128 */
+   ulong32 r0, r1, r2, r3, r4, s1, s2, s3, s4, h0, h1, h2, h3, h4, c, t;
+   ulong64 d0, d1, d2, d3, d4;
+
+   r0 = st->r[0]; r1 = st->r[1]; r2 = st->r[2]; r3 = st->r[3]; r4 = st->r[4];
+   s1 = r1 * 5;   s2 = r2 * 5;   s3 = r3 * 5;   s4 = r4 * 5;
+   h0 = st->h[0]; h1 = st->h[1]; h2 = st->h[2]; h3 = st->h[3]; h4 = st->h[4];
+
+   while (bytes >= 16) {
+      LOAD32L(t, m + 0);  h0 += t & MASK26;
+      LOAD32L(t, m + 3);  h1 += (t >> 2) & MASK26;
+      LOAD32L(t, m + 6);  h2 += (t >> 4) & MASK26;
+      LOAD32L(t, m + 9);  h3 += (t >> 6) & MASK26;
+      LOAD32L(t, m + 12); h4 += (t >> 8) | hibit;
+
+      /* h *= r, using 2^130 = 5 mod p */
+      d0 = (ulong64)h0 * r0 + (ulong64)h1 * s4 + (ulong64)h2 * s3 + (ulong64)h3 * s2 + (ulong64)h4 * s1;
+      d1 = (ulong64)h0 * r1 + (ulong64)h1 * r0 + (ulong64)h2 * s4 + (ulong64)h3 * s3 + (ulong64)h4 * s2;
+      d2 = (ulong64)h0 * r2 + (ulong64)h1 * r1 + (ulong64)h2 * r0 + (ulong64)h3 * s4 + (ulong64)h4 * s3;
+      d3 = (ulong64)h0 * r3 + (ulong64)h1 * r2 + (ulong64)h2 * r1 + (ulong64)h3 * r0 + (ulong64)h4 * s4;
+      d4 = (ulong64)h0 * r4 + (ulong64)h1 * r3 + (ulong64)h2 * r2 + (ulong64)h3 * r1 + (ulong64)h4 * r0;
+
+                    c = (ulong32)(d0 >> 26); h0 = (ulong32)d0 & MASK26;
+      d1 += c;      c = (ulong32)(d1 >> 26); h1 = (ulong32)d1 & MASK26;
+      d2 += c;      c = (ulong32)(d2 >> 26); h2 = (ulong32)d2 & MASK26;
+      d3 += c;      c = (ulong32)(d3 >> 26); h3 = (ulong32)d3 & MASK26;
+      d4 += c;      c = (ulong32)(d4 >> 26); h4 = (ulong32)d4 & MASK26;
+      h0 += c * 5;  c = h0 >> 26;            h0 &= MASK26;
+      h1 += c;
+
+      m     += 16;
+      bytes -= 16;
+   }
+
+   st->h[0] = h0; st->h[1] = h1; st->h[2] = h2; st->h[3] = h3; st->h[4] = h4;
+}
+
+static void poly1305_setkey(poly1305_state *st, const unsigned char *key)
+{
+   ulong32 t;
+   int i;
+
+   /* r &= 0xffffffc0ffffffc0ffffffc0fffffff */
+   LOAD32L(t, key + 0);  st->r[0] = t & 0x3ffffffUL;
+   LOAD32L(t, key + 3);  st->r[1] = (t >> 2) & 0x3ffff03UL;
+   LOAD32L(t, key + 6);  st->r[2] = (t >> 4) & 0x3ffc0ffUL;
+   LOAD32L(t, key + 9);  st->r[3] = (t >> 6) & 0x3f03fffUL;
+   LOAD32L(t, key + 12); st->r[4] = (t >> 8) & 0x00fffffUL;
+   for (i = 0; i < 5; i++) {
+      st->h[i] = 0;
+   }
+   for (i = 0; i < 4; i++) {
+      LOAD32L(st->pad[i], key + 16 + 4 * i);
+   }
+}
+
+static void poly1305_finish(poly1305_state *st, unsigned char *mac)
+{
+   ulong32 h0, h1, h2, h3, h4, g0, g1, g2, g3, g4, c, mask;
+   ulong64 f;
+
+   h0 = st->h[0]; h1 = st->h[1]; h2 = st->h[2]; h3 = st->h[3]; h4 = st->h[4];
+
+   /* fully carry h */
+                c = h1 >> 26; h1 &= MASK26;
+   h2 += c;     c = h2 >> 26; h2 &= MASK26;
+   h3 += c;     c = h3 >> 26; h3 &= MASK26;
+   h4 += c;     c = h4 >> 26; h4 &= MASK26;
+   h0 += c * 5; c = h0 >> 26; h0 &= MASK26;
+   h1 += c;
+
+   /* g = h - p, and pick h or g without branching */
+   g0 = h0 + 5; c = g0 >> 26; g0 &= MASK26;
+   g1 = h1 + c; c = g1 >> 26; g1 &= MASK26;
+   g2 = h2 + c; c = g2 >> 26; g2 &= MASK26;
+   g3 = h3 + c; c = g3 >> 26; g3 &= MASK26;
+   g4 = (h4 + c - (1UL << 26)) & 0xFFFFFFFFUL;
+
+   mask = ((g4 >> 31) - 1) & 0xFFFFFFFFUL;
+   g0 &= mask; g1 &= mask; g2 &= mask; g3 &= mask; g4 &= mask;
+   mask = ~mask & 0xFFFFFFFFUL;
+   h0 = (h0 & mask) | g0;
+   h1 = (h1 & mask) | g1;
+   h2 = (h2 & mask) | g2;
+   h3 = (h3 & mask) | g3;
+   h4 = (h4 & mask) | g4;
+
+   /* h = (h + pad) mod 2^128 */
+   h0 = ((h0      ) | (h1 << 26)) & 0xFFFFFFFFUL;
+   h1 = ((h1 >>  6) | (h2 << 20)) & 0xFFFFFFFFUL;
+   h2 = ((h2 >> 12) | (h3 << 14)) & 0xFFFFFFFFUL;
+   h3 = ((h3 >> 18) | (h4 <<  8)) & 0xFFFFFFFFUL;
+
+   f = (ulong64)h0 + st->pad[0];             STORE32L((ulong32)(f & 0xFFFFFFFFUL), mac + 0);
+   f = (ulong64)h1 + st->pad[1] + (f >> 32); STORE32L((ulong32)(f & 0xFFFFFFFFUL), mac + 4);
+   f = (ulong64)h2 + st->pad[2] + (f >> 32); STORE32L((ulong32)(f & 0xFFFFFFFFUL), mac + 8);
+   f = (ulong64)h3 + st->pad[3] + (f >> 32); STORE32L((ulong32)(f & 0xFFFFFFFFUL), mac + 12);
+}
+
+#endif /* LTC_POLY1305_64 */
+
+/**
+   Initialize a Poly1305 state
+   @param st      The state to initialize
+   @param key     The one-time key, r followed by s
+   @param keylen  The length of the key (octets), must be 32
+   @return CRYPT_OK if successful
+*/
+int poly1305_init(poly1305_state *st, const unsigned char *key, unsigned long keylen)
+{
+   LTC_ARGCHK(st  != NULL);
+   LTC_ARGCHK(key != NULL);
+   LTC_ARGCHK(keylen == 32);
+
+   poly1305_setkey(st, key);
+   st->leftover = 0;
+   st->final    = 0;
+   return CRYPT_OK;
+}
+
+/**
+   Process data through Poly1305
+   @param st     The Poly1305 state
+   @param in     The data to authenticate
+   @param inlen  The length of the data (octets)
+   @return CRYPT_OK if successful
+*/
+int poly1305_process(poly1305_state *st, const unsigned char *in, unsigned long inlen)
+{
+   unsigned long i, want;
+
+   if (inlen == 0) {
+      return CRYPT_OK;
+   }
+   LTC_ARGCHK(st != NULL);
+   LTC_ARGCHK(in != NULL);
+
+   /* top up a partial block first */
+   if (st->leftover) {
+      want = MIN(16 - st->leftover, inlen);
+      for (i = 0; i < want; i++) {
+         st->buffer[st->leftover + i] = in[i];
+      }
+      inlen -= want;
+      in    += want;
+      st->leftover += want;
+      if (st->leftover < 16) {
+         return CRYPT_OK;
+      }
+      poly1305_blocks(st, st->buffer, 16);
+      st->leftover = 0;
+   }
+
+   if (inlen >= 16) {
+      want = inlen & ~15UL;
+      poly1305_blocks(st, in, want);
+      in    += want;
+      inlen -= want;
+   }
+
+   for (i = 0; i < inlen; i++) {
+      st->buffer[st->leftover + i] = in[i];
+   }
+   st->leftover += inlen;
+   return CRYPT_OK;
+}
+
+/**
+   Terminate a Poly1305 session
+   @param st      The Poly1305 state
+   @param mac     [out] The destination of the tag
+   @param maclen  [in/out] The max size and resulting size of the tag
+   @return CRYPT_OK if successful
+*/
+int poly1305_done(poly1305_state *st, unsigned char *mac, unsigned long *maclen)
+{
+   LTC_ARGCHK(st     != NULL);
+   LTC_ARGCHK(mac    != NULL);
+   LTC_ARGCHK(maclen != NULL);
+
+   if (*maclen < 16) {
+      return CRYPT_BUFFER_OVERFLOW;
+   }
+
+   /* the last partial block is padded with a single one bit */
+   if (st->leftover) {
+      st->buffer[st->leftover] = 1;
+      XMEMSET(st->buffer + st->leftover + 1, 0, 15 - st->leftover);
+      st->final = 1;
+      poly1305_blocks(st, st->buffer, 16);
+   }
+   poly1305_finish(st, mac);
+   *maclen = 16;
+
+   zeromem(st, sizeof(poly1305_state));
+   return CRYPT_OK;
+}
+
+#endif
@@ -0,0 +1,59 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis
+ *
+ * LibTomCrypt is a library that provides various cryptographic
+ * algorithms in a highly modular and flexible manner.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtomcrypt.com
+ */
+#include "tomcrypt.h"
+
+/**
+   @file poly1305_test.c
+   Poly1305 self test
+*/
+
+#ifdef LTC_POLY1305
+
+/**
+   Self-test Poly1305 with the RFC 7539 section 2.5.2 vector
+   @return CRYPT_OK if successful, CRYPT_NOP if self-testing has been disabled
+*/
+int poly1305_test(void)
+{
+#ifndef LTC_TEST
+   return CRYPT_NOP;
+#else
+   static const unsigned char key[] = {
+      0x85, 0xd6, 0xbe, 0x78, 0x57, 0x55, 0x6d, 0x33, 0x7f, 0x44, 0x52, 0xfe, 0x42, 0xd5, 0x06, 0xa8,
+      0x01, 0x03, 0x80, 0x8a, 0xfb, 0x0d, 0xb2, 0xfd, 0x4a, 0xbf, 0xf6, 0xaf, 0x41, 0x49, 0xf5, 0x1b
+   };
+   static const char msg[] = "Cryptographic Forum Research Group";
+   static const unsigned char tag[] = {
+      0xa8, 0x06, 0x1d, 0xc1, 0x30, 0x51, 0x36, 0xc6, 0xc2, 0x2b, 0x8b, 0xaf, 0x0c, 0x01, 0x27, 0xa9
+   };
+   poly1305_state st;
+   unsigned char out[16];
+   unsigned long len, outlen;
+   int err;
+
+   /* all at once, then split so the partial block buffering is used */
+   for (len = 0; len < 20; len += 7) {
+      outlen = sizeof(out);
+      if ((err = poly1305_init(&st, key, sizeof(key))) != CRYPT_OK
+          || (err = poly1305_process(&st, (const unsigned char *)msg, len)) != CRYPT_OK
+          || (err = poly1305_process(&st, (const unsigned char *)msg + len, sizeof(msg) - 1 - len)) != CRYPT_OK
+          || (err = poly1305_done(&st, out, &outlen)) != CRYPT_OK) {
+         return err;
+      }
+      if (outlen != sizeof(tag) || XMEMCMP(out, tag, sizeof(tag)) != 0) {
+         return CRYPT_FAIL_TESTVECTOR;
+      }
+   }
+   return CRYPT_OK;
+#endif
+}
+
+#endif
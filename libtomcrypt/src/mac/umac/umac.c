@@ -0,0 +1,428 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis
+ *
+ * LibTomCrypt is a library that provides various cryptographic
+ * algorithms in a highly modular and flexible manner.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtomcrypt.com
+ */
+#include "tomcrypt.h"
+
+/**
+   @file umac.c
+   UMAC message authentication code (RFC 4418), with 64 or 128 bit tags
+   as used by umac-64@openssh.com and umac-128@openssh.com.
+
+   The message is hashed in 1024 byte blocks by NH (level 1); a message
+   longer than one block has the NH outputs compressed by a polynomial
+   hash mod 2^64 - 59 (level 2), and the result is hashed to 32 bits per
+   stream by an inner product mod 2^36 - 5 (level 3).  The tag is that
+   XOR an AES encryption of the nonce.  All subkeys come from the block
+   cipher passed to umac_init(), which must have 16 byte blocks.
+*/
+
+#ifdef LTC_UMAC
+
+#define P36 CONST64(0x0000000FFFFFFFFB)   /* 2^36 -  5 */
+#define P64 CONST64(0xFFFFFFFFFFFFFFC5)   /* 2^64 - 59 */
+#define M36 CONST64(0x0000000FFFFFFFFF)
+
+/* level 2 only handles this many NH outputs, 16 MB of message; longer
+   messages need the 128 bit polynomial, which SSH packets never reach */
+#define UMAC_MAX_MSGLEN ((ulong64)1 << 24)
+
+/* len bytes of key material for subkey index, AES-CTR style */
+static int umac_kdf(umac_state *st, symmetric_key *skey, int index, unsigned char *out, unsigned long len)
+{
+   unsigned char in[16], tmp[16];
+   unsigned long n;
+   int counter, err;
+
+   zeromem(in, sizeof(in));
+   in[7] = (unsigned char)index;
+   for (counter = 1; len > 0; counter++) {
+      in[15] = (unsigned char)counter;
+      if ((err = cipher_descriptor[st->cipher].ecb_encrypt(in, tmp, skey)) != CRYPT_OK) {
+         return err;
+      }
+      n = MIN(len, 16);
+      XMEMCPY(out, tmp, n);
+      out += n;
+      len -= n;
+   }
+   zeromem(tmp, sizeof(tmp));
+   return CRYPT_OK;
+}
+
+static void umac_reset(umac_state *st)
+{
+   int i;
+
+   for (i = 0; i < st->streams; i++) {
+      st->nh[i]   = 0;
+      st->poly[i] = 1;
+   }
+   st->msglen = 0;
+   st->l1off  = 0;
+   st->buflen = 0;
+}
+
+/**
+   Initialize UMAC
+   @param st      [out] The state to initialize
+   @param cipher  The index of the cipher, AES
+   @param key     The secret key
+   @param keylen  The length of the key (octets), 16
+   @param taglen  The length of the tags (octets), 8 or 16
+   @return CRYPT_OK if successful
+*/
+int umac_init(umac_state *st, int cipher, const unsigned char *key, unsigned long keylen, unsigned long taglen)
+{
+   symmetric_key skey;
+   unsigned char buf[(8 * UMAC_MAX_STREAMS + 4) * 8];
+   unsigned long nhlen;
+   ulong32 t;
+   int i, j, err;
+
+   LTC_ARGCHK(st  != NULL);
+   LTC_ARGCHK(key != NULL);
+
+   if ((err = cipher_is_valid(cipher)) != CRYPT_OK) {
+      return err;
+   }
+   if (cipher_descriptor[cipher].block_length != 16) {
+      return CRYPT_INVALID_CIPHER;
+   }
+   if (keylen != UMAC_KEY_LEN) {
+      return CRYPT_INVALID_KEYSIZE;
+   }
+   if (taglen != 8 && taglen != 16) {
+      return CRYPT_INVALID_ARG;
+   }
+
+   st->cipher  = cipher;
+   st->taglen  = taglen;
+   st->streams = (int)(taglen / 4);
+   if ((err = cipher_descriptor[cipher].setup(key, (int)keylen, 0, &skey)) != CRYPT_OK) {
+      return err;
+   }
+
+   /* the pad key */
+   if ((err = umac_kdf(st, &skey, 0, buf, UMAC_KEY_LEN)) != CRYPT_OK) {
+      goto done;
+   }
+   if ((err = cipher_descriptor[cipher].setup(buf, UMAC_KEY_LEN, 0, &st->prf)) != CRYPT_OK) {
+      goto done;
+   }
+   st->padvalid = 0;
+
+   /* NH key, big endian words, stored little endian to match the message */
+   nhlen = UMAC_L1_KEY_LEN + UMAC_L1_KEY_SHIFT * (st->streams - 1);
+   if ((err = umac_kdf(st, &skey, 1, st->nhkey, nhlen)) != CRYPT_OK) {
+      goto done;
+   }
+   for (i = 0; i < (int)nhlen; i += 4) {
+      LOAD32H(t, st->nhkey + i);
+      STORE32L(t, st->nhkey + i);
+   }
+
+   /* level 2 and 3 keys */
+   if ((err = umac_kdf(st, &skey, 2, buf, sizeof(buf))) != CRYPT_OK) {
+      goto done;
+   }
+   for (i = 0; i < st->streams; i++) {
+      LOAD64H(st->polykey[i], buf + 24 * i);
+      st->polykey[i] &= CONST64(0x01ffffff01ffffff);
+   }
+   if ((err = umac_kdf(st, &skey, 3, buf, sizeof(buf))) != CRYPT_OK) {
+      goto done;
+   }
+   for (i = 0; i < st->streams; i++) {
+      for (j = 0; j < 4; j++) {
+         LOAD64H(st->ipkey[4 * i + j], buf + (8 * i + 4) * 8 + 8 * j);
+         st->ipkey[4 * i + j] %= P36;
+      }
+   }
+   if ((err = umac_kdf(st, &skey, 4, buf, 4 * st->streams)) != CRYPT_OK) {
+      goto done;
+   }
+   for (i = 0; i < st->streams; i++) {
+      LOAD32H(st->iptrans[i], buf + 4 * i);
+   }
+
+#ifdef LTC_UMAC_SSE2
+   st->simd = (crypt_cpu_features() & LTC_CPU_SSE2) != 0;
+#elif defined(LTC_UMAC_NEON)
+   st->simd = (crypt_cpu_features() & LTC_CPU_NEON) != 0;
+#endif
+#ifdef LTC_UMAC_AVX2
+   st->avx2 = umac_avx2_is_supported();
+#endif
+   umac_reset(st);
+
+done:
+   cipher_descriptor[cipher].done(&skey);
+   zeromem(&skey, sizeof(skey));
+   zeromem(buf, sizeof(buf));
+   return err;
+}
+
+/* portable NH, see the kernels for the same with SIMD */
+static void umac_nh(const unsigned char *key, const unsigned char *in, unsigned long len, int streams, ulong64 *nh)
+{
+   const unsigned char *k;
+   ulong32 a, b, ka, kb;
+   ulong64 h;
+   unsigned long i;
+   int s, j;
+
+   for (s = 0; s < streams; s++) {
+      k = key + UMAC_L1_KEY_SHIFT * s;
+      h = nh[s];
+      for (i = 0; i < len; i += 32) {
+         for (j = 0; j < 16; j += 4) {
+            LOAD32L(a,  in + i + j);
+            LOAD32L(b,  in + i + j + 16);
+            LOAD32L(ka, k  + i + j);
+            LOAD32L(kb, k  + i + j + 16);
+            h += (ulong64)((a + ka) & 0xFFFFFFFFUL) * ((b + kb) & 0xFFFFFFFFUL);
+         }
+      }
+      nh[s] = h;
+   }
+}
+
+/* NH over whole 32 byte groups at the current offset into the block */
+static void umac_nh_blocks(umac_state *st, const unsigned char *in, unsigned long len)
+{
+   const unsigned char *key = st->nhkey + st->l1off;
+
+   st->l1off += len;
+#ifdef LTC_UMAC_AVX2
+   if (st->avx2) {
+      umac_nh_avx2(key, in, len, st->streams, st->nh);
+      return;
+   }
+#endif
+#ifdef LTC_UMAC_SSE2
+   if (st->simd) {
+      umac_nh_sse2(key, in, len, st->streams, st->nh);
+      return;
+   }
+#elif defined(LTC_UMAC_NEON)
+   if (st->simd) {
+      umac_nh_neon(key, in, len, st->streams, st->nh);
+      return;
+   }
+#endif
+   umac_nh(key, in, len, st->streams, st->nh);
+}
+
+/* finish the NH sums of the block, zero padded to 32 bytes, with its
+   length in bits added */
+static void umac_l1_done(umac_state *st, ulong64 *out)
+{
+   ulong64 bits = (ulong64)(st->l1off + st->buflen) * 8;
+   int i;
+
+   if (st->buflen > 0 || st->l1off == 0) {
+      zeromem(st->buf + st->buflen, sizeof(st->buf) - st->buflen);
+      umac_nh_blocks(st, st->buf, sizeof(st->buf));
+   }
+   for (i = 0; i < st->streams; i++) {
+      out[i] = st->nh[i] + bits;
+      st->nh[i] = 0;
+   }
+   st->l1off  = 0;
+   st->buflen = 0;
+}
+
+/* cur * key + data mod 2^64 - 59, the key has 25 bit halves and the
+   result is only partially reduced */
+static ulong64 umac_poly64(ulong64 cur, ulong64 key, ulong64 data)
+{
+   ulong32 key_hi = (ulong32)(key >> 32), key_lo = (ulong32)(key & 0xFFFFFFFFUL),
+           cur_hi = (ulong32)(cur >> 32), cur_lo = (ulong32)(cur & 0xFFFFFFFFUL);
+   ulong64 x, t, res;
+
+   x = (ulong64)key_hi * cur_lo + (ulong64)cur_hi * key_lo;
+   res = ((ulong64)key_hi * cur_hi + (x >> 32)) * 59 + (ulong64)key_lo * cur_lo;
+
+   t = x << 32;
+   res += t;
+   if (res < t) {
+      res += 59;
+   }
+   res += data;
+   if (res < data) {
+      res += 59;
+   }
+   return res;
+}
+
+static void umac_l2(umac_state *st, const ulong64 *in)
+{
+   int i;
+
+   for (i = 0; i < st->streams; i++) {
+      if ((in[i] >> 32) == 0xFFFFFFFFUL) {
+         /* words in [2^64 - 2^32, 2^64) are split in two */
+         st->poly[i] = umac_poly64(st->poly[i], st->polykey[i], P64 - 1);
+         st->poly[i] = umac_poly64(st->poly[i], st->polykey[i], in[i] - 59);
+      } else {
+         st->poly[i] = umac_poly64(st->poly[i], st->polykey[i], in[i]);
+      }
+   }
+}
+
+/* inner product of the 16 bit pieces of x with the key, mod 2^36 - 5 */
+static ulong32 umac_l3(const ulong64 *key, ulong64 x)
+{
+   ulong64 t;
+
+   t  = key[0] * ((x >> 48) & 0xFFFF);
+   t += key[1] * ((x >> 32) & 0xFFFF);
+   t += key[2] * ((x >> 16) & 0xFFFF);
+   t += key[3] * (x & 0xFFFF);
+
+   t = (t & M36) + 5 * (t >> 36);
+   if (t >= P36) {
+      t -= P36;
+   }
+   return (ulong32)(t & 0xFFFFFFFFUL);
+}
+
+/**
+   Process data through UMAC
+   @param st     The UMAC state
+   @param in     The data to MAC
+   @param inlen  The length of the data (octets)
+   @return CRYPT_OK if successful
+*/
+int umac_process(umac_state *st, const unsigned char *in, unsigned long inlen)
+{
+   ulong64 nh[UMAC_MAX_STREAMS];
+   unsigned long n, m;
+
+   LTC_ARGCHK(st != NULL);
+   LTC_ARGCHK(in != NULL || inlen == 0);
+
+   if (inlen > UMAC_MAX_MSGLEN - st->msglen) {
+      return CRYPT_OVERFLOW;
+   }
+   st->msglen += inlen;
+
+   while (inlen > 0) {
+      /* a full block is only hashed by level 2 once more data follows,
+         a message of exactly one block is finished by level 3 alone */
+      if (st->l1off == UMAC_L1_KEY_LEN) {
+         umac_l1_done(st, nh);
+         umac_l2(st, nh);
+      }
+      n = MIN(inlen, UMAC_L1_KEY_LEN - st->l1off - st->buflen);
+
+      if (st->buflen > 0) {
+         m = MIN(n, sizeof(st->buf) - st->buflen);
+         XMEMCPY(st->buf + st->buflen, in, m);
+         st->buflen += m;
+         in    += m;
+         inlen -= m;
+         n     -= m;
+         if (st->buflen < sizeof(st->buf)) {
+            continue;
+         }
+         umac_nh_blocks(st, st->buf, sizeof(st->buf));
+         st->buflen = 0;
+      }
+
+      m = n & ~31UL;
+      if (m > 0) {
+         umac_nh_blocks(st, in, m);
+         in    += m;
+         inlen -= m;
+         n     -= m;
+      }
+      if (n > 0) {
+         XMEMCPY(st->buf, in, n);
+         st->buflen = n;
+         in    += n;
+         inlen -= n;
+      }
+   }
+   return CRYPT_OK;
+}
+
+/**
+   Terminate a UMAC session, the state is left ready for the next message
+   @param st        The UMAC state
+   @param nonce     The nonce for this message
+   @param noncelen  The length of the nonce (octets), 1 to 16
+   @param out       [out] The destination of the tag
+   @param outlen    [in/out] The max size and resulting size of the tag
+   @return CRYPT_OK if successful
+*/
+int umac_done(umac_state *st, const unsigned char *nonce, unsigned long noncelen, unsigned char *out, unsigned long *outlen)
+{
+   ulong64 nh[UMAC_MAX_STREAMS];
+   unsigned char tmp[16];
+   unsigned int idx = 0;
+   unsigned long i;
+   int err;
+
+   LTC_ARGCHK(st     != NULL);
+   LTC_ARGCHK(nonce  != NULL);
+   LTC_ARGCHK(out    != NULL);
+   LTC_ARGCHK(outlen != NULL);
+
+   if (noncelen < 1 || noncelen > 16) {
+      return CRYPT_INVALID_ARG;
+   }
+   if (*outlen < st->taglen) {
+      return CRYPT_BUFFER_OVERFLOW;
+   }
+
+   if (st->msglen > UMAC_L1_KEY_LEN) {
+      if (st->l1off + st->buflen > 0) {
+         umac_l1_done(st, nh);
+         umac_l2(st, nh);
+      }
+      for (i = 0; i < (unsigned long)st->streams; i++) {
+         if (st->poly[i] >= P64) {
+            st->poly[i] -= P64;
+         }
+         nh[i] = st->poly[i];
+      }
+   } else {
+      umac_l1_done(st, nh);
+   }
+   for (i = 0; i < (unsigned long)st->streams; i++) {
+      STORE32H(umac_l3(st->ipkey + 4 * i, nh[i]) ^ st->iptrans[i], out + 4 * i);
+   }
+
+   /* 64 bit tags take one half of the encrypted nonce, picked by its low
+      bit, so consecutive nonces share an encryption */
+   zeromem(tmp, sizeof(tmp));
+   XMEMCPY(tmp, nonce, noncelen);
+   if (st->taglen == 8) {
+      idx = tmp[noncelen - 1] & 1;
+      tmp[noncelen - 1] &= 0xFE;
+   }
+   if (!st->padvalid || XMEMCMP(tmp, st->nonce, sizeof(tmp)) != 0) {
+      if ((err = cipher_descriptor[st->cipher].ecb_encrypt(tmp, st->pad, &st->prf)) != CRYPT_OK) {
+         return err;
+      }
+      XMEMCPY(st->nonce, tmp, sizeof(tmp));
+      st->padvalid = 1;
+   }
+   for (i = 0; i < st->taglen; i++) {
+      out[i] ^= st->pad[st->taglen * idx + i];
+   }
+   *outlen = st->taglen;
+
+   umac_reset(st);
+   return CRYPT_OK;
+}
+
+#endif
@@ -0,0 +1,61 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis
+ *
+ * LibTomCrypt is a library that provides various cryptographic
+ * algorithms in a highly modular and flexible manner.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtomcrypt.com
+ */
+
+/**
+   @file umac_nh_neon.c
+   UMAC NH kernel for ARM NEON.
+
+   The same as the SSE2 kernel in umac_nh_x86.c, with vmlal doing two of
+   the 32x32->64 bit products and the accumulation at once.
+*/
+#include "tomcrypt.h"
+
+#ifdef LTC_UMAC_NEON
+
+#include <arm_neon.h>
+
+#define LOAD128(p) vreinterpretq_u32_u8(vld1q_u8(p))
+
+#define NH128(acc, d0, d1, k) do { \
+   uint32x4_t a_ = vaddq_u32(d0, LOAD128(k)); \
+   uint32x4_t b_ = vaddq_u32(d1, LOAD128((k) + 16)); \
+   acc = vmlal_u32(acc, vget_low_u32(a_), vget_low_u32(b_)); \
+   acc = vmlal_u32(acc, vget_high_u32(a_), vget_high_u32(b_)); \
+} while (0)
+
+#define SUM128(x) ((ulong64)vgetq_lane_u64(x, 0) + (ulong64)vgetq_lane_u64(x, 1))
+
+void umac_nh_neon(const unsigned char *key, const unsigned char *in, unsigned long len, int streams, ulong64 *nh)
+{
+   uint64x2_t h0, h1, h2, h3;
+   uint32x4_t d0, d1;
+   unsigned long i;
+
+   h0 = h1 = h2 = h3 = vdupq_n_u64(0);
+   for (i = 0; i < len; i += 32) {
+      d0 = LOAD128(in + i);
+      d1 = LOAD128(in + i + 16);
+      NH128(h0, d0, d1, key + i);
+      NH128(h1, d0, d1, key + i + 16);
+      if (streams == 4) {
+         NH128(h2, d0, d1, key + i + 32);
+         NH128(h3, d0, d1, key + i + 48);
+      }
+   }
+   nh[0] += SUM128(h0);
+   nh[1] += SUM128(h1);
+   if (streams == 4) {
+      nh[2] += SUM128(h2);
+      nh[3] += SUM128(h3);
+   }
+}
+
+#endif
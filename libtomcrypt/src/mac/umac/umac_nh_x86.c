@@ -0,0 +1,118 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis
+ *
+ * LibTomCrypt is a library that provides various cryptographic
+ * algorithms in a highly modular and flexible manner.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtomcrypt.com
+ */
+
+/**
+   @file umac_nh_x86.c
+   UMAC NH kernels for x86 with SSE2 and AVX2.
+
+   NH multiplies the sums of word j and word j + 4 of every 32 byte
+   group, each added to its key word mod 2^32, and adds the products
+   mod 2^64.  pmuludq does two of those 32x32->64 bit products per 128
+   bits; the odd words are shifted down to do the other two.  In the AVX2
+   kernel the two halves of a register belong to two streams, whose keys
+   are 16 bytes apart, so one unaligned load fetches the key words for
+   both.  The AVX2 kernel must only be called once umac_avx2_is_supported()
+   has returned non-zero.
+*/
+#include "tomcrypt.h"
+
+#ifdef LTC_UMAC_SSE2
+
+#include <emmintrin.h>
+#include <immintrin.h>
+
+#define SSE2_TARGET __attribute__((target("sse2")))
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+#define LOAD128(p) _mm_loadu_si128((const __m128i *)(p))
+#define LOAD256(p) _mm256_loadu_si256((const __m256i *)(p))
+
+/* acc += NH of one group, d0/d1 the two halves of the message words */
+#define NH128(acc, d0, d1, k) do { \
+   __m128i a_ = _mm_add_epi32(d0, LOAD128(k)); \
+   __m128i b_ = _mm_add_epi32(d1, LOAD128((k) + 16)); \
+   acc = _mm_add_epi64(acc, _mm_mul_epu32(a_, b_)); \
+   acc = _mm_add_epi64(acc, _mm_mul_epu32(_mm_srli_epi64(a_, 32), _mm_srli_epi64(b_, 32))); \
+} while (0)
+
+#define NH256(acc, d0, d1, k) do { \
+   __m256i a_ = _mm256_add_epi32(d0, LOAD256(k)); \
+   __m256i b_ = _mm256_add_epi32(d1, LOAD256((k) + 16)); \
+   acc = _mm256_add_epi64(acc, _mm256_mul_epu32(a_, b_)); \
+   acc = _mm256_add_epi64(acc, _mm256_mul_epu32(_mm256_srli_epi64(a_, 32), _mm256_srli_epi64(b_, 32))); \
+} while (0)
+
+/* the sum of the two 64 bit lanes */
+SSE2_TARGET
+static ulong64 sum128(__m128i x)
+{
+   ulong64 t[2];
+
+   _mm_storeu_si128((__m128i *)t, x);
+   return t[0] + t[1];
+}
+
+SSE2_TARGET
+void umac_nh_sse2(const unsigned char *key, const unsigned char *in, unsigned long len, int streams, ulong64 *nh)
+{
+   __m128i h0, h1, h2, h3, d0, d1;
+   unsigned long i;
+
+   h0 = h1 = h2 = h3 = _mm_setzero_si128();
+   for (i = 0; i < len; i += 32) {
+      d0 = LOAD128(in + i);
+      d1 = LOAD128(in + i + 16);
+      NH128(h0, d0, d1, key + i);
+      NH128(h1, d0, d1, key + i + 16);
+      if (streams == 4) {
+         NH128(h2, d0, d1, key + i + 32);
+         NH128(h3, d0, d1, key + i + 48);
+      }
+   }
+   nh[0] += sum128(h0);
+   nh[1] += sum128(h1);
+   if (streams == 4) {
+      nh[2] += sum128(h2);
+      nh[3] += sum128(h3);
+   }
+}
+
+int umac_avx2_is_supported(void)
+{
+   return (crypt_cpu_features() & LTC_CPU_AVX2) != 0;
+}
+
+AVX2_TARGET
+void umac_nh_avx2(const unsigned char *key, const unsigned char *in, unsigned long len, int streams, ulong64 *nh)
+{
+   __m256i h01, h23, d0, d1;
+   unsigned long i;
+
+   /* streams 0 and 1 in h01, 2 and 3 in h23, one group of the message
+      broadcast to both halves */
+   h01 = h23 = _mm256_setzero_si256();
+   for (i = 0; i < len; i += 32) {
+      d0 = _mm256_broadcastsi128_si256(LOAD128(in + i));
+      d1 = _mm256_broadcastsi128_si256(LOAD128(in + i + 16));
+      NH256(h01, d0, d1, key + i);
+      if (streams == 4) {
+         NH256(h23, d0, d1, key + i + 32);
+      }
+   }
+   nh[0] += sum128(_mm256_castsi256_si128(h01));
+   nh[1] += sum128(_mm256_extracti128_si256(h01, 1));
+   if (streams == 4) {
+      nh[2] += sum128(_mm256_castsi256_si128(h23));
+      nh[3] += sum128(_mm256_extracti128_si256(h23, 1));
+   }
+}
+
+#endif
@@ -0,0 +1,96 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis
+ *
+ * LibTomCrypt is a library that provides various cryptographic
+ * algorithms in a highly modular and flexible manner.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtomcrypt.com
+ */
+#include "tomcrypt.h"
+
+/**
+   @file umac_test.c
+   UMAC self test
+*/
+
+#ifdef LTC_UMAC
+
+/**
+   Self-test UMAC with the RFC 4418 appendix vectors, against AES
+   @return CRYPT_OK if successful, CRYPT_NOP if self-testing has been disabled
+*/
+int umac_test(void)
+{
+#ifndef LTC_TEST
+   return CRYPT_NOP;
+#else
+   static const struct {
+      const char *msg;         /* repeated count times */
+      unsigned long len, count;
+      unsigned char tag64[8], tag128[16];
+   } tests[] = {
+      { "a", 1, 0,
+        { 0x6E, 0x15, 0x5F, 0xAD, 0x26, 0x90, 0x0B, 0xE1 },
+        { 0x32, 0xFE, 0xDB, 0x10, 0x0C, 0x79, 0xAD, 0x58, 0xF0, 0x7F, 0xF7, 0x64, 0x3C, 0xC6, 0x04, 0x65 } },
+      { "a", 1, 3,
+        { 0x44, 0xB5, 0xCB, 0x54, 0x2F, 0x22, 0x01, 0x04 },
+        { 0x18, 0x5E, 0x4F, 0xE9, 0x05, 0xCB, 0xA7, 0xBD, 0x85, 0xE4, 0xC2, 0xDC, 0x3D, 0x11, 0x7D, 0x8D } },
+      { "a", 1, 1024,
+        { 0x26, 0xBF, 0x2F, 0x5D, 0x60, 0x11, 0x8B, 0xD9 },
+        { 0x7A, 0x54, 0xAB, 0xE0, 0x4A, 0xF8, 0x2D, 0x60, 0xFB, 0x29, 0x8C, 0x3C, 0xBD, 0x19, 0x5B, 0xCB } },
+      { "a", 1, 32768,
+        { 0x27, 0xF8, 0xEF, 0x64, 0x3B, 0x0D, 0x11, 0x8D },
+        { 0x7B, 0x13, 0x6B, 0xD9, 0x11, 0xE4, 0xB7, 0x34, 0x28, 0x6E, 0xF2, 0xBE, 0x50, 0x1F, 0x2C, 0x3C } },
+      { "abc", 3, 1,
+        { 0xD4, 0xD7, 0xB9, 0xF6, 0xBD, 0x4F, 0xBF, 0xCF },
+        { 0x88, 0x3C, 0x3D, 0x4B, 0x97, 0xA6, 0x19, 0x76, 0xFF, 0xCF, 0x23, 0x23, 0x08, 0xCB, 0xA5, 0xA5 } },
+      { "abc", 3, 500,
+        { 0xD4, 0xCF, 0x26, 0xDD, 0xEF, 0xD5, 0xC0, 0x1A },
+        { 0x88, 0x24, 0xA2, 0x60, 0xC5, 0x3C, 0x66, 0xA3, 0x6C, 0x92, 0x60, 0xA6, 0x2C, 0xB8, 0x3A, 0xA1 } },
+   };
+   static const unsigned char key[] = "abcdefghijklmnop", nonce[] = "bcdefghi";
+   umac_state st;
+   unsigned char buf[1024], out[16];
+   unsigned long outlen, count, n, len;
+   int cipher, err, i, t;
+
+   if ((cipher = find_cipher("aes")) == -1) {
+      return CRYPT_NOP;
+   }
+   for (i = 0; i < (int)(sizeof(tests)/sizeof(tests[0])); i++) {
+      len = tests[i].len;
+      for (t = 8; t <= 16; t += 8) {
+         if ((err = umac_init(&st, cipher, key, UMAC_KEY_LEN, t)) != CRYPT_OK) {
+            return err;
+         }
+         /* long runs of "a" go through a block at a time, the rest one
+            repetition at a time to use the buffering */
+         for (count = tests[i].count; count > 0; count -= n) {
+            if (len == 1) {
+               n = MIN(count, sizeof(buf));
+               XMEMSET(buf, 'a', n);
+            } else {
+               n = 1;
+               XMEMCPY(buf, tests[i].msg, len);
+            }
+            if ((err = umac_process(&st, buf, n * len)) != CRYPT_OK) {
+               return err;
+            }
+         }
+         outlen = sizeof(out);
+         if ((err = umac_done(&st, nonce, 8, out, &outlen)) != CRYPT_OK) {
+            return err;
+         }
+         if (outlen != (unsigned long)t
+             || XMEMCMP(out, t == 8 ? tests[i].tag64 : tests[i].tag128, t) != 0) {
+            return CRYPT_FAIL_TESTVECTOR;
+         }
+      }
+   }
+   return CRYPT_OK;
+#endif
+}
+
+#endif
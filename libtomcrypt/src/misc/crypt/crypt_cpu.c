@@ -0,0 +1,101 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis
+ *
+ * LibTomCrypt is a library that provides various cryptographic
+ * algorithms in a highly modular and flexible manner.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtomcrypt.com
+ */
+#include "tomcrypt.h"
+
+/**
+  @file crypt_cpu.c
+  Probe the CPU once for the instruction set extensions the kernels use.
+
+  Every *_is_supported() check is answered from crypt_cpu_features(), so
+  they all agree, and crypt_cpu_disable() can turn kernels off for the
+  whole process, eg to fall back to the portable C code.  Disable before
+  the first key setup or sha*_accel_init(), states set up earlier keep
+  the kernels they chose.
+*/
+
+#if defined(__GNUC__) && !defined(LTC_NO_ASM) && (defined(__x86_64__) || defined(__i386__))
+#define CPU_X86
+#include <cpuid.h>
+#elif defined(__GNUC__) && !defined(LTC_NO_ASM) && defined(__aarch64__) && defined(__linux__)
+#define CPU_ARM64
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+
+static unsigned long cpu_features, cpu_disabled;
+static int cpu_probed;
+
+static unsigned long cpu_probe(void)
+{
+   unsigned long f = 0;
+#ifdef CPU_X86
+   unsigned int eax, ebx, ecx, edx, lo, hi;
+
+   if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+      return 0;
+   }
+   if (edx & bit_SSE2)   f |= LTC_CPU_SSE2;
+   if (ecx & bit_SSSE3)  f |= LTC_CPU_SSSE3;
+   if (ecx & bit_SSE4_1) f |= LTC_CPU_SSE41;
+   if (ecx & bit_AES)    f |= LTC_CPU_AESNI;
+   if (ecx & bit_PCLMUL) f |= LTC_CPU_PCLMUL;
+   /* AVX2 also needs the OS to save the ymm registers, AVX-512 the
+      opmask and zmm ones as well */
+   if ((ecx & bit_OSXSAVE) && (ecx & bit_AVX)) {
+      __asm__ __volatile__ ("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+      if ((lo & 6) == 6 && __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+         if (ebx & bit_AVX2) f |= LTC_CPU_AVX2;
+         if ((lo & 0xE6) == 0xE6 && (ebx & bit_AVX512F) && (ebx & bit_AVX512IFMA)) {
+            f |= LTC_CPU_AVX512IFMA;
+         }
+      }
+   }
+   if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+      if ((ebx & bit_BMI) && (ebx & bit_BMI2)) f |= LTC_CPU_BMI2;
+      if (ebx & bit_SHA) f |= LTC_CPU_SHA;
+   }
+#else
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+   /* the NEON kernels are only built when the target guarantees it */
+   f |= LTC_CPU_NEON;
+#endif
+#ifdef CPU_ARM64
+   {
+      unsigned long hwcap = getauxval(AT_HWCAP);
+      if (hwcap & HWCAP_SHA1) f |= LTC_CPU_ARMSHA1;
+      if (hwcap & HWCAP_SHA2) f |= LTC_CPU_ARMSHA2;
+   }
+#endif
+#endif
+   return f;
+}
+
+/**
+  The instruction set extensions this CPU has, less any disabled
+  @return A mask of LTC_CPU_* flags
+*/
+unsigned long crypt_cpu_features(void)
+{
+   if (!cpu_probed) {
+      cpu_features = cpu_probe();
+      cpu_probed = 1;
+   }
+   return cpu_features & ~cpu_disabled;
+}
+
+/**
+  Stop kernels that need any of the given extensions from being used
+  @param features   A mask of LTC_CPU_* flags, LTC_CPU_ALL for portable code only
+*/
+void crypt_cpu_disable(unsigned long features)
+{
+   cpu_disabled |= features;
+}
@@ -18,6 +18,70 @@
 
 #ifdef LTC_CBC_MODE
 
+/* Number of ciphertext blocks decrypted per pass of the wide path */
+#define CBC_STRIPE_BLOCKS 8
+
+/**
+  Wide CBC path for ciphers without an accel_cbc_decrypt hook.  CBC
+  decryption has no chaining dependency between the block cipher calls,
+  so each pass decrypts CBC_STRIPE_BLOCKS blocks together (through
+  accel_ecb_decrypt when the cipher has one) and then XORs every block
+  with the ciphertext block before it.  The XOR runs from the last block
+  back to the first so that ct and pt may be the same buffer.
+  @param ct      Ciphertext
+  @param pt      [out] Plaintext
+  @param stripes Number of CBC_STRIPE_BLOCKS * blocklen stripes to process
+  @param cbc     CBC state
+  @return CRYPT_OK if successful
+*/
+static int cbc_decrypt_stripes(const unsigned char *ct, unsigned char *pt, unsigned long stripes, symmetric_CBC *cbc)
+{
+   unsigned char tmp[CBC_STRIPE_BLOCKS * 16], nextiv[16];
+   const unsigned char *prev;
+   unsigned long stripelen = CBC_STRIPE_BLOCKS * cbc->blocklen;
+   int b, x, err;
+
+   while (stripes--) {
+      if (cipher_descriptor[cbc->cipher].accel_ecb_decrypt != NULL) {
+         if ((err = cipher_descriptor[cbc->cipher].accel_ecb_decrypt(ct, tmp, CBC_STRIPE_BLOCKS, &cbc->key)) != CRYPT_OK) {
+            return err;
+         }
+      } else {
+         for (b = 0; b < CBC_STRIPE_BLOCKS; b++) {
+            if ((err = cipher_descriptor[cbc->cipher].ecb_decrypt(ct + b * cbc->blocklen, tmp + b * cbc->blocklen, &cbc->key)) != CRYPT_OK) {
+               return err;
+            }
+         }
+      }
+
+      /* the last ciphertext block chains into the next stripe */
+      XMEMCPY(nextiv, ct + stripelen - cbc->blocklen, cbc->blocklen);
+
+      for (b = CBC_STRIPE_BLOCKS - 1; b >= 0; b--) {
+         prev = (b == 0) ? cbc->IV : ct + (b - 1) * cbc->blocklen;
+#ifdef LTC_FAST
+         for (x = 0; x < cbc->blocklen; x += sizeof(LTC_FAST_TYPE)) {
+            *((LTC_FAST_TYPE*)(pt + b * cbc->blocklen + x)) = *((LTC_FAST_TYPE*)(tmp + b * cbc->blocklen + x)) ^
+                                                              *((LTC_FAST_TYPE*)((unsigned char *)prev + x));
+         }
+#else
+         for (x = 0; x < cbc->blocklen; x++) {
+            pt[b * cbc->blocklen + x] = tmp[b * cbc->blocklen + x] ^ prev[x];
+         }
+#endif
+      }
+
+      XMEMCPY(cbc->IV, nextiv, cbc->blocklen);
+      ct += stripelen;
+      pt += stripelen;
+   }
+
+#ifdef LTC_CLEAN_STACK
+   zeromem(tmp, sizeof(tmp));
+#endif
+   return CRYPT_OK;
+}
+
 /**
   CBC decrypt
   @param ct     Ciphertext
@@ -61,6 +125,16 @@ int cbc_decrypt(const unsigned char *ct, unsigned char *pt, unsigned long len, s
    if (cipher_descriptor[cbc->cipher].accel_cbc_decrypt != NULL) {
       return cipher_descriptor[cbc->cipher].accel_cbc_decrypt(ct, pt, len / cbc->blocklen, cbc->IV, &cbc->key);
    } else {
+      if (cbc->blocklen <= 16 && len >= (unsigned long)(CBC_STRIPE_BLOCKS * cbc->blocklen)) {
+         unsigned long stripelen = CBC_STRIPE_BLOCKS * cbc->blocklen;
+         if ((err = cbc_decrypt_stripes(ct, pt, len / stripelen, cbc)) != CRYPT_OK) {
+            return err;
+         }
+         ct  += (len / stripelen) * stripelen;
+         pt  += (len / stripelen) * stripelen;
+         len %= stripelen;
+      }
+
       while (len) {
          /* decrypt */
          if ((err = cipher_descriptor[cbc->cipher].ecb_decrypt(ct, tmp, &cbc->key)) != CRYPT_OK) {
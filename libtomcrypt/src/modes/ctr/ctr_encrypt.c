@@ -18,6 +18,90 @@
 
 #ifdef LTC_CTR_MODE
 
+/* Number of counter blocks generated per pass of the wide path */
+#define CTR_STRIPE_BLOCKS 8
+
+/* advance the counter by one in the state's endianess */
+static void ctr_increment(symmetric_CTR *ctr)
+{
+   int x;
+
+   if (ctr->mode == CTR_COUNTER_LITTLE_ENDIAN) {
+      /* little-endian */
+      for (x = 0; x < ctr->blocklen; x++) {
+         ctr->ctr[x] = (ctr->ctr[x] + (unsigned char)1) & (unsigned char)255;
+         if (ctr->ctr[x] != (unsigned char)0) {
+            break;
+         }
+      }
+   } else {
+      /* big-endian */
+      for (x = ctr->blocklen-1; x >= 0; x--) {
+         ctr->ctr[x] = (ctr->ctr[x] + (unsigned char)1) & (unsigned char)255;
+         if (ctr->ctr[x] != (unsigned char)0) {
+            break;
+         }
+      }
+   }
+}
+
+/**
+  Wide CTR path for ciphers without an accel_ctr_encrypt hook.  Each pass
+  lays out CTR_STRIPE_BLOCKS counter blocks, encrypts them together
+  (through accel_ecb_encrypt when the cipher has one, so it can overlap
+  the blocks) and XORs the whole stripe into the output.
+  The pad must be empty on entry and is left empty.
+  @param pt      Plaintext
+  @param ct      [out] Ciphertext
+  @param stripes Number of CTR_STRIPE_BLOCKS * blocklen stripes to process
+  @param ctr     CTR state
+  @return CRYPT_OK if successful
+*/
+static int ctr_encrypt_stripes(const unsigned char *pt, unsigned char *ct, unsigned long stripes, symmetric_CTR *ctr)
+{
+   unsigned char ks[CTR_STRIPE_BLOCKS * 16];
+   unsigned long stripelen = CTR_STRIPE_BLOCKS * ctr->blocklen;
+   unsigned long x;
+   int b, err;
+
+   while (stripes--) {
+      for (b = 0; b < CTR_STRIPE_BLOCKS; b++) {
+         ctr_increment(ctr);
+         XMEMCPY(ks + b * ctr->blocklen, ctr->ctr, ctr->blocklen);
+      }
+
+      if (cipher_descriptor[ctr->cipher].accel_ecb_encrypt != NULL) {
+         if ((err = cipher_descriptor[ctr->cipher].accel_ecb_encrypt(ks, ks, CTR_STRIPE_BLOCKS, &ctr->key)) != CRYPT_OK) {
+            return err;
+         }
+      } else {
+         for (b = 0; b < CTR_STRIPE_BLOCKS; b++) {
+            if ((err = cipher_descriptor[ctr->cipher].ecb_encrypt(ks + b * ctr->blocklen, ks + b * ctr->blocklen, &ctr->key)) != CRYPT_OK) {
+               return err;
+            }
+         }
+      }
+
+#ifdef LTC_FAST
+      for (x = 0; x < stripelen; x += sizeof(LTC_FAST_TYPE)) {
+         *((LTC_FAST_TYPE*)((unsigned char *)ct + x)) = *((LTC_FAST_TYPE*)((unsigned char *)pt + x)) ^
+                                                        *((LTC_FAST_TYPE*)((unsigned char *)ks + x));
+      }
+#else
+      for (x = 0; x < stripelen; x++) {
+         ct[x] = pt[x] ^ ks[x];
+      }
+#endif
+      pt += stripelen;
+      ct += stripelen;
+   }
+
+#ifdef LTC_CLEAN_STACK
+   zeromem(ks, sizeof(ks));
+#endif
+   return CRYPT_OK;
+}
+
 /**
   CTR encrypt
   @param pt     Plaintext
@@ -55,30 +139,24 @@ int ctr_encrypt(const unsigned char *pt, unsigned char *ct, unsigned long len, s
       if ((err = cipher_descriptor[ctr->cipher].accel_ctr_encrypt(pt, ct, len/ctr->blocklen, ctr->ctr, ctr->mode, &ctr->key)) != CRYPT_OK) {
          return err;
       }
+      pt  += (len / ctr->blocklen) * ctr->blocklen;
+      ct  += (len / ctr->blocklen) * ctr->blocklen;
       len %= ctr->blocklen;
+   } else if ((ctr->padlen == ctr->blocklen) && ctr->blocklen <= 16 && (len >= (unsigned long)(CTR_STRIPE_BLOCKS * ctr->blocklen))) {
+      unsigned long stripelen = CTR_STRIPE_BLOCKS * ctr->blocklen;
+      if ((err = ctr_encrypt_stripes(pt, ct, len / stripelen, ctr)) != CRYPT_OK) {
+         return err;
+      }
+      pt  += (len / stripelen) * stripelen;
+      ct  += (len / stripelen) * stripelen;
+      len %= stripelen;
    }
 
    while (len) {
       /* is the pad empty? */
       if (ctr->padlen == ctr->blocklen) {
          /* increment counter */
-         if (ctr->mode == CTR_COUNTER_LITTLE_ENDIAN) {
-            /* little-endian */
-            for (x = 0; x < ctr->blocklen; x++) {
-               ctr->ctr[x] = (ctr->ctr[x] + (unsigned char)1) & (unsigned char)255;
-               if (ctr->ctr[x] != (unsigned char)0) {
-                  break;
-               }
-            }
-         } else {
-            /* big-endian */
-            for (x = ctr->blocklen-1; x >= 0; x--) {
-               ctr->ctr[x] = (ctr->ctr[x] + (unsigned char)1) & (unsigned char)255;
-               if (ctr->ctr[x] != (unsigned char)0) {
-                  break;
-               }
-            }
-         }
+         ctr_increment(ctr);
 
          /* encrypt it */
          if ((err = cipher_descriptor[ctr->cipher].ecb_encrypt(ctr->ctr, ctr->pad, &ctr->key)) != CRYPT_OK) {
@@ -0,0 +1,177 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis
+ *
+ * LibTomCrypt is a library that provides various cryptographic
+ * algorithms in a highly modular and flexible manner.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtomcrypt.com
+ */
+#include "tomcrypt.h"
+
+/**
+   @file chacha_crypt.c
+   ChaCha stream cipher, encrypt/decrypt (D. J. Bernstein)
+
+   Whole blocks are handed to the widest SIMD kernel available, which
+   computes several consecutive blocks in parallel; the remainder and the
+   last partial block use the portable code below.
+*/
+
+#ifdef LTC_CHACHA
+
+#define QUARTERROUND(a,b,c,d) \
+   x[a] += x[b]; x[d] = ROLc(x[d] ^ x[a], 16); \
+   x[c] += x[d]; x[b] = ROLc(x[b] ^ x[c], 12); \
+   x[a] += x[b]; x[d] = ROLc(x[d] ^ x[a],  8); \
+   x[c] += x[d]; x[b] = ROLc(x[b] ^ x[c],  7);
+
+/* one 64 byte keystream block as sixteen words */
+static void chacha_block(ulong32 *x, const ulong32 *input, int rounds)
+{
+   int i;
+
+   for (i = 0; i < 16; i++) {
+      x[i] = input[i];
+   }
+   for (i = rounds; i > 0; i -= 2) {
+      QUARTERROUND(0, 4,  8, 12)
+      QUARTERROUND(1, 5,  9, 13)
+      QUARTERROUND(2, 6, 10, 14)
+      QUARTERROUND(3, 7, 11, 15)
+      QUARTERROUND(0, 5, 10, 15)
+      QUARTERROUND(1, 6, 11, 12)
+      QUARTERROUND(2, 7,  8, 13)
+      QUARTERROUND(3, 4,  9, 14)
+   }
+   for (i = 0; i < 16; i++) {
+      x[i] = (x[i] + input[i]) & 0xFFFFFFFFUL;
+   }
+}
+
+/* XOR blocks of keystream over in, none of which may take the 32 bit
+   block counter past its wrap */
+static void chacha_blocks(chacha_state *st, const unsigned char *in, unsigned char *out, unsigned long blocks)
+{
+   ulong32 x[16], t;
+   unsigned long done = 0;
+   int i;
+
+#ifdef LTC_CHACHA_AVX2
+   if (st->avx2) {
+      done = chacha_avx2_blocks(st->input, in, out, blocks, st->rounds);
+   }
+#endif
+#ifdef LTC_CHACHA_SSE2
+   if (st->simd) {
+      done += chacha_sse2_blocks(st->input, in + 64 * done, out + 64 * done, blocks - done, st->rounds);
+   }
+#endif
+#ifdef LTC_CHACHA_NEON
+   if (st->simd) {
+      done += chacha_neon_blocks(st->input, in + 64 * done, out + 64 * done, blocks - done, st->rounds);
+   }
+#endif
+   in  += 64 * done;
+   out += 64 * done;
+
+   for (; done < blocks; done++) {
+      chacha_block(x, st->input, st->rounds);
+      st->input[12] = (st->input[12] + 1) & 0xFFFFFFFFUL;
+      for (i = 0; i < 16; i++) {
+         LOAD32L(t, in + 4 * i);
+         STORE32L(x[i] ^ t, out + 4 * i);
+      }
+      in  += 64;
+      out += 64;
+   }
+#ifdef LTC_CLEAN_STACK
+   zeromem(x, sizeof(x));
+#endif
+}
+
+/* carry a wrapped block counter, there is nothing to carry into with a 96 bit IV */
+static int chacha_carry(chacha_state *st)
+{
+   if (st->input[12] != 0) {
+      return CRYPT_OK;
+   }
+   if (st->ivlen != 8) {
+      return CRYPT_OVERFLOW;
+   }
+   st->input[13] = (st->input[13] + 1) & 0xFFFFFFFFUL;
+   return CRYPT_OK;
+}
+
+/**
+   Encrypt (or decrypt) bytes of ciphertext (or plaintext) with ChaCha
+   @param st      The ChaCha state
+   @param in      The plaintext (or ciphertext)
+   @param inlen   The length of the input (octets)
+   @param out     [out] The ciphertext (or plaintext), may be in
+   @return CRYPT_OK if successful
+*/
+int chacha_crypt(chacha_state *st, const unsigned char *in, unsigned long inlen, unsigned char *out)
+{
+   ulong32 x[16];
+   ulong64 room;
+   unsigned long i, n, blocks;
+   int err;
+
+   if (inlen == 0) {
+      return CRYPT_OK;
+   }
+   LTC_ARGCHK(st  != NULL);
+   LTC_ARGCHK(in  != NULL);
+   LTC_ARGCHK(out != NULL);
+   LTC_ARGCHK(st->ivlen != 0);
+
+   /* use up what is left of the previous keystream block */
+   if (st->ksleft > 0) {
+      n = MIN(st->ksleft, inlen);
+      for (i = 0; i < n; i++) {
+         out[i] = in[i] ^ st->kstream[64 - st->ksleft + i];
+      }
+      st->ksleft -= n;
+      in    += n;
+      out   += n;
+      inlen -= n;
+   }
+
+   for (blocks = inlen / 64; blocks > 0; blocks -= n) {
+      room = CONST64(0x100000000) - st->input[12];
+      n = blocks;
+      if ((ulong64)n > room) {
+         n = (unsigned long)room;
+      }
+      chacha_blocks(st, in, out, n);
+      if ((err = chacha_carry(st)) != CRYPT_OK) {
+         return err;
+      }
+      in  += 64 * n;
+      out += 64 * n;
+   }
+   inlen %= 64;
+
+   if (inlen > 0) {
+      chacha_block(x, st->input, st->rounds);
+      st->input[12] = (st->input[12] + 1) & 0xFFFFFFFFUL;
+      for (i = 0; i < 16; i++) {
+         STORE32L(x[i], st->kstream + 4 * i);
+      }
+      for (i = 0; i < inlen; i++) {
+         out[i] = in[i] ^ st->kstream[i];
+      }
+      st->ksleft = 64 - inlen;
+#ifdef LTC_CLEAN_STACK
+      zeromem(x, sizeof(x));
+#endif
+      if ((err = chacha_carry(st)) != CRYPT_OK) {
+         return err;
+      }
+   }
+   return CRYPT_OK;
+}
+
+#endif
@@ -0,0 +1,32 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis
+ *
+ * LibTomCrypt is a library that provides various cryptographic
+ * algorithms in a highly modular and flexible manner.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtomcrypt.com
+ */
+#include "tomcrypt.h"
+
+/**
+   @file chacha_done.c
+   ChaCha stream cipher, terminate the state
+*/
+
+#ifdef LTC_CHACHA
+
+/**
+   Wipe a ChaCha state
+   @param st   The ChaCha state
+   @return CRYPT_OK if successful
+*/
+int chacha_done(chacha_state *st)
+{
+   LTC_ARGCHK(st != NULL);
+   zeromem(st, sizeof(chacha_state));
+   return CRYPT_OK;
+}
+
+#endif
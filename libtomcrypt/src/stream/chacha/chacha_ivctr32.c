@@ -0,0 +1,43 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis
+ *
+ * LibTomCrypt is a library that provides various cryptographic
+ * algorithms in a highly modular and flexible manner.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtomcrypt.com
+ */
+#include "tomcrypt.h"
+
+/**
+   @file chacha_ivctr32.c
+   ChaCha stream cipher, set a 96 bit IV and 32 bit counter (RFC 7539)
+*/
+
+#ifdef LTC_CHACHA
+
+/**
+   Set the IV and the initial block counter
+   @param st      The ChaCha state
+   @param iv      The IV
+   @param ivlen   The length of the IV (octets), must be 12
+   @param counter The initial block counter
+   @return CRYPT_OK if successful
+*/
+int chacha_ivctr32(chacha_state *st, const unsigned char *iv, unsigned long ivlen, ulong32 counter)
+{
+   LTC_ARGCHK(st != NULL);
+   LTC_ARGCHK(iv != NULL);
+   LTC_ARGCHK(ivlen == 12);
+
+   st->input[12] = counter;
+   LOAD32L(st->input[13], iv + 0);
+   LOAD32L(st->input[14], iv + 4);
+   LOAD32L(st->input[15], iv + 8);
+   st->ksleft = 0;
+   st->ivlen  = ivlen;
+   return CRYPT_OK;
+}
+
+#endif
@@ -0,0 +1,37 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis
+ *
+ * LibTomCrypt is a library that provides various cryptographic
+ * algorithms in a highly modular and flexible manner.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtomcrypt.com
+ */
+#include "tomcrypt.h"
+
+/**
+   @file chacha_keystream.c
+   ChaCha stream cipher, raw keystream output
+*/
+
+#ifdef LTC_CHACHA
+
+/**
+   Generate keystream bytes
+   @param st      The ChaCha state
+   @param out     [out] The keystream
+   @param outlen  The number of bytes wanted
+   @return CRYPT_OK if successful
+*/
+int chacha_keystream(chacha_state *st, unsigned char *out, unsigned long outlen)
+{
+   if (outlen == 0) {
+      return CRYPT_OK;
+   }
+   LTC_ARGCHK(out != NULL);
+   XMEMSET(out, 0, outlen);
+   return chacha_crypt(st, out, outlen, out);
+}
+
+#endif
@@ -0,0 +1,95 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis
+ *
+ * LibTomCrypt is a library that provides various cryptographic
+ * algorithms in a highly modular and flexible manner.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtomcrypt.com
+ */
+
+/**
+   @file chacha_neon.c
+   ChaCha multi-block kernel for ARM NEON, four blocks at a time.
+
+   Laid out the same way as the SSE2 kernel in chacha_x86.c: each vector
+   holds one state word of four consecutive blocks.
+*/
+#include "tomcrypt.h"
+
+#ifdef LTC_CHACHA_NEON
+
+#include <arm_neon.h>
+
+#define QR(a,b,c,d) \
+   x[a] = vaddq_u32(x[a], x[b]); x[d] = ROT16(veorq_u32(x[d], x[a])); \
+   x[c] = vaddq_u32(x[c], x[d]); x[b] = ROT(veorq_u32(x[b], x[c]), 12); \
+   x[a] = vaddq_u32(x[a], x[b]); x[d] = ROT(veorq_u32(x[d], x[a]),  8); \
+   x[c] = vaddq_u32(x[c], x[d]); x[b] = ROT(veorq_u32(x[b], x[c]),  7);
+
+#define DOUBLEROUND \
+   QR(0, 4,  8, 12) QR(1, 5,  9, 13) QR(2, 6, 10, 14) QR(3, 7, 11, 15) \
+   QR(0, 5, 10, 15) QR(1, 6, 11, 12) QR(2, 7,  8, 13) QR(3, 4,  9, 14)
+
+#define ROT16(a)  vreinterpretq_u32_u16(vrev32q_u16(vreinterpretq_u16_u32(a)))
+#define ROT(a,n)  vsriq_n_u32(vshlq_n_u32(a, n), a, 32 - (n))
+
+#define XOR_STORE128(o, v) \
+   vst1q_u8(out + (o), veorq_u8(vld1q_u8(in + (o)), vreinterpretq_u8_u32(v)))
+
+/* transpose words 4g..4g+3 of the four blocks and XOR them in */
+#define NEON_OUT(g) do { \
+   uint32x4x2_t t0, t1; \
+   t0 = vtrnq_u32(x[4*(g)], x[4*(g)+1]); \
+   t1 = vtrnq_u32(x[4*(g)+2], x[4*(g)+3]); \
+   XOR_STORE128(  0 + 16*(g), vcombine_u32(vget_low_u32(t0.val[0]),  vget_low_u32(t1.val[0]))); \
+   XOR_STORE128( 64 + 16*(g), vcombine_u32(vget_low_u32(t0.val[1]),  vget_low_u32(t1.val[1]))); \
+   XOR_STORE128(128 + 16*(g), vcombine_u32(vget_high_u32(t0.val[0]), vget_high_u32(t1.val[0]))); \
+   XOR_STORE128(192 + 16*(g), vcombine_u32(vget_high_u32(t0.val[1]), vget_high_u32(t1.val[1]))); \
+} while (0)
+
+/**
+  XOR keystream over groups of four blocks with NEON
+  @param input   The ChaCha input words, the counter is advanced
+  @param in      The plaintext (or ciphertext)
+  @param out     [out] The ciphertext (or plaintext)
+  @param blocks  The number of 64 byte blocks available
+  @param rounds  The number of rounds
+  @return The number of blocks processed, a multiple of four
+*/
+unsigned long chacha_neon_blocks(ulong32 *input, const unsigned char *in, unsigned char *out, unsigned long blocks, int rounds)
+{
+   static const uint32_t lanes[4] = { 0, 1, 2, 3 };
+   uint32x4_t x[16], s[16];
+   unsigned long done;
+   int i;
+
+   for (i = 0; i < 16; i++) {
+      s[i] = vdupq_n_u32((uint32_t)input[i]);
+   }
+   s[12] = vaddq_u32(s[12], vld1q_u32(lanes));
+
+   for (done = 0; blocks - done >= 4; done += 4) {
+      for (i = 0; i < 16; i++) {
+         x[i] = s[i];
+      }
+      for (i = rounds; i > 0; i -= 2) {
+         DOUBLEROUND
+      }
+      for (i = 0; i < 16; i++) {
+         x[i] = vaddq_u32(x[i], s[i]);
+      }
+      NEON_OUT(0);
+      NEON_OUT(1);
+      NEON_OUT(2);
+      NEON_OUT(3);
+      s[12] = vaddq_u32(s[12], vdupq_n_u32(4));
+      in  += 256;
+      out += 256;
+   }
+   input[12] = (input[12] + done) & 0xFFFFFFFFUL;
+   return done;
+}
+
+#endif
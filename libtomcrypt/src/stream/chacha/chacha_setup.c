@@ -0,0 +1,77 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis
+ *
+ * LibTomCrypt is a library that provides various cryptographic
+ * algorithms in a highly modular and flexible manner.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtomcrypt.com
+ */
+#include "tomcrypt.h"
+
+/**
+   @file chacha_setup.c
+   ChaCha stream cipher, key setup (D. J. Bernstein)
+*/
+
+#ifdef LTC_CHACHA
+
+static const char * const sigma = "expand 32-byte k";
+static const char * const tau   = "expand 16-byte k";
+
+/**
+   Initialize a ChaCha state with a key, the IV and counter are set
+   afterwards with chacha_ivctr32() or chacha_ivctr64()
+   @param st      [out] The destination of the ChaCha state
+   @param key     The secret key
+   @param keylen  The length of the secret key (octets), 16 or 32
+   @param rounds  Number of rounds (e.g. 20 for ChaCha20), 0 for the default
+   @return CRYPT_OK if successful
+*/
+int chacha_setup(chacha_state *st, const unsigned char *key, unsigned long keylen, int rounds)
+{
+   const char *constants;
+
+   LTC_ARGCHK(st  != NULL);
+   LTC_ARGCHK(key != NULL);
+   LTC_ARGCHK(keylen == 32 || keylen == 16);
+
+   if (rounds == 0) {
+      rounds = 20;
+   }
+   LTC_ARGCHK(rounds % 2 == 0);
+
+   LOAD32L(st->input[4], key + 0);
+   LOAD32L(st->input[5], key + 4);
+   LOAD32L(st->input[6], key + 8);
+   LOAD32L(st->input[7], key + 12);
+   if (keylen == 32) {
+      key += 16;
+      constants = sigma;
+   } else {
+      constants = tau;
+   }
+   LOAD32L(st->input[8],  key + 0);
+   LOAD32L(st->input[9],  key + 4);
+   LOAD32L(st->input[10], key + 8);
+   LOAD32L(st->input[11], key + 12);
+   LOAD32L(st->input[0], constants + 0);
+   LOAD32L(st->input[1], constants + 4);
+   LOAD32L(st->input[2], constants + 8);
+   LOAD32L(st->input[3], constants + 12);
+   st->rounds = rounds;
+   st->ivlen  = 0;
+   st->ksleft = 0;
+#ifdef LTC_CHACHA_SSE2
+   st->simd = (crypt_cpu_features() & LTC_CPU_SSE2) != 0;
+#elif defined(LTC_CHACHA_NEON)
+   st->simd = (crypt_cpu_features() & LTC_CPU_NEON) != 0;
+#endif
+#ifdef LTC_CHACHA_AVX2
+   st->avx2 = chacha_avx2_is_supported();
+#endif
+   return CRYPT_OK;
+}
+
+#endif
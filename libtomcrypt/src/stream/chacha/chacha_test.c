@@ -0,0 +1,94 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis
+ *
+ * LibTomCrypt is a library that provides various cryptographic
+ * algorithms in a highly modular and flexible manner.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtomcrypt.com
+ */
+#include "tomcrypt.h"
+
+/**
+   @file chacha_test.c
+   ChaCha stream cipher, self test
+*/
+
+#ifdef LTC_CHACHA
+
+/**
+   Self-test ChaCha20 with the RFC 7539 section 2.4.2 vector, and check
+   that the SIMD kernels agree with byte at a time processing
+   @return CRYPT_OK if successful, CRYPT_NOP if self-testing has been disabled
+*/
+int chacha_test(void)
+{
+#ifndef LTC_TEST
+   return CRYPT_NOP;
+#else
+   static const unsigned char nonce[] = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x4a, 0x00, 0x00, 0x00, 0x00 };
+   static const char pt[] = "Ladies and Gentlemen of the class of '99: If I could offer you only one tip for the future, sunscreen would be it.";
+   static const unsigned char ct[] = {
+      0x6E, 0x2E, 0x35, 0x9A, 0x25, 0x68, 0xF9, 0x80, 0x41, 0xBA, 0x07, 0x28, 0xDD, 0x0D, 0x69, 0x81,
+      0xE9, 0x7E, 0x7A, 0xEC, 0x1D, 0x43, 0x60, 0xC2, 0x0A, 0x27, 0xAF, 0xCC, 0xFD, 0x9F, 0xAE, 0x0B,
+      0xF9, 0x1B, 0x65, 0xC5, 0x52, 0x47, 0x33, 0xAB, 0x8F, 0x59, 0x3D, 0xAB, 0xCD, 0x62, 0xB3, 0x57,
+      0x16, 0x39, 0xD6, 0x24, 0xE6, 0x51, 0x52, 0xAB, 0x8F, 0x53, 0x0C, 0x35, 0x9F, 0x08, 0x61, 0xD8,
+      0x07, 0xCA, 0x0D, 0xBF, 0x50, 0x0D, 0x6A, 0x61, 0x56, 0xA3, 0x8E, 0x08, 0x8A, 0x22, 0xB6, 0x5E,
+      0x52, 0xBC, 0x51, 0x4D, 0x16, 0xCC, 0xF8, 0x06, 0x81, 0x8C, 0xE9, 0x1A, 0xB7, 0x79, 0x37, 0x36,
+      0x5A, 0xF9, 0x0B, 0xBF, 0x74, 0xA3, 0x5B, 0xE6, 0xB4, 0x0B, 0x8E, 0xED, 0xF2, 0x78, 0x5E, 0x42,
+      0x87, 0x4D
+   };
+   chacha_state st;
+   unsigned char key[32], buf[1000], ref[1000];
+   unsigned long i, len = sizeof(pt) - 1;
+   int err;
+
+   for (i = 0; i < sizeof(key); i++) {
+      key[i] = (unsigned char)i;
+   }
+
+   /* in one call, and in pieces that straddle block boundaries */
+   if ((err = chacha_setup(&st, key, sizeof(key), 20)) != CRYPT_OK
+       || (err = chacha_ivctr32(&st, nonce, sizeof(nonce), 1)) != CRYPT_OK
+       || (err = chacha_crypt(&st, (const unsigned char *)pt, len, buf)) != CRYPT_OK) {
+      return err;
+   }
+   if (XMEMCMP(buf, ct, len) != 0) {
+      return CRYPT_FAIL_TESTVECTOR;
+   }
+   if ((err = chacha_ivctr32(&st, nonce, sizeof(nonce), 1)) != CRYPT_OK
+       || (err = chacha_crypt(&st, (const unsigned char *)pt, 35, buf)) != CRYPT_OK
+       || (err = chacha_crypt(&st, (const unsigned char *)pt + 35, 50, buf + 35)) != CRYPT_OK
+       || (err = chacha_crypt(&st, (const unsigned char *)pt + 85, len - 85, buf + 85)) != CRYPT_OK) {
+      return err;
+   }
+   if (XMEMCMP(buf, ct, len) != 0) {
+      return CRYPT_FAIL_TESTVECTOR;
+   }
+
+   /* the multi-block path against 7 byte pieces, which never reach it,
+      with the 64 bit counter carrying part way through */
+   for (i = 0; i < sizeof(ref); i++) {
+      ref[i] = (unsigned char)(i * 7);
+   }
+   if ((err = chacha_ivctr64(&st, nonce + 4, 8, CONST64(0xFFFFFFFD))) != CRYPT_OK
+       || (err = chacha_crypt(&st, ref, sizeof(ref), buf)) != CRYPT_OK
+       || (err = chacha_ivctr64(&st, nonce + 4, 8, CONST64(0xFFFFFFFD))) != CRYPT_OK) {
+      return err;
+   }
+   for (i = 0; i < sizeof(ref); i += 7) {
+      if ((err = chacha_crypt(&st, buf + i, MIN(7, sizeof(ref) - i), buf + i)) != CRYPT_OK) {
+         return err;
+      }
+   }
+   if (XMEMCMP(buf, ref, sizeof(ref)) != 0) {
+      return CRYPT_FAIL_TESTVECTOR;
+   }
+
+   chacha_done(&st);
+   return CRYPT_OK;
+#endif
+}
+
+#endif
@@ -0,0 +1,211 @@
+/* LibTomCrypt, modular cryptographic library -- Tom St Denis
+ *
+ * LibTomCrypt is a library that provides various cryptographic
+ * algorithms in a highly modular and flexible manner.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://libtomcrypt.com
+ */
+
+/**
+   @file chacha_x86.c
+   ChaCha multi-block kernels for x86: four blocks at a time in SSE2
+   registers and eight at a time with AVX2.
+
+   Each vector holds the same state word of consecutive blocks, so the
+   rounds run with no shuffling between columns and diagonals, and the
+   blocks are transposed back into byte order when the keystream is
+   XORed in.  SSE2 is part of the x86_64 baseline; the AVX2 kernel must
+   only be called once chacha_avx2_is_supported() has returned non-zero.
+*/
+#include "tomcrypt.h"
+
+#ifdef LTC_CHACHA_SSE2
+
+#include <emmintrin.h>
+#include <immintrin.h>
+
+#define SSE2_TARGET __attribute__((target("sse2")))
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+/* one double round over all lanes, x[] are vectors and ADD/XOR/ROT the
+   matching lane-wise operations */
+#define QR(a,b,c,d) \
+   x[a] = ADD(x[a], x[b]); x[d] = ROT(XOR(x[d], x[a]), 16); \
+   x[c] = ADD(x[c], x[d]); x[b] = ROT(XOR(x[b], x[c]), 12); \
+   x[a] = ADD(x[a], x[b]); x[d] = ROT(XOR(x[d], x[a]),  8); \
+   x[c] = ADD(x[c], x[d]); x[b] = ROT(XOR(x[b], x[c]),  7);
+
+#define DOUBLEROUND \
+   QR(0, 4,  8, 12) QR(1, 5,  9, 13) QR(2, 6, 10, 14) QR(3, 7, 11, 15) \
+   QR(0, 5, 10, 15) QR(1, 6, 11, 12) QR(2, 7,  8, 13) QR(3, 4,  9, 14)
+
+#define ADD(a,b) _mm_add_epi32(a, b)
+#define XOR(a,b) _mm_xor_si128(a, b)
+#define ROT(a,n) _mm_or_si128(_mm_slli_epi32(a, n), _mm_srli_epi32(a, 32 - (n)))
+
+/* XOR 16 bytes of keystream over in at offset o */
+#define XOR_STORE128(o, v) \
+   _mm_storeu_si128((__m128i *)(out + (o)), \
+      _mm_xor_si128(_mm_loadu_si128((const __m128i *)(in + (o))), v))
+
+/* transpose words 4g..4g+3 of the four blocks and XOR them in */
+#define SSE2_OUT(g) do { \
+   __m128i t0, t1, t2, t3; \
+   t0 = _mm_unpacklo_epi32(x[4*(g)], x[4*(g)+1]); \
+   t1 = _mm_unpacklo_epi32(x[4*(g)+2], x[4*(g)+3]); \
+   t2 = _mm_unpackhi_epi32(x[4*(g)], x[4*(g)+1]); \
+   t3 = _mm_unpackhi_epi32(x[4*(g)+2], x[4*(g)+3]); \
+   XOR_STORE128(  0 + 16*(g), _mm_unpacklo_epi64(t0, t1)); \
+   XOR_STORE128( 64 + 16*(g), _mm_unpackhi_epi64(t0, t1)); \
+   XOR_STORE128(128 + 16*(g), _mm_unpacklo_epi64(t2, t3)); \
+   XOR_STORE128(192 + 16*(g), _mm_unpackhi_epi64(t2, t3)); \
+} while (0)
+
+/**
+  XOR keystream over groups of four blocks with SSE2
+  @param input   The ChaCha input words, the counter is advanced
+  @param in      The plaintext (or ciphertext)
+  @param out     [out] The ciphertext (or plaintext)
+  @param blocks  The number of 64 byte blocks available
+  @param rounds  The number of rounds
+  @return The number of blocks processed, a multiple of four
+*/
+SSE2_TARGET
+unsigned long chacha_sse2_blocks(ulong32 *input, const unsigned char *in, unsigned char *out, unsigned long blocks, int rounds)
+{
+   __m128i x[16], s[16];
+   unsigned long done;
+   int i;
+
+   for (i = 0; i < 16; i++) {
+      s[i] = _mm_set1_epi32((int)input[i]);
+   }
+   s[12] = _mm_add_epi32(s[12], _mm_set_epi32(3, 2, 1, 0));
+
+   for (done = 0; blocks - done >= 4; done += 4) {
+      for (i = 0; i < 16; i++) {
+         x[i] = s[i];
+      }
+      for (i = rounds; i > 0; i -= 2) {
+         DOUBLEROUND
+      }
+      for (i = 0; i < 16; i++) {
+         x[i] = _mm_add_epi32(x[i], s[i]);
+      }
+      SSE2_OUT(0);
+      SSE2_OUT(1);
+      SSE2_OUT(2);
+      SSE2_OUT(3);
+      s[12] = _mm_add_epi32(s[12], _mm_set1_epi32(4));
+      in  += 256;
+      out += 256;
+   }
+   input[12] = (input[12] + done) & 0xFFFFFFFFUL;
+   return done;
+}
+
+#undef ADD
+#undef XOR
+#undef ROT
+
+#ifdef LTC_CHACHA_AVX2
+
+/**
+  Check whether this CPU (and OS) can run the AVX2 code
+  @return non-zero if the kernel may be used
+*/
+int chacha_avx2_is_supported(void)
+{
+   return (crypt_cpu_features() & LTC_CPU_AVX2) != 0;
+}
+
+#define ADD(a,b) _mm256_add_epi32(a, b)
+#define XOR(a,b) _mm256_xor_si256(a, b)
+/* byte aligned rotations are a single shuffle */
+#define ROT(a,n) ((n) == 16 ? _mm256_shuffle_epi8(a, rot16) : \
+                  (n) ==  8 ? _mm256_shuffle_epi8(a, rot8) : \
+                  _mm256_or_si256(_mm256_slli_epi32(a, n), _mm256_srli_epi32(a, 32 - (n))))
+
+#define XOR_STORE256(o, v) \
+   _mm256_storeu_si256((__m256i *)(out + (o)), \
+      _mm256_xor_si256(_mm256_loadu_si256((const __m256i *)(in + (o))), v))
+
+/* transpose words 4g..4g+3 within each 128 bit lane, leaving y[g][j]
+   holding block j in the low lane and block j+4 in the high lane */
+#define AVX2_TRANSPOSE(g) do { \
+   __m256i t0, t1, t2, t3; \
+   t0 = _mm256_unpacklo_epi32(x[4*(g)], x[4*(g)+1]); \
+   t1 = _mm256_unpacklo_epi32(x[4*(g)+2], x[4*(g)+3]); \
+   t2 = _mm256_unpackhi_epi32(x[4*(g)], x[4*(g)+1]); \
+   t3 = _mm256_unpackhi_epi32(x[4*(g)+2], x[4*(g)+3]); \
+   y[g][0] = _mm256_unpacklo_epi64(t0, t1); \
+   y[g][1] = _mm256_unpackhi_epi64(t0, t1); \
+   y[g][2] = _mm256_unpacklo_epi64(t2, t3); \
+   y[g][3] = _mm256_unpackhi_epi64(t2, t3); \
+} while (0)
+
+/* write blocks j and j+4 */
+#define AVX2_OUT(j) do { \
+   XOR_STORE256(64*(j),        _mm256_permute2x128_si256(y[0][j], y[1][j], 0x20)); \
+   XOR_STORE256(64*(j) + 32,   _mm256_permute2x128_si256(y[2][j], y[3][j], 0x20)); \
+   XOR_STORE256(64*(j) + 256,  _mm256_permute2x128_si256(y[0][j], y[1][j], 0x31)); \
+   XOR_STORE256(64*(j) + 288,  _mm256_permute2x128_si256(y[2][j], y[3][j], 0x31)); \
+} while (0)
+
+/**
+  XOR keystream over groups of eight blocks with AVX2
+  @param input   The ChaCha input words, the counter is advanced
+  @param in      The plaintext (or ciphertext)
+  @param out     [out] The ciphertext (or plaintext)
+  @param blocks  The number of 64 byte blocks available
+  @param rounds  The number of rounds
+  @return The number of blocks processed, a multiple of eight
+*/
+AVX2_TARGET
+unsigned long chacha_avx2_blocks(ulong32 *input, const unsigned char *in, unsigned char *out, unsigned long blocks, int rounds)
+{
+   const __m256i rot16 = _mm256_set_epi8(13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2,
+                                         13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2);
+   const __m256i rot8  = _mm256_set_epi8(14, 13, 12, 15, 10, 9, 8, 11, 6, 5, 4, 7, 2, 1, 0, 3,
+                                         14, 13, 12, 15, 10, 9, 8, 11, 6, 5, 4, 7, 2, 1, 0, 3);
+   __m256i x[16], s[16], y[4][4];
+   unsigned long done;
+   int i;
+
+   for (i = 0; i < 16; i++) {
+      s[i] = _mm256_set1_epi32((int)input[i]);
+   }
+   s[12] = _mm256_add_epi32(s[12], _mm256_set_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+
+   for (done = 0; blocks - done >= 8; done += 8) {
+      for (i = 0; i < 16; i++) {
+         x[i] = s[i];
+      }
+      for (i = rounds; i > 0; i -= 2) {
+         DOUBLEROUND
+      }
+      for (i = 0; i < 16; i++) {
+         x[i] = _mm256_add_epi32(x[i], s[i]);
+      }
+      AVX2_TRANSPOSE(0);
+      AVX2_TRANSPOSE(1);
+      AVX2_TRANSPOSE(2);
+      AVX2_TRANSPOSE(3);
+      AVX2_OUT(0);
+      AVX2_OUT(1);
+      AVX2_OUT(2);
+      AVX2_OUT(3);
+      s[12] = _mm256_add_epi32(s[12], _mm256_set1_epi32(8));
+      in  += 512;
+      out += 512;
+   }
+   input[12] = (input[12] + done) & 0xFFFFFFFFUL;
+   return done;
+}
+
+#endif /* LTC_CHACHA_AVX2 */
+
+#endif
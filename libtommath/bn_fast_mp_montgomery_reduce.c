@@ -21,130 +21,88 @@
  * which uses the comba method to quickly calculate the columns of the
  * reduction.
  *
- * Based on Algorithm 14.32 on pp.601 of HAC.
+ * Based on Algorithm 14.32 on pp.601 of HAC, but worked a column at a
+ * time [product scanning] rather than a row at a time.  The digits
+ * mu_0..mu_{n-1} of the multiple of N being added are found in turn as
+ * the low columns are summed, each one zeroing its column, so the whole
+ * sum x + mu*N is kept in a single mp_word accumulator with no array of
+ * double precision words to carry through.
 */
 int fast_mp_montgomery_reduce (mp_int * x, mp_int * n, mp_digit rho)
 {
-  int     ix, res, olduse;
-  mp_word W[MP_WARRAY];
+  int     ix, res, olduse, used, pa;
+  mp_digit W[MP_WARRAY];
+  register mp_word  _W;
 
   /* get old used count */
   olduse = x->used;
+  used   = n->used;
 
   /* grow a as required */
-  if (x->alloc < n->used + 1) {
-    if ((res = mp_grow (x, n->used + 1)) != MP_OKAY) {
+  if (x->alloc < used + 1) {
+    if ((res = mp_grow (x, used + 1)) != MP_OKAY) {
       return res;
     }
   }
 
-  /* first we have to get the digits of the input into
-   * an array of double precision words W[...]
-   */
-  {
-    register mp_word *_W;
-    register mp_digit *tmpx;
+  /* number of columns to sum, the input is normally below N*R */
+  pa = MAX(used * 2, x->used);
 
-    /* alias for the W[] array */
-    _W   = W;
+  /* W[0..used-1] holds mu, W[used..pa] the result */
+  _W = 0;
+  for (ix = 0; ix < pa; ix++) {
+    int      tx, ty, iy;
+    mp_digit *tmpx, *tmpy;
 
-    /* alias for the digits of  x*/
-    tmpx = x->dp;
-
-    /* copy the digits of a into W[0..a->used-1] */
-    for (ix = 0; ix < x->used; ix++) {
-      *_W++ = *tmpx++;
+    /* the digit of x in this column */
+    if (ix < x->used) {
+      _W += (mp_word)x->dp[ix];
     }
 
-    /* zero the high words of W[a->used..m->used*2] */
-    for (; ix < n->used * 2 + 1; ix++) {
-      *_W++ = 0;
+    /* mu_j * N_{ix-j} for the mu_j found so far, j < ix */
+    ty = MIN(ix, used - 1);
+    tx = ix - ty;
+    iy = MIN(used - tx, ty + 1);
+    if (ix < used) {
+      /* mu_ix * N_0 is added once mu_ix is known */
+      --iy;
+    }
+    if (iy > 0) {
+      tmpx = W + tx;
+      tmpy = n->dp + ty;
+      COMBA_MULADD(_W, tmpx, tmpy, iy);
     }
-  }
-
-  /* now we proceed to zero successive digits
-   * from the least significant upwards
-   */
-  for (ix = 0; ix < n->used; ix++) {
-    /* mu = ai * m' mod b
-     *
-     * We avoid a double precision multiplication (which isn't required)
-     * by casting the value down to a mp_digit.  Note this requires
-     * that W[ix-1] have  the carry cleared (see after the inner loop)
-     */
-    register mp_digit mu;
-    mu = (mp_digit) (((W[ix] & MP_MASK) * rho) & MP_MASK);
-
-    /* a = a + mu * m * b**i
-     *
-     * This is computed in place and on the fly.  The multiplication
-     * by b**i is handled by offseting which columns the results
-     * are added to.
-     *
-     * Note the comba method normally doesn't handle carries in the
-     * inner loop In this case we fix the carry from the previous
-     * column since the Montgomery reduction requires digits of the
-     * result (so far) [see above] to work.  This is
-     * handled by fixing up one carry after the inner loop.  The
-     * carry fixups are done in order so after these loops the
-     * first m->used words of W[] have the carries fixed
-     */
-    {
-      register int iy;
-      register mp_digit *tmpn;
-      register mp_word *_W;
-
-      /* alias for the digits of the modulus */
-      tmpn = n->dp;
-
-      /* Alias for the columns set by an offset of ix */
-      _W = W + ix;
 
-      /* inner loop */
-      for (iy = 0; iy < n->used; iy++) {
-          *_W++ += ((mp_word)mu) * ((mp_word)*tmpn++);
-      }
+    if (ix < used) {
+      /* mu = ai * m' mod b
+       *
+       * choose the next digit of mu so that this column is zero
+       */
+      W[ix] = (((mp_digit)_W & MP_MASK) * rho) & MP_MASK;
+      _W += ((mp_word)W[ix]) * ((mp_word)n->dp[0]);
+    } else {
+      /* store term */
+      W[ix] = ((mp_digit)_W) & MP_MASK;
     }
 
-    /* now fix carry for next digit, W[ix+1] */
-    W[ix + 1] += W[ix] >> ((mp_word) DIGIT_BIT);
+    /* make next carry */
+    _W = _W >> ((mp_word)DIGIT_BIT);
   }
+  W[pa] = (mp_digit)_W;
 
-  /* now we have to propagate the carries and
-   * shift the words downward [all those least
-   * significant digits we zeroed].
+  /* copy out, A = A/b**n
+   *
+   * The result is the columns from n->used upwards
    */
   {
-    register mp_digit *tmpx;
-    register mp_word *_W, *_W1;
-
-    /* nox fix rest of carries */
-
-    /* alias for current word */
-    _W1 = W + ix;
-
-    /* alias for next word, where the carry goes */
-    _W = W + ++ix;
+    register mp_digit *tmpx, *tmpw;
 
-    for (; ix <= n->used * 2 + 1; ix++) {
-      *_W++ += *_W1++ >> ((mp_word) DIGIT_BIT);
-    }
-
-    /* copy out, A = A/b**n
-     *
-     * The result is A/b**n but instead of converting from an
-     * array of mp_word to mp_digit than calling mp_rshd
-     * we just copy them in the right order
-     */
-
-    /* alias for destination word */
     tmpx = x->dp;
+    tmpw = W + used;
 
-    /* alias for shifted double precision result */
-    _W = W + n->used;
-
-    for (ix = 0; ix < n->used + 1; ix++) {
-      *tmpx++ = (mp_digit)(*_W++ & ((mp_word) MP_MASK));
+    /* the input was at most pa digits, x->alloc is large enough */
+    for (ix = 0; ix < pa - used + 1; ix++) {
+      *tmpx++ = *tmpw++;
     }
 
     /* zero oldused digits, if the input a was larger than
@@ -156,7 +114,7 @@ int fast_mp_montgomery_reduce (mp_int * x, mp_int * n, mp_digit rho)
   }
 
   /* set the max used and clamp */
-  x->used = n->used + 1;
+  x->used = pa - used + 1;
   mp_clamp (x);
 
   /* if A >= m then A = A - m */
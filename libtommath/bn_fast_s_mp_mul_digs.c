@@ -33,7 +33,7 @@
  */
 int fast_s_mp_mul_digs (mp_int * a, mp_int * b, mp_int * c, int digs)
 {
-  int     olduse, res, pa, ix, iz;
+  int     olduse, res, pa, ix;
   mp_digit W[MP_WARRAY];
   register mp_word  _W;
 
@@ -68,10 +68,7 @@ int fast_s_mp_mul_digs (mp_int * a, mp_int * b, mp_int * c, int digs)
       iy = MIN(a->used-tx, ty+1);
 
       /* execute loop */
-      for (iz = 0; iz < iy; ++iz) {
-         _W += ((mp_word)*tmpx++)*((mp_word)*tmpy--);
-
-      }
+      COMBA_MULADD(_W, tmpx, tmpy, iy);
 
       /* store term */
       W[ix] = ((mp_digit)_W) & MP_MASK;
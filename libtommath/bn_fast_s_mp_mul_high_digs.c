@@ -26,7 +26,7 @@
  */
 int fast_s_mp_mul_high_digs (mp_int * a, mp_int * b, mp_int * c, int digs)
 {
-  int     olduse, res, pa, ix, iz;
+  int     olduse, res, pa, ix;
   mp_digit W[MP_WARRAY];
   mp_word  _W;
 
@@ -59,9 +59,7 @@ int fast_s_mp_mul_high_digs (mp_int * a, mp_int * b, mp_int * c, int digs)
       iy = MIN(a->used-tx, ty+1);
 
       /* execute loop */
-      for (iz = 0; iz < iy; iz++) {
-         _W += ((mp_word)*tmpx++)*((mp_word)*tmpy--);
-      }
+      COMBA_MULADD(_W, tmpx, tmpy, iy);
 
       /* store term */
       W[ix] = ((mp_digit)_W) & MP_MASK;
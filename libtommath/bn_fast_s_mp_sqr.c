@@ -27,7 +27,7 @@ After that loop you do the squares and add them in.
 
 int fast_s_mp_sqr (mp_int * a, mp_int * b)
 {
-  int       olduse, res, pa, ix, iz;
+  int       olduse, res, pa, ix;
   mp_digit   W[MP_WARRAY], *tmpx;
   mp_word   W1;
 
@@ -69,9 +69,7 @@ int fast_s_mp_sqr (mp_int * a, mp_int * b)
       iy = MIN(iy, (ty-tx+1)>>1);
 
       /* execute loop */
-      for (iz = 0; iz < iy; iz++) {
-         _W += ((mp_word)*tmpx++)*((mp_word)*tmpy--);
-      }
+      COMBA_MULADD(_W, tmpx, tmpy, iy);
 
       /* double the inner product and add carry */
       _W = _W + _W + W1;
@@ -0,0 +1,158 @@
+#include <tommath.h>
+#include "dbhelpers.h"
+#ifdef BN_MP_ARENA_C
+/* LibTomMath, multiple-precision integer library -- Tom St Denis
+ *
+ * LibTomMath is a library that provides multiple-precision
+ * integer arithmetic as well as number theoretic functionality.
+ *
+ * The library was designed directly after the MPI library by
+ * Michael Fromberger but has been written from scratch with
+ * additional optimizations in place.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://math.libtomcrypt.com
+ */
+
+/* A bump-pointer arena for the digits of temporaries.
+ *
+ * While an arena is in use each new digit array is cut from it, after a
+ * word holding its size, so an exptmod's table and temporaries cost no
+ * malloc/free at all.  Freeing the latest array gives its space back,
+ * any other waits for mp_arena_end(), which wipes everything used since
+ * mp_arena_begin() and rewinds.  Arrays already on the heap stay there
+ * when they grow, and the heap is used as before once the arena is full.
+ * mp_clear() wipes the digits it frees and a copy left behind by a move
+ * is wiped here too, the final wipe catches whatever else is left (a
+ * private exponent in a freed temporary, say).
+ *
+ * Digits travel between mp_ints, mp_exch() and the like, so any mp_int
+ * used while the arena is must be cleared or passed to mp_arena_keep()
+ * before mp_arena_end() if it is to be used afterwards.
+ */
+
+static mp_arena *arena;
+
+#define ARENA_NONE   ((size_t)-1)
+#define IN_ARENA(p)  (arena != NULL && (mp_digit *)(p) >= arena->base && \
+                      (mp_digit *)(p) < arena->base + arena->size)
+
+int mp_arena_init (mp_arena * a, size_t size)
+{
+  a->base = OPT_CAST(mp_digit) XMALLOC (sizeof (mp_digit) * size);
+  if (a->base == NULL) {
+    return MP_MEM;
+  }
+  a->size = size;
+  a->used = a->top = 0;
+  a->last = ARENA_NONE;
+  return MP_OKAY;
+}
+
+void mp_arena_free (mp_arena * a)
+{
+  if (a->base != NULL) {
+    XFREE (a->base);
+    a->base = NULL;
+    a->size = a->used = a->top = 0;
+  }
+}
+
+void mp_arena_begin (mp_arena * a)
+{
+  arena = a;
+}
+
+void mp_arena_end (void)
+{
+  if (arena != NULL) {
+    m_burn (arena->base, sizeof (mp_digit) * arena->top);
+    arena->used = arena->top = 0;
+    arena->last = ARENA_NONE;
+    arena = NULL;
+  }
+}
+
+int mp_arena_keep (mp_int * a)
+{
+  mp_digit *tmp;
+
+  if (IN_ARENA (a->dp)) {
+    tmp = OPT_CAST(mp_digit) XMALLOC (sizeof (mp_digit) * a->alloc);
+    if (tmp == NULL) {
+      return MP_MEM;
+    }
+    memcpy (tmp, a->dp, sizeof (mp_digit) * a->alloc);
+    m_burn (a->dp, sizeof (mp_digit) * a->alloc);
+    a->dp = tmp;
+  }
+  return MP_OKAY;
+}
+
+/* the digit allocations of mp_init(), mp_grow() and mp_clear() */
+void *s_mp_malloc (size_t size)
+{
+  size_t  n = (size + sizeof (mp_digit) - 1) / sizeof (mp_digit);
+  mp_digit *p;
+
+  if (arena == NULL || arena->size - arena->used < n + 1) {
+    return XMALLOC (size);
+  }
+  p = arena->base + arena->used;
+  p[0] = n;
+  arena->last = arena->used;
+  arena->used += n + 1;
+  if (arena->used > arena->top) {
+    arena->top = arena->used;
+  }
+  return p + 1;
+}
+
+void *s_mp_realloc (void *p, size_t size)
+{
+  size_t  n = (size + sizeof (mp_digit) - 1) / sizeof (mp_digit), old;
+  mp_digit *q = p;
+
+  if (!IN_ARENA (p)) {
+    return XREALLOC (p, size);
+  }
+  old = q[-1];
+  if (n <= old) {
+    return p;
+  }
+
+  /* the latest array can just grow */
+  if (q - 1 == arena->base + arena->last && arena->size - arena->last >= n + 1) {
+    q[-1] = n;
+    arena->used = arena->last + n + 1;
+    if (arena->used > arena->top) {
+      arena->top = arena->used;
+    }
+    return p;
+  }
+
+  if ((q = s_mp_malloc (size)) != NULL) {
+    memcpy (q, p, sizeof (mp_digit) * old);
+    m_burn (p, sizeof (mp_digit) * old);
+  }
+  return q;
+}
+
+void s_mp_free (void *p)
+{
+  mp_digit *q = p;
+
+  if (!IN_ARENA (p)) {
+    XFREE (p);
+  } else if (q - 1 == arena->base + arena->last) {
+    arena->used = arena->last;
+    arena->last = ARENA_NONE;
+  }
+}
+#endif
+
+/* $Source$ */
+/* $Revision$ */
+/* $Date$ */
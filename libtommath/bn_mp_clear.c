@@ -26,7 +26,7 @@ mp_clear (mp_int * a)
 	m_burn(a->dp, a->alloc * sizeof(*a->dp));
 
     /* free ram */
-    XFREE(a->dp);
+    s_mp_free(a->dp);
 
     /* reset members to make debugging easier */
     a->dp    = NULL;
@@ -65,6 +65,13 @@ int mp_exptmod (mp_int * G, mp_int * X, mp_int * P, mp_int * Y)
 #endif
   }
 
+  /* a vector kernel, for the moduli it takes */
+  if (mp_exptmod_accel != NULL && mp_isodd(P) == 1) {
+     if ((dr = mp_exptmod_accel(G, X, P, Y)) != MP_VAL) {
+        return dr;
+     }
+  }
+
 /* modified diminished radix reduction */
 #if defined(BN_MP_REDUCE_IS_2K_L_C) && defined(BN_MP_REDUCE_2K_L_C) && defined(BN_S_MP_EXPTMOD_C)
   if (mp_reduce_is_2k_l(P) == MP_YES) {
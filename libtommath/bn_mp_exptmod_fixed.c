@@ -0,0 +1,382 @@
+#include <tommath.h>
+#include "dbhelpers.h"
+#ifdef LTM_EXPTMOD_FIXED
+/* LibTomMath, multiple-precision integer library -- Tom St Denis
+ *
+ * LibTomMath is a library that provides multiple-precision
+ * integer arithmetic as well as number theoretic functionality.
+ *
+ * The library was designed directly after the MPI library by
+ * Michael Fromberger but has been written from scratch with
+ * additional optimizations in place.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://math.libtomcrypt.com
+ */
+
+/* Constant-time Montgomery exponentiation for 1024- and 2048-bit moduli.
+ *
+ * The numbers are arrays of exactly 16 or 32 64-bit limbs and the code
+ * is compiled once for each count, so there are no lengths to look at,
+ * no clamping and no heap.  Products and squares are summed a column at
+ * a time into three words, then reduced the same way, and the last
+ * subtraction of m is always done and its result picked with a mask.
+ * The exponentiation uses a fixed window and reads the whole table for
+ * every window.  k0 and R*R mod m are worked out by mp_fixed_mont_setup()
+ * once for each modulus, and the caller keeps them along with it.
+ *
+ * Only moduli that fill their limbs are taken, which also gives R mod m
+ * as R - m.  The rest, and a base that isn't below m, are left to the
+ * generic code.
+ */
+
+#define FIXED_WIN_MAX  5
+
+/* only the multiplications are worth a copy for each size */
+#if defined(__GNUC__) && !defined(__clang__)
+   #define FIXED_ONE_COPY  __attribute__((noclone))
+#else
+   #define FIXED_ONE_COPY
+#endif
+
+/* the column sums, top:acc += x*y, acc the low 128 bits */
+#define FIXED_MULADD(x, y)                                 \
+   do {                                                    \
+      mp_word _p = ((mp_word)(x)) * (y);                   \
+      acc += _p;                                           \
+      top += acc < _p;                                     \
+   } while (0)
+
+#define FIXED_ADD(x)                                       \
+   do {                                                    \
+      mp_word _p = (x);                                    \
+      acc += _p;                                           \
+      top += acc < _p;                                     \
+   } while (0)
+
+/* the next column starts with this one's carry */
+#define FIXED_SHIFT()                                      \
+   do {                                                    \
+      acc = (acc >> 64) | (((mp_word)top) << 64);          \
+      top = 0;                                             \
+   } while (0)
+
+/* r = z/R mod m [z < m*R], a column at a time like
+ * fast_mp_montgomery_reduce(): the first N find the multiples u of m,
+ * which clear the low half, the next N give the result */
+static __inline__ __attribute__((always_inline))
+void fixed_redc (mp_digit *r, const mp_digit *z, const mp_digit *m,
+                 mp_digit k0, const int N)
+{
+  mp_digit u[FIXED_MAX], t[FIXED_MAX], s[FIXED_MAX], top = 0, c, mask;
+  mp_word  acc = 0, w;
+  int      ix, iy;
+
+  for (ix = 0; ix < N; ix++) {
+    FIXED_ADD (z[ix]);
+    for (iy = 0; iy < ix; iy++) {
+      FIXED_MULADD (u[iy], m[ix - iy]);
+    }
+    u[ix] = ((mp_digit)acc) * k0;
+    FIXED_MULADD (u[ix], m[0]);
+    FIXED_SHIFT ();
+  }
+  for (ix = N; ix < 2 * N; ix++) {
+    FIXED_ADD (z[ix]);
+    for (iy = ix - N + 1; iy < N; iy++) {
+      FIXED_MULADD (u[iy], m[ix - iy]);
+    }
+    t[ix - N] = (mp_digit)acc;
+    FIXED_SHIFT ();
+  }
+
+  /* t < 2m, take t - m unless it borrows */
+  c = 0;
+  for (iy = 0; iy < N; iy++) {
+    w = ((mp_word)t[iy]) - m[iy] - c;
+    s[iy] = (mp_digit)w;
+    c = (mp_digit)(w >> 64) & 1;
+  }
+  mask = (mp_digit)0 - ((mp_digit)acc | (c ^ 1));
+  for (iy = 0; iy < N; iy++) {
+    r[iy] = (s[iy] & mask) | (t[iy] & ~mask);
+  }
+}
+
+/* r = a*b/R mod m [a, b < m] */
+static __inline__ __attribute__((always_inline))
+void fixed_mul (mp_digit *r, const mp_digit *a, const mp_digit *b,
+                const mp_digit *m, mp_digit k0, const int N)
+{
+  mp_digit z[2 * FIXED_MAX], top = 0;
+  mp_word  acc = 0;
+  int      ix, iy;
+
+  for (ix = 0; ix < 2 * N - 1; ix++) {
+    for (iy = MAX (0, ix - N + 1); iy <= MIN (ix, N - 1); iy++) {
+      FIXED_MULADD (a[iy], b[ix - iy]);
+    }
+    z[ix] = (mp_digit)acc;
+    FIXED_SHIFT ();
+  }
+  z[2 * N - 1] = (mp_digit)acc;
+  fixed_redc (r, z, m, k0, N);
+}
+
+/* r = a*a/R mod m [a < m], each cross product once and doubled */
+static __inline__ __attribute__((always_inline))
+void fixed_sqr (mp_digit *r, const mp_digit *a, const mp_digit *m,
+                mp_digit k0, const int N)
+{
+  mp_digit z[2 * FIXED_MAX], top;
+  mp_word  acc, carry = 0;
+  int      ix, iy;
+
+  for (ix = 0; ix < 2 * N - 1; ix++) {
+    acc = 0;
+    top = 0;
+    for (iy = MAX (0, ix - N + 1); iy < ix - iy; iy++) {
+      FIXED_MULADD (a[iy], a[ix - iy]);
+    }
+    top = (top << 1) | (mp_digit)(acc >> 127);
+    acc <<= 1;
+    if ((ix & 1) == 0) {
+      FIXED_MULADD (a[ix / 2], a[ix / 2]);
+    }
+    FIXED_ADD (carry);
+    z[ix] = (mp_digit)acc;
+    carry = (acc >> 64) | (((mp_word)top) << 64);
+  }
+  z[2 * N - 1] = (mp_digit)carry;
+  fixed_redc (r, z, m, k0, N);
+}
+
+/* a copy of each for either size, too big to inline */
+#define FIXED_SIZES(N, mul, sqr)                                              \
+static void mul (mp_digit *r, const mp_digit *a, const mp_digit *b,          \
+                 const mp_digit *m, mp_digit k0)                             \
+{                                                                            \
+  fixed_mul (r, a, b, m, k0, N);                                             \
+}                                                                            \
+static void sqr (mp_digit *r, const mp_digit *a, const mp_digit *m,          \
+                 mp_digit k0)                                                \
+{                                                                            \
+  fixed_sqr (r, a, m, k0, N);                                                \
+}
+
+FIXED_SIZES (16, fixed_mul16, fixed_sqr16)
+FIXED_SIZES (32, fixed_mul32, fixed_sqr32)
+
+#define FIXED_MUL(r, a, b)                                                   \
+   (N == 16 ? fixed_mul16 (r, a, b, m, k0) : fixed_mul32 (r, a, b, m, k0))
+#define FIXED_SQR(r, a)                                                      \
+   (N == 16 ? fixed_sqr16 (r, a, m, k0) : fixed_sqr32 (r, a, m, k0))
+
+/* r = 2a mod m [a < m, m has its top bit set] */
+static FIXED_ONE_COPY void fixed_dbl (mp_digit *r, const mp_digit *a, const mp_digit *m, int N)
+{
+  mp_digit t[FIXED_MAX], s[FIXED_MAX], c = 0, top, mask;
+  mp_word  w;
+  int      iy;
+
+  for (iy = 0; iy < N; iy++) {
+    t[iy] = (a[iy] << 1) | c;
+    c = a[iy] >> 63;
+  }
+  top = c;
+  c = 0;
+  for (iy = 0; iy < N; iy++) {
+    w = ((mp_word)t[iy]) - m[iy] - c;
+    s[iy] = (mp_digit)w;
+    c = (mp_digit)(w >> 64) & 1;
+  }
+  mask = (mp_digit)0 - (top | (c ^ 1));
+  for (iy = 0; iy < N; iy++) {
+    r[iy] = (s[iy] & mask) | (t[iy] & ~mask);
+  }
+}
+
+/* r = T[idx], reading every entry */
+static FIXED_ONE_COPY void fixed_select (mp_digit *r, mp_digit T[][FIXED_MAX], int size, int idx, int N)
+{
+  mp_digit mask;
+  int      ix, iy;
+
+  for (iy = 0; iy < N; iy++) {
+    r[iy] = 0;
+  }
+  for (ix = 0; ix < size; ix++) {
+    mask = (mp_digit)0 - (mp_digit)(ix == idx);
+    for (iy = 0; iy < N; iy++) {
+      r[iy] |= T[ix][iy] & mask;
+    }
+  }
+}
+
+/* a = the N limbs of b [b < 2**(64N)] */
+static void fixed_from_mp (mp_digit *a, mp_int *b, int N)
+{
+  int      ix, pos, got, take, d, s;
+  mp_digit v;
+
+  for (ix = 0, pos = 0; ix < N; ix++) {
+    a[ix] = 0;
+    for (got = 0; got < 64; got += take, pos += take) {
+      d = pos / DIGIT_BIT;
+      s = pos % DIGIT_BIT;
+      take = MIN (DIGIT_BIT - s, 64 - got);
+      v = d < b->used ? b->dp[d] >> s : 0;
+      a[ix] |= (v & ((((mp_digit)1) << take) - 1)) << got;
+    }
+  }
+}
+
+/* b = the N limbs of a */
+static int fixed_to_mp (mp_int *b, const mp_digit *a, int N)
+{
+  int      ix, pos, got, take, d, s, res;
+
+  if ((res = mp_grow (b, (64 * N) / DIGIT_BIT + 1)) != MP_OKAY) {
+    return res;
+  }
+  mp_zero (b);
+  for (ix = 0, pos = 0; ix < N; ix++) {
+    for (got = 0; got < 64; got += take, pos += take) {
+      d = pos / DIGIT_BIT;
+      s = pos % DIGIT_BIT;
+      take = MIN (DIGIT_BIT - s, 64 - got);
+      b->dp[d] |= ((a[ix] >> got) & ((((mp_digit)1) << take) - 1)) << s;
+    }
+  }
+  b->used = (64 * N) / DIGIT_BIT + 1;
+  mp_clamp (b);
+  return MP_OKAY;
+}
+
+/* bits [pos, pos+len) of X */
+static int fixed_window (mp_int *X, int pos, int len)
+{
+  int      ix, b, w = 0;
+
+  for (ix = len - 1; ix >= 0; ix--) {
+    b = pos + ix;
+    w = (w << 1) | (int)((X->dp[b / DIGIT_BIT] >> (b % DIGIT_BIT)) & 1);
+  }
+  return w;
+}
+
+/* the constants for P, once for all the exponentiations mod P: its limbs,
+ * k0 = -1/m mod 2**64 and R*R mod m, MP_VAL unless P is odd and of
+ * exactly 1024 or 2048 bits */
+int mp_fixed_mont_setup (mp_int * P, mp_fixed_mont * mont)
+{
+  mp_digit *m = mont->m, *rr = mont->rr;
+  mp_digit t[FIXED_MAX], k0, inv, c;
+  mp_word  w;
+  int      bits = mp_count_bits (P), N, ix, iy;
+
+  if (mp_iseven (P) == 1 || P->sign == MP_NEG) {
+    return MP_VAL;
+  }
+  if (bits == 1024) {
+    N = 16;
+  } else if (bits == 2048) {
+    N = 32;
+  } else {
+    return MP_VAL;
+  }
+  mont->n = N;
+  fixed_from_mp (m, P, N);
+
+  /* k0 = -1/m mod 2**64, by Newton from the 3 bits m[0] is right to */
+  inv = m[0];
+  for (ix = 0; ix < 5; ix++) {
+    inv *= 2 - m[0] * inv;
+  }
+  k0 = (mp_digit)0 - inv;
+  mont->k0 = k0;
+
+  /* R mod m = R - m, doubled N times it is 2**N as a Montgomery number,
+   * and squared six times 2**(64N), so R*R mod m */
+  c = 0;
+  for (iy = 0; iy < N; iy++) {
+    w = ((mp_word)0) - m[iy] - c;
+    t[iy] = (mp_digit)w;
+    c = (mp_digit)(w >> 64) & 1;
+  }
+  fixed_dbl (rr, t, m, N);
+  for (ix = 1; ix < N; ix++) {
+    fixed_dbl (rr, rr, m, N);
+  }
+  for (ix = 0; ix < 6; ix++) {
+    FIXED_SQR (rr, rr);
+  }
+  return MP_OKAY;
+}
+
+static FIXED_ONE_COPY int fixed_exptmod (mp_int * G, mp_int * X, const mp_fixed_mont * mont, mp_int * Y)
+{
+  mp_digit T[1 << FIXED_WIN_MAX][FIXED_MAX];
+  mp_digit acc[FIXED_MAX], t[FIXED_MAX], c;
+  const mp_digit *m = mont->m, k0 = mont->k0;
+  mp_word  w;
+  int      N = mont->n, xbits, win, pos, len, ix, iy, res;
+
+  /* T[0] = R mod m = R - m, T[i] = G**i * R mod m */
+  c = 0;
+  for (iy = 0; iy < N; iy++) {
+    w = ((mp_word)0) - m[iy] - c;
+    T[0][iy] = (mp_digit)w;
+    c = (mp_digit)(w >> 64) & 1;
+  }
+  fixed_from_mp (t, G, N);
+  FIXED_MUL (T[1], t, mont->rr);
+  xbits = mp_count_bits (X);
+  win = xbits <= 256 ? FIXED_WIN_MAX - 1 : FIXED_WIN_MAX;
+  for (ix = 2; ix < (1 << win); ix++) {
+    FIXED_MUL (T[ix], T[ix - 1], T[1]);
+  }
+
+  /* the first window, then square and multiply a window at a time */
+  len = xbits % win ? xbits % win : win;
+  pos = xbits - len;
+  fixed_select (acc, T, 1 << win, xbits ? fixed_window (X, pos, len) : 0, N);
+  for (pos -= win; pos >= 0; pos -= win) {
+    for (ix = 0; ix < win; ix++) {
+      FIXED_SQR (acc, acc);
+    }
+    fixed_select (t, T, 1 << win, fixed_window (X, pos, win), N);
+    FIXED_MUL (acc, acc, t);
+  }
+
+  /* out of Montgomery form */
+  for (iy = 0; iy < N; iy++) {
+    t[iy] = 0;
+  }
+  t[0] = 1;
+  FIXED_MUL (acc, acc, t);
+  res = fixed_to_mp (Y, acc, N);
+
+  m_burn (T, sizeof (T));
+  m_burn (acc, sizeof (acc));
+  m_burn (t, sizeof (t));
+  return res;
+}
+
+/* Y = G**X mod P with the constants mp_fixed_mont_setup() made for P,
+ * for 0 <= G < P, MP_VAL for anything else */
+int mp_exptmod_fixed_mont (mp_int * G, mp_int * X, mp_int * P,
+                           const mp_fixed_mont * mont, mp_int * Y)
+{
+  if (X->sign == MP_NEG || G->sign == MP_NEG || mp_cmp_mag (G, P) != MP_LT) {
+    return MP_VAL;
+  }
+  return fixed_exptmod (G, X, mont, Y);
+}
+#endif
+
+/* $Source$ */
+/* $Revision$ */
+/* $Date$ */
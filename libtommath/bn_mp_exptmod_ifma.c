@@ -0,0 +1,134 @@
+#include <tommath.h>
+#ifdef LTM_EXPTMOD_IFMA
+/* LibTomMath, multiple-precision integer library -- Tom St Denis
+ *
+ * LibTomMath is a library that provides multiple-precision
+ * integer arithmetic as well as number theoretic functionality.
+ *
+ * The library was designed directly after the MPI library by
+ * Michael Fromberger but has been written from scratch with
+ * additional optimizations in place.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://math.libtomcrypt.com
+ */
+
+#include <immintrin.h>
+
+/* Montgomery multiplication with the AVX-512 IFMA instructions.
+ *
+ * The limbs are 52 bits, eight to a zmm register, up to five registers
+ * (2078-bit moduli).  vpmadd52luq and vpmadd52huq add the low and high
+ * halves of the 104-bit products of eight limb pairs straight into
+ * 64-bit accumulators, so the carries can wait until the end.  Each
+ * step adds a*b[i] + m*y, whose lowest limb is then zero mod 2**52, and
+ * moves the accumulator down a limb: the low halves are added before
+ * the move and the high halves, which belong a limb further up, after.
+ * An accumulator limb takes at most four 52-bit terms per step for n
+ * steps, well inside 64 bits.
+ */
+
+#define IFMA_TARGET   __attribute__((target("avx512f,avx512ifma")))
+#define IFMA_MASK     ((((mp_digit)1) << 52) - 1)
+#define IFMA_MAXV     5
+
+static IFMA_TARGET __inline__ __attribute__((always_inline))
+void amm52_n(mp_digit *r, const mp_digit *a, const mp_digit *b,
+             const mp_digit *m, mp_digit k0, const int nv)
+{
+  __m512i  A[IFMA_MAXV], M[IFMA_MAXV], R[IFMA_MAXV], C[IFMA_MAXV];
+  __m512i  bi, yi, c, zero = _mm512_setzero_si512 (),
+           mask = _mm512_set1_epi64 ((long long)IFMA_MASK);
+  __mmask8 over;
+  mp_digit a0 = a[0], y;
+  int      ix, iy;
+
+#pragma GCC unroll 8
+  for (iy = 0; iy < nv; iy++) {
+    A[iy] = _mm512_loadu_si512 (a + 8 * iy);
+    M[iy] = _mm512_loadu_si512 (m + 8 * iy);
+    R[iy] = zero;
+  }
+
+  for (ix = 0; ix < 8 * nv; ix++) {
+    /* y makes the lowest limb of R + a*b[i] + m*y zero mod 2**52 */
+    y = (mp_digit)_mm_cvtsi128_si64 (_mm512_castsi512_si128 (R[0]));
+    y = ((y + a0 * b[ix]) * k0) & IFMA_MASK;
+    bi = _mm512_set1_epi64 ((long long)b[ix]);
+    yi = _mm512_set1_epi64 ((long long)y);
+
+#pragma GCC unroll 8
+    for (iy = 0; iy < nv; iy++) {
+      R[iy] = _mm512_madd52lo_epu64 (R[iy], A[iy], bi);
+      R[iy] = _mm512_madd52lo_epu64 (R[iy], M[iy], yi);
+    }
+
+    /* down a limb, the dropped one's carry goes to the next */
+    c = _mm512_srli_epi64 (R[0], 52);
+#pragma GCC unroll 8
+    for (iy = 0; iy < nv - 1; iy++) {
+      R[iy] = _mm512_alignr_epi64 (R[iy + 1], R[iy], 1);
+    }
+    R[nv - 1] = _mm512_alignr_epi64 (zero, R[nv - 1], 1);
+    R[0] = _mm512_mask_add_epi64 (R[0], 1, R[0], c);
+
+#pragma GCC unroll 8
+    for (iy = 0; iy < nv; iy++) {
+      R[iy] = _mm512_madd52hi_epu64 (R[iy], A[iy], bi);
+      R[iy] = _mm512_madd52hi_epu64 (R[iy], M[iy], yi);
+    }
+  }
+
+  /* one round of carries, each limb's goes a lane up */
+#pragma GCC unroll 8
+  for (iy = 0; iy < nv; iy++) {
+    C[iy] = _mm512_srli_epi64 (R[iy], 52);
+    R[iy] = _mm512_and_si512 (R[iy], mask);
+  }
+  R[0] = _mm512_add_epi64 (R[0], _mm512_alignr_epi64 (C[0], zero, 7));
+#pragma GCC unroll 8
+  for (iy = 1; iy < nv; iy++) {
+    R[iy] = _mm512_add_epi64 (R[iy], _mm512_alignr_epi64 (C[iy], C[iy - 1], 7));
+  }
+
+  over = 0;
+#pragma GCC unroll 8
+  for (iy = 0; iy < nv; iy++) {
+    over |= _mm512_cmpgt_epu64_mask (R[iy], mask);
+    _mm512_storeu_si512 (r + 8 * iy, R[iy]);
+  }
+
+  /* a limb can be left at 2**52 or just over, rarely enough for a loop */
+  if (over != 0) {
+    for (ix = 0; ix < 8 * nv - 1; ix++) {
+      r[ix + 1] += r[ix] >> 52;
+      r[ix] &= IFMA_MASK;
+    }
+  }
+}
+
+static IFMA_TARGET void amm52 (mp_digit *r, const mp_digit *a, const mp_digit *b,
+                               const mp_digit *m, mp_digit k0, int n)
+{
+  switch (n) {
+    case 16: amm52_n (r, a, b, m, k0, 2); break;
+    case 24: amm52_n (r, a, b, m, k0, 3); break;
+    case 32: amm52_n (r, a, b, m, k0, 4); break;
+    case 40: amm52_n (r, a, b, m, k0, 5); break;
+  }
+}
+
+static const mp_vec_kernel ifma_kernel = { 52, 8, 8 * IFMA_MAXV, amm52 };
+
+/* Y = G**X mod P with the IFMA kernel [odd P of 512 to 2078 bits] */
+int mp_exptmod_ifma (mp_int * G, mp_int * X, mp_int * P, mp_int * Y)
+{
+  return s_mp_exptmod_vec (G, X, P, Y, &ifma_kernel);
+}
+#endif
+
+/* $Source$ */
+/* $Revision$ */
+/* $Date$ */
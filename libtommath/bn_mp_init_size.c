@@ -24,7 +24,7 @@ int mp_init_size (mp_int * a, int size)
   size += (MP_PREC * 2) - (size % MP_PREC);	
   
   /* alloc mem */
-  a->dp = OPT_CAST(mp_digit) XMALLOC (sizeof (mp_digit) * size);
+  a->dp = OPT_CAST(mp_digit) s_mp_malloc (sizeof (mp_digit) * size);
   if (a->dp == NULL) {
     return MP_MEM;
   }
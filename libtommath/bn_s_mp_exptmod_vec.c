@@ -0,0 +1,193 @@
+#include <tommath.h>
+#include "dbhelpers.h"
+#ifdef LTM_EXPTMOD_IFMA
+/* LibTomMath, multiple-precision integer library -- Tom St Denis
+ *
+ * LibTomMath is a library that provides multiple-precision
+ * integer arithmetic as well as number theoretic functionality.
+ *
+ * The library was designed directly after the MPI library by
+ * Michael Fromberger but has been written from scratch with
+ * additional optimizations in place.
+ *
+ * The library is free for all purposes without any express
+ * guarantee it works.
+ *
+ * Tom St Denis, tomstdenis@gmail.com, http://math.libtomcrypt.com
+ */
+
+/* The exponentiation around a vector Montgomery kernel, such as the one
+ * in bn_mp_exptmod_ifma.c.
+ *
+ * The numbers are held as n limbs of v->bits bits, one to a 64-bit
+ * word, and R = 2**(n * v->bits).  The kernel does an "almost"
+ * Montgomery multiplication, leaving its result below 2P rather than P,
+ * which is fine as the next input while 4P < R.  Only the very end is
+ * reduced fully.
+ *
+ * A fixed window is used and the table of powers is read in full for
+ * each lookup, so neither the memory accesses nor the number of
+ * multiplications depend on the exponent bits.
+ */
+
+/* a = the limbs of b [b >= 0] */
+static void vec_from_mp(mp_digit *a, mp_int *b, int n, int bits)
+{
+  mp_digit mask = (((mp_digit)1) << bits) - 1;
+  int      ix, pos, d, s;
+
+  for (ix = 0, pos = 0; ix < n; ix++, pos += bits) {
+    d = pos / DIGIT_BIT;
+    s = pos % DIGIT_BIT;
+    a[ix] = 0;
+    if (d < b->used) {
+      a[ix] = b->dp[d] >> s;
+      if (s + bits > DIGIT_BIT && d + 1 < b->used) {
+        a[ix] |= b->dp[d + 1] << (DIGIT_BIT - s);
+      }
+    }
+    a[ix] &= mask;
+  }
+}
+
+/* b = the limbs of a, each below 2**bits */
+static int vec_to_mp(mp_int *b, const mp_digit *a, int n, int bits)
+{
+  int      ix, pos, d, s, res;
+
+  if ((res = mp_grow (b, (n * bits) / DIGIT_BIT + 2)) != MP_OKAY) {
+    return res;
+  }
+  mp_zero (b);
+  for (ix = 0, pos = 0; ix < n; ix++, pos += bits) {
+    d = pos / DIGIT_BIT;
+    s = pos % DIGIT_BIT;
+    b->dp[d] |= (a[ix] << s) & MP_MASK;
+    if (s + bits > DIGIT_BIT) {
+      b->dp[d + 1] |= a[ix] >> (DIGIT_BIT - s);
+    }
+  }
+  b->used = (n * bits) / DIGIT_BIT + 2;
+  mp_clamp (b);
+  return MP_OKAY;
+}
+
+/* r = T[idx] without the address depending on idx */
+static void vec_select(mp_digit *r, mp_digit T[][VEC_MAX], int size, int idx, int n)
+{
+  mp_digit mask;
+  int      ix, iy;
+
+  for (iy = 0; iy < n; iy++) {
+    r[iy] = 0;
+  }
+  for (ix = 0; ix < size; ix++) {
+    mask = (mp_digit)0 - (mp_digit)(ix == idx);
+    for (iy = 0; iy < n; iy++) {
+      r[iy] |= T[ix][iy] & mask;
+    }
+  }
+}
+
+/* bits [pos, pos+len) of X */
+static int vec_window(mp_int *X, int pos, int len)
+{
+  int      ix, w = 0;
+
+  for (ix = len - 1; ix >= 0; ix--) {
+    int b = pos + ix;
+    w = (w << 1) | (int)((X->dp[b / DIGIT_BIT] >> (b % DIGIT_BIT)) & 1);
+  }
+  return w;
+}
+
+/* Y = G**X mod P on a vector kernel, MP_VAL if it doesn't take this P */
+int s_mp_exptmod_vec (mp_int * G, mp_int * X, mp_int * P, mp_int * Y,
+                      const mp_vec_kernel * v)
+{
+  mp_digit T[1 << VEC_WINDOW_MAX][VEC_MAX];
+  mp_digit m[VEC_MAX], one[VEC_MAX], t[VEC_MAX], acc[VEC_MAX];
+  mp_digit rho, k0;
+  mp_int   r;
+  int      n, bits, xbits, win, pos, len, ix, res;
+
+  bits = mp_count_bits (P);
+  n = (bits + 2 + v->bits - 1) / v->bits;
+  n = (n + v->lanes - 1) / v->lanes * v->lanes;
+  if (mp_iseven (P) == 1 || P->sign == MP_NEG || X->sign == MP_NEG ||
+      bits < VEC_MIN_BITS || n > v->max) {
+    return MP_VAL;
+  }
+
+  if ((res = mp_init (&r)) != MP_OKAY) {
+    return res;
+  }
+
+  /* k0 = -1/P mod 2**bits */
+  if ((res = mp_montgomery_setup (P, &rho)) != MP_OKAY) {
+    goto LBL_ERR;
+  }
+  k0 = rho & ((((mp_digit)1) << v->bits) - 1);
+  vec_from_mp (m, P, n, v->bits);
+
+  for (ix = 0; ix < n; ix++) {
+    one[ix] = 0;
+  }
+  one[0] = 1;
+
+  /* T[1] = G*R = G * R**2 / R, T[0] = R */
+  if ((res = mp_2expt (&r, 2 * n * v->bits)) != MP_OKAY ||
+      (res = mp_mod (&r, P, &r)) != MP_OKAY) {
+    goto LBL_ERR;
+  }
+  vec_from_mp (t, &r, n, v->bits);
+  if ((res = mp_mod (G, P, &r)) != MP_OKAY) {
+    goto LBL_ERR;
+  }
+  vec_from_mp (acc, &r, n, v->bits);
+  v->amm (T[1], acc, t, m, k0, n);
+  v->amm (T[0], t, one, m, k0, n);
+
+  xbits = mp_count_bits (X);
+  win = xbits <= 256 ? VEC_WINDOW_MAX - 1 : VEC_WINDOW_MAX;
+  for (ix = 2; ix < (1 << win); ix++) {
+    v->amm (T[ix], T[ix - 1], T[1], m, k0, n);
+  }
+
+  /* the first window, then square and multiply a window at a time */
+  len = xbits % win ? xbits % win : win;
+  pos = xbits - len;
+  vec_select (acc, T, 1 << win, xbits ? vec_window (X, pos, len) : 0, n);
+  for (pos -= win; pos >= 0; pos -= win) {
+    for (ix = 0; ix < win; ix++) {
+      v->amm (acc, acc, acc, m, k0, n);
+    }
+    vec_select (t, T, 1 << win, vec_window (X, pos, win), n);
+    v->amm (acc, acc, t, m, k0, n);
+  }
+
+  /* out of Montgomery form, this one is below P+1 */
+  v->amm (t, acc, one, m, k0, n);
+  if ((res = vec_to_mp (&r, t, n, v->bits)) != MP_OKAY) {
+    goto LBL_ERR;
+  }
+  if (mp_cmp_mag (&r, P) != MP_LT) {
+    if ((res = s_mp_sub (&r, P, &r)) != MP_OKAY) {
+      goto LBL_ERR;
+    }
+  }
+  mp_exch (&r, Y);
+  res = MP_OKAY;
+
+LBL_ERR:
+  m_burn (T, sizeof (T));
+  m_burn (acc, sizeof (acc));
+  m_burn (t, sizeof (t));
+  mp_clear (&r);
+  return res;
+}
+#endif
+
+/* $Source$ */
+/* $Revision$ */
+/* $Date$ */
@@ -21,14 +21,25 @@
 -------------------------------------------------------------
  Intel P4 Northwood     /GCC v3.4.1   /        88/       128/LTM 0.32 ;-)
  AMD Athlon64           /GCC v3.4.4   /        80/       120/LTM 0.35
+ x86-64, 60-bit digits  /GCC v12.2    /       100/       128/etc/tune.c
  
+ Run etc/tune to measure them for another machine.  With 60-bit digits the
+ comba routines win up to 4096-bit operands and beyond.
 */
 
+#ifdef MP_64BIT
+int     KARATSUBA_MUL_CUTOFF = 100,     /* Min. number of digits before Karatsuba multiplication is used. */
+        KARATSUBA_SQR_CUTOFF = 128,     /* Min. number of digits before Karatsuba squaring is used. */
+#else
 int     KARATSUBA_MUL_CUTOFF = 80,      /* Min. number of digits before Karatsuba multiplication is used. */
         KARATSUBA_SQR_CUTOFF = 120,     /* Min. number of digits before Karatsuba squaring is used. */
+#endif
         
         TOOM_MUL_CUTOFF      = 350,      /* no optimal values of these are known yet so set em high */
         TOOM_SQR_CUTOFF      = 400; 
+
+/* set by the application once it knows which vector kernels the CPU has */
+int (*mp_exptmod_accel)(mp_int *G, mp_int *X, mp_int *P, mp_int *Y) = NULL;
 #endif
 
 /* $Source: /cvs/libtom/libtommath/bncore.c,v $ */
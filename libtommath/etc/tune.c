@@ -0,0 +1,104 @@
+/* Tune the Karatsuba cutoffs for this machine and compiler
+ *
+ * For each size in turn mp_mul() and mp_sqr() are timed with Karatsuba
+ * off, then with the cutoff at that size so that one level of Karatsuba
+ * is done over the comba routines.  The cutoff is the smallest size where
+ * Karatsuba wins a few sizes running.  Copy the result into bncore.c.
+ *
+ * Build with "make tune" in libtommath/ and run etc/tune.
+ */
+#include <tommath.h>
+#include <time.h>
+
+/* the library burns freed digits with Dropbear's m_burn() */
+void m_burn(void *data, unsigned int len)
+{
+   memset(data, 0, len);
+}
+
+#define TUNE_MAX   256   /* give up beyond this many digits */
+#define TUNE_RUNS  3     /* consecutive wins needed */
+
+static unsigned long long now_ns(void)
+{
+   struct timespec ts;
+
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* best time of a few batches of mp_mul() [or mp_sqr()] on size digit numbers */
+static unsigned long long time_op(int sqr, int size)
+{
+   mp_int a, b, c;
+   unsigned long long t, best = ~0ULL;
+   int x, y;
+
+   if (mp_init_size(&a, size) != MP_OKAY || mp_init_size(&b, size) != MP_OKAY ||
+       mp_init(&c) != MP_OKAY) {
+      fprintf(stderr, "out of memory\n");
+      exit(EXIT_FAILURE);
+   }
+   for (x = 0; x < size; x++) {
+      a.dp[x] = ((mp_digit)rand() << 31 ^ (mp_digit)rand()) & MP_MASK;
+      b.dp[x] = ((mp_digit)rand() << 31 ^ (mp_digit)rand()) & MP_MASK;
+   }
+   a.dp[size - 1] |= 1;
+   b.dp[size - 1] |= 1;
+   a.used = b.used = size;
+
+   for (x = 0; x < 64; x++) {
+      t = now_ns();
+      for (y = 0; y < 16; y++) {
+         if (sqr) {
+            mp_sqr(&a, &c);
+         } else {
+            mp_mul(&a, &b, &c);
+         }
+      }
+      t = now_ns() - t;
+      if (t < best) {
+         best = t;
+      }
+   }
+   mp_clear(&a);
+   mp_clear(&b);
+   mp_clear(&c);
+   return best;
+}
+
+/* the smallest size where Karatsuba is faster TUNE_RUNS sizes running */
+static int tune(int sqr, int *cutoff)
+{
+   unsigned long long comba, karatsuba;
+   int x, wins = 0;
+
+   for (x = 8; x < TUNE_MAX; x++) {
+      *cutoff = TUNE_MAX * 4;
+      comba = time_op(sqr, x);
+      *cutoff = x;
+      karatsuba = time_op(sqr, x);
+      printf("%s %3d digits: comba %8llu ns, karatsuba %8llu ns\n",
+             sqr ? "sqr" : "mul", x, comba / 16, karatsuba / 16);
+      if (karatsuba < comba) {
+         if (++wins == TUNE_RUNS) {
+            return x - TUNE_RUNS + 1;
+         }
+      } else {
+         wins = 0;
+      }
+   }
+   return TUNE_MAX;
+}
+
+int main(void)
+{
+   int mul, sqr;
+
+   mul = tune(0, &KARATSUBA_MUL_CUTOFF);
+   sqr = tune(1, &KARATSUBA_SQR_CUTOFF);
+
+   printf("\n%d-bit digits: KARATSUBA_MUL_CUTOFF = %d, KARATSUBA_SQR_CUTOFF = %d\n",
+          DIGIT_BIT, mul, sqr);
+   return EXIT_SUCCESS;
+}
@@ -45,9 +45,12 @@ extern "C" {
 #endif
 
 
-/* detect 64-bit mode if possible */
-#if defined(__x86_64__) 
-   #if !(defined(MP_64BIT) && defined(MP_16BIT) && defined(MP_8BIT))
+/* detect 64-bit mode if possible, the compiler needs a 128-bit type for mp_word */
+#if defined(__x86_64__) || defined(__aarch64__) || defined(__powerpc64__) || \
+    defined(__mips64) || defined(__s390x__) || \
+    (defined(__riscv) && defined(__riscv_xlen) && __riscv_xlen == 64)
+   #if defined(__SIZEOF_INT128__) && \
+       !(defined(MP_64BIT) || defined(MP_31BIT) || defined(MP_16BIT) || defined(MP_8BIT))
       #define MP_64BIT
    #endif
 #endif
@@ -73,8 +76,16 @@ extern "C" {
    typedef signed long long   long64;
 #endif
 
-   typedef unsigned long      mp_digit;
+   /* 60-bit digits leave the 128-bit mp_word room to sum 2^8 products
+    * without carrying, which is what the comba routines rely on. long long
+    * rather than long, which is only 32 bits on the ILP32 ABIs of these
+    * CPUs (x32, MIPS n32, aarch64 ilp32) */
+   typedef unsigned long long mp_digit;
+#ifdef __SIZEOF_INT128__
+   typedef unsigned __int128  mp_word;
+#else
    typedef unsigned long      mp_word __attribute__ ((mode(TI)));
+#endif
 
    #define DIGIT_BIT          60
 #else
@@ -160,6 +171,20 @@ extern int KARATSUBA_MUL_CUTOFF,
            TOOM_MUL_CUTOFF,
            TOOM_SQR_CUTOFF;
 
+/* Constant-time Montgomery exponentiation on 16 or 32 64-bit limbs, for
+ * odd moduli of exactly 1024 or 2048 bits, see bn_mp_exptmod_fixed.c */
+#if defined(MP_64BIT) && !defined(LTM_NO_FIXED)
+   #define LTM_EXPTMOD_FIXED
+#endif
+
+/* Montgomery exponentiation with AVX-512 IFMA, for odd moduli of 512 to
+ * 2078 bits.  Nothing is used until mp_exptmod_accel is pointed at it
+ * on a CPU that has it, mp_exptmod then tries it first. */
+#if defined(MP_64BIT) && defined(__x86_64__) && !defined(LTM_NO_ASM) && \
+    (defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 8))
+   #define LTM_EXPTMOD_IFMA
+#endif
+
 /* define this to use lower memory usage routines (exptmods mostly) */
 /* #define MP_LOW_MEM */
 
@@ -217,6 +242,30 @@ int mp_grow(mp_int *a, int size);
 /* init to a given number of digits */
 int mp_init_size(mp_int *a, int size);
 
+/* ---> Scratch arena <--- */
+
+/* space for the digits of an operation's temporaries, see bn_mp_arena.c */
+typedef struct {
+   mp_digit *base;
+   size_t    size, used, last;      /* in digits */
+   size_t    top;                   /* most used since mp_arena_end() */
+} mp_arena;
+
+/* allocate an arena of size digits */
+int mp_arena_init(mp_arena *a, size_t size);
+
+/* free it, it must not be in use */
+void mp_arena_free(mp_arena *a);
+
+/* take new digits from a until mp_arena_end() */
+void mp_arena_begin(mp_arena *a);
+
+/* wipe and rewind the arena in use, back to the heap */
+void mp_arena_end(void);
+
+/* move the digits of a to the heap if they are in the arena */
+int mp_arena_keep(mp_int *a);
+
 /* ---> Basic Manipulations <--- */
 #define mp_iszero(a) (((a)->used == 0) ? MP_YES : MP_NO)
 #define mp_iseven(a) (((a)->used > 0 && (((a)->dp[0] & 1) == 0)) ? MP_YES : MP_NO)
@@ -443,6 +492,9 @@ int mp_reduce_2k_l(mp_int *a, mp_int *n, mp_int *d);
 /* d = a**b (mod c) */
 int mp_exptmod(mp_int *a, mp_int *b, mp_int *c, mp_int *d);
 
+/* Y = G**X mod P on a kernel, MP_VAL if it doesn't do P or X < 0 */
+extern int (*mp_exptmod_accel)(mp_int *G, mp_int *X, mp_int *P, mp_int *Y);
+
 /* ---> Primes <--- */
 
 /* number of primes */
@@ -550,6 +602,23 @@ int mp_fwrite(mp_int *a, int radix, FILE *stream);
 #define mp_tohex(M, S)     mp_toradix((M), (S), 16)
 
 /* lowlevel functions, do not call! */
+
+/* _W += x[0]*y[0] + x[1]*y[-1] + ... for n terms, the inner loop of the comba
+ * routines.  Unrolled by four, it leaves x and y past the terms. */
+#define COMBA_MULADD(_W, x, y, n)                                        \
+   do {                                                                  \
+      int _n;                                                            \
+      for (_n = (n); _n >= 4; _n -= 4, (x) += 4, (y) -= 4) {             \
+         _W += ((mp_word)(x)[0]) * ((mp_word)(y)[0]);                    \
+         _W += ((mp_word)(x)[1]) * ((mp_word)(y)[-1]);                   \
+         _W += ((mp_word)(x)[2]) * ((mp_word)(y)[-2]);                   \
+         _W += ((mp_word)(x)[3]) * ((mp_word)(y)[-3]);                   \
+      }                                                                  \
+      for (; _n > 0; _n--) {                                             \
+         _W += ((mp_word)*(x)++) * ((mp_word)*(y)--);                    \
+      }                                                                  \
+   } while (0)
+
 int s_mp_add(mp_int *a, mp_int *b, mp_int *c);
 int s_mp_sub(mp_int *a, mp_int *b, mp_int *c);
 #define s_mp_mul(a, b, c) s_mp_mul_digs(a, b, c, (a)->used + (b)->used + 1)
@@ -568,7 +637,54 @@ int mp_invmod_slow (mp_int * a, mp_int * b, mp_int * c);
 int fast_mp_montgomery_reduce(mp_int *a, mp_int *m, mp_digit mp);
 int mp_exptmod_fast(mp_int *G, mp_int *X, mp_int *P, mp_int *Y, int mode);
 int s_mp_exptmod (mp_int * G, mp_int * X, mp_int * P, mp_int * Y, int mode);
+
+typedef struct mp_fixed_mont mp_fixed_mont;
+#ifdef LTM_EXPTMOD_FIXED
+#define FIXED_MAX        32
+/* what mp_exptmod_fixed_mont() needs of a modulus m, R = 2**(64n) */
+struct mp_fixed_mont {
+   int n;                    /* 16 or 32 limbs */
+   mp_digit k0;              /* -1/m mod 2**64 */
+   mp_digit m[FIXED_MAX];
+   mp_digit rr[FIXED_MAX];   /* R*R mod m */
+};
+
+int mp_fixed_mont_setup (mp_int * P, mp_fixed_mont * mont);
+int mp_exptmod_fixed_mont (mp_int * G, mp_int * X, mp_int * P,
+                           const mp_fixed_mont * mont, mp_int * Y);
+#endif
+#ifdef LTM_EXPTMOD_IFMA
+/* the most limbs a vector kernel takes, and its largest window */
+#define VEC_MAX          40
+#define VEC_WINDOW_MAX   5
+/* smaller moduli aren't worth converting */
+#define VEC_MIN_BITS     512
+
+typedef struct {
+   int bits;      /* bits per limb, one limb to a 64-bit word */
+   int lanes;     /* the limb count is a multiple of this */
+   int max;       /* and no more than this */
+   /* r = a*b/R mod m, below 2m [a, b < 2m, 4m < R], k0 = -1/m mod 2**bits */
+   void (*amm)(mp_digit *r, const mp_digit *a, const mp_digit *b,
+               const mp_digit *m, mp_digit k0, int n);
+} mp_vec_kernel;
+
+int s_mp_exptmod_vec (mp_int * G, mp_int * X, mp_int * P, mp_int * Y,
+                      const mp_vec_kernel * v);
+int mp_exptmod_ifma (mp_int * G, mp_int * X, mp_int * P, mp_int * Y);
+#endif
+
 void bn_reverse(unsigned char *s, int len);
+/* the digit allocations, kept out of line as mp_init() and mp_clear() are
+ * inlined all over */
+#ifdef __GNUC__
+   #define MP_NOINLINE __attribute__((noinline))
+#else
+   #define MP_NOINLINE
+#endif
+void *s_mp_malloc(size_t size) MP_NOINLINE;
+void *s_mp_realloc(void *p, size_t size) MP_NOINLINE;
+void s_mp_free(void *p) MP_NOINLINE;
 
 extern const char *mp_s_rmap;
 
@@ -20,6 +20,7 @@
 #define BN_MP_ADD_D_C
 #define BN_MP_ADDMOD_C
 #define BN_MP_AND_C
+#define BN_MP_ARENA_C
 #define BN_MP_CLAMP_C
 #define BN_MP_CLEAR_C
 #define BN_MP_CLEAR_MULTI_C
@@ -995,8 +996,6 @@
 #endif
 
 /* Dropbear doesn't need these. */
-#undef BN_MP_KARATSUBA_MUL_C
-#undef BN_MP_KARATSUBA_SQR_C
 #undef BN_MP_TOOM_MUL_C
 #undef BN_MP_TOOM_SQR_C
 
@@ -21,6 +21,12 @@
 #ifndef RSA_PRIV_FILENAME
 #define RSA_PRIV_FILENAME "/etc/dropbear/dropbear_rsa_host_key"
 #endif
+#ifndef ED25519_PRIV_FILENAME
+#define ED25519_PRIV_FILENAME "/etc/dropbear/dropbear_ed25519_host_key"
+#endif
+#ifndef ECDSA_PRIV_FILENAME
+#define ECDSA_PRIV_FILENAME "/etc/dropbear/dropbear_ecdsa_host_key"
+#endif
 
 //#define INETD_MODE
 #define NON_INETD_MODE
@@ -31,12 +37,31 @@
 #define DROPBEAR_3DES
 #define DROPBEAR_BLOWFISH
 
+/* On CPUs with neither AES-NI nor SSSE3/NEON vector permutes, use the
+ * bitsliced constant time AES rather than the lookup table one, whose
+ * memory accesses can leak key bits through the cache. It costs speed:
+ * on x86-64 with the vector units ignored, CTR and CBC decryption run at
+ * about 0.6x the table code and CBC encryption at about 0.15x. It works on
+ * 64 bit words, so 32 bit CPUs such as MIPS32 and ARMv7 without NEON pay
+ * more. Undefine it to go back to the tables where speed matters more,
+ * or prefer chacha20-poly1305 on such CPUs */
+#define DROPBEAR_AES_CT
+
 /* Enable CBC mode for ciphers */
 #define DROPBEAR_ENABLE_CBC_MODE
 
 /* Enable "Counter Mode" for ciphers */
 #define DROPBEAR_ENABLE_CTR_MODE
 
+/* Enable AES-GCM (aes128-gcm@openssh.com). It is an AEAD mode, the
+ * authentication tag replaces the separate MAC */
+#define DROPBEAR_ENABLE_GCM_MODE
+
+/* Enable chacha20-poly1305@openssh.com. Like GCM it authenticates the
+ * packet itself, and is much faster than AES on CPUs without AES
+ * instructions */
+#define DROPBEAR_CHACHA20POLY1305
+
 /* Enable "None" cipher
  * Allows unencrypted traffic if requested by client.*/
 #define DROPBEAR_NONE_CIPHER
@@ -45,22 +70,53 @@
  * Protocol RFC requires sha1 and recommends sha1-96 */
 #define DROPBEAR_SHA1_HMAC
 #define DROPBEAR_SHA1_96_HMAC
+#define DROPBEAR_SHA2_256_HMAC
 #define DROPBEAR_MD5_HMAC
 
+/* Also offer the encrypt-then-MAC (-etm@openssh.com) forms of the above.
+ * The MAC covers the ciphertext and is checked before anything is
+ * decrypted, and the packet length is sent unencrypted */
+#define DROPBEAR_ETM_HMAC
+
+/* UMAC (umac-64@openssh.com and umac-128@openssh.com, and their -etm
+ * forms with DROPBEAR_ETM_HMAC). Several times faster than the HMACs,
+ * it needs AES for its keys */
+#define DROPBEAR_UMAC
+
 /* Allow "None" integrity if requested by client */
 #define DROPBEAR_NONE_INTEGRITY
 
 /* Private / Public Key algorithms */
 #define DROPBEAR_RSA
 #define DROPBEAR_DSS
+/* ssh-ed25519, signing takes tens of microseconds rather than the
+ * milliseconds of RSA or DSS. Needs a compiler with __int128 */
+#define DROPBEAR_ED25519
+/* ecdsa-sha2-nistp256, for clients that only take the NIST curves. Much
+ * cheaper to sign with than RSA or DSS, though not as cheap as ed25519.
+ * Needs a compiler with __int128 */
+#define DROPBEAR_ECDSA
 
 /* Enable "-R" command line argument to automatically generate hostkeys as-needed */
 #define DROPBEAR_DELAY_HOSTKEY
 
 /* Key exchange algorithms */
+/* curve25519-sha256, and its older name curve25519-sha256@libssh.org.
+ * Much cheaper than either DH group. Needs a compiler with __int128 */
+#define DROPBEAR_CURVE25519
+/* ecdh-sha2-nistp256, for clients that only take the NIST curves.
+ * Needs a compiler with __int128 */
+#define DROPBEAR_ECDH
 #define DROPBEAR_DH_GROUP1 1
 #define DROPBEAR_DH_GROUP14 1
 
+/* Draw the DH private exponent from twice the group's security strength
+ * in bits (RFC 8270: 224 bits for group14, 160 for group1) rather than
+ * the full size of the prime. The groups are safe primes, so this is
+ * as strong as the group, and it makes both exponentiations of each
+ * key exchange several times cheaper. */
+#define DROPBEAR_DH_SHORT_EXPONENT
+
 /* Allow password authentication */
 #define ENABLE_SVR_PASSWORD_AUTH
 
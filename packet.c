@@ -37,7 +37,7 @@
 #include "netio.h"
 
 static int read_packet_init(void);
-static void make_mac(unsigned int seqno, const struct key_context_directional * key_state,
+static void make_mac(unsigned int seqno, struct key_context_directional * key_state,
 		buffer * clear_buf, unsigned int clear_len, 
 		unsigned char *output_mac);
 static int checkmac(void);
@@ -203,7 +203,7 @@ static int read_packet_init() {
 
 	unsigned int maxlen;
 	int slen;
-	unsigned int len;
+	unsigned int len, plen, minlen;
 	unsigned int blocksize;
 	unsigned int macsize;
 
@@ -242,21 +242,48 @@ static int read_packet_init() {
 	/* now we have the first block, need to get packet length, so we decrypt
 	 * the first block (only need first 4 bytes) */
 	buf_setpos(ses.readbuf, 0);
-	if (ses.keys->recv.crypt_mode->decrypt(buf_getptr(ses.readbuf, blocksize), 
-				buf_getwriteptr(ses.readbuf, blocksize),
-				blocksize,
-				&ses.keys->recv.cipher_state) != CRYPT_OK) {
-		dropbear_exit("Error decrypting");
+#ifdef DROPBEAR_AEAD_MODE
+	if (ses.keys->recv.crypt_mode->aead_crypt) {
+		/* the whole packet is decrypted and authenticated together in
+		 * decrypt_packet(). plen is the length of the encrypted part,
+		 * which excludes the length field */
+		if (ses.keys->recv.crypt_mode->aead_getlength(ses.recvseq,
+					buf_getptr(ses.readbuf, blocksize), &plen,
+					blocksize,
+					&ses.keys->recv.cipher_state) != CRYPT_OK) {
+			dropbear_exit("Error decrypting");
+		}
+		len = plen + 4 + macsize;
+		/* only the part after the length field is padded to blocksize,
+		 * chacha20-poly1305 peers send packets as short as 12 bytes */
+		minlen = 4 + blocksize;
+	} else
+#endif
+	if (ses.keys->recv.algo_mac->etm) {
+		/* the length is in the clear, and nothing is decrypted until
+		 * decrypt_packet() has checked the MAC */
+		plen = buf_getint(ses.readbuf);
+		len = plen + 4 + macsize;
+		minlen = 4 + blocksize;
+	} else {
+		if (ses.keys->recv.crypt_mode->decrypt(buf_getptr(ses.readbuf, blocksize), 
+					buf_getwriteptr(ses.readbuf, blocksize),
+					blocksize,
+					&ses.keys->recv.cipher_state) != CRYPT_OK) {
+			dropbear_exit("Error decrypting");
+		}
+		plen = buf_getint(ses.readbuf) + 4;
+		len = plen + macsize;
+		minlen = MIN_PACKET_LEN;
 	}
-	len = buf_getint(ses.readbuf) + 4 + macsize;
 
 	TRACE2(("packet size is %u, block %u mac %u", len, blocksize, macsize))
 
 
 	/* check packet length */
 	if ((len > RECV_MAX_PACKET_LEN) ||
-		(len < MIN_PACKET_LEN + macsize) ||
-		((len - macsize) % blocksize != 0)) {
+		(len < minlen + macsize) ||
+		(plen % blocksize != 0)) {
 		dropbear_exit("Integrity error (bad packet size %u)", len);
 	}
 
@@ -282,23 +309,59 @@ void decrypt_packet() {
 
 	ses.kexstate.datarecv += ses.readbuf->len;
 
-	/* we've already decrypted the first blocksize in read_packet_init */
-	buf_setpos(ses.readbuf, blocksize);
+#ifdef DROPBEAR_AEAD_MODE
+	if (ses.keys->recv.crypt_mode->aead_crypt) {
+		/* nothing was decrypted in read_packet_init. Decrypt the
+		 * whole packet in-place, checking the tag that follows it */
+		buf_setpos(ses.readbuf, 0);
+		len = ses.readbuf->len - macsize;
+		if (ses.keys->recv.crypt_mode->aead_crypt(ses.recvseq,
+					buf_getptr(ses.readbuf, len + macsize),
+					buf_getwriteptr(ses.readbuf, len),
+					len, macsize,
+					&ses.keys->recv.cipher_state, DROPBEAR_AEAD_DECRYPT) != CRYPT_OK) {
+			dropbear_exit("Integrity error");
+		}
+		buf_incrpos(ses.readbuf, len);
+	} else
+#endif
+	if (ses.keys->recv.algo_mac->etm) {
+		/* check the MAC over the length and ciphertext first, so a
+		 * forged packet is rejected without decrypting it */
+		if (checkmac() != DROPBEAR_SUCCESS) {
+			dropbear_exit("Integrity error");
+		}
 
-	/* decrypt it in-place */
-	len = ses.readbuf->len - macsize - ses.readbuf->pos;
-	if (ses.keys->recv.crypt_mode->decrypt(
-				buf_getptr(ses.readbuf, len), 
-				buf_getwriteptr(ses.readbuf, len),
-				len,
-				&ses.keys->recv.cipher_state) != CRYPT_OK) {
-		dropbear_exit("Error decrypting");
-	}
-	buf_incrpos(ses.readbuf, len);
+		/* decrypt everything after the length in-place */
+		buf_setpos(ses.readbuf, 4);
+		len = ses.readbuf->len - macsize - ses.readbuf->pos;
+		if (ses.keys->recv.crypt_mode->decrypt(
+					buf_getptr(ses.readbuf, len), 
+					buf_getwriteptr(ses.readbuf, len),
+					len,
+					&ses.keys->recv.cipher_state) != CRYPT_OK) {
+			dropbear_exit("Error decrypting");
+		}
+		buf_incrpos(ses.readbuf, len);
+	} else {
+		/* we've already decrypted the first blocksize in read_packet_init */
+		buf_setpos(ses.readbuf, blocksize);
+
+		/* decrypt it in-place */
+		len = ses.readbuf->len - macsize - ses.readbuf->pos;
+		if (ses.keys->recv.crypt_mode->decrypt(
+					buf_getptr(ses.readbuf, len), 
+					buf_getwriteptr(ses.readbuf, len),
+					len,
+					&ses.keys->recv.cipher_state) != CRYPT_OK) {
+			dropbear_exit("Error decrypting");
+		}
+		buf_incrpos(ses.readbuf, len);
 
-	/* check the hmac */
-	if (checkmac() != DROPBEAR_SUCCESS) {
-		dropbear_exit("Integrity error");
+		/* check the hmac */
+		if (checkmac() != DROPBEAR_SUCCESS) {
+			dropbear_exit("Integrity error");
+		}
 	}
 
 	/* get padding length */
@@ -330,7 +393,8 @@ void decrypt_packet() {
 	TRACE2(("leave decrypt_packet"))
 }
 
-/* Checks the mac at the end of a decrypted readbuf.
+/* Checks the mac at the end of the readbuf, which has been decrypted
+ * unless the MAC is encrypt-then-mac.
  * Returns DROPBEAR_SUCCESS or DROPBEAR_FAILURE */
 static int checkmac() {
 
@@ -411,7 +475,7 @@ void maybe_flush_reply_queue() {
 void encrypt_packet() {
 
 	unsigned char padlen;
-	unsigned char blocksize, mac_size;
+	unsigned char blocksize, mac_size, aadlen;
 	buffer * writebuf; /* the packet which will go on the wire. This is 
 	                      encrypted in-place. */
 	unsigned char packet_type;
@@ -438,6 +502,14 @@ void encrypt_packet() {
 		
 	blocksize = ses.keys->trans.algo_crypt->blocksize;
 	mac_size = ses.keys->trans.algo_mac->hashsize;
+	/* AEAD and encrypt-then-mac modes send the length field in the
+	 * clear, it isn't part of the block aligned encrypted data */
+	aadlen = ses.keys->trans.algo_mac->etm ? 4 : 0;
+#ifdef DROPBEAR_AEAD_MODE
+	if (ses.keys->trans.crypt_mode->aead_crypt) {
+		aadlen = 4;
+	}
+#endif
 
 	/* Encrypted packet len is payload+5. We need to then make sure
 	 * there is enough space for padding or MIN_PACKET_LEN. 
@@ -465,9 +537,9 @@ void encrypt_packet() {
 	buf_setpos(ses.writepayload, 0);
 	buf_setlen(ses.writepayload, 0);
 
-	/* length of padding - packet length must be a multiple of blocksize,
-	 * with a minimum of 4 bytes of padding */
-	padlen = blocksize - (writebuf->len) % blocksize;
+	/* length of padding - packet length (less any cleartext length field)
+	 * must be a multiple of blocksize, with a minimum of 4 bytes of padding */
+	padlen = blocksize - (writebuf->len - aadlen) % blocksize;
 	if (padlen < 4) {
 		padlen += blocksize;
 	}
@@ -487,23 +559,57 @@ void encrypt_packet() {
 	buf_incrlen(writebuf, padlen);
 	genrandom(buf_getptr(writebuf, padlen), padlen);
 
-	make_mac(ses.transseq, &ses.keys->trans, writebuf, writebuf->len, mac_bytes);
+#ifdef DROPBEAR_AEAD_MODE
+	if (ses.keys->trans.crypt_mode->aead_crypt) {
+		/* encrypt in-place, the tag is written after the packet */
+		buf_setpos(writebuf, 0);
+		len = writebuf->len;
+		buf_incrlen(writebuf, mac_size);
+		if (ses.keys->trans.crypt_mode->aead_crypt(ses.transseq,
+					buf_getptr(writebuf, len),
+					buf_getwriteptr(writebuf, len + mac_size),
+					len, mac_size,
+					&ses.keys->trans.cipher_state, DROPBEAR_AEAD_ENCRYPT) != CRYPT_OK) {
+			dropbear_exit("Error encrypting");
+		}
+		buf_incrpos(writebuf, len + mac_size);
+	} else
+#endif
+	if (ses.keys->trans.algo_mac->etm) {
+		/* encrypt everything after the length in-place */
+		buf_setpos(writebuf, 4);
+		len = writebuf->len - 4;
+		if (ses.keys->trans.crypt_mode->encrypt(
+					buf_getptr(writebuf, len),
+					buf_getwriteptr(writebuf, len),
+					len,
+					&ses.keys->trans.cipher_state) != CRYPT_OK) {
+			dropbear_exit("Error encrypting");
+		}
 
-	/* do the actual encryption, in-place */
-	buf_setpos(writebuf, 0);
-	/* encrypt it in-place*/
-	len = writebuf->len;
-	if (ses.keys->trans.crypt_mode->encrypt(
-				buf_getptr(writebuf, len),
-				buf_getwriteptr(writebuf, len),
-				len,
-				&ses.keys->trans.cipher_state) != CRYPT_OK) {
-		dropbear_exit("Error encrypting");
-	}
-	buf_incrpos(writebuf, len);
+		/* then MAC the length and ciphertext */
+		make_mac(ses.transseq, &ses.keys->trans, writebuf, writebuf->len, mac_bytes);
+		buf_setpos(writebuf, writebuf->len);
+		buf_putbytes(writebuf, mac_bytes, mac_size);
+	} else {
+		make_mac(ses.transseq, &ses.keys->trans, writebuf, writebuf->len, mac_bytes);
+
+		/* do the actual encryption, in-place */
+		buf_setpos(writebuf, 0);
+		/* encrypt it in-place*/
+		len = writebuf->len;
+		if (ses.keys->trans.crypt_mode->encrypt(
+					buf_getptr(writebuf, len),
+					buf_getwriteptr(writebuf, len),
+					len,
+					&ses.keys->trans.cipher_state) != CRYPT_OK) {
+			dropbear_exit("Error encrypting");
+		}
+		buf_incrpos(writebuf, len);
 
-	/* stick the MAC on it */
-	buf_putbytes(writebuf, mac_bytes, mac_size);
+		/* stick the MAC on it */
+		buf_putbytes(writebuf, mac_bytes, mac_size);
+	}
 
 	/* Update counts */
 	ses.kexstate.datatrans += writebuf->len;
@@ -541,40 +647,51 @@ void writebuf_enqueue(buffer * writebuf, unsigned char packet_type) {
 
 /* Create the packet mac, and append H(seqno|clearbuf) to the output */
 /* output_mac must have ses.keys->trans.algo_mac->hashsize bytes. */
-static void make_mac(unsigned int seqno, const struct key_context_directional * key_state,
+static void make_mac(unsigned int seqno, struct key_context_directional * key_state,
 		buffer * clear_buf, unsigned int clear_len, 
 		unsigned char *output_mac) {
+	const struct ltc_hash_descriptor *hash_desc = key_state->algo_mac->hash_desc;
 	unsigned char seqbuf[4];
-	unsigned long bufsize;
-	hmac_state hmac;
-
-	if (key_state->algo_mac->hashsize > 0) {
-		/* calculate the mac */
-		if (hmac_init(&hmac, 
-					key_state->hash_index,
-					key_state->mackey,
-					key_state->algo_mac->keysize) != CRYPT_OK) {
-			dropbear_exit("HMAC error");
+	unsigned char inner_mac[MAX_HASH_SIZE];
+	hash_state hs;
+
+	if (key_state->algo_mac->mac != NULL) {
+		/* not an HMAC, UMAC */
+		buf_setpos(clear_buf, 0);
+		if (key_state->algo_mac->mac(seqno,
+					buf_getptr(clear_buf, clear_len), clear_len,
+					output_mac, &key_state->mac_state) != CRYPT_OK) {
+			dropbear_exit("MAC error");
 		}
-	
+	} else if (key_state->algo_mac->hashsize > 0) {
+		/* calculate the mac. The hashed ipad/opad blocks were
+		 * computed when the keys were set up, see gen_mac_states() */
+		memcpy(&hs, &key_state->mac_inner, sizeof(hash_state));
+
 		/* sequence number */
 		STORE32H(seqno, seqbuf);
-		if (hmac_process(&hmac, seqbuf, 4) != CRYPT_OK) {
+		if (hash_desc->process(&hs, seqbuf, 4) != CRYPT_OK) {
 			dropbear_exit("HMAC error");
 		}
 	
 		/* the actual contents */
 		buf_setpos(clear_buf, 0);
-		if (hmac_process(&hmac, 
+		if (hash_desc->process(&hs, 
 					buf_getptr(clear_buf, clear_len),
 					clear_len) != CRYPT_OK) {
 			dropbear_exit("HMAC error");
 		}
-	
-		bufsize = MAX_MAC_LEN;
-		if (hmac_done(&hmac, output_mac, &bufsize) != CRYPT_OK) {
+		if (hash_desc->done(&hs, inner_mac) != CRYPT_OK) {
+			dropbear_exit("HMAC error");
+		}
+
+		memcpy(&hs, &key_state->mac_outer, sizeof(hash_state));
+		if (hash_desc->process(&hs, inner_mac, hash_desc->hashsize) != CRYPT_OK
+				|| hash_desc->done(&hs, inner_mac) != CRYPT_OK) {
 			dropbear_exit("HMAC error");
 		}
+		/* hashsize may be truncated, eg sha1-96 */
+		memcpy(output_mac, inner_mac, key_state->algo_mac->hashsize);
 	}
 	TRACE2(("leave writemac"))
 }
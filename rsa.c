@@ -40,6 +40,8 @@
 
 static void rsa_pad_em(dropbear_rsa_key * key,
 	buffer *data_buf, mp_int * rsa_em);
+static int rsa_crt_init(dropbear_rsa_key *key);
+static void rsa_private(dropbear_rsa_key *key, mp_int *in, mp_int *out);
 
 /* Load a public rsa key from a buffer, initialising the values.
  * The key will have the same format as buf_put_rsa_key.
@@ -54,6 +56,13 @@ int buf_get_rsa_pub_key(buffer* buf, dropbear_rsa_key *key) {
 	key->d = NULL;
 	key->p = NULL;
 	key->q = NULL;
+	key->dP = NULL;
+	key->dQ = NULL;
+	key->qInv = NULL;
+	key->p_mont = NULL;
+	key->q_mont = NULL;
+	key->blind_re = NULL;
+	key->blind_rinv = NULL;
 
 	buf_incrpos(buf, 4+SSH_SIGNKEY_RSA_LEN); /* int + "ssh-rsa" */
 
@@ -116,6 +125,12 @@ int buf_get_rsa_priv_key(buffer* buf, dropbear_rsa_key *key) {
 			TRACE(("leave buf_get_rsa_priv_key: q: ret == DROPBEAR_FAILURE"))
 			goto out;
 		}
+
+		/* the key is loaded once, before forking for connections,
+		 * so this is shared by every signature */
+		if (rsa_crt_init(key) == DROPBEAR_FAILURE) {
+			dropbear_log(LOG_WARNING, "RSA key has bad p and q, not using CRT");
+		}
 	}
 
 	ret = DROPBEAR_SUCCESS;
@@ -159,6 +174,28 @@ void rsa_key_free(dropbear_rsa_key *key) {
 		mp_clear(key->q);
 		m_free(key->q);
 	}
+	if (key->dP) {
+		mp_clear(key->dP);
+		m_free(key->dP);
+	}
+	if (key->dQ) {
+		mp_clear(key->dQ);
+		m_free(key->dQ);
+	}
+	if (key->qInv) {
+		mp_clear(key->qInv);
+		m_free(key->qInv);
+	}
+	m_mp_fixed_free(key->p_mont);
+	m_mp_fixed_free(key->q_mont);
+	if (key->blind_re) {
+		mp_clear(key->blind_re);
+		m_free(key->blind_re);
+	}
+	if (key->blind_rinv) {
+		mp_clear(key->blind_rinv);
+		m_free(key->blind_rinv);
+	}
 	m_free(key);
 	TRACE2(("leave rsa_key_free"))
 }
@@ -212,12 +249,12 @@ void buf_put_rsa_sign(buffer* buf, dropbear_rsa_key *key, buffer *data_buf) {
 	DEF_MP_INT(rsa_s);
 	DEF_MP_INT(rsa_tmp1);
 	DEF_MP_INT(rsa_tmp2);
-	DEF_MP_INT(rsa_tmp3);
 	
 	TRACE(("enter buf_put_rsa_sign"))
 	dropbear_assert(key != NULL);
 
-	m_mp_init_multi(&rsa_s, &rsa_tmp1, &rsa_tmp2, &rsa_tmp3, NULL);
+	m_mp_init_multi(&rsa_s, &rsa_tmp1, &rsa_tmp2, NULL);
+	m_mp_scratch_begin(key->n);
 
 	rsa_pad_em(key, data_buf, &rsa_tmp1);
 
@@ -227,48 +264,56 @@ void buf_put_rsa_sign(buffer* buf, dropbear_rsa_key *key, buffer *data_buf) {
 
 	/* With blinding, s = (r^(-1))((em)*r^e)^d mod n */
 
-	/* generate the r blinding value */
-	/* rsa_tmp2 is r */
-	gen_random_mpint(key->n, &rsa_tmp2);
+	/* the r^e, r^-1 pair is made once and then squared for each
+	 * signature, (r^2)^e = (r^e)^2, so a new r costs two
+	 * multiplications rather than an exptmod and an invmod */
+	if (key->blind_re == NULL) {
+		rsa_blinding_refresh(key);
+	}
 
 	/* rsa_tmp1 is em */
 	/* em' = em * r^e mod n */
-
-	/* rsa_s used as a temp var*/
-	if (mp_exptmod(&rsa_tmp2, key->e, key->n, &rsa_s) != MP_OKAY) {
-		dropbear_exit("RSA error");
-	}
-	if (mp_invmod(&rsa_tmp2, key->n, &rsa_tmp3) != MP_OKAY) {
-		dropbear_exit("RSA error");
-	}
-	if (mp_mulmod(&rsa_tmp1, &rsa_s, key->n, &rsa_tmp2) != MP_OKAY) {
+	if (mp_mulmod(&rsa_tmp1, key->blind_re, key->n, &rsa_tmp2) != MP_OKAY) {
 		dropbear_exit("RSA error");
 	}
 
 	/* rsa_tmp2 is em' */
 	/* s' = (em')^d mod n */
-	if (mp_exptmod(&rsa_tmp2, key->d, key->n, &rsa_tmp1) != MP_OKAY) {
+	rsa_private(key, &rsa_tmp2, &rsa_s);
+
+	/* rsa_s is s' */
+	/* s = (s')r^(-1) mod n */
+	if (mp_mulmod(&rsa_s, key->blind_rinv, key->n, &rsa_s) != MP_OKAY) {
 		dropbear_exit("RSA error");
 	}
 
-	/* rsa_tmp1 is s' */
-	/* rsa_tmp3 is r^(-1) mod n */
-	/* s = (s')r^(-1) mod n */
-	if (mp_mulmod(&rsa_tmp1, &rsa_tmp3, key->n, &rsa_s) != MP_OKAY) {
+	if (mp_sqrmod(key->blind_re, key->n, key->blind_re) != MP_OKAY
+			|| mp_sqrmod(key->blind_rinv, key->n, key->blind_rinv) != MP_OKAY) {
 		dropbear_exit("RSA error");
 	}
+	m_mp_scratch_keep(key->blind_re);
+	m_mp_scratch_keep(key->blind_rinv);
 
 #else
 
 	/* s = em^d mod n */
 	/* rsa_tmp1 is em */
-	if (mp_exptmod(&rsa_tmp1, key->d, key->n, &rsa_s) != MP_OKAY) {
-		dropbear_exit("RSA error");
-	}
+	rsa_private(key, &rsa_tmp1, &rsa_s);
 
 #endif /* RSA_BLINDING */
 
-	mp_clear_multi(&rsa_tmp1, &rsa_tmp2, &rsa_tmp3, NULL);
+	/* A fault during signing (especially in one half of the CRT)
+	 * gives a signature that reveals a factor of n, so check
+	 * s^e == em before it goes anywhere. e is small, this is cheap. */
+	/* rsa_tmp1 is em */
+	if (mp_exptmod(&rsa_s, key->e, key->n, &rsa_tmp2) != MP_OKAY) {
+		dropbear_exit("RSA error");
+	}
+	if (mp_cmp(&rsa_tmp1, &rsa_tmp2) != MP_EQ) {
+		dropbear_exit("RSA signature failed verification");
+	}
+
+	mp_clear_multi(&rsa_tmp1, &rsa_tmp2, NULL);
 	
 	/* create the signature to return */
 	buf_putstring(buf, SSH_SIGNKEY_RSA, SSH_SIGNKEY_RSA_LEN);
@@ -289,6 +334,7 @@ void buf_put_rsa_sign(buffer* buf, dropbear_rsa_key *key, buffer *data_buf) {
 	}
 	buf_incrwritepos(buf, ssize);
 	mp_clear(&rsa_s);
+	m_mp_scratch_end();
 
 #if defined(DEBUG_RSA) && defined(DEBUG_TRACE)
 	if (!debug_trace) {
@@ -299,6 +345,113 @@ void buf_put_rsa_sign(buffer* buf, dropbear_rsa_key *key, buffer *data_buf) {
 	TRACE(("leave buf_put_rsa_sign"))
 }
 
+/* Compute the CRT parameters for a private key with p and q, checking
+ * that p*q is n. Returns DROPBEAR_SUCCESS, or DROPBEAR_FAILURE leaving
+ * them NULL so that signing uses d */
+static int rsa_crt_init(dropbear_rsa_key *key) {
+
+	int ret = DROPBEAR_FAILURE;
+	DEF_MP_INT(tmp);
+
+	TRACE(("enter rsa_crt_init"))
+	m_mp_init(&tmp);
+	m_mp_alloc_init_multi(&key->dP, &key->dQ, &key->qInv, NULL);
+
+	if (mp_mul(key->p, key->q, &tmp) != MP_OKAY
+			|| mp_cmp(&tmp, key->n) != MP_EQ) {
+		goto out;
+	}
+
+	/* dP = d mod (p-1), dQ = d mod (q-1), qInv = q^-1 mod p */
+	if (mp_sub_d(key->p, 1, &tmp) != MP_OKAY
+			|| mp_mod(key->d, &tmp, key->dP) != MP_OKAY
+			|| mp_sub_d(key->q, 1, &tmp) != MP_OKAY
+			|| mp_mod(key->d, &tmp, key->dQ) != MP_OKAY
+			|| mp_invmod(key->q, key->p, key->qInv) != MP_OKAY) {
+		goto out;
+	}
+
+	key->p_mont = m_mp_fixed_new(key->p);
+	key->q_mont = m_mp_fixed_new(key->q);
+
+	ret = DROPBEAR_SUCCESS;
+out:
+	mp_clear(&tmp);
+	if (ret == DROPBEAR_FAILURE) {
+		mp_clear_multi(key->dP, key->dQ, key->qInv, NULL);
+		m_free(key->dP);
+		m_free(key->dQ);
+		m_free(key->qInv);
+	}
+	TRACE(("leave rsa_crt_init"))
+	return ret;
+}
+
+/* out = in^d mod n. With the CRT parameters this is two exponentiations
+ * of half the size, mod p and mod q, combined with Garner's formula:
+ *   m1 = in^dP mod p, m2 = in^dQ mod q
+ *   out = m2 + q * ((m1 - m2) * qInv mod p) */
+static void rsa_private(dropbear_rsa_key *key, mp_int *in, mp_int *out) {
+
+	DEF_MP_INT(m1);
+	DEF_MP_INT(m2);
+
+	if (key->dP == NULL) {
+		if (mp_exptmod(in, key->d, key->n, out) != MP_OKAY) {
+			dropbear_exit("RSA error");
+		}
+		return;
+	}
+
+	m_mp_init_multi(&m1, &m2, NULL);
+
+	if (mp_mod(in, key->p, &m1) != MP_OKAY
+			|| m_mp_exptmod(&m1, key->dP, key->p, key->p_mont, &m1) != MP_OKAY
+			|| mp_mod(in, key->q, &m2) != MP_OKAY
+			|| m_mp_exptmod(&m2, key->dQ, key->q, key->q_mont, &m2) != MP_OKAY) {
+		dropbear_exit("RSA error");
+	}
+
+	/* mp_mulmod leaves a non-negative result for m1 < m2 */
+	if (mp_sub(&m1, &m2, &m1) != MP_OKAY
+			|| mp_mulmod(&m1, key->qInv, key->p, &m1) != MP_OKAY
+			|| mp_mul(&m1, key->q, &m1) != MP_OKAY
+			|| mp_add(&m1, &m2, out) != MP_OKAY) {
+		dropbear_exit("RSA error");
+	}
+
+	mp_clear_multi(&m1, &m2, NULL);
+}
+
+#ifdef RSA_BLINDING
+/* Replace the blinding pair with one from a fresh random r. Squaring
+ * alone would give every process forked from the listener the same
+ * sequence, so the listener calls this after each fork (via
+ * sign_key_refresh_blinding()) and the child starts from its own r. */
+void rsa_blinding_refresh(dropbear_rsa_key *key) {
+
+	DEF_MP_INT(r);
+
+	TRACE(("enter rsa_blinding_refresh"))
+	m_mp_init(&r);
+	if (key->blind_re == NULL) {
+		m_mp_alloc_init_multi(&key->blind_re, &key->blind_rinv, NULL);
+	}
+
+	/* r must be invertible, which all but a negligible few are */
+	do {
+		gen_random_mpint(key->n, &r);
+	} while (mp_invmod(&r, key->n, key->blind_rinv) != MP_OKAY);
+
+	if (mp_exptmod(&r, key->e, key->n, key->blind_re) != MP_OKAY) {
+		dropbear_exit("RSA error");
+	}
+
+	mp_clear(&r);
+	TRACE(("leave rsa_blinding_refresh"))
+}
+#endif /* RSA_BLINDING */
+
 /* Creates the message value as expected by PKCS, see rfc2437 etc */
 /* format to be padded to is:
  * EM = 01 | FF* | 00 | prefix | hash
@@ -40,6 +40,19 @@ typedef struct {
 	mp_int* d;
 	mp_int* p;
 	mp_int* q;
+	/* CRT parameters derived from p and q at load, NULL for keys
+	 * without them: d mod (p-1), d mod (q-1) and q^-1 mod p */
+	mp_int* dP;
+	mp_int* dQ;
+	mp_int* qInv;
+	/* and the constants for exponentiations mod p and mod q, NULL
+	 * where the fixed size code doesn't take them, see m_mp_fixed_new() */
+	mp_fixed_mont* p_mont;
+	mp_fixed_mont* q_mont;
+	/* RSA_BLINDING pair r^e and r^-1 mod n, squared after each
+	 * signature, see rsa_blinding_refresh() */
+	mp_int* blind_re;
+	mp_int* blind_rinv;
 
 } dropbear_rsa_key;
 
@@ -49,6 +62,9 @@ int buf_get_rsa_priv_key(buffer* buf, dropbear_rsa_key *key);
 void buf_put_rsa_pub_key(buffer* buf, dropbear_rsa_key *key);
 void buf_put_rsa_priv_key(buffer* buf, dropbear_rsa_key *key);
 void rsa_key_free(dropbear_rsa_key *key);
+#ifdef RSA_BLINDING
+void rsa_blinding_refresh(dropbear_rsa_key *key);
+#endif
 
 #endif /* DROPBEAR_RSA */
 
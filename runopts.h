@@ -36,6 +36,7 @@ typedef struct runopts {
 	time_t keepalive_secs; /* Time between sending keepalives. 0 is off */
 	time_t idle_timeout_secs; /* Exit if no traffic is sent/received in this time */
 	int usingsyslog;
+	int portable_crypto; /* don't use the CPU specific crypto kernels */
 
 #ifdef ENABLE_USER_ALGO_LIST
 	char *cipher_list;
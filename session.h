@@ -38,6 +38,8 @@
 #include "dbutil.h"
 #include "netio.h"
 #include "list.h"
+#include "gcm.h"
+#include "chachapoly.h"
 
 extern int sessinitdone; /* Is set to 0 somewhere */
 extern int exitflag;
@@ -65,16 +67,32 @@ struct key_context_directional {
 	const struct dropbear_cipher *algo_crypt;
 	const struct dropbear_cipher_mode *crypt_mode;
 	const struct dropbear_hash *algo_mac;
-	int hash_index; /* lookup for libtomcrypt */
 	int algo_comp; /* compression */
 	/* actual keys */
 	union {
 		symmetric_CBC cbc;
 #ifdef DROPBEAR_ENABLE_CTR_MODE
 		symmetric_CTR ctr;
+#endif
+#ifdef DROPBEAR_ENABLE_GCM_MODE
+		dropbear_gcm_state gcm;
+#endif
+#ifdef DROPBEAR_CHACHA20POLY1305
+		dropbear_chachapoly_state chachapoly;
 #endif
 	} cipher_state;
 	unsigned char mackey[MAX_MAC_LEN];
+	/* HMAC hash states with the ipad/opad key blocks already processed,
+	 * set up in gen_new_keys() and copied at the start of each packet */
+	hash_state mac_inner;
+	hash_state mac_outer;
+	/* state for the MACs that aren't an HMAC, see struct dropbear_hash */
+	union {
+#ifdef DROPBEAR_UMAC
+		umac_state umac;
+#endif
+		char dummy;
+	} mac_state;
 	int valid;
 };
 
@@ -185,6 +203,11 @@ struct sshsession {
 
 	void(*extra_session_cleanup)(void); /* client or server specific cleanup */
 
+	int(*idle_work)(int run); /* Optional work for when the session has
+								 nothing else to do. Returns whether there
+								 is any, and does a piece of it if run is
+								 set */
+
 	struct AuthState authstate; /* Common amongst client and server, since most
 								   struct elements are common */
 
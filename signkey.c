@@ -35,9 +35,15 @@ static const char * const signkey_names[DROPBEAR_SIGNKEY_NUM_NAMED] = {
 #ifdef DROPBEAR_DSS
 	"ssh-dss",
 #endif
+#ifdef DROPBEAR_ED25519
+	"ssh-ed25519",
+#endif
+#ifdef DROPBEAR_ECDSA
+	"ecdsa-sha2-nistp256",
+#endif
 };
 
-/* malloc a new sign_key and set the dss and rsa keys to NULL */
+/* malloc a new sign_key and set the dss, rsa, ed25519 and ecdsa keys to NULL */
 sign_key * new_sign_key() {
 
 	sign_key * ret;
@@ -88,6 +94,14 @@ signkey_key_ptr(sign_key *key, enum signkey_type type) {
 #ifdef DROPBEAR_DSS
 		case DROPBEAR_SIGNKEY_DSS:
 			return (void**)&key->dsskey;
+#endif
+#ifdef DROPBEAR_ED25519
+		case DROPBEAR_SIGNKEY_ED25519:
+			return (void**)&key->ed25519key;
+#endif
+#ifdef DROPBEAR_ECDSA
+		case DROPBEAR_SIGNKEY_ECDSA_NISTP256:
+			return (void**)&key->ecdsakey;
 #endif
 		default:
 			return NULL;
@@ -142,6 +156,26 @@ int buf_get_pub_key(buffer *buf, sign_key *key, enum signkey_type *type) {
 		}
 	}
 #endif
+#ifdef DROPBEAR_ED25519
+	if (keytype == DROPBEAR_SIGNKEY_ED25519) {
+		ed25519_key_free(key->ed25519key);
+		key->ed25519key = m_malloc(sizeof(*key->ed25519key));
+		ret = buf_get_ed25519_pub_key(buf, key->ed25519key);
+		if (ret == DROPBEAR_FAILURE) {
+			m_free(key->ed25519key);
+		}
+	}
+#endif
+#ifdef DROPBEAR_ECDSA
+	if (keytype == DROPBEAR_SIGNKEY_ECDSA_NISTP256) {
+		ecdsa_key_free(key->ecdsakey);
+		key->ecdsakey = m_malloc(sizeof(*key->ecdsakey));
+		ret = buf_get_ecdsa_pub_key(buf, key->ecdsakey);
+		if (ret == DROPBEAR_FAILURE) {
+			m_free(key->ecdsakey);
+		}
+	}
+#endif
 
 	TRACE2(("leave buf_get_pub_key"))
 
@@ -195,6 +229,28 @@ int buf_get_priv_key(buffer *buf, sign_key *key, enum signkey_type *type) {
 		}
 	}
 #endif
+#ifdef DROPBEAR_ED25519
+	if (keytype == DROPBEAR_SIGNKEY_ED25519) {
+		ed25519_key_free(key->ed25519key);
+		key->ed25519key = m_malloc(sizeof(*key->ed25519key));
+		ret = buf_get_ed25519_priv_key(buf, key->ed25519key);
+		if (ret == DROPBEAR_FAILURE) {
+			ed25519_key_free(key->ed25519key);
+			key->ed25519key = NULL;
+		}
+	}
+#endif
+#ifdef DROPBEAR_ECDSA
+	if (keytype == DROPBEAR_SIGNKEY_ECDSA_NISTP256) {
+		ecdsa_key_free(key->ecdsakey);
+		key->ecdsakey = m_malloc(sizeof(*key->ecdsakey));
+		ret = buf_get_ecdsa_priv_key(buf, key->ecdsakey);
+		if (ret == DROPBEAR_FAILURE) {
+			ecdsa_key_free(key->ecdsakey);
+			key->ecdsakey = NULL;
+		}
+	}
+#endif
 
 	TRACE2(("leave buf_get_priv_key"))
 
@@ -202,7 +258,8 @@ int buf_get_priv_key(buffer *buf, sign_key *key, enum signkey_type *type) {
 	
 }
 
-/* type is either DROPBEAR_SIGNKEY_DSS or DROPBEAR_SIGNKEY_RSA */
+/* type is DROPBEAR_SIGNKEY_DSS, DROPBEAR_SIGNKEY_RSA, DROPBEAR_SIGNKEY_ED25519
+ * or DROPBEAR_SIGNKEY_ECDSA_NISTP256 */
 void buf_put_pub_key(buffer* buf, sign_key *key, enum signkey_type type) {
 
 	buffer *pubkeys;
@@ -219,6 +276,16 @@ void buf_put_pub_key(buffer* buf, sign_key *key, enum signkey_type type) {
 	if (type == DROPBEAR_SIGNKEY_RSA) {
 		buf_put_rsa_pub_key(pubkeys, key->rsakey);
 	}
+#endif
+#ifdef DROPBEAR_ED25519
+	if (type == DROPBEAR_SIGNKEY_ED25519) {
+		buf_put_ed25519_pub_key(pubkeys, key->ed25519key);
+	}
+#endif
+#ifdef DROPBEAR_ECDSA
+	if (type == DROPBEAR_SIGNKEY_ECDSA_NISTP256) {
+		buf_put_ecdsa_pub_key(pubkeys, key->ecdsakey);
+	}
 #endif
 	if (pubkeys->len == 0) {
 		dropbear_exit("Bad key types in buf_put_pub_key");
@@ -229,7 +296,8 @@ void buf_put_pub_key(buffer* buf, sign_key *key, enum signkey_type type) {
 	TRACE2(("leave buf_put_pub_key"))
 }
 
-/* type is either DROPBEAR_SIGNKEY_DSS or DROPBEAR_SIGNKEY_RSA */
+/* type is DROPBEAR_SIGNKEY_DSS, DROPBEAR_SIGNKEY_RSA, DROPBEAR_SIGNKEY_ED25519
+ * or DROPBEAR_SIGNKEY_ECDSA_NISTP256 */
 void buf_put_priv_key(buffer* buf, sign_key *key, enum signkey_type type) {
 
 	TRACE(("enter buf_put_priv_key"))
@@ -248,6 +316,20 @@ void buf_put_priv_key(buffer* buf, sign_key *key, enum signkey_type type) {
 		TRACE(("leave buf_put_priv_key: rsa done"))
 		return;
 	}
+#endif
+#ifdef DROPBEAR_ED25519
+	if (type == DROPBEAR_SIGNKEY_ED25519) {
+		buf_put_ed25519_priv_key(buf, key->ed25519key);
+		TRACE(("leave buf_put_priv_key: ed25519 done"))
+		return;
+	}
+#endif
+#ifdef DROPBEAR_ECDSA
+	if (type == DROPBEAR_SIGNKEY_ECDSA_NISTP256) {
+		buf_put_ecdsa_priv_key(buf, key->ecdsakey);
+		TRACE(("leave buf_put_priv_key: ecdsa done"))
+		return;
+	}
 #endif
 	dropbear_exit("Bad key types in put pub key");
 }
@@ -264,6 +346,14 @@ void sign_key_free(sign_key *key) {
 	rsa_key_free(key->rsakey);
 	key->rsakey = NULL;
 #endif
+#ifdef DROPBEAR_ED25519
+	ed25519_key_free(key->ed25519key);
+	key->ed25519key = NULL;
+#endif
+#ifdef DROPBEAR_ECDSA
+	ecdsa_key_free(key->ecdsakey);
+	key->ecdsakey = NULL;
+#endif
 
 	m_free(key->filename);
 
@@ -271,6 +361,34 @@ void sign_key_free(sign_key *key) {
 	TRACE2(("leave sign_key_free"))
 }
 
+#ifdef RSA_BLINDING
+/* Give the host keys fresh blinding values, called by the listener
+ * after forking so that each connection blinds with a different r */
+void sign_key_refresh_blinding(sign_key *key) {
+#ifdef DROPBEAR_RSA
+	if (key->rsakey && key->rsakey->d) {
+		rsa_blinding_refresh(key->rsakey);
+	}
+#endif
+}
+#endif
+
+/* Work done ahead of signing with key as type, by the session while it is
+ * idle. Returns whether there is any to do, and does a piece of it if run
+ * is set */
+int sign_key_precompute(sign_key *key, enum signkey_type type, int run) {
+#ifdef DROPBEAR_DSS
+	if (type == DROPBEAR_SIGNKEY_DSS
+			&& key->dsskey && dss_nonce_wanted(key->dsskey)) {
+		if (run) {
+			dss_nonce_refill(key->dsskey);
+		}
+		return 1;
+	}
+#endif
+	return 0;
+}
+
 void buf_put_sign(buffer* buf, sign_key *key, enum signkey_type type, 
 	buffer *data_buf) {
 	buffer *sigblob;
@@ -285,6 +403,16 @@ void buf_put_sign(buffer* buf, sign_key *key, enum signkey_type type,
 	if (type == DROPBEAR_SIGNKEY_RSA) {
 		buf_put_rsa_sign(sigblob, key->rsakey, data_buf);
 	}
+#endif
+#ifdef DROPBEAR_ED25519
+	if (type == DROPBEAR_SIGNKEY_ED25519) {
+		buf_put_ed25519_sign(sigblob, key->ed25519key, data_buf);
+	}
+#endif
+#ifdef DROPBEAR_ECDSA
+	if (type == DROPBEAR_SIGNKEY_ECDSA_NISTP256) {
+		buf_put_ecdsa_sign(sigblob, key->ecdsakey, data_buf);
+	}
 #endif
 	if (sigblob->len == 0) {
 		dropbear_exit("Non-matching signing type");
@@ -28,6 +28,8 @@
 #include "buffer.h"
 #include "dss.h"
 #include "rsa.h"
+#include "ed25519.h"
+#include "ecdsa.h"
 
 enum signkey_type {
 #ifdef DROPBEAR_RSA
@@ -35,6 +37,12 @@ enum signkey_type {
 #endif
 #ifdef DROPBEAR_DSS
 	DROPBEAR_SIGNKEY_DSS,
+#endif
+#ifdef DROPBEAR_ED25519
+	DROPBEAR_SIGNKEY_ED25519,
+#endif
+#ifdef DROPBEAR_ECDSA
+	DROPBEAR_SIGNKEY_ECDSA_NISTP256,
 #endif
 	DROPBEAR_SIGNKEY_NUM_NAMED,
 	DROPBEAR_SIGNKEY_ANY = 80,
@@ -61,6 +69,12 @@ struct SIGN_key {
 #ifdef DROPBEAR_RSA
 	dropbear_rsa_key * rsakey;
 #endif
+#ifdef DROPBEAR_ED25519
+	dropbear_ed25519_key * ed25519key;
+#endif
+#ifdef DROPBEAR_ECDSA
+	dropbear_ecdsa_key * ecdsakey;
+#endif
 };
 
 typedef struct SIGN_key sign_key;
@@ -74,6 +88,10 @@ void buf_put_pub_key(buffer* buf, sign_key *key, enum signkey_type type);
 void buf_put_priv_key(buffer* buf, sign_key *key, enum signkey_type type);
 void sign_key_free(sign_key *key);
 void buf_put_sign(buffer* buf, sign_key *key, enum signkey_type type, buffer *data_buf);
+#ifdef RSA_BLINDING
+void sign_key_refresh_blinding(sign_key *key);
+#endif
+int sign_key_precompute(sign_key *key, enum signkey_type type, int run);
 
 void** signkey_key_ptr(sign_key *key, enum signkey_type type);
 
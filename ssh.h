@@ -105,6 +105,12 @@
 #define SSH_SIGNKEY_DSS_LEN 7
 #define SSH_SIGNKEY_RSA "ssh-rsa"
 #define SSH_SIGNKEY_RSA_LEN 7
+#define SSH_SIGNKEY_ED25519 "ssh-ed25519"
+#define SSH_SIGNKEY_ED25519_LEN 11
+#define SSH_SIGNKEY_ECDSA_NISTP256 "ecdsa-sha2-nistp256"
+#define SSH_SIGNKEY_ECDSA_NISTP256_LEN 19
+#define SSH_ECC_NISTP256 "nistp256"
+#define SSH_ECC_NISTP256_LEN 8
 
 /* Agent commands. These aren't part of the spec, and are defined
  * only on the openssh implementation. */
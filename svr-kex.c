@@ -34,10 +34,11 @@
 #include "bignum.h"
 #include "dbrandom.h"
 #include "runopts.h"
-// #include "ecc.h"
+#include "ecc.h"
 #include "gensignkey.h"
 
-static void send_msg_kexdh_reply(mp_int *dh_e);
+static void send_msg_kexdh_reply(mp_int *dh_e,
+		const unsigned char *q_c, unsigned int q_c_len);
 
 /* Handle a diffie-hellman key exchange initialisation. This involves
  * calculating a session key reply value, and corresponding hash. These
@@ -46,6 +47,8 @@ static void send_msg_kexdh_reply(mp_int *dh_e);
 void recv_msg_kexdh_init() {
 
 	DEF_MP_INT(dh_e);
+	const unsigned char *q_c = NULL;
+	unsigned int q_c_len = 0;
 
 	TRACE(("enter recv_msg_kexdh_init"))
 	if (!ses.kexstate.recvkexinit) {
@@ -61,13 +64,17 @@ void recv_msg_kexdh_init() {
 			break;
 		case DROPBEAR_KEX_ECDH:
 		case DROPBEAR_KEX_CURVE25519:
+			/* Q_C, left in the payload */
+			q_c_len = buf_getint(ses.payload);
+			q_c = buf_getptr(ses.payload, q_c_len);
+			buf_incrpos(ses.payload, q_c_len);
 			break;
 	}
 	if (ses.payload->pos != ses.payload->len) {
 		dropbear_exit("Bad kex value");
 	}
 
-	send_msg_kexdh_reply(&dh_e);
+	send_msg_kexdh_reply(&dh_e, q_c, q_c_len);
 
 	mp_clear(&dh_e);
 
@@ -101,6 +108,16 @@ static void svr_ensure_hostkey() {
 		case DROPBEAR_SIGNKEY_DSS:
 			fn = DSS_PRIV_FILENAME;
 			break;
+#endif
+#ifdef DROPBEAR_ED25519
+		case DROPBEAR_SIGNKEY_ED25519:
+			fn = ED25519_PRIV_FILENAME;
+			break;
+#endif
+#ifdef DROPBEAR_ECDSA
+		case DROPBEAR_SIGNKEY_ECDSA_NISTP256:
+			fn = ECDSA_PRIV_FILENAME;
+			break;
 #endif
 		default:
 			dropbear_assert(0);
@@ -141,7 +158,8 @@ out:
  *
  * See the transport RFC4253 section 8 for details
  * or RFC5656 section 4 for elliptic curve variant. */
-static void send_msg_kexdh_reply(mp_int *dh_e) {
+static void send_msg_kexdh_reply(mp_int *dh_e,
+		const unsigned char *q_c, unsigned int q_c_len) {
 	TRACE(("enter send_msg_kexdh_reply"))
 
 	/* we can start creating the kexdh_reply packet */
@@ -170,8 +188,30 @@ static void send_msg_kexdh_reply(mp_int *dh_e) {
 			}
 			break;
 		case DROPBEAR_KEX_ECDH:
+#ifdef DROPBEAR_ECDH
+			{
+			struct kex_ecdh_param *param = gen_kexecdh_param();
+			kexecdh_comb_key(param, q_c, q_c_len, svr_opts.hostkey);
+
+			/* put Q_S */
+			buf_putstring(ses.writepayload, (const char*)param->pub,
+					ECC256_POINT_LEN);
+			free_kexecdh_param(param);
+			}
+#endif
 			break;
 		case DROPBEAR_KEX_CURVE25519:
+#ifdef DROPBEAR_CURVE25519
+			{
+			struct kex_curve25519_param *param = gen_kexcurve25519_param();
+			kexcurve25519_comb_key(param, q_c, q_c_len, svr_opts.hostkey);
+
+			/* put Q_S */
+			buf_putstring(ses.writepayload, (const char*)param->pub,
+					CURVE25519_LEN);
+			free_kexcurve25519_param(param);
+			}
+#endif
 			break;
 	}
 
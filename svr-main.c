@@ -280,6 +280,12 @@ static void main_noinetd() {
 				preauth_addrs[conn_idx] = remote_host;
 				remote_host = NULL;
 
+#ifdef RSA_BLINDING
+				/* the child has the blinding values, draw new ones
+				 * for the next connection */
+				sign_key_refresh_blinding(svr_opts.hostkey);
+#endif
+
 			} else {
 
 				/* child */
@@ -388,11 +394,27 @@ static void commonsetup() {
 
 	crypto_init();
 
+	/* the DH groups are inherited by each connection */
+	kexdh_init_groups();
+#ifdef DROPBEAR_ED25519
+	/* and so is the ed25519 signing table */
+	ed25519_init_base();
+#endif
+#ifdef DROPBEAR_ECC
+	/* and the nistp256 base point table, for ECDH keys and ECDSA */
+	ecc256_init_base();
+#endif
+
 	/* Now we can setup the hostkeys - needs to be after logging is on,
 	 * otherwise we might end up blatting error messages to the socket */
 	load_all_hostkeys();
 
 	seedrandom();
+
+#ifdef RSA_BLINDING
+	/* after seeding, so that the first connection doesn't have to */
+	sign_key_refresh_blinding(svr_opts.hostkey);
+#endif
 }
 
 /* Set up listening sockets for all the requested ports */
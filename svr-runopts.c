@@ -51,6 +51,12 @@ static void printhelp(const char * progname) {
 #ifdef DROPBEAR_RSA
 					"		rsa %s\n"
 #endif
+#ifdef DROPBEAR_ED25519
+					"		ed25519 %s\n"
+#endif
+#ifdef DROPBEAR_ECDSA
+					"		ecdsa %s\n"
+#endif
 #ifdef DROPBEAR_DELAY_HOSTKEY
 					"-R		Create hostkeys as required\n" 
 #endif
@@ -85,6 +91,8 @@ static void printhelp(const char * progname) {
 					"-W <receive_window_buffer> (default %d, larger may be faster, max 1MB)\n"
 					"-K <keepalive>  (0 is never, default %d, in seconds)\n"
 					"-I <idle_timeout>  (0 is never, default %d, in seconds)\n"
+					"-C		Use only the portable crypto code, not the\n"
+					"		CPU specific kernels (see also DROPBEAR_CPU_DISABLE)\n"
 					"-V    Version\n"
 #ifdef DEBUG_TRACE
 					"-v		verbose (compiled with DEBUG_TRACE)\n"
@@ -95,6 +103,12 @@ static void printhelp(const char * progname) {
 #endif
 #ifdef DROPBEAR_RSA
 					RSA_PRIV_FILENAME,
+#endif
+#ifdef DROPBEAR_ED25519
+					ED25519_PRIV_FILENAME,
+#endif
+#ifdef DROPBEAR_ECDSA
+					ECDSA_PRIV_FILENAME,
 #endif
 					DROPBEAR_MAX_PORTS, DROPBEAR_DEFPORT, DROPBEAR_PIDFILE,
 					DEFAULT_RECV_WINDOW, DEFAULT_KEEPALIVE, DEFAULT_IDLE_TIMEOUT);
@@ -144,6 +158,7 @@ void svr_getopts(int argc, char ** argv) {
 	opts.recv_window = DEFAULT_RECV_WINDOW;
 	opts.keepalive_secs = DEFAULT_KEEPALIVE;
 	opts.idle_timeout_secs = DEFAULT_IDLE_TIMEOUT;
+	opts.portable_crypto = 0;
 
 	for (i = 1; i < (unsigned int)argc; i++) {
 		if (argv[i][0] != '-' || argv[i][1] == '\0')
@@ -198,6 +213,9 @@ void svr_getopts(int argc, char ** argv) {
 				case 'I':
 					next = &idle_timeout_arg;
 					break;
+				case 'C':
+					opts.portable_crypto = 1;
+					break;
 #ifdef ENABLE_SVR_PASSWORD_AUTH
 				case 's':
 					svr_opts.noauthpass = 1;
@@ -423,6 +441,18 @@ static void loadhostkey(const char *keyfile, int fatal_duplicate) {
 	}
 #endif
 
+#ifdef DROPBEAR_ED25519
+	if (type == DROPBEAR_SIGNKEY_ED25519) {
+		loadhostkey_helper("ed25519", (void**)&read_key->ed25519key, (void**)&svr_opts.hostkey->ed25519key, fatal_duplicate);
+	}
+#endif
+
+#ifdef DROPBEAR_ECDSA
+	if (type == DROPBEAR_SIGNKEY_ECDSA_NISTP256) {
+		loadhostkey_helper("ECDSA", (void**)&read_key->ecdsakey, (void**)&svr_opts.hostkey->ecdsakey, fatal_duplicate);
+	}
+#endif
+
 	sign_key_free(read_key);
 	TRACE(("leave loadhostkey"))
 }
@@ -456,6 +486,14 @@ void load_all_hostkeys() {
 	loadhostkey(DSS_PRIV_FILENAME, 0);
 #endif
 
+#ifdef DROPBEAR_ED25519
+	loadhostkey(ED25519_PRIV_FILENAME, 0);
+#endif
+
+#ifdef DROPBEAR_ECDSA
+	loadhostkey(ECDSA_PRIV_FILENAME, 0);
+#endif
+
 #ifdef DROPBEAR_DELAY_HOSTKEY
 	if (svr_opts.delay_hostkey) {
 		disable_unset_keys = 0;
@@ -478,6 +516,22 @@ void load_all_hostkeys() {
 	}
 #endif
 
+#ifdef DROPBEAR_ED25519
+	if (disable_unset_keys && !svr_opts.hostkey->ed25519key) {
+		disablekey(DROPBEAR_SIGNKEY_ED25519);
+	} else {
+		any_keys = 1;
+	}
+#endif
+
+#ifdef DROPBEAR_ECDSA
+	if (disable_unset_keys && !svr_opts.hostkey->ecdsakey) {
+		disablekey(DROPBEAR_SIGNKEY_ECDSA_NISTP256);
+	} else {
+		any_keys = 1;
+	}
+#endif
+
 	if (!any_keys) {
 		dropbear_exit("No hostkeys available. 'dropbear -R' may be useful or run dropbearkey.");
 	}
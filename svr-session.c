@@ -80,6 +80,34 @@ svr_session_cleanup(void) {
 	svr_ses.childpidsize = 0;
 }
 
+/* Precomputation for the next key exchange, and for the host key signature
+ * it will need. The signature's is done once the peer's KEXINIT has settled
+ * on a host key algorithm and its KEXDH_INIT is still to come, or ahead of a
+ * rekey under the same terms as kex_precompute() */
+static int svr_idle_work(int run) {
+
+	int type;
+
+	if (kex_precompute_wanted(1)) {
+		if (run) {
+			kex_precompute();
+		}
+		return 1;
+	}
+
+	if (ses.kexstate.recvkexinit && !ses.kexstate.sentnewkeys) {
+		type = ses.newkeys->algo_hostkey;
+	} else if (kex_rekey_near(1)) {
+		type = ses.keys->algo_hostkey;
+	} else {
+		return 0;
+	}
+	if (type < 0) {
+		return 0;
+	}
+	return sign_key_precompute(svr_opts.hostkey, type, run);
+}
+
 void svr_session(int sock, int childpipe) {
 	char *host, *port;
 	size_t len;
@@ -109,6 +137,7 @@ void svr_session(int sock, int childpipe) {
 	/* set up messages etc */
 	ses.remoteclosed = svr_remoteclosed;
 	ses.extra_session_cleanup = svr_session_cleanup;
+	ses.idle_work = svr_idle_work;
 
 	/* packet handlers */
 	ses.packettypes = svr_packettypes;
@@ -62,22 +62,56 @@
 
 #define SHA1_HASH_SIZE 20
 #define MD5_HASH_SIZE 16
-#define MAX_HASH_SIZE 20 /* sha1 */
+#define SHA256_HASH_SIZE 32
+#define MAX_HASH_SIZE 32 /* sha256 */
 
-#define MAX_KEY_LEN 16 /* 128 bits for aes128 */
+#define MAX_KEY_LEN 64 /* 2 x 256 bits for chacha20-poly1305 */
 #define MAX_IV_LEN 20 /* must be same as max blocksize,  */
-#define MAX_MAC_LEN 20
+#define MAX_MAC_LEN 32 /* sha256 */
 
 /* RSA can be vulnerable to timing attacks which use the time required for
- * signing to guess the private key. Blinding avoids this attack, though makes
- * signing operations slightly slower. */
-//#define RSA_BLINDING
+ * signing to guess the private key. Blinding avoids this attack; with the
+ * blinding values cached and squared for each signature it costs two
+ * modular multiplications per signature. */
+#define RSA_BLINDING
+
+/* A session precomputes this many DSS signing nonces while it waits on the
+ * network, so signing in the key exchange is a few multiplications mod q
+ * rather than an exptmod mod p and an invmod. See dss_nonce_refill() */
+#define DSS_NONCE_POOL 1
+
+/* How long a session with idle work pending waits for the network before
+ * doing a piece of it, in microseconds. Not zero, so that the work can't
+ * turn the session loop into a busy poll */
+#define IDLE_WORK_DELAY 1000
+
+/* the field arithmetic of curve25519.c and ecc.c wants 64x64->128 bit
+ * multiplies */
+#ifndef __SIZEOF_INT128__
+#undef DROPBEAR_CURVE25519
+#undef DROPBEAR_ED25519
+#undef DROPBEAR_ECDH
+#undef DROPBEAR_ECDSA
+#endif
+#if defined(DROPBEAR_CURVE25519) || defined(DROPBEAR_ED25519)
+#define DROPBEAR_CURVE25519_FIELD
+#endif
+#if defined(DROPBEAR_ECDH) || defined(DROPBEAR_ECDSA)
+#define DROPBEAR_ECC
+#endif
 
 /* hashes which will be linked and registered */
 /* LTC SHA384 depends on SHA512 */
 #if defined(DROPBEAR_MD5_HMAC)
 #define DROPBEAR_MD5
 #endif
+#if defined(DROPBEAR_SHA2_256_HMAC) || defined(DROPBEAR_CURVE25519) \
+	|| defined(DROPBEAR_ECC)
+#define DROPBEAR_SHA256
+#endif
+#if defined(DROPBEAR_ED25519)
+#define DROPBEAR_SHA512
+#endif
 
 #define MAX_NAME_LEN 64 /* maximum length of a protocol name, isn't
 						   explicitly specified for all protocols (just
@@ -150,6 +184,19 @@
 #define DROPBEAR_AES
 #endif
 
+#if defined(DROPBEAR_ENABLE_GCM_MODE) && !defined(DROPBEAR_AES)
+#undef DROPBEAR_ENABLE_GCM_MODE
+#endif
+
+#if defined(DROPBEAR_UMAC) && !defined(DROPBEAR_AES)
+#undef DROPBEAR_UMAC
+#endif
+
+/* Ciphers which authenticate the packet themselves */
+#if defined(DROPBEAR_ENABLE_GCM_MODE) || defined(DROPBEAR_CHACHA20POLY1305)
+#define DROPBEAR_AEAD_MODE
+#endif
+
 #ifndef HAVE_FORK
 #define USE_VFORK
 #endif  /* don't HAVE_FORK */